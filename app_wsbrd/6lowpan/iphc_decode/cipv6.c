@@ -111,6 +111,7 @@ buffer_t *lowpan_down(buffer_t *buf)
     if (!buf) {
         return NULL;
     }
+    latency_checkpoint(&buf->latency, LATENCY_TX_IPHC);
 
     buf->info = (buffer_info_t)(B_FROM_IPV6_TXRX | B_TO_MAC | B_DIR_DOWN);
 
@@ -161,6 +162,7 @@ buffer_t *lowpan_up(buffer_t *buf)
     buf->ip_routed_up = true;
     buf = iphc_decompress(buf);
     if (buf) {
+        latency_checkpoint(&buf->latency, LATENCY_RX_LOWPAN);
         buf->info = (buffer_info_t)(B_DIR_UP | B_FROM_IPV6_TXRX | B_TO_IPV6_FWD);
     }
     return buf;
@@ -16,6 +16,7 @@
  * limitations under the License.
  */
 
+#include <inttypes.h>
 #include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
@@ -33,6 +34,8 @@
 #include "common/specs/ip.h"
 
 #include "common/random_early_detection.h"
+#include "common/codel.h"
+#include "common/time_extra.h"
 #include "common/events_scheduler.h"
 
 #include "app/wsbrd.h"
@@ -192,6 +195,44 @@ static void lowpan_adaptation_tx_queue_write_to_front(struct net_if *cur, fragme
     lowpan_adaptation_tx_queue_level_update(cur, interface_ptr);
 }
 
+// Unicast frames to a known neighbor are managed by CoDel, others by RED
+static struct ws_neigh *lowpan_adaptation_aqm_neigh(struct net_if *cur, const buffer_t *buf)
+{
+    if (!cur->adaptation_codel.target_ms || !buf->link_specific.ieee802_15_4.requestAck)
+        return NULL;
+    return ws_neigh_get(&cur->ws_info.neighbor_storage,
+                        &EUI64_FROM_BUF(buf->dst_sa.address + PAN_ID_LEN));
+}
+
+static bool lowpan_adaptation_tx_queue_has_dst(fragmenter_interface_t *interface_ptr, const buffer_t *buf)
+{
+    ns_list_foreach(buffer_t, entry, &interface_ptr->directTxQueue)
+        if (!memcmp(&entry->dst_sa.address[2], &buf->dst_sa.address[2], 8))
+            return true;
+    return false;
+}
+
+// Must be called after buf is removed from the queue
+static bool lowpan_adaptation_aqm_drop(struct net_if *cur, fragmenter_interface_t *interface_ptr, buffer_t *buf)
+{
+    struct ws_neigh *ws_neigh = lowpan_adaptation_aqm_neigh(cur, buf);
+    uint64_t now_us, sojourn_us;
+    bool backlog;
+
+    if (!ws_neigh)
+        return false;
+    now_us = time_now_us(CLOCK_MONOTONIC);
+    sojourn_us = now_us - buf->adaptation_queue_us;
+    // Only look for other frames to the same destination when it matters
+    backlog = sojourn_us >= cur->adaptation_codel.target_ms * 1000ull &&
+              lowpan_adaptation_tx_queue_has_dst(interface_ptr, buf);
+    if (!codel_dequeue(&ws_neigh->aqm, &cur->adaptation_codel, sojourn_us, now_us, backlog))
+        return false;
+    TRACE(TR_TX_ABORT, "tx-abort: codel sojourn=%"PRIu64"ms dst:%s",
+          sojourn_us / 1000, tr_eui64(buf->dst_sa.address + PAN_ID_LEN));
+    return true;
+}
+
 static buffer_t *lowpan_adaptation_tx_queue_read(struct net_if *cur, fragmenter_interface_t *interface_ptr)
 {
     TRACE(TR_QUEUE, "queue: looking for frame to tx");
@@ -204,6 +245,10 @@ static buffer_t *lowpan_adaptation_tx_queue_read(struct net_if *cur, fragmenter_
             ns_list_remove(&interface_ptr->directTxQueue, buf);
             interface_ptr->directTxQueue_size--;
             lowpan_adaptation_tx_queue_level_update(cur, interface_ptr);
+            if (lowpan_adaptation_aqm_drop(cur, interface_ptr, buf)) {
+                buffer_free(buf);
+                continue;
+            }
             TRACE(TR_QUEUE, "queue: frame dequeued dst:%s", tr_eui64(buf->dst_sa.address + PAN_ID_LEN));
             return buf;
         }
@@ -556,7 +601,7 @@ buffer_t *lowpan_adaptation_data_process_tx_preprocess(struct net_if *cur, buffe
             TRACE(TR_TX_ABORT, "tx-abort: neighbor %s not found", tr_eui64(buf->dst_sa.address + PAN_ID_LEN));
             goto tx_error_handler;
         }
-        if (!ws_neigh->trusted_device) {
+        if (!ws_neigh_hot(&cur->ws_info.neighbor_storage, ws_neigh)->trusted) {
             TRACE(TR_TX_ABORT, "tx-abort: neighbor %s not trusted", tr_eui64(buf->dst_sa.address + PAN_ID_LEN));
             goto tx_error_handler;
         }
@@ -592,7 +637,8 @@ static void lowpan_adaptation_data_request_primitiv_set(const buffer_t *buf, mcp
     if (dataReq->Key.SecurityLevel) {
         ws_neigh = ws_neigh_get(&cur->ws_info.neighbor_storage,
                                 &EUI64_FROM_BUF(dataReq->DstAddr));
-        if ((ws_neigh && ws_neigh->node_role == WS_NR_ROLE_LFN) || buf->options.lfn_multicast)
+        if ((ws_neigh && ws_neigh_hot(&cur->ws_info.neighbor_storage, ws_neigh)->node_role == WS_NR_ROLE_LFN) ||
+            buf->options.lfn_multicast)
             dataReq->Key.KeyIndex = cur->ws_info.lfn_gtk_index;
         else
             dataReq->Key.KeyIndex = cur->ws_info.ffn_gtk_index;
@@ -604,6 +650,7 @@ static void lowpan_data_request_to_mac(struct net_if *cur, buffer_t *buf, fragme
     mcps_data_req_t dataReq;
 
     BUG_ON(!interface_ptr->mpx_api);
+    latency_checkpoint(&buf->latency, LATENCY_TX_LLC_QUEUE);
     lowpan_adaptation_data_request_primitiv_set(buf, &dataReq, cur);
     if (tx_ptr->fragmented_data) {
         dataReq.msdu = tx_ptr->fragmenter_buf;
@@ -614,6 +661,7 @@ static void lowpan_data_request_to_mac(struct net_if *cur, buffer_t *buf, fragme
     }
 
     dataReq.lfn_multicast = buf->options.lfn_multicast;
+    dataReq.latency = &buf->latency;
     interface_ptr->mpx_api->mpx_data_request(interface_ptr->mpx_api, &dataReq, interface_ptr->mpx_user_id);
 }
 
@@ -684,7 +732,7 @@ static bool lowpan_adaptation_interface_check_buffer_timeout(struct net_if *cur,
 
         if (!ws_neigh)
             return true;
-        if (ws_neigh->node_role == WS_NR_ROLE_LFN) {
+        if (ws_neigh_hot(&cur->ws_info.neighbor_storage, ws_neigh)->node_role == WS_NR_ROLE_LFN) {
             lfn_uc_l_interval_s = ws_neigh->fhss_data.lfn.uc_listen_interval_ms / 1000;
             return buffer_age_s > LFN_BUFFER_TIMEOUT_PARAM * lfn_uc_l_interval_s;
         }
@@ -720,6 +768,10 @@ int8_t lowpan_adaptation_interface_tx(struct net_if *cur, buffer_t *buf)
         if (!buf->adaptation_timestamp) {
             buf->adaptation_timestamp--;
         }
+        // Frames put back in the queue after a failed transmission keep
+        // their accumulated sojourn time
+        buf->adaptation_queue_us = time_now_us(CLOCK_MONOTONIC);
+        latency_checkpoint(&buf->latency, LATENCY_TX_FRAG);
     } else if (lowpan_adaptation_interface_check_buffer_timeout(cur, buf)) {
         TRACE(TR_TX_ABORT, "tx-abort: buffer timed out dst:%s", tr_eui64(buf->dst_sa.address + PAN_ID_LEN));
         goto tx_error_handler;
@@ -739,7 +791,18 @@ int8_t lowpan_adaptation_interface_tx(struct net_if *cur, buffer_t *buf)
         if (red_congestion_check(&cur->random_early_detection)) {
             WARN("congestion detected: dropping oldest packet");
             // If we need to drop packet we drop oldest normal Priority packet.
-            buffer_t *dropped = ns_list_get_first(&interface_ptr->directTxQueue);
+            // Frames managed by CoDel are left alone so a slow neighbor does
+            // not cause drops for the others, unless there is nothing else to
+            // drop: RED remains the hard limit of the queue.
+            buffer_t *dropped = NULL;
+            ns_list_foreach(buffer_t, entry, &interface_ptr->directTxQueue) {
+                if (!lowpan_adaptation_aqm_neigh(cur, entry)) {
+                    dropped = entry;
+                    break;
+                }
+            }
+            if (!dropped)
+                dropped = ns_list_get_first(&interface_ptr->directTxQueue);
             if (dropped) {
                 TRACE(TR_TX_ABORT, "tx-abort: congestion detected dst:%s",
                       tr_eui64(dropped->dst_sa.address + PAN_ID_LEN));
@@ -860,13 +923,16 @@ static int8_t lowpan_adaptation_interface_tx_confirm(struct net_if *cur, const m
     if (confirm->hif.status == HIF_STATUS_SUCCESS) {
         //Check is there more packets
         if (lowpan_adaptation_tx_process_ready(tx_ptr)) {
+            latency_end(&buf->latency, LATENCY_TX_CNF, LATENCY_TX_TOTAL);
             if (tx_ptr->fragmented_data)
                 interface_ptr->fragmenter_active = false;
             lowpan_adaptation_data_process_clean(interface_ptr, tx_ptr);
         } else {
+            latency_checkpoint(&buf->latency, LATENCY_TX_CNF);
             lowpan_data_request_to_mac(cur, buf, tx_ptr, interface_ptr);
         }
     } else {
+        latency_checkpoint(&buf->latency, LATENCY_TX_CNF);
         if (buf->link_specific.ieee802_15_4.requestAck && confirm->hif.status == HIF_STATUS_TIMEDOUT) {
             lowpan_adaptation_tx_queue_write_to_front(cur, interface_ptr, buf);
             ns_list_remove(&interface_ptr->activeUnicastList, tx_ptr);
@@ -902,6 +968,7 @@ static void lowpan_adaptation_interface_data_ind(struct net_if *cur, const mcps_
         return;
     }
     uint8_t *ptr;
+    latency_start_rx(&buf->latency);
     buffer_data_add(buf, data_ind->msdu_ptr, data_ind->msduLength);
     //tr_debug("MAC Paylod size %u %s",data_ind->msduLength, tr_eui64(data_ind->msdu_ptr));
     buf->src_sa.addr_type = (addrtype_e)data_ind->SrcAddrMode;
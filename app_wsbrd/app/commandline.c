@@ -66,6 +66,14 @@ static const struct number_limit valid_lowpan_mtu = {
     LOWPAN_MTU_MIN, LOWPAN_MTU_MAX
 };
 
+static const struct number_limit valid_tun_rx_batch = {
+    1, 256
+};
+
+static const struct number_limit valid_mpl_buffer_size = {
+    1280, INT_MAX
+};
+
 // 0xffff is not a valid pan_id and means 'undefined' or 'broadcast'
 // See IEEE 802.15.4
 static const struct number_limit valid_pan_id = {
@@ -181,8 +189,10 @@ void parse_commandline(struct wsbrd_conf *config, int argc, char *argv[],
         { "uart_baudrate",                 &config->rcp_cfg.uart_baudrate,         conf_set_number,      NULL },
         { "uart_rtscts",                   &config->rcp_cfg.uart_rtscts,           conf_set_bool,        NULL },
         { "cpc_instance",                  config->rcp_cfg.cpc_instance,           conf_set_string,      (void *)sizeof(config->rcp_cfg.cpc_instance) },
+        { "rcp_io_thread",                 &config->rcp_io_thread,                    conf_set_bool,        NULL },
         { "tun_device",                    config->tun_dev,                           conf_set_string,      (void *)sizeof(config->tun_dev) },
         { "tun_autoconf",                  &config->tun_autoconf,                     conf_set_bool,        NULL },
+        { "tun_rx_batch",                  &config->tun_rx_batch,                     conf_set_number,      &valid_tun_rx_batch },
         { "neighbor_proxy",                config->neighbor_proxy,                    conf_set_string,      (void *)sizeof(config->neighbor_proxy) },
         { "user",                          config->user,                              conf_set_string,      (void *)sizeof(config->user) },
         { "group",                         config->group,                             conf_set_string,      (void *)sizeof(config->group) },
@@ -191,6 +201,9 @@ void parse_commandline(struct wsbrd_conf *config, int argc, char *argv[],
         { "ipv6_prefix",                   &config->ipv6_prefix,                      conf_set_netmask,     NULL },
         { "storage_prefix",                config->storage_prefix,                    conf_set_string,      (void *)sizeof(config->storage_prefix) },
         { "trace",                         &g_enabled_traces,                         conf_add_flags,       &valid_traces },
+        { "capture_checkpoint_interval",   &config->capture_checkpoint_interval,      conf_set_number,      &valid_unsigned },
+        { "trace_ring",                    config->trace_ring,                        conf_set_string,      (void *)sizeof(config->trace_ring) },
+        { "trace_ring_size",               &config->trace_ring_size,                  conf_set_number,      &valid_positive },
         { "internal_dhcp",                 &config->dhcp_server,                      conf_set_dhcp_internal, NULL },
         { "dhcp_server",                   &config->dhcp_server,                      conf_set_netaddr,     &valid_ipv6 },
         { "radius_server",                 &config->auth_cfg.radius_addr,             conf_set_netaddr,     &valid_ipv4or6 },
@@ -243,8 +256,18 @@ void parse_commandline(struct wsbrd_conf *config, int argc, char *argv[],
         { "async_frag_duration",           &config->ws_async_frag_duration,           conf_set_number,      &valid_async_frag_duration },
         { "join_metrics",                  &config->ws_join_metrics,                  conf_set_flags,       &valid_join_metrics },
         { "lowpan_mtu",                    &config->lowpan_mtu,                       conf_set_number,      &valid_lowpan_mtu },
+        { "mpl_buffer_size",               &config->mpl_buffer_size,                  conf_set_number,      &valid_mpl_buffer_size },
+        { "codel_target",                  &config->codel_target,                     conf_set_number,      &valid_unsigned },
+        { "codel_interval",                &config->codel_interval,                   conf_set_number,      &valid_positive },
         { "pan_size",                      &config->pan_size,                         conf_set_number,      &valid_uint16 },
         { "pcap_file",                     config->pcap_file,                         conf_set_string,      (void *)sizeof(config->pcap_file) },
+        { "pcap_buffer_size",              &config->pcap_buffer_size,                 conf_set_number,      &valid_positive },
+        { "pcap_file_size",                &config->pcap_file_size,                   conf_set_number,      &valid_unsigned },
+        { "pcap_file_duration",            &config->pcap_file_duration,               conf_set_number,      &valid_unsigned },
+        { "pcap_file_count",               &config->pcap_file_count,                  conf_set_number,      &valid_positive },
+        { "pcap_snaplen",                  &config->pcap_snaplen,                     conf_set_number,      &valid_unsigned },
+        { "latency_stats",                 &config->latency_stats,                    conf_set_bool,        NULL },
+        { "metrics_port",                  &config->metrics_port,                     conf_set_number,      &valid_uint16 },
         { }
     };
     static const char *opts_short = "u:F:o:t:T:n:d:m:c:S:K:C:A:b:HhvD";
@@ -280,6 +303,7 @@ void parse_commandline(struct wsbrd_conf *config, int argc, char *argv[],
     // Keep these values in sync with examples/wsbrd.conf
     config->rcp_cfg.uart_baudrate = 115200;
     config->tun_autoconf = true;
+    config->tun_rx_batch = 32;
     config->dhcp_server.sin6_family = AF_INET6;
     config->dhcp_server.sin6_addr = in6addr_any;
     config->ws_class = 0;
@@ -296,6 +320,13 @@ void parse_commandline(struct wsbrd_conf *config, int argc, char *argv[],
     config->lfn_bc_sync_period = 5;
     config->bc_dwell_interval = 255;
     config->lowpan_mtu = 2043;
+    config->mpl_buffer_size = 8192;
+    config->codel_target = 1000;
+    config->codel_interval = 10000;
+    config->trace_ring_size = 4 * 1024 * 1024;
+    config->capture_checkpoint_interval = 600;
+    config->pcap_buffer_size = 1024 * 1024;
+    config->pcap_file_count = 10;
     config->auth_cfg.ffn.pmk_lifetime_s = 172800 * 60;
     config->auth_cfg.ffn.ptk_lifetime_s = 86400 * 60;
     config->auth_cfg.ffn.gtk_expire_offset_s = 43200 * 60;
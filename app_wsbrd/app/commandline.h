@@ -35,10 +35,12 @@ struct wsbrd_conf {
     int color_output;
 
     struct rcp_cfg rcp_cfg;
+    bool rcp_io_thread;
 
     char tun_dev[IF_NAMESIZE];
     char neighbor_proxy[IF_NAMESIZE];
     bool tun_autoconf;
+    int tun_rx_batch;
     struct sockaddr_in6 dhcp_server;
 
     char ws_name[33]; // null-terminated string of 32 chars
@@ -62,6 +64,7 @@ struct wsbrd_conf {
     struct in6_addr ipv6_prefix;
 
     char capture[PATH_MAX];
+    int capture_checkpoint_interval;
 
     char storage_prefix[PATH_MAX];
     bool storage_delete;
@@ -92,8 +95,20 @@ struct wsbrd_conf {
     uint8_t ws_denied_mac_address_count;
 
     int lowpan_mtu;
+    int mpl_buffer_size;
+    int codel_target;
+    int codel_interval;
     int pan_size;
     char pcap_file[PATH_MAX];
+    int pcap_buffer_size;
+    int pcap_file_size;
+    int pcap_file_duration;
+    int pcap_file_count;
+    int pcap_snaplen;
+    bool latency_stats;
+    int metrics_port;
+    char trace_ring[PATH_MAX];
+    int trace_ring_size;
 };
 
 void print_help_br(FILE *stream);
@@ -13,19 +13,62 @@
  */
 #include <errno.h>
 #include <math.h>
+#include <sys/queue.h>
 
 #include "app_wsbrd/app/wsbrd.h"
 #include "app_wsbrd/app/commandline_values.h"
+#include "app_wsbrd/ipv6/nd_router_object.h"
+#include "app_wsbrd/net/latency.h"
 #include "app_wsbrd/ws/ws_auth.h"
 #include "app_wsbrd/ws/ws_llc.h"
+#include "common/dbus.h"
+#include "common/fnv_hash.h"
 #include "common/log.h"
+#include "common/memutils.h"
 #include "common/string_extra.h"
+#include "common/time_extra.h"
+#include "common/timer.h"
 #include "common/tun.h"
 #include "common/version.h"
 
 #include "dbus_auth.h"
 #include "dbus.h"
 
+// Changes of Nodes and RoutingGraph are published at most once per period,
+// with a signal carrying only the modified entries.
+#define DBUS_DELTA_PERIOD_MS 1000
+// Link metrics of the nodes change without notification, so the snapshots
+// returned on property reads are also rebuilt after this delay.
+#define DBUS_SNAPSHOT_MAX_AGE_MS 1000
+
+struct dbus_delta_key {
+    uint8_t key[16];
+    bool known;     // Entry has been exposed to D-Bus clients
+    bool pending;
+    bool exists;
+    SLIST_ENTRY(dbus_delta_key) link;
+    SLIST_ENTRY(dbus_delta_key) pending_link;
+};
+
+struct dbus_delta {
+    const char *signal;
+    const char *entry_type;     // Entries are structures starting with an "ay" key
+    const char *entry_fields;
+    const char *properties[3];  // Properties to invalidate, NULL terminated
+    int key_len;
+    bool (*exists)(struct wsbr_ctxt *ctxt, const uint8_t *key);
+    void (*append)(sd_bus_message *m, struct wsbr_ctxt *ctxt, const uint8_t *key);
+    void (*append_all)(sd_bus_message *m, struct wsbr_ctxt *ctxt);
+
+    struct wsbr_ctxt *ctxt;
+    SLIST_HEAD(, dbus_delta_key) keys[256];
+    SLIST_HEAD(, dbus_delta_key) pending;
+    uint64_t version;
+    sd_bus_message *snapshot;
+    uint64_t snapshot_ms;
+    struct timer_entry timer;
+};
+
 int dbus_set_mode_switch(sd_bus_message *m, void *userdata, sd_bus_error *ret_error)
 {
     uint8_t wisun_broadcast_mac_addr[8] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
@@ -451,6 +494,10 @@ void dbus_message_append_node(sd_bus_message *m, const char *property,
             dbus_message_open_info(m, property, "mdr_cmd_capable", "b");
             sd_bus_message_append(m, "b", neighbor->pom_ie.mdr_command_capable);
             dbus_message_close_info(m, property);
+
+            dbus_message_open_info(m, property, "aqm_drops", "t");
+            sd_bus_message_append(m, "t", neighbor->aqm.drops);
+            dbus_message_close_info(m, property);
         }
     }
     sd_bus_message_close_container(m);
@@ -509,14 +556,23 @@ static void dbus_message_append_ipv6_neigh(sd_bus_message *reply, struct ipv6_ne
     dbus_message_append_rpl_target(reply, &target, root->pcs);
 }
 
-int dbus_get_routing_graph(sd_bus *bus, const char *path, const char *interface,
-                           const char *property, sd_bus_message *reply,
-                           void *userdata, sd_bus_error *ret_error)
+static bool dbus_ipv6_neigh_is_route(struct wsbr_ctxt *ctxt, struct ipv6_neighbour *ipv6_neigh)
+{
+    struct ws_neigh *ws_neigh;
+
+    if (IN6_IS_ADDR_MULTICAST(ipv6_neigh->ip_address) || IN6_IS_ADDR_LINKLOCAL(ipv6_neigh->ip_address))
+        return false;
+    if (rpl_target_get(&ctxt->net_if.rpl_root, ipv6_neigh->ip_address))
+        return false;
+    ws_neigh = ws_neigh_get(&ctxt->net_if.ws_info.neighbor_storage,
+                            &EUI64_FROM_BUF(ipv6_neighbour_eui64(&ctxt->net_if.ipv6_neighbour_cache, ipv6_neigh)));
+    return ws_neigh && ws_neigh_hot(&ctxt->net_if.ws_info.neighbor_storage, ws_neigh)->node_role == WS_NR_ROLE_LFN;
+}
+
+static void dbus_message_append_routing_graph(sd_bus_message *reply, struct wsbr_ctxt *ctxt)
 {
-    struct wsbr_ctxt *ctxt = userdata;
     struct rpl_target target_br = { };
     struct rpl_target *target;
-    struct ws_neigh *ws_neigh;
 
     sd_bus_message_open_container(reply, 'a', "(aybaay)");
 
@@ -529,22 +585,295 @@ int dbus_get_routing_graph(sd_bus *bus, const char *path, const char *interface,
     // Since LFN are not routed by RPL, rank 1 LFNs are not RPL targets.
     // This hack allows to expose rank 1 LFNs and relies on their ipv6 address
     // registration.
-    ns_list_foreach(struct ipv6_neighbour, ipv6_neigh, &ctxt->net_if.ipv6_neighbour_cache.list) {
-        if (IN6_IS_ADDR_MULTICAST(ipv6_neigh->ip_address) || IN6_IS_ADDR_LINKLOCAL(ipv6_neigh->ip_address))
-            continue;
-        if (rpl_target_get(&ctxt->net_if.rpl_root, ipv6_neigh->ip_address))
-            continue;
-        ws_neigh = ws_neigh_get(&ctxt->net_if.ws_info.neighbor_storage,
-                                &EUI64_FROM_BUF(ipv6_neighbour_eui64(&ctxt->net_if.ipv6_neighbour_cache, ipv6_neigh)));
-        if (!ws_neigh || ws_neigh->node_role != WS_NR_ROLE_LFN)
+    ns_list_foreach(struct ipv6_neighbour, ipv6_neigh, &ctxt->net_if.ipv6_neighbour_cache.list)
+        if (dbus_ipv6_neigh_is_route(ctxt, ipv6_neigh))
+            dbus_message_append_ipv6_neigh(reply, ipv6_neigh, &ctxt->net_if.rpl_root);
+
+    sd_bus_message_close_container(reply);
+}
+
+static bool dbus_route_exists(struct wsbr_ctxt *ctxt, const uint8_t *ipv6)
+{
+    struct ipv6_neighbour *ipv6_neigh;
+
+    if (rpl_target_get(&ctxt->net_if.rpl_root, ipv6))
+        return true;
+    ipv6_neigh = ipv6_neighbour_lookup(&ctxt->net_if.ipv6_neighbour_cache, ipv6);
+    return ipv6_neigh && dbus_ipv6_neigh_is_route(ctxt, ipv6_neigh);
+}
+
+static void dbus_message_append_route(sd_bus_message *m, struct wsbr_ctxt *ctxt, const uint8_t *ipv6)
+{
+    struct rpl_target *target = rpl_target_get(&ctxt->net_if.rpl_root, ipv6);
+
+    if (target)
+        dbus_message_append_rpl_target(m, target, ctxt->net_if.rpl_root.pcs);
+    else
+        dbus_message_append_ipv6_neigh(m, ipv6_neighbour_lookup(&ctxt->net_if.ipv6_neighbour_cache, ipv6),
+                                       &ctxt->net_if.rpl_root);
+}
+
+static bool dbus_node_exists_key(struct wsbr_ctxt *ctxt, const uint8_t *eui64)
+{
+    if (!memcmp(eui64, ctxt->rcp.eui64.u8, 8))
+        return true;
+    return dbus_node_exists(ctxt, &EUI64_FROM_BUF(eui64));
+}
+
+static void dbus_message_append_node_key(sd_bus_message *m, struct wsbr_ctxt *ctxt, const uint8_t *eui64)
+{
+    if (!memcmp(eui64, ctxt->rcp.eui64.u8, 8))
+        dbus_message_append_node_br(m, "Nodes", ctxt);
+    else
+        dbus_message_append_node_eui64(m, "Nodes", ctxt, &EUI64_FROM_BUF(eui64));
+}
+
+static void dbus_message_append_nodes_all(sd_bus_message *m, struct wsbr_ctxt *ctxt)
+{
+    dbus_message_append_nodes(m, "Nodes", ctxt);
+}
+
+static void dbus_delta_flush(struct timer_group *group, struct timer_entry *timer);
+
+static struct dbus_delta dbus_delta_nodes = {
+    .signal       = "NodesChanged",
+    .entry_type   = "(aya{sv})",
+    .entry_fields = "aya{sv}",
+    .properties   = { "Nodes" },
+    .key_len      = 8,
+    .exists       = dbus_node_exists_key,
+    .append       = dbus_message_append_node_key,
+    .append_all   = dbus_message_append_nodes_all,
+    .timer.callback = dbus_delta_flush,
+};
+
+// Nodes is historically signaled along with RoutingGraph.
+static struct dbus_delta dbus_delta_routes = {
+    .signal       = "RoutesChanged",
+    .entry_type   = "(aybaay)",
+    .entry_fields = "aybaay",
+    .properties   = { "RoutingGraph", "Nodes" },
+    .key_len      = 16,
+    .exists       = dbus_route_exists,
+    .append       = dbus_message_append_route,
+    .append_all   = dbus_message_append_routing_graph,
+    .timer.callback = dbus_delta_flush,
+};
+
+static uint32_t dbus_delta_bucket(struct dbus_delta *delta, const uint8_t *key)
+{
+    return fnv_hash_reverse_32_init(key, delta->key_len) % ARRAY_SIZE(delta->keys);
+}
+
+static struct dbus_delta_key *dbus_delta_key_fetch(struct dbus_delta *delta, const uint8_t *key)
+{
+    uint32_t bucket = dbus_delta_bucket(delta, key);
+    struct dbus_delta_key *entry;
+
+    SLIST_FOREACH(entry, &delta->keys[bucket], link)
+        if (!memcmp(entry->key, key, delta->key_len))
+            return entry;
+    entry = zalloc(sizeof(*entry));
+    memcpy(entry->key, key, delta->key_len);
+    SLIST_INSERT_HEAD(&delta->keys[bucket], entry, link);
+    return entry;
+}
+
+static void dbus_delta_key_del(struct dbus_delta *delta, struct dbus_delta_key *entry)
+{
+    SLIST_REMOVE(&delta->keys[dbus_delta_bucket(delta, entry->key)], entry, dbus_delta_key, link);
+    free(entry);
+}
+
+static void dbus_delta_mark(struct dbus_delta *delta, struct wsbr_ctxt *ctxt, const uint8_t *key)
+{
+    struct dbus_delta_key *entry = dbus_delta_key_fetch(delta, key);
+
+    delta->ctxt = ctxt;
+    if (delta->snapshot)
+        delta->snapshot = sd_bus_message_unref(delta->snapshot);
+    if (!entry->pending) {
+        entry->pending = true;
+        SLIST_INSERT_HEAD(&delta->pending, entry, pending_link);
+    }
+    if (timer_stopped(&delta->timer))
+        timer_start_rel(NULL, &delta->timer, DBUS_DELTA_PERIOD_MS);
+}
+
+static void dbus_delta_append(sd_bus_message *m, struct dbus_delta *delta, bool exists, bool known)
+{
+    struct dbus_delta_key *entry;
+
+    if (exists)
+        sd_bus_message_open_container(m, 'a', delta->entry_type);
+    else
+        sd_bus_message_open_container(m, 'a', "ay");
+    SLIST_FOREACH(entry, &delta->pending, pending_link) {
+        if (entry->exists != exists || entry->known != known)
             continue;
-        dbus_message_append_ipv6_neigh(reply, ipv6_neigh, &ctxt->net_if.rpl_root);
+        if (exists)
+            delta->append(m, delta->ctxt, entry->key);
+        else
+            sd_bus_message_append_array(m, 'y', entry->key, delta->key_len);
+    }
+    sd_bus_message_close_container(m);
+}
+
+static void dbus_delta_flush(struct timer_group *group, struct timer_entry *timer)
+{
+    struct dbus_delta *delta = container_of(timer, struct dbus_delta, timer);
+    struct dbus_delta_key *entry;
+    bool changed = false;
+    sd_bus_message *m;
+
+    SLIST_FOREACH(entry, &delta->pending, pending_link) {
+        entry->exists = delta->exists(delta->ctxt, entry->key);
+        changed |= entry->exists || entry->known;
     }
 
+    if (changed) {
+        delta->version++;
+        m = dbus_signal_new(delta->signal);
+        if (m) {
+            sd_bus_message_append(m, "t", delta->version);
+            dbus_delta_append(m, delta, true, false);  // Added
+            dbus_delta_append(m, delta, true, true);   // Updated
+            dbus_delta_append(m, delta, false, true);  // Removed
+            dbus_signal_send(m);
+        }
+        for (int i = 0; delta->properties[i]; i++)
+            dbus_emit_change(delta->properties[i]);
+    }
+
+    while ((entry = SLIST_FIRST(&delta->pending))) {
+        SLIST_REMOVE_HEAD(&delta->pending, pending_link);
+        entry->pending = false;
+        if (entry->exists)
+            entry->known = true;
+        else
+            dbus_delta_key_del(delta, entry);
+    }
+}
+
+// Record the entries of a snapshot as exposed to clients, so later changes
+// are reported as updates instead of additions.
+static void dbus_delta_learn(struct dbus_delta *delta, sd_bus_message *m)
+{
+    const void *key;
+    size_t len;
+
+    sd_bus_message_rewind(m, true);
+    sd_bus_message_enter_container(m, 'a', delta->entry_type);
+    while (sd_bus_message_enter_container(m, 'r', delta->entry_fields) > 0) {
+        sd_bus_message_read_array(m, 'y', &key, &len);
+        if (len == delta->key_len)
+            dbus_delta_key_fetch(delta, key)->known = true;
+        sd_bus_message_skip(m, delta->entry_fields + strlen("ay"));
+        sd_bus_message_exit_container(m);
+    }
+    sd_bus_message_exit_container(m);
+}
+
+static int dbus_delta_get(struct dbus_delta *delta, sd_bus_message *reply, struct wsbr_ctxt *ctxt)
+{
+    uint64_t now_ms = time_now_ms(CLOCK_MONOTONIC);
+    int ret;
+
+    delta->ctxt = ctxt;
+    if (delta->snapshot && now_ms - delta->snapshot_ms > DBUS_SNAPSHOT_MAX_AGE_MS)
+        delta->snapshot = sd_bus_message_unref(delta->snapshot);
+    if (!delta->snapshot) {
+        // The snapshot is stored in a signal message which is never sent
+        delta->snapshot = dbus_signal_new(delta->signal);
+        if (!delta->snapshot) {
+            delta->append_all(reply, ctxt);
+            return 0;
+        }
+        delta->append_all(delta->snapshot, ctxt);
+        ret = sd_bus_message_seal(delta->snapshot, 1, 0);
+        if (ret < 0) {
+            WARN("sd_bus_message_seal: %s", strerror(-ret));
+            delta->snapshot = sd_bus_message_unref(delta->snapshot);
+            delta->append_all(reply, ctxt);
+            return 0;
+        }
+        delta->snapshot_ms = now_ms;
+        dbus_delta_learn(delta, delta->snapshot);
+    }
+    sd_bus_message_rewind(delta->snapshot, true);
+    return sd_bus_message_copy(reply, delta->snapshot, true);
+}
+
+void dbus_nodes_changed(struct wsbr_ctxt *ctxt, const struct eui64 *eui64)
+{
+    dbus_delta_mark(&dbus_delta_nodes, ctxt, eui64->u8);
+}
+
+void dbus_routes_changed(struct wsbr_ctxt *ctxt, const uint8_t ipv6[16])
+{
+    dbus_delta_mark(&dbus_delta_routes, ctxt, ipv6);
+}
+
+int dbus_get_nodes(sd_bus *bus, const char *path, const char *interface,
+                   const char *property, sd_bus_message *reply,
+                   void *userdata, sd_bus_error *ret_error)
+{
+    return dbus_delta_get(&dbus_delta_nodes, reply, userdata);
+}
+
+int dbus_get_routing_graph(sd_bus *bus, const char *path, const char *interface,
+                           const char *property, sd_bus_message *reply,
+                           void *userdata, sd_bus_error *ret_error)
+{
+    return dbus_delta_get(&dbus_delta_routes, reply, userdata);
+}
+
+static int dbus_get_registration_latency(sd_bus *bus, const char *path, const char *interface,
+                                         const char *property, sd_bus_message *reply,
+                                         void *userdata, sd_bus_error *ret_error)
+{
+    sd_bus_message_append(reply, "(ttt)",
+                          g_nd_registration_stats.count,
+                          g_nd_registration_stats.latency_total_us,
+                          g_nd_registration_stats.latency_max_us);
+    return 0;
+}
+
+static int dbus_get_packet_latency(sd_bus *bus, const char *path, const char *interface,
+                                   const char *property, sd_bus_message *reply,
+                                   void *userdata, sd_bus_error *ret_error)
+{
+    const struct histogram *hist;
+
+    sd_bus_message_open_container(reply, 'a', "(sttttt)");
+    for (int i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        hist = &g_latency.hist[i];
+        sd_bus_message_append(reply, "(sttttt)",
+                              latency_stage_str(i), hist->count,
+                              histogram_quantile(hist, 0.5),
+                              histogram_quantile(hist, 0.99),
+                              histogram_quantile(hist, 0.999),
+                              hist->max);
+    }
     sd_bus_message_close_container(reply);
     return 0;
 }
 
+static int dbus_dump_packet_latency(sd_bus_message *m, void *userdata, sd_bus_error *ret_error)
+{
+    const char *filename;
+    int ret;
+
+    ret = sd_bus_message_read(m, "s", &filename);
+    if (ret < 0)
+        return sd_bus_error_set_errno(ret_error, -ret);
+    ret = latency_dump(filename);
+    if (ret < 0)
+        return sd_bus_error_set_errno(ret_error, -ret);
+    sd_bus_reply_method_return(m, NULL);
+    return 0;
+}
+
 int dbus_get_hw_address(sd_bus *bus, const char *path, const char *interface,
                         const char *property, sd_bus_message *reply,
                         void *userdata, sd_bus_error *ret_error)
@@ -627,6 +956,9 @@ const sd_bus_vtable wsbrd_dbus_vtable[] = {
         SD_BUS_METHOD("IncrementRplDodagVersionNumber", NULL, NULL, dbus_increment_rpl_dodag_version_number, 0),
         SD_BUS_METHOD("AllowMac64",          "aay",    NULL, dbus_allow_mac64, 0),
         SD_BUS_METHOD("DenyMac64",           "aay",    NULL, dbus_deny_mac64, 0),
+        SD_BUS_METHOD("DumpPacketLatency",   "s",      NULL, dbus_dump_packet_latency, 0),
+        SD_BUS_SIGNAL("NodesChanged",  "ta(aya{sv})a(aya{sv})aay", 0),
+        SD_BUS_SIGNAL("RoutesChanged", "ta(aybaay)a(aybaay)aay",   0),
         SD_BUS_PROPERTY("Gtks", "aay", dbus_get_gtks,
                         offsetof(struct wsbr_ctxt, net_if),
                         SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
@@ -643,6 +975,9 @@ const sd_bus_vtable wsbrd_dbus_vtable[] = {
                         SD_BUS_VTABLE_PROPERTY_EMITS_INVALIDATION),
         SD_BUS_PROPERTY("RoutingGraph", "a(aybaay)", dbus_get_routing_graph, 0,
                         SD_BUS_VTABLE_PROPERTY_EMITS_INVALIDATION),
+        SD_BUS_PROPERTY("RegistrationLatency", "(ttt)", dbus_get_registration_latency, 0, 0),
+        SD_BUS_PROPERTY("PacketLatency", "a(sttttt)", dbus_get_packet_latency, 0, 0),
+        SD_BUS_PROPERTY("GroupKeyDistribution", "a(yuuut)", dbus_get_group_key_distribution, 0, 0),
         SD_BUS_PROPERTY("HwAddress", "ay", dbus_get_hw_address,
                         offsetof(struct wsbr_ctxt, rcp.eui64),
                         0),
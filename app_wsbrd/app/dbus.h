@@ -14,14 +14,30 @@
 #ifndef WSBR_DBUS_H
 #define WSBR_DBUS_H
 
+#include <stdint.h>
+
 struct wsbr_ctxt;
+struct eui64;
 
 #ifdef HAVE_LIBSYSTEMD
 #include <systemd/sd-bus.h>
 
 extern const struct sd_bus_vtable wsbrd_dbus_vtable[];
+
+// Notify a change of a node (resp. a RoutingGraph entry). Changes are
+// coalesced and published with NodesChanged (resp. RoutesChanged).
+void dbus_nodes_changed(struct wsbr_ctxt *ctxt, const struct eui64 *eui64);
+void dbus_routes_changed(struct wsbr_ctxt *ctxt, const uint8_t ipv6[16]);
 #else
 static const struct sd_bus_vtable *const wsbrd_dbus_vtable;
+
+static inline void dbus_nodes_changed(struct wsbr_ctxt *ctxt, const struct eui64 *eui64)
+{
+}
+
+static inline void dbus_routes_changed(struct wsbr_ctxt *ctxt, const uint8_t ipv6[16])
+{
+}
 #endif
 
 #endif
@@ -15,7 +15,9 @@
 
 #include "app_wsbrd/app/wsbrd.h"
 #include "common/authenticator/authenticator.h"
+#include "common/memutils.h"
 #include "common/string_extra.h"
+#include "common/time_extra.h"
 
 #include "dbus_auth.h"
 
@@ -45,19 +47,51 @@ void dbus_message_append_supp(sd_bus_message *m, const char *property, const voi
     }
 }
 
-int dbus_get_nodes(sd_bus *bus, const char *path, const char *interface,
-                   const char *property, sd_bus_message *reply,
-                   void *userdata, sd_bus_error *ret_error)
+bool dbus_node_exists(struct wsbr_ctxt *ctxt, const struct eui64 *eui64)
+{
+    return auth_get_supp(&ctxt->auth, eui64);
+}
+
+void dbus_message_append_node_eui64(sd_bus_message *m, const char *property,
+                                    struct wsbr_ctxt *ctxt, const struct eui64 *eui64)
+{
+    const struct auth_supp_ctx *supp = auth_get_supp(&ctxt->auth, eui64);
+    const struct ws_neigh *neigh = ws_neigh_get(&ctxt->net_if.ws_info.neighbor_storage, eui64);
+
+    dbus_message_append_node(m, property, eui64, false, supp, neigh);
+}
+
+void dbus_message_append_nodes(sd_bus_message *m, const char *property, struct wsbr_ctxt *ctxt)
 {
-    struct wsbr_ctxt *ctxt = userdata;
     const struct auth_supp_ctx *supp;
     const struct ws_neigh *neigh;
 
-    sd_bus_message_open_container(reply, 'a', "(aya{sv})");
-    dbus_message_append_node_br(reply, property, ctxt);
+    sd_bus_message_open_container(m, 'a', "(aya{sv})");
+    dbus_message_append_node_br(m, property, ctxt);
     SLIST_FOREACH(supp, &ctxt->auth.supplicants, link) {
         neigh = ws_neigh_get(&ctxt->net_if.ws_info.neighbor_storage, &supp->eui64);
-        dbus_message_append_node(reply, property, &supp->eui64, false, supp, neigh);
+        dbus_message_append_node(m, property, &supp->eui64, false, supp, neigh);
+    }
+    sd_bus_message_close_container(m);
+}
+
+int dbus_get_group_key_distribution(sd_bus *bus, const char *path, const char *interface,
+                                    const char *property, sd_bus_message *reply,
+                                    void *userdata, sd_bus_error *ret_error)
+{
+    struct wsbr_ctxt *ctxt = userdata;
+    const struct auth_rekey *rekeys[] = { &ctxt->auth.gtk_group.rekey, &ctxt->auth.lgtk_group.rekey };
+    const struct auth_rekey *rekey;
+    uint64_t end_ms;
+
+    sd_bus_message_open_container(reply, 'a', "(yuuut)");
+    for (int i = 0; i < ARRAY_SIZE(rekeys); i++) {
+        rekey = rekeys[i];
+        if (rekey->key_slot < 0)
+            continue;
+        end_ms = rekey->done_ms ? : time_now_ms(CLOCK_MONOTONIC);
+        sd_bus_message_append(reply, "(yuuut)", rekey->key_slot + 1, rekey->supps_len,
+                              rekey->started_count, rekey->done_count, end_ms - rekey->start_ms);
     }
     sd_bus_message_close_container(reply);
     return 0;
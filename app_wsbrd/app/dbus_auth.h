@@ -31,8 +31,15 @@ void dbus_message_append_node(sd_bus_message *m, const char *property,
                               bool is_br, const void *supp,
                               const struct ws_neigh *neighbor);
 void dbus_message_append_node_br(sd_bus_message *m, const char *property, struct wsbr_ctxt *ctxt);
+void dbus_message_append_node_eui64(sd_bus_message *m, const char *property,
+                                    struct wsbr_ctxt *ctxt, const struct eui64 *eui64);
+void dbus_message_append_nodes(sd_bus_message *m, const char *property, struct wsbr_ctxt *ctxt);
+bool dbus_node_exists(struct wsbr_ctxt *ctxt, const struct eui64 *eui64);
 int dbus_get_nodes(sd_bus *bus, const char *path, const char *interface,
                    const char *property, sd_bus_message *reply,
                    void *userdata, sd_bus_error *ret_error);
+int dbus_get_group_key_distribution(sd_bus *bus, const char *path, const char *interface,
+                                    const char *property, sd_bus_message *reply,
+                                    void *userdata, sd_bus_error *ret_error);
 
 #endif
@@ -89,33 +89,47 @@ void dbus_message_append_supp(sd_bus_message *m, const char *property, const voi
     }
 }
 
-int dbus_get_nodes(sd_bus *bus, const char *path, const char *interface,
-                   const char *property, sd_bus_message *reply,
-                   void *userdata, sd_bus_error *ret_error)
+// Supplicants still negotiating are not in the key storage, but they are
+// neighbors of the border router at that point.
+bool dbus_node_exists(struct wsbr_ctxt *ctxt, const struct eui64 *eui64)
+{
+    return ws_pae_key_storage_supp_exists(eui64->u8) ||
+           ws_neigh_get(&ctxt->net_if.ws_info.neighbor_storage, eui64);
+}
+
+void dbus_message_append_node_eui64(sd_bus_message *m, const char *property,
+                                    struct wsbr_ctxt *ctxt, const struct eui64 *eui64)
 {
     const struct ws_neigh *neighbor_info;
-    struct wsbr_ctxt *ctxt = userdata;
+    supp_entry_t *supp;
+
+    neighbor_info = ws_neigh_get(&ctxt->net_if.ws_info.neighbor_storage, eui64);
+    if (ws_pae_key_storage_supp_exists(eui64->u8))
+        supp = ws_pae_key_storage_supp_read(NULL, eui64->u8, NULL, NULL, NULL);
+    else
+        supp = NULL;
+    dbus_message_append_node(m, property, eui64, false, supp, neighbor_info);
+    if (supp)
+        free(supp);
+}
+
+void dbus_message_append_nodes(sd_bus_message *m, const char *property, struct wsbr_ctxt *ctxt)
+{
     int len_pae;
     uint8_t eui64_pae[4096][8];
-    supp_entry_t *supp;
 
     len_pae = ws_pae_auth_supp_list(ctxt->net_if.id, eui64_pae, sizeof(eui64_pae));
 
-    sd_bus_message_open_container(reply, 'a', "(aya{sv})");
-    dbus_message_append_node_br(reply, property, ctxt);
-
-    for (int i = 0; i < len_pae; i++) {
-        neighbor_info = ws_neigh_get(&ctxt->net_if.ws_info.neighbor_storage,
-                                     &EUI64_FROM_BUF(eui64_pae[i]));
-        if (ws_pae_key_storage_supp_exists(eui64_pae[i]))
-            supp = ws_pae_key_storage_supp_read(NULL, eui64_pae[i], NULL, NULL, NULL);
-        else
-            supp = NULL;
-        dbus_message_append_node(reply, property, &EUI64_FROM_BUF(eui64_pae[i]),
-                                 false, supp, neighbor_info);
-        if (supp)
-            free(supp);
-    }
-    sd_bus_message_close_container(reply);
-    return 0;
+    sd_bus_message_open_container(m, 'a', "(aya{sv})");
+    dbus_message_append_node_br(m, property, ctxt);
+    for (int i = 0; i < len_pae; i++)
+        dbus_message_append_node_eui64(m, property, ctxt, &EUI64_FROM_BUF(eui64_pae[i]));
+    sd_bus_message_close_container(m);
+}
+
+int dbus_get_group_key_distribution(sd_bus *bus, const char *path, const char *interface,
+                                    const char *property, sd_bus_message *reply,
+                                    void *userdata, sd_bus_error *ret_error)
+{
+    return sd_bus_error_set_errno(ret_error, ENOTSUP);
 }
@@ -28,6 +28,7 @@ struct wsbr_ctxt;
 struct bus;
 struct net_if;
 struct rcp;
+struct latency_tstamp;
 
 struct mlme_security {
     unsigned SecurityLevel: 3;      /**< Security level */
@@ -54,6 +55,7 @@ typedef struct mcps_data_req {
     uint8_t ms_mode;
     uint8_t fhss_type;              /**< FHSS policy to send that frame */
     uint8_t frame_type;
+    struct latency_tstamp *latency; // Optional
 } mcps_data_req_t;
 
 // Used by rcp_legacy_tx_req_legacy()
@@ -34,6 +34,7 @@
 #include "common/capture.h"
 #include "common/log.h"
 #include "common/endian.h"
+#include "common/histogram.h"
 #include "common/iobuf.h"
 #include "common/netinet_in_extra.h"
 #include "common/tun.h"
@@ -118,6 +119,9 @@ void wsbr_tun_init(struct wsbr_ctxt *ctxt)
     strcpy(ctxt->tun.ifname, ctxt->config.tun_dev);
     tun_init(&ctxt->tun, ctxt->config.tun_autoconf);
     capture_register_netfd(ctxt->tun.fd);
+    // wsbr_tun_read() reads until the queue is empty
+    ret = fcntl(ctxt->tun.fd, F_SETFL, O_NONBLOCK);
+    FATAL_ON(ret < 0, 2, "%s: fcntl: %m", __func__);
 
     if (ctxt->config.tun_autoconf) {
         memcpy(addr.s6_addr + 8, &ctxt->rcp.eui64, 8);
@@ -171,7 +175,8 @@ static bool is_icmpv6_type_supported_by_wisun(uint8_t iv6t)
         return false;
 }
 
-void wsbr_tun_read(struct wsbr_ctxt *ctxt)
+// Returns false if nothing could be read
+static bool wsbr_tun_recv(struct wsbr_ctxt *ctxt)
 {
     uint8_t buf[1504]; // Max ethernet frame size + TUN header
     struct iobuf_read iobuf = { .data = buf };
@@ -181,20 +186,21 @@ void wsbr_tun_read(struct wsbr_ctxt *ctxt)
 
     iobuf.data_size = xread(ctxt->tun.fd, buf, sizeof(buf));
     if (iobuf.data_size < 0) {
-        WARN("%s: read: %m", __func__);
-        return;
+        WARN_ON(errno != EAGAIN, "%s: read: %m", __func__);
+        return false;
     }
     TRACE(TR_TUN, "rx-tun: %i bytes", iobuf.data_size);
 
     ip_version = FIELD_GET(IPV6_MASK_VERSION, iobuf_pop_be32(&iobuf));
     if (ip_version != 6) {
         TRACE(TR_DROP, "drop %-9s: unsupported IPv%u", "tun", ip_version);
-        return;
+        return true;
     }
 
     buf_6lowpan = buffer_get_minimal(iobuf.data_size);
     if (!buf_6lowpan)
         FATAL(1,"could not allocate tun buffer_t");
+    latency_start(&buf_6lowpan->latency);
     buf_6lowpan->interface = &ctxt->net_if;
     buffer_data_add(buf_6lowpan, iobuf.data, iobuf.data_size);
 
@@ -210,7 +216,7 @@ void wsbr_tun_read(struct wsbr_ctxt *ctxt)
         if(!addr_am_group_member_on_interface(&ctxt->net_if, buf_6lowpan->dst_sa.address)) {
             TRACE(TR_DROP, "drop %-9s: unsupported dst=%s", "tun", tr_ipv6(buf_6lowpan->dst_sa.address));
             buffer_free(buf_6lowpan);
-            return;
+            return true;
         }
         if (!memcmp(buf_6lowpan->dst_sa.address, ADDR_ALL_MPL_FORWARDERS, 16))
             buf_6lowpan->options.mpl_fwd_workaround = true;
@@ -224,10 +230,33 @@ void wsbr_tun_read(struct wsbr_ctxt *ctxt)
         if (!is_icmpv6_type_supported_by_wisun(type)) {
             TRACE(TR_DROP, "drop %-9s: unsupported ICMPv6 type %u", "tun", type);
             buffer_free(buf_6lowpan);
-            return;
+            return true;
         }
     }
 
     buf_6lowpan->info = (buffer_info_t)(B_DIR_DOWN | B_FROM_IPV6_FWD | B_TO_IPV6_FWD);
     protocol_push(buf_6lowpan);
+    return true;
+}
+
+/*
+ * A downlink burst (e.g. a multicast firmware update) would otherwise cost a
+ * full poll() iteration per packet. The file descriptor is non-blocking, so
+ * packets are read until the TUN queue is empty, the adaptation layer applies
+ * backpressure (see wsbr_poll()), or tun_rx_batch packets were processed, so
+ * the other file descriptors are not starved.
+ */
+void wsbr_tun_read(struct wsbr_ctxt *ctxt)
+{
+    int cnt = 0;
+
+    while (wsbr_tun_recv(ctxt)) {
+        cnt++;
+        if (cnt >= ctxt->config.tun_rx_batch)
+            break;
+        if (lowpan_adaptation_queue_size(ctxt->net_if.id) > 2)
+            break;
+    }
+    histogram_add(&ctxt->tun_rx_batch_hist, cnt);
+    ctxt->tun_rx_packets += cnt;
 }
@@ -21,17 +21,16 @@
 const struct wsbr_cfg size_params[5] = {
     [WS_NETWORK_SIZE_CERTIFICATION] = {
         // Discovery
-        .trickle_discovery.Imin = 15,
-        .trickle_discovery.Imax = 60,
+        .trickle_discovery.Imin_ms = 15 * 1000,
+        .trickle_discovery.Imax_ms = 60 * 1000,
         .trickle_discovery.k = 3,
-        .trickle_discovery.TimerExpirations = TRICKLE_EXPIRATIONS_INFINITE,
 
         // Wi-SUN FAN 1.1v08 6.2.1.1 Configuration Parameters
-        .trickle_mpl.Imin = 6,      // Arbitrary (Wi-SUN 10s default is too long)
-        .trickle_mpl.Imax = 6 << 3, // 48s instead of 80s with modified Imin
+        .trickle_mpl.Imin_ms = 6 * 1000,  // Arbitrary (Wi-SUN 10s default is too long)
+        .trickle_mpl.Imax_ms = TRICKLE_DOUBLINGS(6 * 1000, 3), // 48s instead of 80s with modified Imin
         // RFC 7731 5.4. MPL Parameters
-        .trickle_mpl.k = 3,         // Arbitrary (RFC 7731 k=1 default is too small)
-        .trickle_mpl.TimerExpirations = 3,
+        .trickle_mpl.k = 3, // Arbitrary (RFC 7731 k=1 default is too small)
+        .mpl_timer_expirations = 3,
         .mpl_seed_set_entry_lifetime = 30 * 60,
 
         // Security protocol
@@ -43,16 +42,15 @@ const struct wsbr_cfg size_params[5] = {
     },
     [WS_NETWORK_SIZE_SMALL] = {
         // Discovery
-        .trickle_discovery.Imin = 15,
-        .trickle_discovery.Imax = 60,
+        .trickle_discovery.Imin_ms = 15 * 1000,
+        .trickle_discovery.Imax_ms = 60 * 1000,
         .trickle_discovery.k = 1,
-        .trickle_discovery.TimerExpirations = TRICKLE_EXPIRATIONS_INFINITE,
 
         // MPL
-        .trickle_mpl.Imin = 1,
-        .trickle_mpl.Imax = 10,
+        .trickle_mpl.Imin_ms = 1 * 1000,
+        .trickle_mpl.Imax_ms = 10 * 1000,
         .trickle_mpl.k = 8,
-        .trickle_mpl.TimerExpirations = 2,
+        .mpl_timer_expirations = 2,
         // Imax * MPL_SAFE_HOP_COUNT * (TimerExpirations + 1)
         .mpl_seed_set_entry_lifetime = 10 * MPL_SAFE_HOP_COUNT * (2 + 1),
 
@@ -65,16 +63,15 @@ const struct wsbr_cfg size_params[5] = {
     },
     [WS_NETWORK_SIZE_MEDIUM] = {
         // Discovery
-        .trickle_discovery.Imin = 60,
-        .trickle_discovery.Imax = 960,
+        .trickle_discovery.Imin_ms = 60 * 1000,
+        .trickle_discovery.Imax_ms = 960 * 1000,
         .trickle_discovery.k = 1,
-        .trickle_discovery.TimerExpirations = TRICKLE_EXPIRATIONS_INFINITE,
 
         // MPL
-        .trickle_mpl.Imin = 1,
-        .trickle_mpl.Imax = 32,
+        .trickle_mpl.Imin_ms = 1 * 1000,
+        .trickle_mpl.Imax_ms = 32 * 1000,
         .trickle_mpl.k = 8,
-        .trickle_mpl.TimerExpirations = 2,
+        .mpl_timer_expirations = 2,
         // Imax * MPL_SAFE_HOP_COUNT * (TimerExpirations + 1)
         .mpl_seed_set_entry_lifetime = 32 * MPL_SAFE_HOP_COUNT * (2 + 1),
 
@@ -87,16 +84,15 @@ const struct wsbr_cfg size_params[5] = {
     },
     [WS_NETWORK_SIZE_LARGE] = {
         // Discovery
-        .trickle_discovery.Imin = 120,
-        .trickle_discovery.Imax = 1536,
+        .trickle_discovery.Imin_ms = 120 * 1000,
+        .trickle_discovery.Imax_ms = 1536 * 1000,
         .trickle_discovery.k = 1,
-        .trickle_discovery.TimerExpirations = TRICKLE_EXPIRATIONS_INFINITE,
 
         // MPL
-        .trickle_mpl.Imin = 5,
-        .trickle_mpl.Imax = 40,
+        .trickle_mpl.Imin_ms = 5 * 1000,
+        .trickle_mpl.Imax_ms = 40 * 1000,
         .trickle_mpl.k = 8,
-        .trickle_mpl.TimerExpirations = 2,
+        .mpl_timer_expirations = 2,
         // Imax * MPL_SAFE_HOP_COUNT * (TimerExpirations + 1)
         .mpl_seed_set_entry_lifetime = 40 * MPL_SAFE_HOP_COUNT * (2 + 1),
 
@@ -109,16 +105,15 @@ const struct wsbr_cfg size_params[5] = {
     },
     [WS_NETWORK_SIZE_XLARGE] = {
         // Discovery
-        .trickle_discovery.Imin = 240,
-        .trickle_discovery.Imax = 1920,
+        .trickle_discovery.Imin_ms = 240 * 1000,
+        .trickle_discovery.Imax_ms = 1920 * 1000,
         .trickle_discovery.k = 1,
-        .trickle_discovery.TimerExpirations = TRICKLE_EXPIRATIONS_INFINITE,
 
         // MPL
-        .trickle_mpl.Imin = 10,
-        .trickle_mpl.Imax = 80,
+        .trickle_mpl.Imin_ms = 10 * 1000,
+        .trickle_mpl.Imax_ms = 80 * 1000,
         .trickle_mpl.k = 8,
-        .trickle_mpl.TimerExpirations = 2,
+        .mpl_timer_expirations = 2,
         // Imax * MPL_SAFE_HOP_COUNT * (TimerExpirations + 1)
         .mpl_seed_set_entry_lifetime = 80 * MPL_SAFE_HOP_COUNT * (2 + 1),
 
@@ -18,7 +18,7 @@
 #include <stdint.h>
 
 #include "security/protocols/sec_prot_cfg.h"
-#include "common/trickle_legacy.h"
+#include "common/trickle.h"
 
 enum ws_network_size {
     WS_NETWORK_SIZE_SMALL,
@@ -29,10 +29,11 @@ enum ws_network_size {
 };
 
 struct wsbr_cfg {
-    struct trickle_legacy_params trickle_discovery;
+    struct trickle_cfg trickle_discovery;
 
     // MPL paramters
-    struct trickle_legacy_params trickle_mpl;
+    struct trickle_cfg trickle_mpl;
+    uint8_t mpl_timer_expirations;
     uint16_t mpl_seed_set_entry_lifetime;
 
     struct sec_prot_cfg security_protocol_config;
@@ -36,6 +36,7 @@
 #include "common/specs/ieee802154.h"
 
 #include "net/protocol.h"
+#include "net/latency.h"
 #include "ws/ws_bootstrap.h"
 #include "ws/ws_common.h"
 #include "ws/ws_config.h"
@@ -108,6 +109,8 @@ void wsbr_data_req_ext(struct net_if *cur,
                     neighbor_ws ? neighbor_ws->frame_counter_min : NULL,
                     data->rate_list[0].phy_mode_id ? data->rate_list : NULL,
                     data->ms_mode == WS_MODE_SWITCH_MAC ? HIF_MODE_SWITCH_TYPE_MAC : HIF_MODE_SWITCH_TYPE_PHY);
+    if (data->latency)
+        latency_checkpoint(data->latency, LATENCY_TX_HIF);
     iobuf_free(&frame);
 }
 
@@ -149,6 +152,8 @@ void wsbr_rx_ind(struct rcp *rcp, const struct rcp_rx_ind *ind)
     struct ieee802154_hdr hdr;
     int ret;
 
+    if (g_latency.enabled)
+        g_latency.rx_ind_us = time_now_us(CLOCK_MONOTONIC);
     ret = ieee802154_frame_parse(ind->frame, ind->frame_len, &hdr, &ie_header, &ie_payload);
     if (ret < 0)
         return;
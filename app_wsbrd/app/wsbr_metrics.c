@@ -0,0 +1,274 @@
+/*
+ * SPDX-License-Identifier: LicenseRef-MSLA
+ * Copyright (c) 2025 Silicon Laboratories Inc. (www.silabs.com)
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of the Silicon Labs Master Software License
+ * Agreement (MSLA) available at [1].  This software is distributed to you in
+ * Object Code format and/or Source Code format and is governed by the sections
+ * of the MSLA applicable to Object Code, Source Code and Modified Open Source
+ * Code. By using this software, you agree to the terms of the MSLA.
+ *
+ * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
+ */
+#define _GNU_SOURCE
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "common/specs/ws.h"
+#include "common/log.h"
+#include "common/timer.h"
+#include "6lowpan/lowpan_adaptation_interface.h"
+#include "ws/ws_llc.h"
+
+#include "wsbrd.h"
+#include "wsbr_metrics.h"
+
+void wsbr_metrics_init(struct wsbr_ctxt *ctxt)
+{
+    struct sockaddr_in6 addr = {
+        .sin6_family = AF_INET6,
+        .sin6_addr   = IN6ADDR_LOOPBACK_INIT,
+        .sin6_port   = htons(ctxt->config.metrics_port),
+    };
+    int ret;
+
+    ctxt->metrics_fd = socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    FATAL_ON(ctxt->metrics_fd < 0, 2, "%s: socket: %m", __func__);
+    ret = setsockopt(ctxt->metrics_fd, SOL_SOCKET, SO_REUSEADDR, &(int){ 1 }, sizeof(int));
+    FATAL_ON(ret < 0, 2, "%s: setsockopt: %m", __func__);
+    ret = bind(ctxt->metrics_fd, (struct sockaddr *)&addr, sizeof(addr));
+    FATAL_ON(ret < 0, 2, "%s: bind [::1]:%d: %m", __func__, ctxt->config.metrics_port);
+    ret = listen(ctxt->metrics_fd, 4);
+    FATAL_ON(ret < 0, 2, "%s: listen: %m", __func__);
+}
+
+static void wsbr_metrics_close_client(struct wsbr_ctxt *ctxt)
+{
+    close(ctxt->metrics_client_fd);
+    free(ctxt->metrics_resp);
+    ctxt->metrics_resp = NULL;
+    ctxt->metrics_resp_len = 0;
+    ctxt->metrics_resp_offset = 0;
+    ctxt->metrics_client_fd = -1;
+    ctxt->fds[POLLFD_METRICS_CLIENT].fd = -1;
+    ctxt->fds[POLLFD_METRICS_CLIENT].events = POLLIN;
+    // The client may be replaced before the events of this poll() round
+    // are processed
+    ctxt->fds[POLLFD_METRICS_CLIENT].revents = 0;
+}
+
+void wsbr_metrics_accept(struct wsbr_ctxt *ctxt)
+{
+    int fd;
+
+    fd = accept4(ctxt->metrics_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+        WARN("%s: accept: %m", __func__);
+        return;
+    }
+    // Only one scrape at a time, the previous client is too slow anyway
+    if (ctxt->metrics_client_fd >= 0)
+        wsbr_metrics_close_client(ctxt);
+    ctxt->metrics_client_fd = fd;
+    ctxt->metrics_req_len = 0;
+    ctxt->fds[POLLFD_METRICS_CLIENT].fd = fd;
+}
+
+static void metrics_print_label(FILE *out, const char *str)
+{
+    for (; *str; str++) {
+        if (*str == '\\' || *str == '"')
+            fprintf(out, "\\%c", *str);
+        else if (*str == '\n')
+            fprintf(out, "\\n");
+        else
+            fputc(*str, out);
+    }
+}
+
+static void wsbr_metrics_print(struct wsbr_ctxt *ctxt, FILE *out)
+{
+    const struct timer_stats *timer_stats = timer_get_stats();
+    const struct red_config *red;
+    struct tr_drop_site *site;
+    struct auth_supp_ctx *supp;
+    struct rpl_target *target;
+    struct ws_neigh *neigh;
+    int ffn = 0, lfn = 0;
+    int cnt;
+
+    fprintf(out, "# TYPE wsbrd_adaptation_queue gauge\n");
+    fprintf(out, "# HELP wsbrd_adaptation_queue Frames waiting in the 6LoWPAN adaptation layer.\n");
+    fprintf(out, "wsbrd_adaptation_queue %d\n", lowpan_adaptation_queue_size(ctxt->net_if.id));
+    fprintf(out, "# TYPE wsbrd_llc_queue gauge\n");
+    fprintf(out, "# HELP wsbrd_llc_queue Frames sent to the RCP and waiting for a confirmation.\n");
+    fprintf(out, "wsbrd_llc_queue %d\n", ws_llc_queue_size(&ctxt->net_if));
+
+    fprintf(out, "# TYPE wsbrd_tun_rx_batch summary\n");
+    fprintf(out, "# HELP wsbrd_tun_rx_batch Packets read from the TUN interface per wakeup.\n");
+    fprintf(out, "wsbrd_tun_rx_batch{quantile=\"0.5\"} %"PRIu64"\n",
+            histogram_quantile(&ctxt->tun_rx_batch_hist, 0.5));
+    fprintf(out, "wsbrd_tun_rx_batch{quantile=\"0.99\"} %"PRIu64"\n",
+            histogram_quantile(&ctxt->tun_rx_batch_hist, 0.99));
+    fprintf(out, "wsbrd_tun_rx_batch{quantile=\"1\"} %"PRIu64"\n", ctxt->tun_rx_batch_hist.max);
+    fprintf(out, "wsbrd_tun_rx_batch_sum %"PRIu64"\n", ctxt->tun_rx_packets);
+    fprintf(out, "wsbrd_tun_rx_batch_count %"PRIu64"\n", ctxt->tun_rx_batch_hist.count);
+
+    fprintf(out, "# TYPE wsbrd_red_average_queue gauge\n");
+    fprintf(out, "# HELP wsbrd_red_average_queue Average queue size computed by Random Early Detection.\n");
+    red = &ctxt->net_if.random_early_detection;
+    fprintf(out, "wsbrd_red_average_queue{queue=\"adaptation\"} %g\n", red->average_queue_size / 256.0);
+    red = &ctxt->net_if.llc_random_early_detection;
+    fprintf(out, "wsbrd_red_average_queue{queue=\"llc\"} %g\n", red->average_queue_size / 256.0);
+    red = &ctxt->net_if.llc_eapol_random_early_detection;
+    fprintf(out, "wsbrd_red_average_queue{queue=\"llc-eapol\"} %g\n", red->average_queue_size / 256.0);
+    red = &ctxt->net_if.pae_random_early_detection;
+    fprintf(out, "wsbrd_red_average_queue{queue=\"pae\"} %g\n", red->average_queue_size / 256.0);
+
+    for (int i = 0; i < ctxt->net_if.ws_info.neighbor_storage.hot_len; i++) {
+        if (ctxt->net_if.ws_info.neighbor_storage.hot[i].node_role == WS_NR_ROLE_LFN)
+            lfn++;
+        else
+            ffn++;
+    }
+    fprintf(out, "# TYPE wsbrd_aqm_drops counter\n");
+    fprintf(out, "# HELP wsbrd_aqm_drops Unicast frames dropped by CoDel in the adaptation layer.\n");
+    SLIST_FOREACH(neigh, &ctxt->net_if.ws_info.neighbor_storage.neigh_list, link)
+        if (neigh->aqm.drops)
+            fprintf(out, "wsbrd_aqm_drops_total{neighbor=\"%s\"} %"PRIu64"\n",
+                    tr_eui64(neigh->eui64.u8), neigh->aqm.drops);
+    fprintf(out, "# TYPE wsbrd_neighbors gauge\n");
+    fprintf(out, "# HELP wsbrd_neighbors Entries in the neighbor table.\n");
+    fprintf(out, "wsbrd_neighbors{role=\"ffn\"} %d\n", ffn);
+    fprintf(out, "wsbrd_neighbors{role=\"lfn\"} %d\n", lfn);
+
+    cnt = 0;
+    SLIST_FOREACH(target, &ctxt->net_if.rpl_root.targets, link)
+        cnt++;
+    fprintf(out, "# TYPE wsbrd_rpl_targets gauge\n");
+    fprintf(out, "# HELP wsbrd_rpl_targets RPL targets known by the root.\n");
+    fprintf(out, "wsbrd_rpl_targets %d\n", cnt);
+
+#ifndef HAVE_AUTH_LEGACY
+    cnt = 0;
+    SLIST_FOREACH(supp, &ctxt->auth.supplicants, link)
+        if (!timer_stopped(&supp->rt_timer))
+            cnt++;
+    fprintf(out, "# TYPE wsbrd_auth_sessions gauge\n");
+    fprintf(out, "# HELP wsbrd_auth_sessions Supplicants with an authentication exchange in progress.\n");
+    fprintf(out, "wsbrd_auth_sessions %d\n", cnt);
+#else
+    (void)supp;
+#endif
+
+    fprintf(out, "# TYPE wsbrd_hif_frames counter\n");
+    fprintf(out, "# HELP wsbrd_hif_frames Frames exchanged with the RCP.\n");
+    fprintf(out, "wsbrd_hif_frames_total{dir=\"tx\"} %"PRIu64"\n",
+            __atomic_load_n(&ctxt->rcp.tx_frames, __ATOMIC_RELAXED));
+    fprintf(out, "wsbrd_hif_frames_total{dir=\"rx\"} %"PRIu64"\n",
+            __atomic_load_n(&ctxt->rcp.rx_frames, __ATOMIC_RELAXED));
+    fprintf(out, "# TYPE wsbrd_hif_bytes counter\n");
+    fprintf(out, "# UNIT wsbrd_hif_bytes bytes\n");
+    fprintf(out, "# HELP wsbrd_hif_bytes Bytes exchanged with the RCP.\n");
+    fprintf(out, "wsbrd_hif_bytes_total{dir=\"tx\"} %"PRIu64"\n",
+            __atomic_load_n(&ctxt->rcp.tx_bytes, __ATOMIC_RELAXED));
+    fprintf(out, "wsbrd_hif_bytes_total{dir=\"rx\"} %"PRIu64"\n",
+            __atomic_load_n(&ctxt->rcp.rx_bytes, __ATOMIC_RELAXED));
+
+    // Sites which never dropped anything are omitted to keep the output small
+    fprintf(out, "# TYPE wsbrd_drops counter\n");
+    fprintf(out, "# HELP wsbrd_drops Packets dropped, by TRACE(TR_DROP) call site.\n");
+    for (site = tr_drop_site_first(); site < tr_drop_site_last(); site++) {
+        if (!__atomic_load_n(&site->count, __ATOMIC_RELAXED))
+            continue;
+        fprintf(out, "wsbrd_drops_total{file=\"");
+        metrics_print_label(out, site->file);
+        fprintf(out, "\",line=\"%d\",reason=\"", site->line);
+        metrics_print_label(out, site->fmt);
+        fprintf(out, "\"} %"PRIu64"\n", __atomic_load_n(&site->count, __ATOMIC_RELAXED));
+    }
+
+    fprintf(out, "# TYPE wsbrd_timer_lag_seconds summary\n");
+    fprintf(out, "# UNIT wsbrd_timer_lag_seconds seconds\n");
+    fprintf(out, "# HELP wsbrd_timer_lag_seconds Delay between timer expiration and processing.\n");
+    fprintf(out, "wsbrd_timer_lag_seconds_sum %g\n",
+            __atomic_load_n(&timer_stats->lag_sum_ms, __ATOMIC_RELAXED) / 1000.0);
+    fprintf(out, "wsbrd_timer_lag_seconds_count %"PRIu64"\n",
+            __atomic_load_n(&timer_stats->lag_count, __ATOMIC_RELAXED));
+    fprintf(out, "# TYPE wsbrd_timer_lag_max_seconds gauge\n");
+    fprintf(out, "# UNIT wsbrd_timer_lag_max_seconds seconds\n");
+    fprintf(out, "wsbrd_timer_lag_max_seconds %g\n",
+            __atomic_load_n(&timer_stats->lag_max_ms, __ATOMIC_RELAXED) / 1000.0);
+
+    fprintf(out, "# EOF\n");
+}
+
+void wsbr_metrics_send(struct wsbr_ctxt *ctxt)
+{
+    ssize_t ret;
+
+    while (ctxt->metrics_resp_offset < ctxt->metrics_resp_len) {
+        ret = write(ctxt->metrics_client_fd, ctxt->metrics_resp + ctxt->metrics_resp_offset,
+                    ctxt->metrics_resp_len - ctxt->metrics_resp_offset);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret < 0 && errno == EAGAIN)
+            return; // Wait for POLLOUT
+        if (ret <= 0) {
+            WARN("%s: write: %m", __func__);
+            wsbr_metrics_close_client(ctxt);
+            return;
+        }
+        ctxt->metrics_resp_offset += ret;
+    }
+    shutdown(ctxt->metrics_client_fd, SHUT_WR);
+    wsbr_metrics_close_client(ctxt);
+}
+
+void wsbr_metrics_recv(struct wsbr_ctxt *ctxt)
+{
+    size_t body_len;
+    char *body;
+    ssize_t ret;
+    FILE *out;
+
+    ret = recv(ctxt->metrics_client_fd, ctxt->metrics_req + ctxt->metrics_req_len,
+               sizeof(ctxt->metrics_req) - ctxt->metrics_req_len - 1, MSG_DONTWAIT);
+    if (ret < 0 && (errno == EAGAIN || errno == EINTR))
+        return;
+    if (ret <= 0) {
+        wsbr_metrics_close_client(ctxt);
+        return;
+    }
+    ctxt->metrics_req_len += ret;
+    ctxt->metrics_req[ctxt->metrics_req_len] = '\0';
+    // Wait for the end of the request headers (the content is ignored)
+    if (!strstr(ctxt->metrics_req, "\r\n\r\n") &&
+        ctxt->metrics_req_len < sizeof(ctxt->metrics_req) - 1)
+        return;
+
+    // Further requests on this connection are ignored
+    if (ctxt->metrics_resp)
+        return;
+    out = open_memstream(&body, &body_len);
+    FATAL_ON(!out, 2, "%s: open_memstream: %m", __func__);
+    wsbr_metrics_print(ctxt, out);
+    fclose(out);
+    out = open_memstream(&ctxt->metrics_resp, &ctxt->metrics_resp_len);
+    FATAL_ON(!out, 2, "%s: open_memstream: %m", __func__);
+    fprintf(out, "HTTP/1.0 200 OK\r\n"
+                 "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+                 "Content-Length: %zu\r\n"
+                 "Connection: close\r\n"
+                 "\r\n", body_len);
+    fwrite(body, 1, body_len, out);
+    fclose(out);
+    free(body);
+    ctxt->metrics_resp_offset = 0;
+    ctxt->fds[POLLFD_METRICS_CLIENT].events = POLLOUT;
+    wsbr_metrics_send(ctxt);
+}
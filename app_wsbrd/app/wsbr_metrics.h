@@ -0,0 +1,32 @@
+/*
+ * SPDX-License-Identifier: LicenseRef-MSLA
+ * Copyright (c) 2025 Silicon Laboratories Inc. (www.silabs.com)
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of the Silicon Labs Master Software License
+ * Agreement (MSLA) available at [1].  This software is distributed to you in
+ * Object Code format and/or Source Code format and is governed by the sections
+ * of the MSLA applicable to Object Code, Source Code and Modified Open Source
+ * Code. By using this software, you agree to the terms of the MSLA.
+ *
+ * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
+ */
+#ifndef WSBR_METRICS_H
+#define WSBR_METRICS_H
+
+/*
+ * Minimal HTTP server exposing internal counters in the OpenMetrics text
+ * format (compatible with Prometheus). It only listens on the loopback
+ * interface and serves one client at a time from the main loop. Any request
+ * receives the whole metric set. Sockets are non-blocking: the response is
+ * written whenever the client is ready to receive it.
+ */
+
+struct wsbr_ctxt;
+
+void wsbr_metrics_init(struct wsbr_ctxt *ctxt);
+void wsbr_metrics_accept(struct wsbr_ctxt *ctxt);
+void wsbr_metrics_recv(struct wsbr_ctxt *ctxt);
+void wsbr_metrics_send(struct wsbr_ctxt *ctxt);
+
+#endif
@@ -11,108 +11,284 @@
  *
  * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
  */
-#define _DEFAULT_SOURCE
+#define _GNU_SOURCE
 #include <sys/stat.h>
+#include <signal.h>
+#include <inttypes.h>
 #include <unistd.h>
+#include <limits.h>
 #include <fcntl.h>
 #include <errno.h>
 
 #include "common/bits.h"
 #include "common/endian.h"
 #include "common/log.h"
+#include "common/mathutils.h"
 #include "common/memutils.h"
 #include "common/ieee802154_frame.h"
 #include "common/ieee802154_ie.h"
 #include "common/iobuf.h"
 #include "common/pcapng.h"
 #include "common/string_extra.h"
+#include "common/time_extra.h"
 #include "common/specs/ieee802154.h"
 
 #include "rcp_api_legacy.h"
 #include "wsbrd.h"
 
-void wsbr_pcapng_closed(struct wsbr_ctxt *ctxt)
-{
-    int ret;
+#define PCAPNG_FLUSH_PERIOD_MS 100
 
-    WARN("stopped pcapng capture");
-    ret = close(ctxt->pcapng_fd);
-    FATAL_ON(ret < 0, 2, "close pcapng: %m");
-    ctxt->pcapng_fd = -1;
-    ctxt->fds[POLLFD_PCAP].fd = -1;
+// Writer thread
+static void wsbr_pcapng_close(struct wsbr_pcapng *pcapng)
+{
+    close(pcapng->fd);
+    pcapng->fd = -1;
 }
 
-static void wsbr_pcapng_write_start(struct wsbr_ctxt *ctxt);
-
-static void wsbr_pcapng_write(struct wsbr_ctxt *ctxt, const struct iobuf_write *buf)
+// Writer thread
+static bool wsbr_pcapng_write(struct wsbr_ctxt *ctxt, const void *buf, size_t len)
 {
-    int ret;
+    struct wsbr_pcapng *pcapng = &ctxt->pcapng;
+    ssize_t ret;
 
-    // recover if other process stopped reading from FIFO
-    if (ctxt->pcapng_fd < 0) {
-        ctxt->pcapng_fd = open(ctxt->config.pcap_file, O_WRONLY | O_NONBLOCK);
-        if (ctxt->pcapng_fd < 0)
-            return;
-        WARN("restarted pcapng capture");
-        ctxt->fds[POLLFD_PCAP].fd = ctxt->pcapng_fd;
-        wsbr_pcapng_write_start(ctxt);
+    while (len) {
+        ret = write(pcapng->fd, buf, len);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret < 0 && pcapng->type == S_IFIFO && errno == EPIPE) {
+            WARN("stopped pcapng capture");
+            wsbr_pcapng_close(pcapng);
+            return false;
+        }
+        if (ret < 0) {
+            // Warn only once, the error is likely to repeat (eg. ENOSPC)
+            if (!pcapng->write_err)
+                WARN("write %s: %m", ctxt->config.pcap_file);
+            pcapng->write_err = true;
+            return false;
+        }
+        pcapng->write_err = false;
+        pcapng->file_len += ret;
+        buf = (const uint8_t *)buf + ret;
+        len -= ret;
     }
-
-    ret = write(ctxt->pcapng_fd, buf->data, buf->len);
-    if (ret >= 0)
-        return;
-    if (ctxt->pcapng_type == S_IFIFO && errno == EAGAIN)
-        WARN("pcapng fifo full");
-    else
-        FATAL(2, "write pcapng: %m");
+    return true;
 }
 
+// Writer thread
 static void wsbr_pcapng_write_start(struct wsbr_ctxt *ctxt)
 {
     struct iobuf_write buf = { };
 
     pcapng_write_shb(&buf);
-    pcapng_write_idb(&buf, LINKTYPE_IEEE802_15_4_NOFCS);
-    wsbr_pcapng_write(ctxt, &buf);
+    pcapng_write_idb(&buf, LINKTYPE_IEEE802_15_4_NOFCS, ctxt->config.pcap_snaplen);
+    wsbr_pcapng_write(ctxt, buf.data, buf.len);
     iobuf_free(&buf);
+    ctxt->pcapng.file_start_ms = time_now_ms(CLOCK_MONOTONIC);
+    ctxt->pcapng.file_empty = true;
+}
+
+// Returns false with errno set if the file cannot be opened
+static bool wsbr_pcapng_open(struct wsbr_ctxt *ctxt)
+{
+    struct wsbr_pcapng *pcapng = &ctxt->pcapng;
+    int flags;
+
+    if (pcapng->type == S_IFIFO) {
+        // Opening a FIFO with O_NONBLOCK fails with ENXIO if there is no
+        // reader, this is used to detect when to start the capture.
+        pcapng->fd = open(ctxt->config.pcap_file, O_WRONLY | O_NONBLOCK);
+        if (pcapng->fd < 0)
+            return false;
+        // Block the writer thread (not the main loop) if the reader is slow
+        flags = fcntl(pcapng->fd, F_GETFL);
+        fcntl(pcapng->fd, F_SETFL, flags & ~O_NONBLOCK);
+    } else {
+        pcapng->fd = open(ctxt->config.pcap_file, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        if (pcapng->fd < 0)
+            return false;
+    }
+    pcapng->file_len = 0;
+    wsbr_pcapng_write_start(ctxt);
+    return true;
+}
+
+// Writer thread
+static void wsbr_pcapng_rotate(struct wsbr_ctxt *ctxt)
+{
+    char path_old[PATH_MAX + 16];
+    char path_new[PATH_MAX + 16];
+
+    wsbr_pcapng_close(&ctxt->pcapng);
+    for (int i = ctxt->config.pcap_file_count - 1; i > 0; i--) {
+        if (i == 1)
+            snprintf(path_old, sizeof(path_old), "%s", ctxt->config.pcap_file);
+        else
+            snprintf(path_old, sizeof(path_old), "%s.%d", ctxt->config.pcap_file, i - 1);
+        snprintf(path_new, sizeof(path_new), "%s.%d", ctxt->config.pcap_file, i);
+        if (rename(path_old, path_new) < 0 && errno != ENOENT)
+            WARN("rename %s: %m", path_old);
+    }
+    wsbr_pcapng_open(ctxt);
+}
+
+// Writer thread
+static bool wsbr_pcapng_need_rotate(struct wsbr_ctxt *ctxt)
+{
+    struct wsbr_pcapng *pcapng = &ctxt->pcapng;
+
+    if (pcapng->type != S_IFREG || pcapng->file_empty)
+        return false;
+    if (ctxt->config.pcap_file_size && pcapng->file_len >= ctxt->config.pcap_file_size)
+        return true;
+    if (ctxt->config.pcap_file_duration &&
+        time_now_ms(CLOCK_MONOTONIC) - pcapng->file_start_ms >= ctxt->config.pcap_file_duration * 1000ull)
+        return true;
+    return false;
+}
+
+// Writer thread. The head always points to a block boundary, so rotation
+// never splits a block. A file may exceed pcap_file_size by one batch.
+static void wsbr_pcapng_flush(struct wsbr_ctxt *ctxt)
+{
+    struct wsbr_pcapng *pcapng = &ctxt->pcapng;
+    uint64_t head = __atomic_load_n(&pcapng->head, __ATOMIC_ACQUIRE);
+    uint64_t tail = pcapng->tail;
+    size_t off, len;
+
+    if (pcapng->fd >= 0 && wsbr_pcapng_need_rotate(ctxt))
+        wsbr_pcapng_rotate(ctxt);
+    if (head == tail)
+        return;
+    if (pcapng->fd < 0) {
+        if (wsbr_pcapng_open(ctxt)) {
+            if (pcapng->type == S_IFIFO)
+                WARN("restarted pcapng capture");
+        } else if (pcapng->type != S_IFIFO) {
+            if (!pcapng->write_err)
+                WARN("open %s: %m", ctxt->config.pcap_file);
+            pcapng->write_err = true;
+        }
+    }
+    // Data is discarded if the file cannot be written
+    if (pcapng->fd >= 0) {
+        off = tail % pcapng->ring_size;
+        len = MIN(head - tail, pcapng->ring_size - off);
+        if (wsbr_pcapng_write(ctxt, pcapng->ring + off, len) && head - tail > len)
+            wsbr_pcapng_write(ctxt, pcapng->ring, head - tail - len);
+        pcapng->file_empty = false;
+    }
+    __atomic_store_n(&pcapng->tail, head, __ATOMIC_RELEASE);
+}
+
+static void *wsbr_pcapng_thread(void *arg)
+{
+    struct wsbr_ctxt *ctxt = arg;
+
+    while (!__atomic_load_n(&ctxt->pcapng.stop, __ATOMIC_RELAXED)) {
+        usleep(PCAPNG_FLUSH_PERIOD_MS * 1000);
+        wsbr_pcapng_flush(ctxt);
+    }
+    wsbr_pcapng_flush(ctxt);
+    return NULL;
+}
+
+static void wsbr_pcapng_exit(void)
+{
+    struct wsbr_pcapng *pcapng = &g_ctxt.pcapng;
+    struct timespec timeout;
+
+    // exit() may be called from the writer thread itself (eg. FATAL())
+    if (!pcapng->running || pthread_equal(pthread_self(), pcapng->thread))
+        return;
+    __atomic_store_n(&pcapng->stop, true, __ATOMIC_RELAXED);
+    // The thread may be blocked on a FIFO which is not read anymore
+    clock_gettime(CLOCK_REALTIME, &timeout);
+    timeout.tv_sec += 1;
+    if (pthread_timedjoin_np(pcapng->thread, NULL, &timeout))
+        WARN("pcapng capture not flushed");
+    pcapng->running = false;
 }
 
 void wsbr_pcapng_init(struct wsbr_ctxt *ctxt)
 {
+    struct wsbr_pcapng *pcapng = &ctxt->pcapng;
     struct stat statbuf;
     int ret;
 
     ret = stat(ctxt->config.pcap_file, &statbuf);
     if (ret) {
         if (errno == ENOENT)
-            ctxt->pcapng_type = S_IFREG;
+            pcapng->type = S_IFREG;
         else
             FATAL(2, "stat %s: %m", ctxt->config.pcap_file);
     } else {
-        ctxt->pcapng_type = statbuf.st_mode & S_IFMT;
+        pcapng->type = statbuf.st_mode & S_IFMT;
     }
-    if (ctxt->pcapng_type == S_IFIFO) {
-        ctxt->pcapng_fd = open(ctxt->config.pcap_file, O_WRONLY | O_NONBLOCK);
-        if (ctxt->pcapng_fd < 0) {
-            if (errno == ENXIO)
-                WARN("open %s: FIFO not yet opened for reading", ctxt->config.pcap_file);
-            else
-                FATAL(2, "open %s: %m", ctxt->config.pcap_file);
-        }
-    } else {
-        ctxt->pcapng_fd = open(ctxt->config.pcap_file, O_WRONLY | O_CREAT | O_TRUNC, 0666);
-        FATAL_ON(ctxt->pcapng_fd < 0, 2, "open %s: %m", ctxt->config.pcap_file);
+    // Open the file before starting the thread to report errors early
+    if (!wsbr_pcapng_open(ctxt)) {
+        if (pcapng->type == S_IFIFO && errno == ENXIO)
+            WARN("open %s: FIFO not yet opened for reading", ctxt->config.pcap_file);
+        else
+            FATAL(2, "open %s: %m", ctxt->config.pcap_file);
     }
 
-    ctxt->fds[POLLFD_PCAP].fd = ctxt->pcapng_fd;
-    wsbr_pcapng_write_start(ctxt);
+    pcapng->ring_size = ctxt->config.pcap_buffer_size;
+    pcapng->ring = xalloc(pcapng->ring_size);
+}
+
+/*
+ * Must be called after drop_privileges(): capabilities and user ID are only
+ * changed for the calling thread, and rotated files are created by the
+ * writer thread. Frames are buffered in the ring until then.
+ */
+void wsbr_pcapng_start(struct wsbr_ctxt *ctxt)
+{
+    struct wsbr_pcapng *pcapng = &ctxt->pcapng;
+    sigset_t sigmask, sigmask_prev;
+    int ret;
+
+    // Signals are handled by the main thread, kill_handler() must not run
+    // here and skip the final flush.
+    sigfillset(&sigmask);
+    pthread_sigmask(SIG_SETMASK, &sigmask, &sigmask_prev);
+    ret = pthread_create(&pcapng->thread, NULL, wsbr_pcapng_thread, ctxt);
+    FATAL_ON(ret, 2, "pthread_create: %s", strerror(ret));
+    pthread_sigmask(SIG_SETMASK, &sigmask_prev, NULL);
+    pthread_setname_np(pcapng->thread, "wsbrd-pcapng");
+    pcapng->running = true;
+    atexit(wsbr_pcapng_exit);
+}
+
+// Main loop
+static void wsbr_pcapng_push(struct wsbr_pcapng *pcapng, const void *buf, size_t len)
+{
+    uint64_t tail = __atomic_load_n(&pcapng->tail, __ATOMIC_ACQUIRE);
+    uint64_t head = pcapng->head;
+    size_t off, n;
+
+    if (head + len - tail > pcapng->ring_size) {
+        if (!pcapng->drop_count)
+            WARN("pcapng buffer full, dropping frames");
+        pcapng->drop_count++;
+        return;
+    }
+    if (pcapng->drop_count) {
+        WARN("pcapng capture lost %"PRIu64" frames", pcapng->drop_count);
+        pcapng->drop_count = 0;
+    }
+    off = head % pcapng->ring_size;
+    n = MIN(len, pcapng->ring_size - off);
+    memcpy(pcapng->ring + off, buf, n);
+    memcpy(pcapng->ring, (const uint8_t *)buf + n, len - n);
+    __atomic_store_n(&pcapng->head, head + len, __ATOMIC_RELEASE);
 }
 
 void wsbr_pcapng_write_frame(struct wsbr_ctxt *ctxt, uint64_t timestamp_us,
                              const void *frame, size_t frame_len)
 {
-    struct iobuf_write iobuf_pcapng = { };
-    struct iobuf_write iobuf_frame = { };
+    struct iobuf_write *iobuf_pcapng = &ctxt->pcapng.epb_buf;
+    struct iobuf_write *iobuf_frame = &ctxt->pcapng.frame_buf;
     struct iobuf_read ie_payload;
     struct iobuf_read ie_header;
     struct ieee802154_hdr hdr;
@@ -130,24 +306,25 @@ void wsbr_pcapng_write_frame(struct wsbr_ctxt *ctxt, uint64_t timestamp_us,
      */
     hdr.sec_level = IEEE802154_SEC_LEVEL_NONE;
 
-    ieee802154_frame_write_hdr(&iobuf_frame, &hdr);
-    iobuf_push_data(&iobuf_frame, ie_header.data, ie_header.data_size);
+    // Buffers are kept allocated between calls
+    iobuf_frame->len = 0;
+    iobuf_pcapng->len = 0;
+
+    ieee802154_frame_write_hdr(iobuf_frame, &hdr);
+    iobuf_push_data(iobuf_frame, ie_header.data, ie_header.data_size);
     if (ie_payload.data_size) {
-        ieee802154_ie_push_header(&iobuf_frame, IEEE802154_IE_ID_HT1);
-        iobuf_push_data(&iobuf_frame, ie_payload.data, ie_payload.data_size);
+        ieee802154_ie_push_header(iobuf_frame, IEEE802154_IE_ID_HT1);
+        iobuf_push_data(iobuf_frame, ie_payload.data, ie_payload.data_size);
     }
 
-    if (!ctxt->pcapng_t0_us) {
+    if (!ctxt->pcapng.t0_us) {
         // NOTE: Since time is measured only once, details like clock drift and
         // leap seconds are ignored.
         clock_gettime(CLOCK_REALTIME, &tp);
-        ctxt->pcapng_t0_us = (uint64_t)tp.tv_sec * 1000000 + tp.tv_nsec / 1000 - timestamp_us;
+        ctxt->pcapng.t0_us = (uint64_t)tp.tv_sec * 1000000 + tp.tv_nsec / 1000 - timestamp_us;
     }
 
-    pcapng_write_epb(&iobuf_pcapng, timestamp_us + ctxt->pcapng_t0_us,
-                     iobuf_frame.data, iobuf_frame.len);
-    wsbr_pcapng_write(ctxt, &iobuf_pcapng);
-
-    iobuf_free(&iobuf_pcapng);
-    iobuf_free(&iobuf_frame);
+    pcapng_write_epb(iobuf_pcapng, timestamp_us + ctxt->pcapng.t0_us,
+                     iobuf_frame->data, iobuf_frame->len, ctxt->config.pcap_snaplen);
+    wsbr_pcapng_push(&ctxt->pcapng, iobuf_pcapng->data, iobuf_pcapng->len);
 }
@@ -14,15 +14,55 @@
 #ifndef WSBR_PCAPNG_H
 #define WSBR_PCAPNG_H
 
+#include <sys/types.h>
+#include <pthread.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
+#include "common/iobuf.h"
+
 struct wsbr_ctxt;
 struct mcps_data_ind;
 struct mcps_data_rx_ie_list;
 
+/*
+ * Frames are serialized by the main loop into a single-producer
+ * single-consumer ring, and written to the capture file in batches by a
+ * dedicated thread. If the writer cannot keep up (slow storage, FIFO not
+ * read), frames are dropped instead of blocking the main loop.
+ *
+ * When the capture file is a regular file, it can be rotated based on its
+ * size or age. The previous files are renamed with a numbered suffix (.1 is
+ * the most recent), and only pcap_file_count files are kept.
+ */
+struct wsbr_pcapng {
+    pthread_t thread;
+    bool running;
+    bool stop;                  // Atomic
+
+    uint8_t *ring;
+    size_t ring_size;
+    uint64_t head;              // Atomic, only written by the main loop
+    uint64_t tail;              // Atomic, only written by the writer thread
+
+    // Main loop only
+    struct iobuf_write frame_buf;
+    struct iobuf_write epb_buf;
+    uint64_t t0_us;
+    uint64_t drop_count;
+
+    // Writer thread only
+    int fd;
+    mode_t type;
+    size_t file_len;
+    uint64_t file_start_ms;
+    bool file_empty;
+    bool write_err;
+};
+
 void wsbr_pcapng_init(struct wsbr_ctxt *ctxt);
-void wsbr_pcapng_closed(struct wsbr_ctxt *ctxt);
+void wsbr_pcapng_start(struct wsbr_ctxt *ctxt);
 void wsbr_pcapng_write_frame(struct wsbr_ctxt *ctxt, uint64_t timestamp_us,
                              const void *frame, size_t frame_len);
 
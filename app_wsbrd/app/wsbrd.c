@@ -14,6 +14,7 @@
 #define _GNU_SOURCE
 #include <linux/capability.h>
 #include <netinet/in.h>
+#include <limits.h>
 #include <unistd.h>
 #include <signal.h>
 #include <string.h>
@@ -27,6 +28,7 @@
 #include "common/events_scheduler.h"
 #include "common/bus.h"
 #include "common/log.h"
+#include "common/log_bin.h"
 #include "common/bits.h"
 #include "common/mathutils.h"
 #include "common/version.h"
@@ -36,6 +38,7 @@
 #include "common/specs/ws.h"
 #include "common/rand.h"
 #include "common/rcp_api.h"
+#include "common/rcp_io.h"
 
 #include "6lowpan/bootstraps/protocol_6lowpan.h"
 #include "6lowpan/lowpan_adaptation_interface.h"
@@ -54,6 +57,8 @@
 #include "net/ns_address_internal.h"
 #include "net/netaddr_types.h"
 #include "net/protocol.h"
+#include "net/latency.h"
+#include "ipv6/ipv6_neigh_storage.h"
 #include "rpl/rpl_glue.h"
 #include "rpl/rpl_storage.h"
 #include "rpl/rpl.h"
@@ -66,6 +71,7 @@
 #include "wsbr_cfg.h"
 #include "wsbr_mac.h"
 #include "wsbr_pcapng.h"
+#include "wsbr_metrics.h"
 #include "libwsbrd.h"
 #include "wsbrd.h"
 #include "rail_config.h"
@@ -101,6 +107,54 @@ static void wsbr_on_gtk_change(struct auth_ctx *auth, const uint8_t gtk[16], uin
         ws_mngt_lfn_version_increase(&ctxt->net_if.ws_info);
 }
 
+static void wsbr_on_supp_gtk_installed(struct auth_ctx *auth, const struct eui64 *eui64, uint8_t index)
+{
+    struct wsbr_ctxt *ctxt = container_of(auth, struct wsbr_ctxt, auth);
+
+    dbus_nodes_changed(ctxt, eui64);
+}
+
+static int wsbr_get_supp_depth(struct auth_ctx *auth, const struct auth_supp_ctx *supp)
+{
+    struct wsbr_ctxt *ctxt = container_of(auth, struct wsbr_ctxt, auth);
+    int ret;
+
+    if (IN6_IS_ADDR_UNSPECIFIED(&supp->eapol_target))
+        return 1;
+    // The EAPOL relay is the parent of the supplicant
+    ret = rpl_target_depth(&ctxt->net_if.rpl_root, supp->eapol_target.s6_addr);
+    return ret < 0 ? INT_MAX : ret + 2;
+}
+
+// Rank 1 LFNs are exposed in RoutingGraph only while they are neighbors
+static void wsbr_neigh_changed(struct wsbr_ctxt *ctxt, struct ws_neigh *neigh)
+{
+    struct ipv6_neighbour *ipv6_neigh;
+
+    dbus_nodes_changed(ctxt, &neigh->eui64);
+    if (ws_neigh_hot(&ctxt->net_if.ws_info.neighbor_storage, neigh)->node_role != WS_NR_ROLE_LFN)
+        return;
+    ipv6_neigh = ipv6_neighbour_lookup_gua_by_eui64(&ctxt->net_if.ipv6_neighbour_cache, neigh->eui64.u8);
+    if (ipv6_neigh)
+        dbus_routes_changed(ctxt, ipv6_neigh->ip_address);
+}
+
+static void wsbr_neigh_add(struct ws_neigh_table *table, struct ws_neigh *neigh)
+{
+    struct wsbr_ctxt *ctxt = container_of(table, struct wsbr_ctxt, net_if.ws_info.neighbor_storage);
+
+    ws_bootstrap_neighbor_add_cb(table, neigh);
+    wsbr_neigh_changed(ctxt, neigh);
+}
+
+static void wsbr_neigh_del(struct ws_neigh_table *table, struct ws_neigh *neigh)
+{
+    struct wsbr_ctxt *ctxt = container_of(table, struct wsbr_ctxt, net_if.ws_info.neighbor_storage);
+
+    ws_bootstrap_neighbor_del_cb(table, neigh);
+    wsbr_neigh_changed(ctxt, neigh);
+}
+
 // See warning in wsbrd.h
 struct wsbr_ctxt g_ctxt = {
     .scheduler.event_fd = { -1, -1 },
@@ -111,7 +165,9 @@ struct wsbr_ctxt g_ctxt = {
 
     // avoid initializating to 0 = STDIN_FILENO
     .tun.fd = -1,
-    .pcapng_fd = -1,
+    .pcapng.fd = -1,
+    .metrics_fd = -1,
+    .metrics_client_fd = -1,
     .rcp.bus.fd = -1,
     .dhcp_server.fd = -1,
     .net_if.rpl_root.sockfd = -1,
@@ -122,6 +178,8 @@ struct wsbr_ctxt g_ctxt = {
     .auth.timeout_ms = 60 * 1000, // Arbitrary
     .auth.sendto_mac    = ws_llc_auth_sendto_mac,
     .auth.on_gtk_change = wsbr_on_gtk_change,
+    .auth.on_supp_gtk_installed = wsbr_on_supp_gtk_installed,
+    .auth.get_supp_depth = wsbr_get_supp_depth,
 
     .dhcp_relay.fd = -1,
     // RFC 8415 7.6. Transmission and Retransmission Parameters
@@ -158,8 +216,8 @@ struct wsbr_ctxt g_ctxt = {
     .net_if.pae_random_early_detection.threshold_max = MAX_SIMULTANEOUS_SECURITY_NEGOTIATIONS_TX_QUEUE_MAX,
     .net_if.pae_random_early_detection.drop_max_probability = 100,
 
-    .net_if.ws_info.neighbor_storage.on_add = ws_bootstrap_neighbor_add_cb,
-    .net_if.ws_info.neighbor_storage.on_del = ws_bootstrap_neighbor_del_cb,
+    .net_if.ws_info.neighbor_storage.on_add = wsbr_neigh_add,
+    .net_if.ws_info.neighbor_storage.on_del = wsbr_neigh_del,
     .net_if.ws_info.pan_information.pan_id = -1,
     .net_if.ws_info.fhss_config.bsi = -1,
 };
@@ -179,6 +237,7 @@ static void wsbr_rpl_target_add(struct rpl_root *root, struct rpl_target *target
                              0);                  // pref
     tun_add_node_to_proxy_neightbl(&ctxt->net_if, target->prefix);
     tun_add_ipv6_direct_route(&ctxt->net_if, target->prefix);
+    dbus_routes_changed(ctxt, target->prefix);
 }
 
 static void wsbr_rpl_target_del(struct rpl_root *root, struct rpl_target *target)
@@ -193,8 +252,7 @@ static void wsbr_rpl_target_del(struct rpl_root *root, struct rpl_target *target
                                 (void *)root,        // info
                                 0);                  // source id
     rpl_storage_del_target(root, target);
-    dbus_emit_change("Nodes");
-    dbus_emit_change("RoutingGraph");
+    dbus_routes_changed(ctxt, target->prefix);
 }
 
 static void wsbr_rpl_target_update(struct rpl_root *root, struct rpl_target *target, bool updated_transit)
@@ -208,8 +266,7 @@ static void wsbr_rpl_target_update(struct rpl_root *root, struct rpl_target *tar
     if (!updated_transit)
         return;
 
-    dbus_emit_change("Nodes");
-    dbus_emit_change("RoutingGraph");
+    dbus_routes_changed(ctxt, target->prefix);
 
     /*
      * HACK: Delete the neighbor cache entry in case the node did not
@@ -305,9 +362,9 @@ static void wsbr_configure_ws(struct wsbr_ctxt *ctxt)
 
     ws_chan_mask_calc_reg(fhss->uc_chan_mask, fhss->chan_params, fhss->regional_regulation);
     ws_chan_mask_calc_reg(fhss->bc_chan_mask, fhss->chan_params, fhss->regional_regulation);
-    bitand(fhss->uc_chan_mask, ctxt->config.ws_allowed_channels, 256);
-    bitand(fhss->bc_chan_mask, ctxt->config.ws_allowed_channels, 256);
-    if (!memzcmp(fhss->uc_chan_mask, sizeof(fhss->uc_chan_mask)))
+    ws_chan_mask_and(fhss->uc_chan_mask, ctxt->config.ws_allowed_channels);
+    ws_chan_mask_and(fhss->bc_chan_mask, ctxt->config.ws_allowed_channels);
+    if (!ws_chan_mask_count(fhss->uc_chan_mask))
         FATAL(1, "combination of allowed_channels and regulatory constraints results in no valid channel (see --list-rf-configs)");
 
     rail_fill_pom(ctxt);
@@ -345,11 +402,22 @@ static void wsbr_configure_ws(struct wsbr_ctxt *ctxt)
      * with the seed-id field set to the GUA\ULA of the FFN seed (this for
      * backwards compatibility with FAN 1.0).
      */
+    mpl_set_buffer_size(ctxt->config.mpl_buffer_size);
+    ctxt->net_if.adaptation_codel.target_ms   = ctxt->config.codel_target;
+    ctxt->net_if.adaptation_codel.interval_ms = ctxt->config.codel_interval;
     ctxt->net_if.mpl_domain = mpl_domain_create(&ctxt->net_if, ADDR_ALL_MPL_FORWARDERS,
                                                 size_params[ctxt->config.ws_size].mpl_seed_set_entry_lifetime,
                                                 ctxt->config.enable_ffn10 ? MPL_SEED_128_BIT : MPL_SEED_IPV6_SRC,
-                                                &size_params[ctxt->config.ws_size].trickle_mpl);
-    ws_info->mngt.trickle_params = size_params[ctxt->config.ws_size].trickle_discovery;
+                                                &size_params[ctxt->config.ws_size].trickle_mpl,
+                                                size_params[ctxt->config.ws_size].mpl_timer_expirations);
+    ws_info->mngt.trickle_pa.cfg = &size_params[ctxt->config.ws_size].trickle_discovery;
+    ws_info->mngt.trickle_pa.on_transmit = ws_mngt_pa_trickle_transmit;
+    strcpy(ws_info->mngt.trickle_pa.debug_name, "adv");
+    trickle_init(&ws_info->mngt.trickle_pa);
+    ws_info->mngt.trickle_pc.cfg = &size_params[ctxt->config.ws_size].trickle_discovery;
+    ws_info->mngt.trickle_pc.on_transmit = ws_mngt_pc_trickle_transmit;
+    strcpy(ws_info->mngt.trickle_pc.debug_name, "cfg");
+    trickle_init(&ws_info->mngt.trickle_pc);
 
     ws_info->pan_information.version = ctxt->config.ws_fan_version;
     ws_info->pan_information.max_pan_size = wsbr_get_max_pan_size(ctxt->config.ws_size);
@@ -443,7 +511,12 @@ void kill_handler(int signal)
 {
     struct wsbr_ctxt *ctxt = &g_ctxt;
 
-    if (ctxt->config.rcp_cfg.uart_dev[0])
+    ws_pae_controller_nw_info_flush();
+    ws_pan_info_storage_flush();
+    ipv6_neigh_storage_flush();
+    if (ctxt->rcp.io)
+        rcp_io_tx_flush(&ctxt->rcp);
+    else if (ctxt->config.rcp_cfg.uart_dev[0])
         uart_tx_flush(&ctxt->rcp.bus);
     exit(0);
 }
@@ -480,6 +553,10 @@ static void wsbr_fds_init(struct wsbr_ctxt *ctxt)
     ctxt->fds[POLLFD_PAE_AUTH].events = POLLIN;
     ctxt->fds[POLLFD_RADIUS].fd = ws_auth_fd_radius(&ctxt->net_if);
     ctxt->fds[POLLFD_RADIUS].events = POLLIN;
+    ctxt->fds[POLLFD_METRICS].fd = ctxt->metrics_fd;
+    ctxt->fds[POLLFD_METRICS].events = POLLIN;
+    ctxt->fds[POLLFD_METRICS_CLIENT].fd = ctxt->metrics_client_fd;
+    ctxt->fds[POLLFD_METRICS_CLIENT].events = POLLIN;
 }
 
 static void wsbr_poll(struct wsbr_ctxt *ctxt)
@@ -529,21 +606,26 @@ static void wsbr_poll(struct wsbr_ctxt *ctxt)
         rcp_rx(&ctxt->rcp);
     if (ctxt->fds[POLLFD_TIMER].revents & POLLIN)
         timer_process();
-    if (ctxt->fds[POLLFD_PCAP].revents & POLLERR)
-        wsbr_pcapng_closed(ctxt);
+    if (ctxt->fds[POLLFD_METRICS].revents & POLLIN)
+        wsbr_metrics_accept(ctxt);
+    if (ctxt->fds[POLLFD_METRICS_CLIENT].revents & POLLOUT)
+        wsbr_metrics_send(ctxt);
+    else if (ctxt->fds[POLLFD_METRICS_CLIENT].revents & (POLLIN | POLLERR | POLLHUP))
+        wsbr_metrics_recv(ctxt);
 }
 
+static const char *wsbr_storage_files[] = {
+    "neighbor-*:*:*:*:*:*:*:*",
+    "keys-*:*:*:*:*:*:*:*",
+    "network-keys",
+    "br-info",
+    "rpl-*",
+    NULL,
+};
+
 int wsbr_main(int argc, char *argv[])
 {
     struct sigaction sigact = { };
-    static const char *files[] = {
-        "neighbor-*:*:*:*:*:*:*:*",
-        "keys-*:*:*:*:*:*:*:*",
-        "network-keys",
-        "br-info",
-        "rpl-*",
-        NULL,
-    };
     struct wsbr_ctxt *ctxt = &g_ctxt;
 
     INFO("Silicon Labs Wi-SUN border router %s", version_daemon_str);
@@ -563,17 +645,25 @@ int wsbr_main(int argc, char *argv[])
     parse_commandline(&ctxt->config, argc, argv, print_help_br);
     if (ctxt->config.color_output != -1)
         g_enable_color_traces = ctxt->config.color_output;
+    if (ctxt->config.trace_ring[0])
+        tr_bin_open(ctxt->config.trace_ring, ctxt->config.trace_ring_size);
     check_mbedtls_features();
     event_scheduler_init(&ctxt->scheduler);
     g_storage_prefix = ctxt->config.storage_prefix;
+    storage_delete_tmp();
     if (ctxt->config.storage_delete) {
         INFO("deleting storage");
-        storage_delete(files);
+        storage_delete(wsbr_storage_files);
     }
     if (ctxt->config.storage_exit)
         exit(0);
     if (ctxt->config.pcap_file[0])
         wsbr_pcapng_init(ctxt);
+    g_latency.enabled = ctxt->config.latency_stats;
+    if (g_latency.enabled)
+        ctxt->scheduler.depth_hist = &g_latency.event_queue_depth;
+    if (ctxt->config.metrics_port)
+        wsbr_metrics_init(ctxt);
     if (ctxt->config.capture[0])
         capture_start(ctxt->config.capture);
 
@@ -609,7 +699,13 @@ int wsbr_main(int argc, char *argv[])
                               ctxt->net_if.ws_info.pan_information.lfn_version, ctxt->net_if.ws_info.network_name);
     ws_auth_init(&ctxt->net_if, &ctxt->config, ctxt->tun.ifname);
     ws_bootstrap_6lbr_init(&ctxt->net_if);
+    if (ctxt->config.rcp_io_thread)
+        rcp_io_start(&ctxt->rcp);
+    if (ctxt->config.pcap_file[0])
+        wsbr_pcapng_start(ctxt);
     wsbr_fds_init(ctxt);
+    if (ctxt->config.capture[0] && ctxt->config.capture_checkpoint_interval)
+        capture_start_checkpoints(wsbr_storage_files, ctxt->config.capture_checkpoint_interval);
 
     INFO("Wi-SUN Border Router is ready");
 
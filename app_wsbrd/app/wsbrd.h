@@ -28,12 +28,14 @@ typedef struct sd_bus sd_bus;
 #include "common/dhcp_relay.h"
 #include "common/dhcp_server.h"
 #include "common/events_scheduler.h"
+#include "common/histogram.h"
 #include "common/rcp_api.h"
 #include "common/timer.h"
 #include "common/tun.h"
 #include "net/protocol.h"
 
 #include "commandline.h"
+#include "wsbr_pcapng.h"
 
 struct iobuf_read;
 
@@ -49,7 +51,8 @@ enum {
     POLLFD_EAPOL_RELAY,
     POLLFD_PAE_AUTH,       // HAVE_AUTH_LEGACY only
     POLLFD_RADIUS,
-    POLLFD_PCAP,
+    POLLFD_METRICS,
+    POLLFD_METRICS_CLIENT,
     POLLFD_COUNT,
 };
 
@@ -65,14 +68,22 @@ struct wsbr_ctxt {
     sd_bus *dbus;
 
     struct tun_ctx tun;
+    struct histogram tun_rx_batch_hist; // Packets read from TUN per wakeup
+    uint64_t tun_rx_packets;
     struct rcp rcp;
 
     int spinel_tid;
     int spinel_iid;
 
-    int pcapng_fd;
-    mode_t pcapng_type;
-    uint64_t pcapng_t0_us;
+    struct wsbr_pcapng pcapng;
+
+    int metrics_fd;
+    int metrics_client_fd;
+    char metrics_req[1024];
+    size_t metrics_req_len;
+    char *metrics_resp;      // Response not yet accepted by the socket
+    size_t metrics_resp_len;
+    size_t metrics_resp_offset;
 };
 
 // This global variable is necessary for various API of nanostack. Beside this
@@ -390,6 +390,7 @@ buffer_t *ipv6_down(buffer_t *buf)
     if (exthdr_result < 0) {
         goto drop;
     }
+    latency_checkpoint(&buf->latency, LATENCY_TX_RPL_SRH);
 
     uint16_t payload_len = buffer_data_length(buf);
 
@@ -510,6 +511,8 @@ drop:
  */
 buffer_t *ipv6_forwarding_down(buffer_t *buf)
 {
+    latency_checkpoint(&buf->latency, LATENCY_TX_IPV6_FWD);
+
     /* If it's for us, loop it back up. It goes back into forwarding up, as
      * we should process Destination headers etc...
      * (Note that we could theoretically go forwarding up/down a few times in
@@ -831,6 +834,8 @@ static buffer_t *ipv6_tun_up(buffer_t *b)
     status = wsbr_tun_write(buffer_data_pointer(b), buffer_data_length(b));
     if (status <= 0)
         tr_warn("packet not sent to tun interface: %m");
+    else
+        latency_end(&b->latency, LATENCY_RX_TUN, LATENCY_RX_TOTAL);
     return buffer_free(b);
 }
 
@@ -1053,7 +1058,7 @@ static void ipv6_refresh_neighbor_lifetime(buffer_t *buf, const sockaddr_t *ll_s
         return;
 
     aro.status = NDP_ARO_STATUS_SUCCESS;
-    aro.lifetime = ws_neigh->lifetime_s / 60;
+    aro.lifetime = ws_neigh_hot(&buf->interface->ws_info.neighbor_storage, ws_neigh)->lifetime_s / 60;
 
     nd_update_registration(buf->interface, ipv6_neighbour, &aro, ws_neigh);
 }
@@ -1069,6 +1074,7 @@ buffer_t *ipv6_forwarding_up(buffer_t *buf)
     /* When processing a reassembled packet, we don't reprocess headers from before the fragment header */
     uint16_t frag_offset;
 
+    latency_checkpoint(&buf->latency, LATENCY_RX_IPV6_FWD);
     cur = buf->interface;
 
     // Make sure that this is a v6 header (just in case...)
@@ -18,12 +18,15 @@
 #include <fnmatch.h>
 #include <stdlib.h>
 #include <glob.h>
+#include <sys/queue.h>
 
 #include "common/key_value_storage.h"
 #include "common/time_extra.h"
 #include "common/memutils.h"
 #include "common/parsers.h"
 #include "common/endian.h"
+#include "common/fnv_hash.h"
+#include "common/timer.h"
 #include "common/log.h"
 
 #include "ipv6/ipv6_neigh_storage.h"
@@ -31,6 +34,23 @@
 #include "net/protocol.h"
 #include "app/tun.h"
 
+// Registrations tend to come in bursts (ex: after a border router restart),
+// so neighbor files are rewritten at most once per delay for a given EUI-64.
+#define IPV6_NEIGH_STORAGE_DELAY_MS 1000
+
+struct ipv6_neigh_storage_pending {
+    struct ipv6_neighbour_cache *cache;
+    uint8_t eui64[8];
+    SLIST_ENTRY(ipv6_neigh_storage_pending) link;
+};
+
+static void ipv6_neigh_storage_timer_expired(struct timer_group *group, struct timer_entry *timer);
+
+static SLIST_HEAD(, ipv6_neigh_storage_pending) ipv6_neigh_storage_pending[256];
+static struct timer_entry ipv6_neigh_storage_timer = {
+    .callback = ipv6_neigh_storage_timer_expired,
+};
+
 static void ipv6_neigh_storage_delete(const uint8_t *eui64)
 {
     char filename[PATH_MAX];
@@ -40,7 +60,7 @@ static void ipv6_neigh_storage_delete(const uint8_t *eui64)
     storage_delete((const char *[]){ filename, NULL });
 }
 
-void ipv6_neigh_storage_save(struct ipv6_neighbour_cache *cache, const uint8_t *eui64)
+static void ipv6_neigh_storage_write(struct ipv6_neighbour_cache *cache, const uint8_t *eui64)
 {
     char ipv6_str[INET6_ADDRSTRLEN];
     char time_str[STR_MAX_LEN_DATE];
@@ -58,7 +78,7 @@ void ipv6_neigh_storage_save(struct ipv6_neighbour_cache *cache, const uint8_t *
         return;
     }
 
-    ns_list_foreach(struct ipv6_neighbour, cur, &cache->list) {
+    ns_list_foreach(struct ipv6_neighbour, cur, ipv6_neighbour_eui64_bucket(cache, eui64)) {
         if (memcmp(eui64, ipv6_neighbour_eui64(cache, cur), 8))
             continue;
         if (!cur->lifetime_s || !cur->expiration_s)
@@ -79,6 +99,41 @@ void ipv6_neigh_storage_save(struct ipv6_neighbour_cache *cache, const uint8_t *
         ipv6_neigh_storage_delete(eui64);
 }
 
+void ipv6_neigh_storage_flush(void)
+{
+    struct ipv6_neigh_storage_pending *pending;
+
+    timer_stop(NULL, &ipv6_neigh_storage_timer);
+    for (int i = 0; i < ARRAY_SIZE(ipv6_neigh_storage_pending); i++) {
+        while ((pending = SLIST_FIRST(&ipv6_neigh_storage_pending[i]))) {
+            SLIST_REMOVE_HEAD(&ipv6_neigh_storage_pending[i], link);
+            ipv6_neigh_storage_write(pending->cache, pending->eui64);
+            free(pending);
+        }
+    }
+}
+
+static void ipv6_neigh_storage_timer_expired(struct timer_group *group, struct timer_entry *timer)
+{
+    ipv6_neigh_storage_flush();
+}
+
+void ipv6_neigh_storage_save(struct ipv6_neighbour_cache *cache, const uint8_t *eui64)
+{
+    uint32_t bucket = fnv_hash_reverse_32_init(eui64, 8) % ARRAY_SIZE(ipv6_neigh_storage_pending);
+    struct ipv6_neigh_storage_pending *pending;
+
+    SLIST_FOREACH(pending, &ipv6_neigh_storage_pending[bucket], link)
+        if (pending->cache == cache && !memcmp(pending->eui64, eui64, 8))
+            return;
+    pending = zalloc(sizeof(*pending));
+    pending->cache = cache;
+    memcpy(pending->eui64, eui64, 8);
+    SLIST_INSERT_HEAD(&ipv6_neigh_storage_pending[bucket], pending, link);
+    if (timer_stopped(&ipv6_neigh_storage_timer))
+        timer_start_rel(NULL, &ipv6_neigh_storage_timer, IPV6_NEIGH_STORAGE_DELAY_MS);
+}
+
 static void ipv6_neigh_storage_load_neigh(struct ipv6_neighbour_cache *cache, const char *filename)
 {
     struct net_if *cur = container_of(cache, struct net_if, ipv6_neighbour_cache);
@@ -162,7 +217,7 @@ static void ipv6_neigh_storage_load_neigh(struct ipv6_neighbour_cache *cache, co
         memcpy(ll_addr.address + PAN_ID_LEN, eui64, 8);
         // the neighbor state is set to stale
         ipv6_neighbour_entry_update_unsolicited(cache, ipv6_neigh, ll_addr.addr_type, ll_addr.address);
-        ipv6_neigh->type = IP_NEIGHBOUR_REGISTERED;
+        ipv6_neighbour_set_type(cache, ipv6_neigh, IP_NEIGHBOUR_REGISTERED);
     }
 
     storage_close(nvm);
@@ -21,5 +21,7 @@ struct ipv6_neighbour_cache;
 
 void ipv6_neigh_storage_save(struct ipv6_neighbour_cache *cache, const uint8_t *eui64);
 void ipv6_neigh_storage_load(struct ipv6_neighbour_cache *cache);
+// Write the files of the pending registrations immediately
+void ipv6_neigh_storage_flush(void);
 
 #endif /* IPV6_NEIGH_STORAGE_H */
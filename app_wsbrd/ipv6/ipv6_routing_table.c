@@ -40,7 +40,9 @@
 #include <netinet/in.h>
 #include "common/rand.h"
 #include "common/bits.h"
+#include "common/mathutils.h"
 #include "common/memutils.h"
+#include "common/fnv_hash.h"
 #include "common/log_legacy.h"
 #include "common/string_extra.h"
 
@@ -69,6 +71,7 @@
 #define DCACHE_MAX_LONG_TERM    16
 #define DCACHE_MAX_SHORT_TERM   40
 #define DCACHE_MAX_ABSOLUTE     64 /* Never have more than this */
+#define DCACHE_HASH_SIZE        64 /* buckets of the address index */
 #define DCACHE_GC_AGE           (30 * DCACHE_GC_PERIOD)    /* 10 minutes */
 
 /* We track "lifetime" of garbage-collectible entries, resetting
@@ -76,8 +79,29 @@
  * for garbage-collection. */
 #define DCACHE_GC_AGE_LL (120 / DCACHE_GC_PERIOD)  /* 2 minutes for link-local destinations, in DCACHE_GC_PERIOD intervals */
 
+/*
+ * Routes are indexed in a path-compressed binary trie (Patricia trie) keyed
+ * on their prefix, so that longest prefix match does not depend on the
+ * number of routes. Each node stores the routes sharing exactly the same
+ * prefix. Nodes without routes only exist to join 2 branches.
+ *
+ * Bit ordering follows bittest() so that matching is strictly equivalent to
+ * bitcmp() on the prefix.
+ */
+struct ipv6_route_node {
+    uint8_t prefix[16];
+    uint8_t prefix_len;
+    struct ipv6_route_node *parent;
+    struct ipv6_route_node *child[2];
+    NS_LIST_HEAD(ipv6_route_t, node_link) routes;
+};
+
 static NS_LIST_DEFINE(ipv6_destination_cache, ipv6_destination_t, link);
+typedef NS_LIST_HEAD(ipv6_destination_t, hash_link) ipv6_destination_list_t;
+static ipv6_destination_list_t ipv6_destination_hash[DCACHE_HASH_SIZE];
+static uint16_t ipv6_destination_count;
 static NS_LIST_DEFINE(ipv6_routing_table, ipv6_route_t, link);
+static struct ipv6_route_node *ipv6_route_trie;
 
 static void ipv6_destination_cache_forget_neighbour(const ipv6_neighbour_t *neighbour);
 static bool ipv6_destination_release(ipv6_destination_t *dest);
@@ -85,6 +109,7 @@ static uint16_t total_metric(const ipv6_route_t *route);
 static uint8_t ipv6_route_table_count_source(int8_t interface_id, ipv6_route_src_t source);
 static void ipv6_route_table_remove_last_one_from_source(int8_t interface_id, ipv6_route_src_t source);
 static uint8_t ipv6_route_table_get_max_entries(int8_t interface_id, ipv6_route_src_t source);
+static void ipv6_neighbour_timer_expired(struct timer_group *group, struct timer_entry *timer);
 
 static uint32_t next_probe_time(ipv6_neighbour_cache_t *cache, uint8_t retrans_num)
 {
@@ -101,12 +126,36 @@ static uint32_t next_probe_time(ipv6_neighbour_cache_t *cache, uint8_t retrans_n
     return rand_randomise_base(t, 0x4000, 0xBFFF);
 }
 
+static ipv6_neighbour_addr_list_t *ipv6_neighbour_addr_bucket(ipv6_neighbour_cache_t *cache, const uint8_t *address)
+{
+    return &cache->addr_hash[fnv_hash_reverse_32_init(address, 16) % NCACHE_HASH_SIZE];
+}
+
+ipv6_neighbour_eui64_list_t *ipv6_neighbour_eui64_bucket(ipv6_neighbour_cache_t *cache, const uint8_t *eui64)
+{
+    return &cache->eui64_hash[fnv_hash_reverse_32_init(eui64, 8) % NCACHE_HASH_SIZE];
+}
+
+static void ipv6_neighbour_timer_start(ipv6_neighbour_cache_t *cache, ipv6_neighbour_t *entry, uint32_t ms)
+{
+    timer_start_rel(&cache->timer_group, &entry->timer, ms);
+}
+
+static void ipv6_neighbour_timer_stop(ipv6_neighbour_cache_t *cache, ipv6_neighbour_t *entry)
+{
+    timer_stop(&cache->timer_group, &entry->timer);
+}
+
 void ipv6_neighbour_cache_init(ipv6_neighbour_cache_t *cache, int8_t interface_id)
 {
-    /* Init Double linked Routing Table */
-    ns_list_foreach_safe(ipv6_neighbour_t, cur, &cache->list) {
-        ipv6_neighbour_entry_remove(cache, cur);
+    ns_list_init(&cache->list);
+    ns_list_init(&cache->gc_list);
+    cache->gc_count = 0;
+    for (int i = 0; i < NCACHE_HASH_SIZE; i++) {
+        ns_list_init(&cache->addr_hash[i]);
+        ns_list_init(&cache->eui64_hash[i]);
     }
+    timer_group_init(&cache->timer_group);
     cache->gc_timer = NCACHE_GC_PERIOD;
     cache->retrans_timer = 1000;
     cache->max_ll_len = 2 + 8;
@@ -122,17 +171,14 @@ void ipv6_neighbour_cache_init(ipv6_neighbour_cache_t *cache, int8_t interface_i
 void ipv6_neighbour_cache_flush(ipv6_neighbour_cache_t *cache)
 {
     /* Flush non-registered entries only */
-    ns_list_foreach_safe(ipv6_neighbour_t, cur, &cache->list) {
-        if (cur->type == IP_NEIGHBOUR_GARBAGE_COLLECTIBLE) {
-            ipv6_neighbour_entry_remove(cache, cur);
-        }
-    }
+    ns_list_foreach_safe(ipv6_neighbour_t, cur, &cache->gc_list)
+        ipv6_neighbour_entry_remove(cache, cur);
 }
 
 
 ipv6_neighbour_t *ipv6_neighbour_lookup(ipv6_neighbour_cache_t *cache, const uint8_t *address)
 {
-    ns_list_foreach(ipv6_neighbour_t, cur, &cache->list)
+    ns_list_foreach(ipv6_neighbour_t, cur, ipv6_neighbour_addr_bucket(cache, address))
         if (addr_ipv6_equal(cur->ip_address, address))
             return cur;
 
@@ -148,6 +194,14 @@ void ipv6_neighbour_entry_remove(ipv6_neighbour_cache_t *cache, ipv6_neighbour_t
      * the entry.
      */
     ns_list_remove(&cache->list, entry);
+    ns_list_remove(ipv6_neighbour_addr_bucket(cache, entry->ip_address), entry);
+    if (cache->recv_addr_reg)
+        ns_list_remove(ipv6_neighbour_eui64_bucket(cache, ipv6_neighbour_eui64(cache, entry)), entry);
+    if (entry->type == IP_NEIGHBOUR_GARBAGE_COLLECTIBLE) {
+        ns_list_remove(&cache->gc_list, entry);
+        cache->gc_count--;
+    }
+    ipv6_neighbour_timer_stop(cache, entry);
     switch (entry->state) {
         case IP_NEIGHBOUR_NEW:
         case IP_NEIGHBOUR_INCOMPLETE:
@@ -173,7 +227,7 @@ ipv6_neighbour_t *ipv6_neighbour_lookup_mc(ipv6_neighbour_cache_t *cache, const
     if (!IN6_IS_ADDR_MULTICAST(address))
         return NULL;
 
-    ns_list_foreach(ipv6_neighbour_t, cur, &cache->list)
+    ns_list_foreach(ipv6_neighbour_t, cur, ipv6_neighbour_addr_bucket(cache, address))
         if (addr_ipv6_equal(cur->ip_address, address)) {
             if (memcmp(ipv6_neighbour_eui64(cache, cur), eui64, 8))
                 continue;
@@ -185,20 +239,11 @@ ipv6_neighbour_t *ipv6_neighbour_lookup_mc(ipv6_neighbour_cache_t *cache, const
 
 ipv6_neighbour_t *ipv6_neighbour_create(ipv6_neighbour_cache_t *cache, const uint8_t *address, const uint8_t *eui64)
 {
-    uint16_t count = 0;
     ipv6_neighbour_t *entry = NULL;
-    ipv6_neighbour_t *garbage_possible_entry = NULL;
-
-    ns_list_foreach(ipv6_neighbour_t, cur, &cache->list) {
-        if (cur->type == IP_NEIGHBOUR_GARBAGE_COLLECTIBLE) {
-            garbage_possible_entry = cur;
-            count++;
-        }
-    }
 
-    if (count >= NCACHE_MAX_ABSOLUTE && garbage_possible_entry) {
-        //Remove Last storaged IP_NEIGHBOUR_GARBAGE_COLLECTIBLE type entry
-        ipv6_neighbour_entry_remove(cache, garbage_possible_entry);
+    if (cache->gc_count >= NCACHE_MAX_ABSOLUTE) {
+        //Remove least recently used IP_NEIGHBOUR_GARBAGE_COLLECTIBLE type entry
+        ipv6_neighbour_entry_remove(cache, ns_list_get_last(&cache->gc_list));
     }
 
     // Allocate new - note we have a basic size, plus enough for the LL address,
@@ -207,9 +252,16 @@ ipv6_neighbour_t *ipv6_neighbour_create(ipv6_neighbour_cache_t *cache, const uin
     // neighbour may be using a short link-layer address, not its EUI-64.
     entry = zalloc(sizeof(ipv6_neighbour_t) + cache->max_ll_len + (cache->recv_addr_reg ? 8 : 0));
     memcpy(entry->ip_address, address, 16);
-    if (cache->recv_addr_reg)
-        memcpy(ipv6_neighbour_eui64(cache, entry), eui64, 8);
+    entry->timer.callback = ipv6_neighbour_timer_expired;
+    entry->type = IP_NEIGHBOUR_GARBAGE_COLLECTIBLE;
     ns_list_add_to_start(&cache->list, entry);
+    ns_list_add_to_start(&cache->gc_list, entry);
+    cache->gc_count++;
+    ns_list_add_to_start(ipv6_neighbour_addr_bucket(cache, address), entry);
+    if (cache->recv_addr_reg) {
+        memcpy(ipv6_neighbour_eui64(cache, entry), eui64, 8);
+        ns_list_add_to_start(ipv6_neighbour_eui64_bucket(cache, eui64), entry);
+    }
     TRACE(TR_NEIGH_IPV6, "neigh-ipv6 add %s eui64=%s",
           tr_ipv6(entry->ip_address), tr_eui64(ipv6_neighbour_eui64(cache, entry)));
 
@@ -229,6 +281,10 @@ ipv6_neighbour_t *ipv6_neighbour_used(ipv6_neighbour_cache_t *cache, ipv6_neighb
         ns_list_remove(&cache->list, entry);
         ns_list_add_to_start(&cache->list, entry);
     }
+    if (entry->type == IP_NEIGHBOUR_GARBAGE_COLLECTIBLE && entry != ns_list_get_first(&cache->gc_list)) {
+        ns_list_remove(&cache->gc_list, entry);
+        ns_list_add_to_start(&cache->gc_list, entry);
+    }
 
     /* If the entry is stale, prepare delay timer for active NUD probe */
     if (entry->state == IP_NEIGHBOUR_STALE && cache->send_nud_probes) {
@@ -236,8 +292,8 @@ ipv6_neighbour_t *ipv6_neighbour_used(ipv6_neighbour_cache_t *cache, ipv6_neighb
     }
 
     /* Special case for Registered Unreachable entries - restart the probe timer if stopped */
-    else if (entry->state == IP_NEIGHBOUR_UNREACHABLE && entry->timer == 0) {
-        entry->timer = next_probe_time(cache, entry->retrans_count);
+    else if (entry->state == IP_NEIGHBOUR_UNREACHABLE && timer_stopped(&entry->timer)) {
+        ipv6_neighbour_timer_start(cache, entry, next_probe_time(cache, entry->retrans_count));
     }
 
     return entry;
@@ -257,7 +313,7 @@ static bool ipv6_neighbour_update_ll(ipv6_neighbour_t *entry, addrtype_e ll_type
 
 ipv6_neighbour_t *ipv6_neighbour_lookup_gua_by_eui64(ipv6_neighbour_cache_t *cache, const uint8_t *eui64)
 {
-    ns_list_foreach_safe(ipv6_neighbour_t, cur, &cache->list)
+    ns_list_foreach(ipv6_neighbour_t, cur, ipv6_neighbour_eui64_bucket(cache, eui64))
         if (cur->type != IP_NEIGHBOUR_GARBAGE_COLLECTIBLE &&
             !memcmp(ipv6_neighbour_eui64(cache, cur), eui64, 8) &&
             !IN6_IS_ADDR_MULTICAST(cur->ip_address) &&
@@ -266,32 +322,46 @@ ipv6_neighbour_t *ipv6_neighbour_lookup_gua_by_eui64(ipv6_neighbour_cache_t *cac
     return NULL;
 }
 
+void ipv6_neighbour_set_type(ipv6_neighbour_cache_t *cache, ipv6_neighbour_t *entry, ip_neighbour_cache_type_e type)
+{
+    if (entry->type == type)
+        return;
+    if (entry->type == IP_NEIGHBOUR_GARBAGE_COLLECTIBLE) {
+        ns_list_remove(&cache->gc_list, entry);
+        cache->gc_count--;
+    } else if (type == IP_NEIGHBOUR_GARBAGE_COLLECTIBLE) {
+        ns_list_add_to_start(&cache->gc_list, entry);
+        cache->gc_count++;
+    }
+    entry->type = type;
+}
+
 void ipv6_neighbour_set_state(ipv6_neighbour_cache_t *cache, ipv6_neighbour_t *entry, ip_neighbour_cache_state_e state)
 {
     switch (state) {
         case IP_NEIGHBOUR_INCOMPLETE:
             entry->retrans_count = 0;
-            entry->timer = cache->retrans_timer;
+            ipv6_neighbour_timer_start(cache, entry, cache->retrans_timer);
             break;
         case IP_NEIGHBOUR_STALE:
-            entry->timer = 0;
+            ipv6_neighbour_timer_stop(cache, entry);
             break;
         case IP_NEIGHBOUR_DELAY:
-            entry->timer = DELAY_FIRST_PROBE_TIME;
+            ipv6_neighbour_timer_start(cache, entry, DELAY_FIRST_PROBE_TIME);
             break;
         case IP_NEIGHBOUR_PROBE:
             entry->retrans_count = 0;
-            entry->timer = next_probe_time(cache, 0);
+            ipv6_neighbour_timer_start(cache, entry, next_probe_time(cache, 0));
             break;
         case IP_NEIGHBOUR_REACHABLE:
-            entry->timer = cache->reachable_time;
+            ipv6_neighbour_timer_start(cache, entry, cache->reachable_time);
             break;
         case IP_NEIGHBOUR_UNREACHABLE:
             /* Progress to this from PROBE - timers continue */
             ipv6_destination_cache_forget_neighbour(entry);
             break;
         default:
-            entry->timer = 0;
+            ipv6_neighbour_timer_stop(cache, entry);
             break;
     }
     entry->state = state;
@@ -330,10 +400,7 @@ ipv6_neighbour_t *ipv6_neighbour_update_unsolicited(ipv6_neighbour_cache_t *cach
 
 static void ipv6_neighbour_cache_gc_periodic(ipv6_neighbour_cache_t *cache)
 {
-    ns_list_foreach_reverse_safe(ipv6_neighbour_t, entry, &cache->list) {
-        if (entry->type != IP_NEIGHBOUR_GARBAGE_COLLECTIBLE)
-            continue;
-
+    ns_list_foreach_reverse_safe(ipv6_neighbour_t, entry, &cache->gc_list) {
         if (time_now_s(CLOCK_MONOTONIC) >= entry->expiration_s)
             ipv6_neighbour_entry_remove(cache, entry);
     }
@@ -372,77 +439,60 @@ void ipv6_neighbour_cache_slow_timer(int seconds)
     ipv6_neighbour_cache_gc_periodic(cache);
 }
 
-void ipv6_neighbour_cache_fast_timer(int ticks)
+static void ipv6_neighbour_timer_expired(struct timer_group *group, struct timer_entry *timer)
 {
-    ipv6_neighbour_cache_t *cache = &protocol_stack_interface_info_get()->ipv6_neighbour_cache;
-    uint32_t ms = (uint32_t) ticks * 100;
-
-    ns_list_foreach_safe(ipv6_neighbour_t, cur, &cache->list) {
-        if (cur->timer == 0) {
-            continue;
-        }
+    ipv6_neighbour_cache_t *cache = container_of(group, ipv6_neighbour_cache_t, timer_group);
+    ipv6_neighbour_t *cur = container_of(timer, ipv6_neighbour_t, timer);
 
-        if (cur->timer > ms) {
-            cur->timer -= ms;
-            continue;
-        }
-
-        cur->timer = 0;
-
-        /* Timer expired */
-        switch (cur->state) {
-            case IP_NEIGHBOUR_NEW:
-                /* Shouldn't happen */
-                break;
-            case IP_NEIGHBOUR_INCOMPLETE:
-                if (++cur->retrans_count >= MAX_MULTICAST_SOLICIT) {
-                    /* Should be safe for registration - Tentative/Registered entries can't be INCOMPLETE */
-                    ipv6_destination_cache_forget_neighbour(cur);
-                    ipv6_neighbour_entry_remove(cache, cur);
-                } else {
-                    ipv6_interface_resolve_send_ns(cache, cur, false, cur->retrans_count);
-                    cur->timer = cache->retrans_timer;
-                }
-                break;
-            case IP_NEIGHBOUR_STALE:
-                /* Shouldn't happen */
-                break;
-            case IP_NEIGHBOUR_REACHABLE:
-                ipv6_neighbour_set_state(cache, cur, IP_NEIGHBOUR_STALE);
-                break;
-            case IP_NEIGHBOUR_DELAY:
-                ipv6_neighbour_set_state(cache, cur, IP_NEIGHBOUR_PROBE);
-                ipv6_interface_resolve_send_ns(cache, cur, true, 0);
-                break;
-            case IP_NEIGHBOUR_PROBE:
-                if (cur->retrans_count >= MARK_UNREACHABLE - 1)
-                    ipv6_neighbour_set_state(cache, cur, IP_NEIGHBOUR_UNREACHABLE);
-            /* fall through */
-            case IP_NEIGHBOUR_UNREACHABLE:
-                if (cur->retrans_count < 0xFF) {
-                    cur->retrans_count++;
-                }
+    switch (cur->state) {
+        case IP_NEIGHBOUR_NEW:
+            /* Shouldn't happen */
+            break;
+        case IP_NEIGHBOUR_INCOMPLETE:
+            if (++cur->retrans_count >= MAX_MULTICAST_SOLICIT) {
+                /* Should be safe for registration - Tentative/Registered entries can't be INCOMPLETE */
+                ipv6_destination_cache_forget_neighbour(cur);
+                ipv6_neighbour_entry_remove(cache, cur);
+            } else {
+                ipv6_interface_resolve_send_ns(cache, cur, false, cur->retrans_count);
+                ipv6_neighbour_timer_start(cache, cur, cache->retrans_timer);
+            }
+            break;
+        case IP_NEIGHBOUR_STALE:
+            /* Shouldn't happen */
+            break;
+        case IP_NEIGHBOUR_REACHABLE:
+            ipv6_neighbour_set_state(cache, cur, IP_NEIGHBOUR_STALE);
+            break;
+        case IP_NEIGHBOUR_DELAY:
+            ipv6_neighbour_set_state(cache, cur, IP_NEIGHBOUR_PROBE);
+            ipv6_interface_resolve_send_ns(cache, cur, true, 0);
+            break;
+        case IP_NEIGHBOUR_PROBE:
+            if (cur->retrans_count >= MARK_UNREACHABLE - 1)
+                ipv6_neighbour_set_state(cache, cur, IP_NEIGHBOUR_UNREACHABLE);
+        /* fall through */
+        case IP_NEIGHBOUR_UNREACHABLE:
+            if (cur->retrans_count < 0xFF) {
+                cur->retrans_count++;
+            }
 
-                if (cur->retrans_count >= MAX_UNICAST_SOLICIT && cur->type == IP_NEIGHBOUR_GARBAGE_COLLECTIBLE) {
-                    ipv6_neighbour_entry_remove(cache, cur);
+            if (cur->retrans_count >= MAX_UNICAST_SOLICIT && cur->type == IP_NEIGHBOUR_GARBAGE_COLLECTIBLE) {
+                ipv6_neighbour_entry_remove(cache, cur);
+            } else {
+                ipv6_interface_resolve_send_ns(cache, cur, true, cur->retrans_count);
+                if (cur->retrans_count >= MAX_UNICAST_SOLICIT - 1) {
+                    /* "Final" unicast probe */
+                    /* If we're not going to remove this, leave the timer stopped. We'll restart to probe once more if it's used */
+                    if (cur->type == IP_NEIGHBOUR_GARBAGE_COLLECTIBLE)
+                        /* Only wait 1 initial retrans time for response to final probe - don't want backoff in this case */
+                        ipv6_neighbour_timer_start(cache, cur, cache->retrans_timer);
                 } else {
-                    ipv6_interface_resolve_send_ns(cache, cur, true, cur->retrans_count);
-                    if (cur->retrans_count >= MAX_UNICAST_SOLICIT - 1) {
-                        /* "Final" unicast probe */
-                        if (cur->type == IP_NEIGHBOUR_GARBAGE_COLLECTIBLE) {
-                            /* Only wait 1 initial retrans time for response to final probe - don't want backoff in this case */
-                            cur->timer = cache->retrans_timer;
-                        } else {
-                            /* We're not going to remove this. Let's stop the timer. We'll restart to probe once more if it's used */
-                            cur->timer = 0;
-                        }
-                    } else {
-                        /* Backoff for the next probe */
-                        cur->timer = next_probe_time(cache, cur->retrans_count);
-                    }
+                    /* Backoff for the next probe */
+                    ipv6_neighbour_timer_start(cache, cur, next_probe_time(cache, cur->retrans_count));
                 }
-                break;
-        }
+            }
+            break;
     }
 }
 
@@ -458,9 +508,19 @@ void ipv6_neighbour_cache_fast_timer(int ticks)
  * other addresses. That prevents us having multiple Destination Cache entries
  * for one global address.
  */
+static ipv6_destination_list_t *ipv6_destination_bucket(const uint8_t *address)
+{
+    return &ipv6_destination_hash[fnv_hash_reverse_32_init(address, 16) % DCACHE_HASH_SIZE];
+}
+
+void ipv6_destination_cache_init(void)
+{
+    for (int i = 0; i < DCACHE_HASH_SIZE; i++)
+        ns_list_init(&ipv6_destination_hash[i]);
+}
+
 ipv6_destination_t *ipv6_destination_lookup_or_create(const uint8_t *address, int8_t interface_id)
 {
-    uint16_t count = 0;
     ipv6_destination_t *entry = NULL;
     bool interface_specific = addr_ipv6_scope(address) <= IPV6_SCOPE_REALM_LOCAL;
 
@@ -469,8 +529,7 @@ ipv6_destination_t *ipv6_destination_lookup_or_create(const uint8_t *address, in
     }
 
     /* Find any existing entry */
-    ns_list_foreach(ipv6_destination_t, cur, &ipv6_destination_cache) {
-        count++;
+    ns_list_foreach(ipv6_destination_t, cur, ipv6_destination_bucket(address)) {
         if (!addr_ipv6_equal(cur->destination, address)) {
             continue;
         }
@@ -485,7 +544,7 @@ ipv6_destination_t *ipv6_destination_lookup_or_create(const uint8_t *address, in
 
 
     if (!entry) {
-        if (count > DCACHE_MAX_ABSOLUTE) {
+        if (ipv6_destination_count > DCACHE_MAX_ABSOLUTE) {
             entry = ns_list_get_last(&ipv6_destination_cache);
             ipv6_destination_release(entry);
         }
@@ -504,6 +563,8 @@ ipv6_destination_t *ipv6_destination_lookup_or_create(const uint8_t *address, in
             entry->interface_id = -1;
         }
         ns_list_add_to_start(&ipv6_destination_cache, entry);
+        ns_list_add_to_start(ipv6_destination_bucket(address), entry);
+        ipv6_destination_count++;
     } else if (entry != ns_list_get_first(&ipv6_destination_cache)) {
         /* If there was an entry, and it wasn't at the start, move it */
         ns_list_remove(&ipv6_destination_cache, entry);
@@ -541,6 +602,8 @@ static bool ipv6_destination_release(ipv6_destination_t *dest)
 {
     if (--dest->refcount == 0) {
         ns_list_remove(&ipv6_destination_cache, dest);
+        ns_list_remove(ipv6_destination_bucket(dest->destination), dest);
+        ipv6_destination_count--;
         tr_debug("Destination cache remove: %s", tr_ipv6(dest->destination));
         free(dest);
         return true;
@@ -656,6 +719,128 @@ static uint16_t total_metric(const ipv6_route_t *route)
     return metric;
 }
 
+// Number of leading bits shared by a and b, up to len
+static uint8_t ipv6_route_trie_common_len(const uint8_t *a, const uint8_t *b, uint8_t len)
+{
+    uint8_t diff;
+    int i;
+
+    for (i = 0; i < len / 8; i++)
+        if (a[i] != b[i])
+            break;
+    if (i * 8 >= len)
+        return len;
+    diff = a[i] ^ b[i];
+    if (!diff)
+        return len;
+    return MIN(len, i * 8 + __builtin_ctz(diff));
+}
+
+static struct ipv6_route_node **ipv6_route_trie_link(struct ipv6_route_node *node)
+{
+    if (!node->parent)
+        return &ipv6_route_trie;
+    return &node->parent->child[node->parent->child[1] == node];
+}
+
+static struct ipv6_route_node *ipv6_route_trie_node_new(const uint8_t *prefix, uint8_t prefix_len,
+                                                        struct ipv6_route_node *parent)
+{
+    struct ipv6_route_node *node = zalloc(sizeof(struct ipv6_route_node));
+
+    bitcpy(node->prefix, prefix, prefix_len);
+    node->prefix_len = prefix_len;
+    node->parent = parent;
+    ns_list_init(&node->routes);
+    return node;
+}
+
+static struct ipv6_route_node *ipv6_route_trie_lookup(const uint8_t *prefix, uint8_t prefix_len)
+{
+    struct ipv6_route_node *node = ipv6_route_trie;
+
+    while (node && node->prefix_len < prefix_len) {
+        if (ipv6_route_trie_common_len(prefix, node->prefix, node->prefix_len) != node->prefix_len)
+            return NULL;
+        node = node->child[bittest(prefix, node->prefix_len)];
+    }
+    if (!node || node->prefix_len != prefix_len || bitcmp(prefix, node->prefix, prefix_len))
+        return NULL;
+    return node;
+}
+
+static struct ipv6_route_node *ipv6_route_trie_insert(const uint8_t *prefix, uint8_t prefix_len)
+{
+    struct ipv6_route_node **link = &ipv6_route_trie;
+    struct ipv6_route_node *parent = NULL;
+    struct ipv6_route_node *node, *glue;
+    uint8_t common_len;
+
+    while ((node = *link)) {
+        common_len = ipv6_route_trie_common_len(prefix, node->prefix, MIN(prefix_len, node->prefix_len));
+        if (common_len == node->prefix_len && common_len == prefix_len)
+            return node;
+        if (common_len == node->prefix_len) {
+            parent = node;
+            link = &node->child[bittest(prefix, node->prefix_len)];
+            continue;
+        }
+        // The new prefix diverges from this node, or is one of its ancestors
+        if (common_len == prefix_len) {
+            glue = ipv6_route_trie_node_new(prefix, prefix_len, parent);
+            glue->child[bittest(node->prefix, prefix_len)] = node;
+            node->parent = glue;
+            *link = glue;
+            return glue;
+        }
+        glue = ipv6_route_trie_node_new(prefix, common_len, parent);
+        glue->child[bittest(node->prefix, common_len)] = node;
+        node->parent = glue;
+        *link = glue;
+        parent = glue;
+        link = &glue->child[bittest(prefix, common_len)];
+        break;
+    }
+    *link = ipv6_route_trie_node_new(prefix, prefix_len, parent);
+    return *link;
+}
+
+// Collapse nodes which are neither holding routes nor joining branches
+static void ipv6_route_trie_release(struct ipv6_route_node *node)
+{
+    struct ipv6_route_node *parent, *child;
+
+    while (node && ns_list_is_empty(&node->routes) && !(node->child[0] && node->child[1])) {
+        child = node->child[0] ? node->child[0] : node->child[1];
+        parent = node->parent;
+        *ipv6_route_trie_link(node) = child;
+        if (child)
+            child->parent = parent;
+        free(node);
+        node = parent;
+    }
+}
+
+// Fill nodes[] with the nodes matching addr, from the most specific
+static int ipv6_route_trie_match(const uint8_t *addr, struct ipv6_route_node *nodes[129])
+{
+    struct ipv6_route_node *node = ipv6_route_trie;
+    struct ipv6_route_node *path[129];
+    int count = 0;
+    int i;
+
+    while (node && !bitcmp(addr, node->prefix, node->prefix_len)) {
+        if (!ns_list_is_empty(&node->routes))
+            path[count++] = node;
+        if (node->prefix_len == 128)
+            break;
+        node = node->child[bittest(addr, node->prefix_len)];
+    }
+    for (i = 0; i < count; i++)
+        nodes[i] = path[count - 1 - i];
+    return count;
+}
+
 static void ipv6_route_entry_remove(ipv6_route_t *route)
 {
     tr_info("Deleted route:");
@@ -663,6 +848,8 @@ static void ipv6_route_entry_remove(ipv6_route_t *route)
     if (route->info_autofree) {
         free(route->info.info);
     }
+    ns_list_remove(&route->node->routes, route);
+    ipv6_route_trie_release(route->node);
     ns_list_remove(&ipv6_routing_table, route);
     free(route);
 }
@@ -693,27 +880,26 @@ static bool ipv6_route_is_better(const ipv6_route_t *a, const ipv6_route_t *b)
 }
 
 /* Find the "best" route regardless of reachability, but respecting the skip flag and predicates */
-static ipv6_route_t *ipv6_route_find_best(const uint8_t *addr, int8_t interface_id)
+static ipv6_route_t *ipv6_route_find_best(struct ipv6_route_node *nodes[], int node_count, int8_t interface_id)
 {
     ipv6_route_t *best = NULL;
-    ns_list_foreach(ipv6_route_t, route, &ipv6_routing_table) {
-        /* We mustn't be skipping this route */
-        if (route->search_skip) {
-            continue;
-        }
 
-        /* Interface must match, if caller specified */
-        if (interface_id != -1 && interface_id != route->info.interface_id) {
-            continue;
-        }
+    /* Nodes are sorted by decreasing prefix length, which takes precedence */
+    for (int i = 0; i < node_count && !best; i++) {
+        ns_list_foreach(ipv6_route_t, route, &nodes[i]->routes) {
+            /* We mustn't be skipping this route */
+            if (route->search_skip) {
+                continue;
+            }
 
-        /* Prefix must match */
-        if (bitcmp(addr, route->prefix, route->prefix_len)) {
-            continue;
-        }
+            /* Interface must match, if caller specified */
+            if (interface_id != -1 && interface_id != route->info.interface_id) {
+                continue;
+            }
 
-        if (!best || ipv6_route_is_better(route, best)) {
-            best = route;
+            if (!best || ipv6_route_is_better(route, best)) {
+                best = route;
+            }
         }
     }
     return best;
@@ -721,11 +907,14 @@ static ipv6_route_t *ipv6_route_find_best(const uint8_t *addr, int8_t interface_
 
 ipv6_route_t *ipv6_route_choose_next_hop(const uint8_t *dest, int8_t interface_id)
 {
+    struct ipv6_route_node *nodes[129];
     ipv6_route_t *best = NULL;
+    int node_count;
 
-    ns_list_foreach(ipv6_route_t, route, &ipv6_routing_table) {
-        route->search_skip = false;
-    }
+    node_count = ipv6_route_trie_match(dest, nodes);
+    for (int i = 0; i < node_count; i++)
+        ns_list_foreach(ipv6_route_t, route, &nodes[i]->routes)
+            route->search_skip = false;
 
     /* Search algorithm from RFC 4191, S3.2:
      *
@@ -754,7 +943,7 @@ ipv6_route_t *ipv6_route_choose_next_hop(const uint8_t *dest, int8_t interface_i
      * possibility would be a special precedence flag.
      */
     for (;;) {
-        ipv6_route_t *route = ipv6_route_find_best(dest, interface_id);
+        ipv6_route_t *route = ipv6_route_find_best(nodes, node_count, interface_id);
         if (!route) {
             break;
         }
@@ -786,8 +975,14 @@ ipv6_route_t *ipv6_route_choose_next_hop(const uint8_t *dest, int8_t interface_i
 
 ipv6_route_t *ipv6_route_lookup_with_info(const uint8_t *prefix, uint8_t prefix_len, int8_t interface_id, const uint8_t *next_hop, ipv6_route_src_t source, void *info, int_fast16_t src_id)
 {
-    ns_list_foreach(ipv6_route_t, r, &ipv6_routing_table) {
-        if (interface_id == r->info.interface_id && prefix_len == r->prefix_len && !bitcmp(prefix, r->prefix, prefix_len)) {
+    struct ipv6_route_node *node = ipv6_route_trie_lookup(prefix, prefix_len);
+
+    if (!node) {
+        return NULL;
+    }
+
+    ns_list_foreach(ipv6_route_t, r, &node->routes) {
+        if (interface_id == r->info.interface_id) {
             if (source != ROUTE_ANY) {
                 if (source != r->info.source) {
                     continue;
@@ -906,6 +1101,8 @@ ipv6_route_t *ipv6_route_add_metric(const uint8_t *prefix, uint8_t prefix_len, i
         /* Doesn't matter much where they start off, but put them at the */
         /* beginning so new routes tend to get tried first. */
         ns_list_add_to_start(&ipv6_routing_table, route);
+        route->node = ipv6_route_trie_insert(route->prefix, prefix_len);
+        ns_list_add_to_start(&route->node->routes, route);
         changed_info = NEW;
     } else { /* updating a route - only lifetime and metric can be changing */
         route->lifetime = lifetime;
@@ -27,6 +27,7 @@
 #include <stdbool.h>
 #include <time.h>
 #include "common/ns_list.h"
+#include "common/timer.h"
 
 #include "net/netaddr_types.h"
 
@@ -47,6 +48,8 @@
 
 #define DCACHE_GC_PERIOD    20  /* seconds */
 
+#define NCACHE_HASH_SIZE    1024 /* buckets of the address and EUI-64 indexes */
+
 /* XXX in the process of renaming this - it's really specifically the
  * IP Neighbour Cache  but was initially called a routing table */
 
@@ -96,10 +99,13 @@ typedef struct ipv6_neighbour {
     ip_neighbour_cache_state_e      state;
     ip_neighbour_cache_type_e       type;
     addrtype_e                      ll_type;
-    uint32_t                        timer;                      /* 100ms ticks */
+    struct timer_entry              timer;                      /* NUD state timer */
     uint32_t                        lifetime_s;
     time_t                          expiration_s;
     ns_list_link_t                  link;                       /*!< List link */
+    ns_list_link_t                  gc_link;                    /* Only for garbage-collectible entries */
+    ns_list_link_t                  addr_link;
+    ns_list_link_t                  eui64_link;                 /* Only if "recv_addr_reg" */
     uint8_t                         ll_address[];
 } ipv6_neighbour_t;
 
@@ -108,6 +114,9 @@ typedef struct ipv6_neighbour {
  */
 #define ipv6_neighbour_eui64(ncache, entry) ((entry)->ll_address + (ncache)->max_ll_len)
 
+typedef NS_LIST_HEAD(ipv6_neighbour_t, addr_link) ipv6_neighbour_addr_list_t;
+typedef NS_LIST_HEAD(ipv6_neighbour_t, eui64_link) ipv6_neighbour_eui64_list_t;
+
 typedef struct ipv6_route_info_cache {
     uint16_t                                metric; // interface metric
     uint8_t                                 sources[ROUTE_MAX];
@@ -129,6 +138,12 @@ typedef struct ipv6_neighbour_cache {
     ipv6_route_interface_info_t             route_if_info;
     //uint8_t                                   num_entries;
     NS_LIST_HEAD(ipv6_neighbour_t, link)    list;
+    // Garbage-collectible entries, in most-recently-used-first order
+    NS_LIST_HEAD(ipv6_neighbour_t, gc_link) gc_list;
+    uint16_t                                gc_count;
+    ipv6_neighbour_addr_list_t              addr_hash[NCACHE_HASH_SIZE];
+    ipv6_neighbour_eui64_list_t             eui64_hash[NCACHE_HASH_SIZE];
+    struct timer_group                      timer_group;
 } ipv6_neighbour_cache_t;
 
 void ipv6_neighbour_cache_init(ipv6_neighbour_cache_t *cache, int8_t interface_id);
@@ -141,9 +156,10 @@ ipv6_neighbour_t *ipv6_neighbour_lookup_mc(ipv6_neighbour_cache_t *cache, const
 ipv6_neighbour_t *ipv6_neighbour_create(ipv6_neighbour_cache_t *cache, const uint8_t *address, const uint8_t *eui64);
 void ipv6_neighbour_entry_remove(ipv6_neighbour_cache_t *cache, ipv6_neighbour_t *entry);
 ipv6_neighbour_t *ipv6_neighbour_lookup_gua_by_eui64(ipv6_neighbour_cache_t *cache, const uint8_t *eui64);
+ipv6_neighbour_eui64_list_t *ipv6_neighbour_eui64_bucket(ipv6_neighbour_cache_t *cache, const uint8_t *eui64);
+void ipv6_neighbour_set_type(ipv6_neighbour_cache_t *cache, ipv6_neighbour_t *entry, ip_neighbour_cache_type_e type);
 void ipv6_neighbour_entry_update_unsolicited(ipv6_neighbour_cache_t *cache, ipv6_neighbour_t *entry, addrtype_e type, const uint8_t *ll_address/*, bool tentative*/);
 ipv6_neighbour_t *ipv6_neighbour_update_unsolicited(ipv6_neighbour_cache_t *cache, const uint8_t *ip_address, addrtype_e ll_type, const uint8_t *ll_address);
-void ipv6_neighbour_cache_fast_timer(int ticks);
 void ipv6_neighbour_cache_slow_timer(int seconds);
 
 typedef struct ipv6_route_info {
@@ -163,10 +179,12 @@ typedef struct ipv6_destination {
     uint16_t                        lifetime;           // Life in GC calls, so 20s units
     ipv6_neighbour_t                *last_neighbour;    // last neighbour used (only for reachability confirmation)
     ns_list_link_t                  link;
+    ns_list_link_t                  hash_link;
 } ipv6_destination_t;
 
 ipv6_destination_t *ipv6_destination_lookup_or_create(const uint8_t *address, int8_t interface_id);
 ipv6_destination_t *ipv6_destination_lookup_or_create_with_route(const uint8_t *address, int8_t interface_id, ipv6_route_info_t *route_out);
+void ipv6_destination_cache_init(void);
 void ipv6_destination_cache_timer(int ticks);
 void ipv6_destination_cache_clean(int8_t interface_id);
 
@@ -181,6 +199,8 @@ typedef struct ipv6_route {
     ipv6_route_info_t   info;
     uint32_t            lifetime;           // (seconds); 0xFFFFFFFF means permanent
     ns_list_link_t      link;
+    struct ipv6_route_node *node;           // prefix trie node holding this route
+    ns_list_link_t      node_link;
     uint8_t             prefix[];           // variable length
 } ipv6_route_t;
 
@@ -19,12 +19,16 @@
 #include <string.h>
 #include <stdlib.h>
 #include <netinet/in.h>
+#include <sys/queue.h>
 #include "common/ws/ws_neigh.h"
 #include "common/string_extra.h"
 #include "common/time_extra.h"
 #include "common/iobuf.h"
 #include "common/log.h"
 #include "common/bits.h"
+#include "common/fnv_hash.h"
+#include "common/memutils.h"
+#include "common/timer.h"
 #include "common/specs/ndp.h"
 #include "common/specs/icmpv6.h"
 #include "common/specs/ipv6.h"
@@ -38,12 +42,61 @@
 
 #include "ipv6/nd_router_object.h"
 
+// Host routes and proxy neighbor entries are installed in the kernel with
+// netlink requests. They are batched so a burst of registrations does not
+// stall the main loop, and duplicate requests in a batch are dropped.
+#define ND_KERNEL_SYNC_DELAY_MS 100
+
+struct nd_kernel_pending {
+    struct net_if *net_if;
+    uint8_t addr[16];
+    SLIST_ENTRY(nd_kernel_pending) link;
+};
+
+static void nd_kernel_sync(struct timer_group *group, struct timer_entry *timer);
+
+struct nd_registration_stats g_nd_registration_stats;
+
+static SLIST_HEAD(, nd_kernel_pending) nd_kernel_pending[256];
+static struct timer_entry nd_kernel_sync_timer = {
+    .callback = nd_kernel_sync,
+};
+
+static void nd_kernel_sync(struct timer_group *group, struct timer_entry *timer)
+{
+    struct nd_kernel_pending *pending;
+
+    for (int i = 0; i < ARRAY_SIZE(nd_kernel_pending); i++) {
+        while ((pending = SLIST_FIRST(&nd_kernel_pending[i]))) {
+            SLIST_REMOVE_HEAD(&nd_kernel_pending[i], link);
+            tun_add_node_to_proxy_neightbl(pending->net_if, pending->addr);
+            tun_add_ipv6_direct_route(pending->net_if, pending->addr);
+            free(pending);
+        }
+    }
+}
+
+static void nd_kernel_sync_schedule(struct net_if *net_if, const uint8_t addr[16])
+{
+    uint32_t bucket = fnv_hash_reverse_32_init(addr, 16) % ARRAY_SIZE(nd_kernel_pending);
+    struct nd_kernel_pending *pending;
+
+    SLIST_FOREACH(pending, &nd_kernel_pending[bucket], link)
+        if (pending->net_if == net_if && !memcmp(pending->addr, addr, 16))
+            return;
+    pending = zalloc(sizeof(*pending));
+    pending->net_if = net_if;
+    memcpy(pending->addr, addr, 16);
+    SLIST_INSERT_HEAD(&nd_kernel_pending[bucket], pending, link);
+    if (timer_stopped(&nd_kernel_sync_timer))
+        timer_start_rel(NULL, &nd_kernel_sync_timer, ND_KERNEL_SYNC_DELAY_MS);
+}
+
 static void nd_add_ipv6_neigh_route(struct net_if *net_if, struct ipv6_neighbour *neigh)
 {
     ipv6_route_add_metric(neigh->ip_address, 128, net_if->id, neigh->ip_address,
                           ROUTE_ARO, NULL, 0, neigh->lifetime_s - 2, 32);
-    tun_add_node_to_proxy_neightbl(net_if, neigh->ip_address);
-    tun_add_ipv6_direct_route(net_if, neigh->ip_address);
+    nd_kernel_sync_schedule(net_if, neigh->ip_address);
 }
 
 void nd_update_registration(struct net_if *cur_interface, ipv6_neighbour_t *neigh, const struct ipv6_nd_opt_earo *aro,
@@ -56,7 +109,7 @@ void nd_update_registration(struct net_if *cur_interface, ipv6_neighbour_t *neig
 
     /* We are about to send an ARO response - update our Neighbour Cache accordingly */
     if (aro->status == NDP_ARO_STATUS_SUCCESS && aro->lifetime != 0) {
-        neigh->type = IP_NEIGHBOUR_REGISTERED;
+        ipv6_neighbour_set_type(&cur_interface->ipv6_neighbour_cache, neigh, IP_NEIGHBOUR_REGISTERED);
         neigh->lifetime_s = aro->lifetime * UINT32_C(60);
         neigh->expiration_s = time_now_s(CLOCK_MONOTONIC) + neigh->lifetime_s;
         ipv6_neighbour_set_state(&cur_interface->ipv6_neighbour_cache, neigh, IP_NEIGHBOUR_STALE);
@@ -81,7 +134,7 @@ void nd_update_registration(struct net_if *cur_interface, ipv6_neighbour_t *neig
 
 void nd_remove_aro_routes_by_eui64(struct net_if *net_if, const uint8_t *eui64)
 {
-    ns_list_foreach_safe(ipv6_neighbour_t, neigh, &net_if->ipv6_neighbour_cache.list)
+    ns_list_foreach_safe(ipv6_neighbour_t, neigh, ipv6_neighbour_eui64_bucket(&net_if->ipv6_neighbour_cache, eui64))
         if ((neigh->type == IP_NEIGHBOUR_REGISTERED || neigh->type == IP_NEIGHBOUR_TENTATIVE) &&
             !memcmp(ipv6_neighbour_eui64(&net_if->ipv6_neighbour_cache, neigh), eui64, 8) &&
             !IN6_IS_ADDR_MULTICAST(neigh->ip_address))
@@ -90,7 +143,7 @@ void nd_remove_aro_routes_by_eui64(struct net_if *net_if, const uint8_t *eui64)
 
 void nd_restore_aro_routes_by_eui64(struct net_if *net_if, const uint8_t *eui64)
 {
-    ns_list_foreach_safe(ipv6_neighbour_t, neigh, &net_if->ipv6_neighbour_cache.list)
+    ns_list_foreach_safe(ipv6_neighbour_t, neigh, ipv6_neighbour_eui64_bucket(&net_if->ipv6_neighbour_cache, eui64))
         if ((neigh->type == IP_NEIGHBOUR_REGISTERED || neigh->type == IP_NEIGHBOUR_TENTATIVE) &&
             !memcmp(ipv6_neighbour_eui64(&net_if->ipv6_neighbour_cache, neigh), eui64, 8) &&
             !IN6_IS_ADDR_MULTICAST(neigh->ip_address))
@@ -98,9 +151,9 @@ void nd_restore_aro_routes_by_eui64(struct net_if *net_if, const uint8_t *eui64)
 }
 
 /* Process ICMP Neighbor Solicitation (RFC 4861 + RFC 6775 + RFC 8505 + draft-ietf-6lo-multicast-registration-15) EARO. */
-bool nd_ns_earo_handler(struct net_if *cur_interface, const uint8_t *earo_ptr, size_t earo_len,
-                        const uint8_t *slla_ptr, const uint8_t src_addr[16], const uint8_t target[16],
-                        struct ipv6_nd_opt_earo *na_earo)
+static bool nd_ns_earo_process(struct net_if *cur_interface, const uint8_t *earo_ptr, size_t earo_len,
+                               const uint8_t *slla_ptr, const uint8_t src_addr[16], const uint8_t target[16],
+                               struct ipv6_nd_opt_earo *na_earo)
 {
     const uint8_t *registered_addr = src_addr;
     struct iobuf_read earo = {
@@ -257,7 +310,7 @@ bool nd_ns_earo_handler(struct net_if *cur_interface, const uint8_t *earo_ptr, s
     }
 
     if (neigh->type != IP_NEIGHBOUR_REGISTERED) {
-        neigh->type = IP_NEIGHBOUR_TENTATIVE;
+        ipv6_neighbour_set_type(&cur_interface->ipv6_neighbour_cache, neigh, IP_NEIGHBOUR_TENTATIVE);
         neigh->lifetime_s = TENTATIVE_NCE_LIFETIME;
     }
 
@@ -270,3 +323,20 @@ bool nd_ns_earo_handler(struct net_if *cur_interface, const uint8_t *earo_ptr, s
     nd_update_registration(cur_interface, neigh, na_earo, ws_neigh);
     return true;
 }
+
+bool nd_ns_earo_handler(struct net_if *cur_interface, const uint8_t *earo_ptr, size_t earo_len,
+                        const uint8_t *slla_ptr, const uint8_t src_addr[16], const uint8_t target[16],
+                        struct ipv6_nd_opt_earo *na_earo)
+{
+    uint64_t start_us = time_now_us(CLOCK_MONOTONIC);
+    uint64_t latency_us;
+    bool ret;
+
+    ret = nd_ns_earo_process(cur_interface, earo_ptr, earo_len, slla_ptr, src_addr, target, na_earo);
+    latency_us = time_now_us(CLOCK_MONOTONIC) - start_us;
+    g_nd_registration_stats.count++;
+    g_nd_registration_stats.latency_total_us += latency_us;
+    if (latency_us > g_nd_registration_stats.latency_max_us)
+        g_nd_registration_stats.latency_max_us = latency_us;
+    return ret;
+}
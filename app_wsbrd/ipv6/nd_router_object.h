@@ -27,6 +27,16 @@ typedef struct ipv6_neighbour ipv6_neighbour_t;
 struct ws_neigh;
 enum addrtype;
 
+// Time spent processing NS(EARO) until the Neighbor Cache is updated. Storage
+// and kernel updates are deferred and not accounted.
+struct nd_registration_stats {
+    uint64_t count;
+    uint64_t latency_total_us;
+    uint64_t latency_max_us;
+};
+
+extern struct nd_registration_stats g_nd_registration_stats;
+
 bool nd_ns_earo_handler(struct net_if *cur_interface, const uint8_t *earo_ptr, size_t earo_len,
                         const uint8_t *slla_ptr, const uint8_t src_addr[16], const uint8_t target[16],
                         struct ipv6_nd_opt_earo *na_earo);
@@ -20,16 +20,17 @@
 #include <stdlib.h>
 #include <inttypes.h>
 #include "common/endian.h"
-#include "common/trickle_legacy.h"
+#include "common/trickle.h"
+#include "common/timer.h"
 #include "common/rand.h"
 #include "common/bits.h"
 #include "common/log_legacy.h"
 #include "common/ns_list.h"
 #include "common/seqno.h"
 #include "common/specs/ipv6.h"
+#include "common/mathutils.h"
 #include "common/memutils.h"
 
-#include "net/timers.h"
 #include "net/ns_buffer.h"
 #include "net/protocol.h"
 #include "ipv6/ipv6.h"
@@ -46,32 +47,43 @@
 #define MPL_OPT_V           0x10
 
 #define MAX_BUFFERED_MESSAGES_SIZE 8192
-#define MAX_BUFFERED_MESSAGE_LIFETIME 600 // 1/10 s ticks
+#define MAX_BUFFERED_MESSAGE_LIFETIME_MS 60000
 
-static uint16_t mpl_total_buffered;
+static size_t mpl_total_buffered;
+static size_t mpl_max_buffered = MAX_BUFFERED_MESSAGES_SIZE;
+
+typedef struct mpl_seed mpl_seed_t;
 
 /* Note that we don't use a buffer_t, to save a little RAM. We don't need
  * any of the metadata it stores...
  */
 typedef struct mpl_data_message {
-    bool running;
     bool colour;
-    uint32_t timestamp;
-    trickle_legacy_t trickle;
-    ns_list_link_t link;
+    uint8_t expirations;            /* trickle intervals elapsed, MPL TimerExpirations */
+    uint64_t timestamp_ms;
+    mpl_seed_t *seed;
+    struct trickle trickle;
+    ns_list_link_t link;            /* domain messages, oldest first */
     uint16_t mpl_opt_data_offset;   /* offset to option data of MPL option */
     uint8_t message[];
 } mpl_buffered_message_t;
 
-typedef struct mpl_seed {
+struct mpl_seed {
     ns_list_link_t link;
+    mpl_domain_t *domain;
     bool colour;
-    uint16_t lifetime;
+    struct timer_entry timer_lifetime;
     uint8_t min_sequence;
+    uint8_t max_sequence;
+    uint16_t count;
+    /*
+     * Sequence numbers are 8-bit, so the buffered message set is directly
+     * indexed by sequence. All entries are >= min_sequence.
+     */
+    mpl_buffered_message_t *messages[256];
     uint8_t id_len;
-    NS_LIST_HEAD(mpl_buffered_message_t, link) messages; /* sequence number order */
     uint8_t id[];
-} mpl_seed_t;
+};
 
 /* For simplicity, we assume each MPL domain is on exactly 1 interface */
 struct mpl_domain {
@@ -81,16 +93,22 @@ struct mpl_domain {
     bool colour;
     uint16_t seed_set_entry_lifetime;
     NS_LIST_HEAD(mpl_seed_t, link) seeds;
-    trickle_legacy_params_t data_trickle_params;
+    NS_LIST_HEAD(mpl_buffered_message_t, link) messages; /* timestamp order */
+    struct timer_entry timer_gc;
+    const struct trickle_cfg *data_trickle_cfg;
+    uint8_t data_timer_expirations;
     ns_list_link_t link;
     uint8_t seed_id_mode;
 };
 
 static NS_LIST_DEFINE(mpl_domains, mpl_domain_t, link);
+static struct timer_group mpl_timer_group;
 
 static void mpl_buffer_delete(mpl_seed_t *seed, mpl_buffered_message_t *message);
 static buffer_t *mpl_exthdr_provider(buffer_t *buf, ipv6_exthdr_stage_e stage, int16_t *result);
 static void mpl_seed_delete(mpl_domain_t *domain, mpl_seed_t *seed);
+static void mpl_seed_lifetime_expired(struct timer_group *group, struct timer_entry *timer);
+static void mpl_domain_gc(struct timer_group *group, struct timer_entry *timer);
 
 static bool mpl_initted;
 
@@ -101,6 +119,7 @@ static void mpl_init(void)
     }
     mpl_initted = true;
 
+    timer_group_init(&mpl_timer_group);
     ipv6_set_exthdr_provider(ROUTE_MPL, mpl_exthdr_provider);
 }
 
@@ -114,6 +133,23 @@ static uint16_t mpl_buffer_size(const mpl_buffered_message_t *message)
     return IPV6_HDRLEN + read_be16(message->message + IPV6_HDROFF_PAYLOAD_LENGTH);
 }
 
+static bool mpl_buffer_running(const mpl_domain_t *domain, const mpl_buffered_message_t *message)
+{
+    return message->expirations < domain->data_timer_expirations;
+}
+
+static uint64_t mpl_domain_message_age_limit_ms(const mpl_domain_t *domain)
+{
+    uint64_t message_age_limit_ms = domain->seed_set_entry_lifetime * UINT64_C(1000) / 4;
+
+    return MIN(message_age_limit_ms, MAX_BUFFERED_MESSAGE_LIFETIME_MS);
+}
+
+void mpl_set_buffer_size(size_t size)
+{
+    mpl_max_buffered = size;
+}
+
 mpl_domain_t *mpl_domain_lookup(struct net_if *cur, const uint8_t address[16])
 {
     ns_list_foreach(mpl_domain_t, domain, &mpl_domains) {
@@ -149,12 +185,13 @@ static mpl_domain_t *mpl_domain_lookup_ignoring_scop(struct net_if *cur, const u
 
 mpl_domain_t *mpl_domain_create(struct net_if *cur, const uint8_t address[16],
                                 uint16_t seed_set_entry_lifetime, uint8_t seed_id_mode,
-                                const trickle_legacy_params_t *data_trickle_params)
+                                const struct trickle_cfg *data_trickle_cfg,
+                                uint8_t data_timer_expirations)
 {
     mpl_domain_t *domain;
 
     if (!addr_is_ipv6_multicast(address) || addr_ipv6_multicast_scope(address) < IPV6_SCOPE_REALM_LOCAL ||
-        !data_trickle_params) {
+        !data_trickle_cfg) {
         return NULL;
     }
 
@@ -175,8 +212,11 @@ mpl_domain_t *mpl_domain_create(struct net_if *cur, const uint8_t address[16],
     domain->sequence = rand_get_8bit();
     domain->colour = false;
     ns_list_init(&domain->seeds);
+    ns_list_init(&domain->messages);
+    domain->timer_gc.callback = mpl_domain_gc;
     domain->seed_set_entry_lifetime = seed_set_entry_lifetime;
-    domain->data_trickle_params = *data_trickle_params;
+    domain->data_trickle_cfg = data_trickle_cfg;
+    domain->data_timer_expirations = data_timer_expirations;
     ns_list_add_to_end(&mpl_domains, domain);
     BUG_ON(seed_id_mode != MPL_SEED_IPV6_SRC && seed_id_mode != MPL_SEED_128_BIT);
     domain->seed_id_mode = seed_id_mode;
@@ -199,16 +239,14 @@ static mpl_seed_t *mpl_seed_lookup(const mpl_domain_t *domain, uint8_t id_len, c
 
 static mpl_seed_t *mpl_seed_create(mpl_domain_t *domain, uint8_t id_len, const uint8_t *seed_id, uint8_t sequence)
 {
-    mpl_seed_t *seed = malloc(sizeof(mpl_seed_t) + id_len);
-    if (!seed) {
-        return NULL;
-    }
+    mpl_seed_t *seed = zalloc(sizeof(mpl_seed_t) + id_len);
 
+    seed->domain = domain;
     seed->min_sequence = sequence;
-    seed->lifetime = domain->seed_set_entry_lifetime;
     seed->id_len = id_len;
     seed->colour = domain->colour;
-    ns_list_init(&seed->messages);
+    seed->timer_lifetime.callback = mpl_seed_lifetime_expired;
+    timer_start_rel(&mpl_timer_group, &seed->timer_lifetime, domain->seed_set_entry_lifetime * 1000);
     memcpy(seed->id, seed_id, id_len);
     ns_list_add_to_end(&domain->seeds, seed);
     return seed;
@@ -216,59 +254,122 @@ static mpl_seed_t *mpl_seed_create(mpl_domain_t *domain, uint8_t id_len, const u
 
 static void mpl_seed_delete(mpl_domain_t *domain, mpl_seed_t *seed)
 {
-    ns_list_foreach_safe(mpl_buffered_message_t, message, &seed->messages) {
-        mpl_buffer_delete(seed, message);
-    }
+    for (int i = 0; i < ARRAY_SIZE(seed->messages) && seed->count; i++)
+        if (seed->messages[i])
+            mpl_buffer_delete(seed, seed->messages[i]);
+    timer_stop(&mpl_timer_group, &seed->timer_lifetime);
     ns_list_remove(&domain->seeds, seed);
     free(seed);
 }
 
+static void mpl_seed_lifetime_expired(struct timer_group *group, struct timer_entry *timer)
+{
+    mpl_seed_t *seed = container_of(timer, mpl_seed_t, timer_lifetime);
+
+    mpl_seed_delete(seed->domain, seed);
+}
+
 static void mpl_seed_advance_min_sequence(mpl_seed_t *seed, uint8_t min_sequence)
 {
-    seed->min_sequence = min_sequence;
-    ns_list_foreach_safe(mpl_buffered_message_t, message, &seed->messages) {
-        if (seqno_cmp8(min_sequence, mpl_buffer_sequence(message)) > 0) {
-            mpl_buffer_delete(seed, message);
-        }
+    while (seed->count && seqno_cmp8(min_sequence, seed->min_sequence) > 0) {
+        if (seed->messages[seed->min_sequence])
+            mpl_buffer_delete(seed, seed->messages[seed->min_sequence]);
+        seed->min_sequence++;
     }
+    seed->min_sequence = min_sequence;
 }
 
 static mpl_buffered_message_t *mpl_buffer_lookup(mpl_seed_t *seed, uint8_t sequence)
 {
-    ns_list_foreach(mpl_buffered_message_t, message, &seed->messages) {
-        if (mpl_buffer_sequence(message) == sequence) {
-            return message;
-        }
-    }
-    return NULL;
+    mpl_buffered_message_t *message = seed->messages[sequence];
+
+    BUG_ON(message && mpl_buffer_sequence(message) != sequence);
+    return message;
 }
 
-static void mpl_free_space(void)
+static bool mpl_free_space(void)
 {
-    mpl_seed_t *oldest_seed = NULL;
     mpl_buffered_message_t *oldest_message = NULL;
 
     /* We'll free one message - earliest sequence number from one seed */
     /* Choose which seed by looking at the timestamp - oldest one first */
     ns_list_foreach(mpl_domain_t, domain, &mpl_domains) {
-        ns_list_foreach(mpl_seed_t, seed, &domain->seeds) {
-            mpl_buffered_message_t *message = ns_list_get_first(&seed->messages);
-            if (!message) {
-                continue;
-            }
-            if (!oldest_message ||
-                    g_monotonic_time_100ms - message->timestamp > g_monotonic_time_100ms - oldest_message->timestamp) {
-                oldest_message = message;
-                oldest_seed = seed;
-            }
-        }
+        mpl_buffered_message_t *message = ns_list_get_first(&domain->messages);
+
+        if (message && (!oldest_message || message->timestamp_ms < oldest_message->timestamp_ms))
+            oldest_message = message;
     }
 
     if (!oldest_message) {
-        return;
+        return false;
     }
 
-    mpl_seed_advance_min_sequence(oldest_seed, mpl_buffer_sequence(oldest_message) + 1);
+    mpl_seed_advance_min_sequence(oldest_message->seed, mpl_buffer_sequence(oldest_message) + 1);
+    return true;
+}
+
+static void mpl_domain_gc(struct timer_group *group, struct timer_entry *timer)
+{
+    mpl_domain_t *domain = container_of(timer, mpl_domain_t, timer_gc);
+    const uint64_t message_age_limit_ms = mpl_domain_message_age_limit_ms(domain);
+    const uint64_t now_ms = time_now_ms(CLOCK_MONOTONIC);
+    mpl_buffered_message_t *message;
+
+    /* Once data trickle timer has stopped, we MAY delete a message by
+     * advancing MinSequence. We use timestamp to control this, so we
+     * can hold beyond just the initial data transmission, permitting
+     * it to be restarted by control messages.
+     */
+    message = ns_list_get_first(&domain->messages);
+    while (message && now_ms >= message->timestamp_ms + message_age_limit_ms) {
+        if (mpl_buffer_running(domain, message)) {
+            message = ns_list_get_next(&domain->messages, message);
+            continue;
+        }
+        /*
+         *   RFC 7731 7.4. Buffered Message Set
+         * All MPL Data Messages within a Buffered Message Set MUST have a
+         * sequence number greater than or equal to MinSequence for the
+         * corresponding SeedID. When increasing MinSequence for an MPL Seed,
+         * the MPL Forwarder MUST delete any MPL Data Messages from the
+         * corresponding Buffered Message Set that have sequence numbers less
+         * than MinSequence.
+         */
+        mpl_seed_advance_min_sequence(message->seed, mpl_buffer_sequence(message) + 1);
+        message = ns_list_get_first(&domain->messages);
+    }
+    // Messages still running trigger a new collection when they stop
+    if (message)
+        timer_start_abs(&mpl_timer_group, &domain->timer_gc, message->timestamp_ms + message_age_limit_ms);
+}
+
+static void mpl_buffer_stop(mpl_domain_t *domain, mpl_buffered_message_t *message)
+{
+    const uint64_t expire_ms = message->timestamp_ms + mpl_domain_message_age_limit_ms(domain);
+
+    trickle_stop(&message->trickle);
+    if (timer_stopped(&domain->timer_gc) || domain->timer_gc.expire_ms > expire_ms)
+        timer_start_abs(&mpl_timer_group, &domain->timer_gc, expire_ms);
+}
+
+static void mpl_buffer_transmit(mpl_domain_t *domain, mpl_buffered_message_t *message, bool newest);
+
+static void mpl_buffer_trickle_transmit(struct trickle *tkl)
+{
+    mpl_buffered_message_t *message = container_of(tkl, mpl_buffered_message_t, trickle);
+
+    mpl_buffer_transmit(message->seed->domain, message,
+                        mpl_buffer_sequence(message) == message->seed->max_sequence);
+}
+
+static void mpl_buffer_trickle_interval_done(struct trickle *tkl)
+{
+    mpl_buffered_message_t *message = container_of(tkl, mpl_buffered_message_t, trickle);
+    mpl_domain_t *domain = message->seed->domain;
+
+    message->expirations++;
+    if (!mpl_buffer_running(domain, message))
+        mpl_buffer_stop(domain, message);
 }
 
 
@@ -277,9 +378,12 @@ static mpl_buffered_message_t *mpl_buffer_create(buffer_t *buf, mpl_domain_t *do
     /* IP layer ensures buffer length == IP length */
     uint16_t ip_len = buffer_data_length(buf);
 
-    while (mpl_total_buffered + ip_len > MAX_BUFFERED_MESSAGES_SIZE) {
+    while (mpl_total_buffered + ip_len > mpl_max_buffered) {
         tr_debug("MPL MAX buffered message size limit...free space");
-        mpl_free_space();
+        if (!mpl_free_space()) {
+            tr_debug("MPL message too large for buffer");
+            return NULL;
+        }
     }
 
     /* As we came in, message sequence was >= min_sequence, but mpl_free_space
@@ -298,46 +402,48 @@ static mpl_buffered_message_t *mpl_buffer_create(buffer_t *buf, mpl_domain_t *do
         return NULL;
     }
 
-    mpl_buffered_message_t *message = malloc(sizeof(mpl_buffered_message_t) + ip_len);
-    if (!message) {
-        tr_debug("No heap for new MPL message");
-        return NULL;
-    }
+    mpl_buffered_message_t *message = zalloc(sizeof(mpl_buffered_message_t) + ip_len);
+
     memcpy(message->message, buffer_data_pointer(buf), ip_len);
     message->message[IPV6_HDROFF_HOP_LIMIT] = hop_limit;
     message->mpl_opt_data_offset = buf->mpl_option_data_offset;
     message->colour = seed->colour;
-    message->timestamp = g_monotonic_time_100ms;
-    /* Make sure trickle structure is initialised */
-    trickle_legacy_start(&message->trickle, "MPL MSG", &domain->data_trickle_params);
+    message->timestamp_ms = time_now_ms(CLOCK_MONOTONIC);
+    message->seed = seed;
+
+    if (!seed->count || seqno_cmp8(sequence, seed->max_sequence) > 0)
+        seed->max_sequence = sequence;
+    seed->messages[sequence] = message;
+    seed->count++;
+    ns_list_add_to_end(&domain->messages, message);
+    mpl_total_buffered += ip_len;
+
+    message->trickle.cfg = domain->data_trickle_cfg;
+    message->trickle.on_transmit = mpl_buffer_trickle_transmit;
+    message->trickle.on_interval_done = mpl_buffer_trickle_interval_done;
+    strcpy(message->trickle.debug_name, "mpl");
+    trickle_init(&message->trickle);
 
     if (seeding) {
         // When seeding, the first message is sent immediately
         // Make sure it is only sent TimerExpirations times in this case
-        message->trickle.e = 1;
-    }
-
-    /* Messages held ordered - eg for benefit of mpl_seed_bm_len() */
-    bool inserted = false;
-    ns_list_foreach_reverse(mpl_buffered_message_t, m, &seed->messages) {
-        if (seqno_cmp8(sequence, mpl_buffer_sequence(m)) > 0) {
-            ns_list_add_after(&seed->messages, m, message);
-            inserted = true;
-            break;
-        }
+        message->expirations = 1;
     }
-    if (!inserted) {
-        ns_list_add_to_start(&seed->messages, message);
-    }
-    mpl_total_buffered += ip_len;
+    if (mpl_buffer_running(domain, message))
+        trickle_start(&message->trickle);
+    else
+        mpl_buffer_stop(domain, message);
 
     return message;
 }
 
 static void mpl_buffer_delete(mpl_seed_t *seed, mpl_buffered_message_t *message)
 {
+    trickle_stop(&message->trickle);
     mpl_total_buffered -= mpl_buffer_size(message);
-    ns_list_remove(&seed->messages, message);
+    seed->messages[mpl_buffer_sequence(message)] = NULL;
+    seed->count--;
+    ns_list_remove(&seed->domain->messages, message);
     free(message);
 }
 
@@ -375,7 +481,13 @@ static void mpl_buffer_transmit(mpl_domain_t *domain, mpl_buffered_message_t *me
 
 static void mpl_buffer_inconsistent(const mpl_domain_t *domain, mpl_buffered_message_t *message)
 {
-    trickle_legacy_inconsistent(&message->trickle, &domain->data_trickle_params);
+    if (!mpl_buffer_running(domain, message)) {
+        message->expirations = 0;
+        trickle_reset(&message->trickle);
+    } else if (message->trickle.I_ms > domain->data_trickle_cfg->Imin_ms) {
+        message->expirations = 0;
+        trickle_inconsistent(&message->trickle);
+    }
 }
 
 static uint8_t mpl_seed_id_len(uint8_t seed_id_type)
@@ -494,11 +606,12 @@ bool mpl_forwarder_process_message(buffer_t *buf, mpl_domain_t *domain, bool see
     }
 
     /* If the M flag is set, we report an inconsistency against any messages with higher sequences */
-    if ((opt_data[0] & MPL_OPT_M)) {
-        ns_list_foreach(mpl_buffered_message_t, message, &seed->messages) {
-            if (seqno_cmp8(mpl_buffer_sequence(message), sequence) > 0) {
-                mpl_buffer_inconsistent(domain, message);
-            }
+    if ((opt_data[0] & MPL_OPT_M) && seed->count) {
+        for (uint8_t i = seed->max_sequence; seqno_cmp8(i, sequence) > 0; i--) {
+            if (seqno_cmp8(seed->min_sequence, i) > 0)
+                break;
+            if (seed->messages[i])
+                mpl_buffer_inconsistent(domain, seed->messages[i]);
         }
     }
 
@@ -511,18 +624,18 @@ bool mpl_forwarder_process_message(buffer_t *buf, mpl_domain_t *domain, bool see
     mpl_buffered_message_t *message = mpl_buffer_lookup(seed, sequence);
     if (message) {
         tr_debug("Repeated MPL message %"PRIu8, sequence);
-        trickle_legacy_consistent(&message->trickle);
+        trickle_consistent(&message->trickle);
         return false;
     }
 
-    seed->lifetime = domain->seed_set_entry_lifetime;
+    timer_start_rel(&mpl_timer_group, &seed->timer_lifetime, domain->seed_set_entry_lifetime * 1000);
 
     uint8_t hop_limit = buffer_data_pointer(buf)[IPV6_HDROFF_HOP_LIMIT];
     if (!seeding && hop_limit != 0) {
         hop_limit--;
     }
 
-    if (domain->data_trickle_params.TimerExpirations == 0 || hop_limit == 0) {
+    if (domain->data_timer_expirations == 0 || hop_limit == 0) {
         /* As a non-forwarder, just accept the packet and advance the
          * min_sequence - means we will drop anything arriving out-of-order, but
          * old implementation always did this in all cases anyway (even if
@@ -546,48 +659,6 @@ bool mpl_forwarder_process_message(buffer_t *buf, mpl_domain_t *domain, bool see
     return true;
 }
 
-void mpl_timer(int seconds)
-{
-    ns_list_foreach(mpl_domain_t, domain, &mpl_domains) {
-        uint32_t message_age_limit = (domain->seed_set_entry_lifetime * UINT32_C(10)) / 4;
-        if (message_age_limit > MAX_BUFFERED_MESSAGE_LIFETIME) {
-            message_age_limit = MAX_BUFFERED_MESSAGE_LIFETIME;
-        }
-        ns_list_foreach_safe(mpl_seed_t, seed, &domain->seeds) {
-            /* Count down seed lifetime, and expire immediately when hit */
-            if (seed->lifetime > seconds) {
-                seed->lifetime -= seconds;
-            } else {
-                mpl_seed_delete(domain, seed);
-                continue;
-            }
-            /* Once data trickle timer has stopped, we MAY delete a message by
-             * advancing MinSequence. We use timestamp to control this, so we
-             * can hold beyond just the initial data transmission, permitting
-             * it to be restarted by control messages.
-             */
-            ns_list_foreach_safe(mpl_buffered_message_t, message, &seed->messages) {
-                if (!trickle_legacy_running(&message->trickle, &domain->data_trickle_params) &&
-                        g_monotonic_time_100ms - message->timestamp >= message_age_limit) {
-                    /*
-                     *   RFC 7731 7.4. Buffered Message Set
-                     * All MPL Data Messages within a Buffered Message Set MUST have a
-                     * sequence number greater than or equal to MinSequence for the
-                     * corresponding SeedID. When increasing MinSequence for an MPL Seed,
-                     * the MPL Forwarder MUST delete any MPL Data Messages from the
-                     * corresponding Buffered Message Set that have sequence numbers less
-                     * than MinSequence.
-                     */
-                    mpl_seed_advance_min_sequence(seed, mpl_buffer_sequence(message) + 1);
-                    continue;
-                }
-                if (trickle_legacy_tick(&message->trickle, &domain->data_trickle_params, seconds))
-                    mpl_buffer_transmit(domain, message, ns_list_get_next(&seed->messages, message) == NULL);
-            }
-        }
-    }
-}
-
 static buffer_t *mpl_exthdr_provider(buffer_t *buf, ipv6_exthdr_stage_e stage, int16_t *result)
 {
     mpl_domain_t *domain = mpl_domain_lookup_with_realm_check(buf->interface, buf->dst_sa.address);
@@ -20,11 +20,10 @@
 #define MPL_H_
 #include <stdint.h>
 #include <stdbool.h>
-
-#include <stdint.h>
+#include <stddef.h>
 
 struct net_if;
-struct trickle_legacy_params;
+struct trickle_cfg;
 typedef struct buffer buffer_t;
 
 // RFC 7731 6.1. MPL Option
@@ -41,12 +40,14 @@ bool mpl_process_hbh(buffer_t *buf, struct net_if *cur, uint8_t *opt_data);
 
 bool mpl_forwarder_process_message(buffer_t *buf, mpl_domain_t *domain, bool decrement_hop_limit);
 
-void mpl_timer(int seconds);
+// Total amount of memory used to buffer data messages across all domains
+void mpl_set_buffer_size(size_t size);
 
-/* Time units for trickle parameters is 50 ms (1/20 s) ticks */
+// The trickle configuration is referenced, not copied.
 mpl_domain_t *mpl_domain_create(struct net_if *cur, const uint8_t address[16],
                                 uint16_t seed_set_entry_lifetime, uint8_t seed_id_mode,
-                                const struct trickle_legacy_params *data_trickle_params);
+                                const struct trickle_cfg *data_trickle_cfg,
+                                uint8_t data_timer_expirations);
 mpl_domain_t *mpl_domain_lookup(struct net_if *cur, const uint8_t address[16]);
 
 #endif
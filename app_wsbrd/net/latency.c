@@ -0,0 +1,103 @@
+/*
+ * SPDX-License-Identifier: LicenseRef-MSLA
+ * Copyright (c) 2025 Silicon Laboratories Inc. (www.silabs.com)
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of the Silicon Labs Master Software License
+ * Agreement (MSLA) available at [1].  This software is distributed to you in
+ * Object Code format and/or Source Code format and is governed by the sections
+ * of the MSLA applicable to Object Code, Source Code and Modified Open Source
+ * Code. By using this software, you agree to the terms of the MSLA.
+ *
+ * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
+ */
+#include <inttypes.h>
+#include <stdio.h>
+#include <errno.h>
+
+#include "common/named_values.h"
+#include "common/memutils.h"
+#include "common/log.h"
+
+#include "latency.h"
+
+struct latency_ctx g_latency = { };
+
+static const struct name_value latency_stage_names[] = {
+    { "tx-ipv6-fwd",  LATENCY_TX_IPV6_FWD },
+    { "tx-rpl-srh",   LATENCY_TX_RPL_SRH },
+    { "tx-iphc",      LATENCY_TX_IPHC },
+    { "tx-frag",      LATENCY_TX_FRAG },
+    { "tx-llc-queue", LATENCY_TX_LLC_QUEUE },
+    { "tx-hif",       LATENCY_TX_HIF },
+    { "tx-cnf",       LATENCY_TX_CNF },
+    { "tx-total",     LATENCY_TX_TOTAL },
+    { "rx-6lowpan",   LATENCY_RX_LOWPAN },
+    { "rx-ipv6-fwd",  LATENCY_RX_IPV6_FWD },
+    { "rx-tun",       LATENCY_RX_TUN },
+    { "rx-total",     LATENCY_RX_TOTAL },
+    { NULL },
+};
+
+const char *latency_stage_str(enum latency_stage stage)
+{
+    return val_to_str(stage, latency_stage_names, "unknown");
+}
+
+void __latency_checkpoint(struct latency_tstamp *ts, enum latency_stage stage)
+{
+    uint64_t now_us;
+
+    if (ts->rx != (stage > LATENCY_TX_TOTAL))
+        return;
+    now_us = time_now_us(CLOCK_MONOTONIC);
+    histogram_add(&g_latency.hist[stage], now_us - ts->prev_us);
+    ts->prev_us = now_us;
+}
+
+void __latency_end(struct latency_tstamp *ts, enum latency_stage stage, enum latency_stage total)
+{
+    if (ts->rx != (stage > LATENCY_TX_TOTAL))
+        return;
+    __latency_checkpoint(ts, stage);
+    histogram_add(&g_latency.hist[total], ts->prev_us - ts->start_us);
+    ts->start_us = 0;
+}
+
+int latency_dump(const char *path)
+{
+    const struct histogram *hist;
+    FILE *stream;
+
+    stream = fopen(path, "w");
+    if (!stream) {
+        WARN("fopen %s: %m", path);
+        return -errno;
+    }
+    fprintf(stream, "# stage count p50 p99 p999 max (us)\n");
+    for (int i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        hist = &g_latency.hist[i];
+        fprintf(stream, "%s %"PRIu64" %"PRIu64" %"PRIu64" %"PRIu64" %"PRIu64"\n",
+                latency_stage_str(i), hist->count,
+                histogram_quantile(hist, 0.5),
+                histogram_quantile(hist, 0.99),
+                histogram_quantile(hist, 0.999),
+                hist->max);
+    }
+    hist = &g_latency.event_queue_depth;
+    fprintf(stream, "\n# event queue depth: count p50 p99 p999 max\n");
+    fprintf(stream, "event-queue %"PRIu64" %"PRIu64" %"PRIu64" %"PRIu64" %"PRIu64"\n",
+            hist->count,
+            histogram_quantile(hist, 0.5),
+            histogram_quantile(hist, 0.99),
+            histogram_quantile(hist, 0.999),
+            hist->max);
+    for (int i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        fprintf(stream, "\n# %s: low high count (us)\n", latency_stage_str(i));
+        histogram_dump(&g_latency.hist[i], stream);
+    }
+    fprintf(stream, "\n# event-queue: low high count\n");
+    histogram_dump(&g_latency.event_queue_depth, stream);
+    fclose(stream);
+    return 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * SPDX-License-Identifier: LicenseRef-MSLA
+ * Copyright (c) 2025 Silicon Laboratories Inc. (www.silabs.com)
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of the Silicon Labs Master Software License
+ * Agreement (MSLA) available at [1].  This software is distributed to you in
+ * Object Code format and/or Source Code format and is governed by the sections
+ * of the MSLA applicable to Object Code, Source Code and Modified Open Source
+ * Code. By using this software, you agree to the terms of the MSLA.
+ *
+ * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
+ */
+#ifndef NET_LATENCY_H
+#define NET_LATENCY_H
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "common/histogram.h"
+#include "common/time_extra.h"
+
+/*
+ * Per-stage packet latency measurement. Each buffer_t carries the time of its
+ * first and of its previous checkpoint. When a packet reaches a checkpoint,
+ * the time elapsed since the previous one is added to the histogram of the
+ * stage. Checkpoints which are not crossed (ie. no SRH for multicast packets)
+ * are accounted in the next stage. Received packets forwarded back to the
+ * radio are not measured on their way down.
+ *
+ * When disabled, a checkpoint costs a single test of a global variable.
+ *
+ * The depth of the event scheduler queue is also sampled on each posted event,
+ * since events waiting in the queue delay every other processing.
+ */
+
+enum latency_stage {
+    // Downward, from TUN to RCP
+    LATENCY_TX_IPV6_FWD,  // TUN read to IPv6 forwarding
+    LATENCY_TX_RPL_SRH,   // IPv6 forwarding to RPL Source Routing Header insertion
+    LATENCY_TX_IPHC,      // To 6LoWPAN header compression
+    LATENCY_TX_FRAG,      // To the adaptation layer (fragmenter)
+    LATENCY_TX_LLC_QUEUE, // Waiting in the adaptation layer queue
+    LATENCY_TX_HIF,       // LLC processing until the HIF request is sent
+    LATENCY_TX_CNF,       // Waiting for the RCP confirmation
+    LATENCY_TX_TOTAL,
+    // Upward, from RCP to TUN
+    LATENCY_RX_LOWPAN,    // RCP indication to 6LoWPAN decompression
+    LATENCY_RX_IPV6_FWD,  // To IPv6 forwarding
+    LATENCY_RX_TUN,       // To TUN write
+    LATENCY_RX_TOTAL,
+    LATENCY_STAGE_COUNT,
+};
+
+struct latency_tstamp {
+    uint64_t start_us;
+    uint64_t prev_us;
+    bool rx;
+};
+
+struct latency_ctx {
+    bool enabled;
+    uint64_t rx_ind_us; // Time of the RCP indication being processed
+    struct histogram hist[LATENCY_STAGE_COUNT];
+    struct histogram event_queue_depth;
+};
+
+extern struct latency_ctx g_latency;
+
+const char *latency_stage_str(enum latency_stage stage);
+
+void __latency_checkpoint(struct latency_tstamp *ts, enum latency_stage stage);
+void __latency_end(struct latency_tstamp *ts, enum latency_stage stage, enum latency_stage total);
+
+// Write all the histograms in a file
+int latency_dump(const char *path);
+
+static inline void latency_start(struct latency_tstamp *ts)
+{
+    if (!g_latency.enabled)
+        return;
+    ts->start_us = time_now_us(CLOCK_MONOTONIC);
+    ts->prev_us  = ts->start_us;
+    ts->rx       = false;
+}
+
+// Use the time recorded on RCP indication as start time
+static inline void latency_start_rx(struct latency_tstamp *ts)
+{
+    if (!g_latency.enabled)
+        return;
+    ts->start_us = g_latency.rx_ind_us;
+    ts->prev_us  = ts->start_us;
+    ts->rx       = true;
+}
+
+static inline void latency_checkpoint(struct latency_tstamp *ts, enum latency_stage stage)
+{
+    if (!g_latency.enabled || !ts->start_us)
+        return;
+    __latency_checkpoint(ts, stage);
+}
+
+static inline void latency_end(struct latency_tstamp *ts, enum latency_stage stage, enum latency_stage total)
+{
+    if (!g_latency.enabled || !ts->start_us)
+        return;
+    __latency_end(ts, stage, total);
+}
+
+#endif
@@ -36,6 +36,7 @@
 #include "common/ns_list.h"
 
 #include "net/netaddr_types.h"
+#include "net/latency.h"
 #include "ipv6/ipv6_routing_table.h"
 
 #ifndef BUFFERS_MAX
@@ -176,6 +177,8 @@ typedef struct buffer {
     uint16_t            offset;                 /*!< Offset indicator (used in some upward paths) */
     bool                ip_routed_up: 1;
     uint32_t            adaptation_timestamp;   /*!< Timestamp when buffer pushed to adaptation interface. Unit 100ms */
+    uint64_t            adaptation_queue_us;    /*!< Same as adaptation_timestamp, used for the CoDel sojourn time (CLOCK_MONOTONIC) */
+    struct latency_tstamp latency;
     buffer_link_info_t  link_specific;
     uint16_t            mpl_option_data_offset;
     buffer_options_t    options;                /*!< Additional signal info etc */
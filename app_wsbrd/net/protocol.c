@@ -85,7 +85,6 @@ void update_reachable_time(int seconds)
 void protocol_core_init(void)
 {
     ws_timer_start(WS_TIMER_MONOTONIC_TIME);
-    ws_timer_start(WS_TIMER_MPL);
     ws_timer_start(WS_TIMER_PAE_FAST);
     ws_timer_start(WS_TIMER_PAE_SLOW);
     ws_timer_start(WS_TIMER_IPV6_DESTINATION);
@@ -97,11 +96,9 @@ void protocol_core_init(void)
     ws_timer_start(WS_TIMER_6LOWPAN_ND);
     ws_timer_start(WS_TIMER_6LOWPAN_ADAPTATION);
     ws_timer_start(WS_TIMER_6LOWPAN_NEIGHBOR_SLOW);
-    ws_timer_start(WS_TIMER_6LOWPAN_NEIGHBOR_FAST);
     ws_timer_start(WS_TIMER_6LOWPAN_CONTEXT);
     ws_timer_start(WS_TIMER_6LOWPAN_REACHABLE_TIME);
     ws_timer_start(WS_TIMER_WS_COMMON_FAST);
-    ws_timer_start(WS_TIMER_ASYNC);
 }
 
 static void protocol_set_eui64(struct net_if *cur, uint8_t eui64[8])
@@ -135,8 +132,8 @@ void protocol_init(struct net_if *entry, struct rcp *rcp, int mtu)
     ns_list_link_init(entry, link);
     ns_list_init(&entry->ip_addresses);
     ns_list_init(&entry->ip_groups);
-    ns_list_init(&entry->ipv6_neighbour_cache.list);
     ipv6_neighbour_cache_init(&entry->ipv6_neighbour_cache, entry->id);
+    ipv6_destination_cache_init();
     protocol_set_eui64(entry, rcp->eui64.u8);
     ns_list_add_to_start(&protocol_interface_info_list, entry);
 }
@@ -18,7 +18,7 @@
 #ifndef _NS_PROTOCOL_H
 #define _NS_PROTOCOL_H
 #include "common/random_early_detection.h"
-#include "common/trickle_legacy.h"
+#include "common/codel.h"
 #include "common/ns_list.h"
 
 #include "net/protocol_abstract.h"
@@ -59,6 +59,7 @@ struct net_if {
     uint8_t iid_slaac[8];
 
     struct red_config random_early_detection;
+    struct codel_cfg adaptation_codel;
     struct red_config llc_random_early_detection;
     struct red_config llc_eapol_random_early_detection;
     struct red_config pae_random_early_detection;
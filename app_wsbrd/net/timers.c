@@ -20,8 +20,6 @@
 #include "ws/ws_pae_controller.h"
 #include "ipv6/ipv6_routing_table.h"
 #include "net/protocol.h"
-#include "mpl/mpl.h"
-#include "rpl/rpl.h"
 #include "common/memutils.h"
 #include "common/log.h"
 
@@ -40,27 +38,17 @@ static void timer_send_lpa(int time_update)
     ws_mngt_lpa_send(&interface->ws_info, interface->ws_info.mngt.lpa_dst);
 }
 
-static void timer_update_async(int time_update)
-{
-    struct net_if *interface = protocol_stack_interface_info_get();
-    ws_mngt_async_trickle_timer_cb(&interface->ws_info, time_update);
-}
-
 #define timer_entry(name, callback, period_ms, is_periodic) \
     [WS_TIMER_##name] = { #name, callback, period_ms, is_periodic, 0 }
 struct ws_timer g_timers[] = {
     timer_entry(MONOTONIC_TIME,         timer_update_monotonic_time,                100,                     true),
-    timer_entry(MPL,                    mpl_timer,                                  1000,                    true),
-    timer_entry(RPL,                    rpl_timer,                                  1000,                    true),
     timer_entry(IPV6_DESTINATION,       ipv6_destination_cache_timer,               DCACHE_GC_PERIOD * 1000, true),
     timer_entry(IPV6_ROUTE,             ipv6_route_table_ttl_update,                1000,                    true),
     timer_entry(CIPV6_FRAG,             cipv6_frag_timer,                           1000,                    true),
     timer_entry(ICMP_FAST,              icmp_fast_timer,                            100,                     true),
     timer_entry(PAE_FAST,               ws_pae_controller_fast_timer,               100,                     true),
     timer_entry(PAE_SLOW,               ws_pae_controller_slow_timer,               1000,                    true),
-    timer_entry(ASYNC,                  timer_update_async,                         1000,                    true),
     timer_entry(6LOWPAN_NEIGHBOR_SLOW,  ipv6_neighbour_cache_slow_timer,            1000,                    true),
-    timer_entry(6LOWPAN_NEIGHBOR_FAST,  ipv6_neighbour_cache_fast_timer,            100,                     true),
     timer_entry(6LOWPAN_REACHABLE_TIME, update_reachable_time,                      1000,                    true),
     timer_entry(LPA,                    timer_send_lpa,                             0,                       false),
 };
@@ -23,8 +23,6 @@ struct timer_group;
 
 enum timer_id {
     WS_TIMER_MONOTONIC_TIME,
-    WS_TIMER_MPL,
-    WS_TIMER_RPL,
     WS_TIMER_IPV6_DESTINATION,
     WS_TIMER_IPV6_ROUTE,
     WS_TIMER_CIPV6_FRAG,
@@ -34,11 +32,9 @@ enum timer_id {
     WS_TIMER_6LOWPAN_ND,
     WS_TIMER_6LOWPAN_ADAPTATION,
     WS_TIMER_6LOWPAN_NEIGHBOR_SLOW,
-    WS_TIMER_6LOWPAN_NEIGHBOR_FAST,
     WS_TIMER_6LOWPAN_CONTEXT,
     WS_TIMER_6LOWPAN_REACHABLE_TIME,
     WS_TIMER_WS_COMMON_FAST,
-    WS_TIMER_ASYNC,
     WS_TIMER_PAE_FAST, // HAVE_AUTH_LEGACY only
     WS_TIMER_PAE_SLOW, // HAVE_AUTH_LEGACY only
     WS_TIMER_DHCPV6_SOCKET,
@@ -16,8 +16,6 @@
 #include <netinet/icmp6.h>
 #include <netinet/in.h>
 
-#include "net/timers.h"
-#include "app/wsbrd.h" // FIXME
 #include "common/bits.h"
 #include "common/capture.h"
 #include "common/iobuf.h"
@@ -31,6 +29,7 @@
 #include "common/specs/icmpv6.h"
 #include "common/specs/rpl.h"
 #include "rpl_lollipop.h"
+#include "rpl_srh.h"
 #include "rpl.h"
 
 const uint8_t rpl_all_nodes[16] = { // ff02::1a
@@ -94,6 +93,28 @@ struct rpl_transit *rpl_transit_preferred(struct rpl_root *root, struct rpl_targ
     return NULL;
 }
 
+int rpl_target_depth(struct rpl_root *root, const uint8_t prefix[16])
+{
+    struct rpl_transit *transit;
+    struct rpl_target *target;
+    const uint8_t *nxthop;
+
+    // Same walk as rpl_srh_build(), without the traces
+    nxthop = prefix;
+    for (int depth = 0; depth <= WS_RPL_SRH_MAXSEG; depth++) {
+        target = rpl_target_get(root, nxthop);
+        if (!target || target->external)
+            return -1;
+        transit = rpl_transit_preferred(root, target);
+        if (!transit)
+            return -1;
+        if (!memcmp(transit->parent, root->dodag_id, 16))
+            return depth;
+        nxthop = transit->parent;
+    }
+    return -1;
+}
+
 static void rpl_transit_update_timer(struct rpl_root *root, struct rpl_target *target)
 {
     uint64_t expire_s = UINT64_MAX;
@@ -132,40 +153,21 @@ static void rpl_transit_expire(struct timer_group *group, struct timer_entry *ti
     }
 }
 
-static void rpl_dio_trickle_params(struct rpl_root *root, struct trickle_legacy_params *params)
-{
-    memset(params, 0, sizeof(struct trickle_legacy_params));
-    //   RFC 6550 - 8.3.1. Trickle Parameters
-    // Imin: learned from the DIO message as (2^DIOIntervalMin) ms.
-    params->Imin = roundup(POW2(root->dio_i_min),
-                           g_timers[WS_TIMER_RPL].period_ms) / g_timers[WS_TIMER_RPL].period_ms;
-    params->Imax = roundup(POW2(root->dio_i_min + root->dio_i_doublings),
-                           g_timers[WS_TIMER_RPL].period_ms) / g_timers[WS_TIMER_RPL].period_ms;
-    params->k    = root->dio_redundancy;
-    params->TimerExpirations = TRICKLE_EXPIRATIONS_INFINITE;
-}
-
 void rpl_dodag_version_inc(struct rpl_root *root)
 {
-    struct trickle_legacy_params dio_trickle_params;
-
     root->dodag_version_number = rpl_lollipop_inc(root->dodag_version_number);
     //   RFC 6550 - 8.3. DIO Transmission
     // The following packets and events MUST be considered inconsistencies with
     // respect to the Trickle timer, and cause the Trickle timer to reset:
     // - When a node joins a new DODAG Version (e.g., by updating its
     //   DODAGVersionNumber, joining a new RPL Instance, etc.).
-    rpl_dio_trickle_params(root, &dio_trickle_params);
-    trickle_legacy_inconsistent(&root->dio_trickle, &dio_trickle_params);
+    trickle_inconsistent(&root->dio_trickle);
 }
 
 void rpl_dtsn_inc(struct rpl_root *root)
 {
-    struct trickle_legacy_params dio_trickle_params;
-
     root->dtsn++;
-    rpl_dio_trickle_params(root, &dio_trickle_params);
-    trickle_legacy_inconsistent(&root->dio_trickle, &dio_trickle_params);
+    trickle_inconsistent(&root->dio_trickle);
 }
 
 // RFC 6550 - 6.7.1. RPL Control Message Option Generic Format
@@ -303,6 +305,13 @@ static void rpl_send_dio(struct rpl_root *root, const uint8_t dst[16])
     iobuf_free(&buf);
 }
 
+static void rpl_dio_trickle_transmit(struct trickle *tkl)
+{
+    struct rpl_root *root = container_of(tkl, struct rpl_root, dio_trickle);
+
+    rpl_send_dio(root, rpl_all_nodes);
+}
+
 static void rpl_send_dao_ack(struct rpl_root *root, const uint8_t dst[16], uint8_t dao_seq)
 {
     struct iobuf_write buf = { };
@@ -341,7 +350,6 @@ static bool rpl_opt_solicit_matches(struct iobuf_read *opt_buf, struct rpl_root
 static void rpl_recv_dis(struct rpl_root *root, const uint8_t *pkt, size_t size,
                          const uint8_t src[16], const uint8_t dst[16])
 {
-    struct trickle_legacy_params dio_trickle_params;
     struct iobuf_read opt_buf;
     struct iobuf_read buf = {
         .data_size = size,
@@ -380,12 +388,10 @@ static void rpl_recv_dis(struct rpl_root *root, const uint8_t *pkt, size_t size,
         return;
     }
     // RFC 6550 - 8.3. DIO Transmission
-    if (IN6_IS_ADDR_MULTICAST(dst)) {
-        rpl_dio_trickle_params(root, &dio_trickle_params);
-        trickle_legacy_inconsistent(&root->dio_trickle, &dio_trickle_params);
-    } else {
+    if (IN6_IS_ADDR_MULTICAST(dst))
+        trickle_inconsistent(&root->dio_trickle);
+    else
         rpl_send_dio(root, src);
-    }
 }
 
 static void rpl_transit_update(struct rpl_root *root,
@@ -699,7 +705,6 @@ void rpl_recv(struct rpl_root *root)
 void rpl_start(struct rpl_root *root,
                const char ifname[IF_NAMESIZE])
 {
-    struct trickle_legacy_params dio_trickle_params;
     struct icmp6_filter filter;
     struct rpl_target *target;
     int err;
@@ -729,20 +734,17 @@ void rpl_start(struct rpl_root *root,
     err = setsockopt(root->sockfd, IPPROTO_ICMPV6, ICMP6_FILTER, &filter, sizeof(filter));
     FATAL_ON(err < 0, 2, "%s: setsockopt ICMP6_FILTER: %m", __func__);
 
-    rpl_dio_trickle_params(root, &dio_trickle_params);
-    trickle_legacy_start(&root->dio_trickle, "RPL DIO", &dio_trickle_params);
+    //   RFC 6550 - 8.3.1. Trickle Parameters
+    // Imin: learned from the DIO message as (2^DIOIntervalMin) ms.
+    root->dio_trickle_cfg.Imin_ms = POW2(root->dio_i_min);
+    root->dio_trickle_cfg.Imax_ms = TRICKLE_DOUBLINGS(root->dio_trickle_cfg.Imin_ms, root->dio_i_doublings);
+    root->dio_trickle_cfg.k       = root->dio_redundancy;
+    root->dio_trickle.cfg = &root->dio_trickle_cfg;
+    root->dio_trickle.on_transmit = rpl_dio_trickle_transmit;
+    strcpy(root->dio_trickle.debug_name, "dio");
+    trickle_init(&root->dio_trickle);
+    trickle_start(&root->dio_trickle);
     timer_group_init(&root->timer_group);
     SLIST_FOREACH(target, &root->targets, link)
         rpl_transit_update_timer(root, target);
-    ws_timer_start(WS_TIMER_RPL);
-}
-
-void rpl_timer(int ticks)
-{
-    struct trickle_legacy_params dio_trickle_params;
-    struct rpl_root *root = &g_ctxt.net_if.rpl_root;
-
-    rpl_dio_trickle_params(root, &dio_trickle_params);
-    if (trickle_legacy_tick(&root->dio_trickle, &dio_trickle_params, ticks))
-        rpl_send_dio(root, rpl_all_nodes);
 }
@@ -20,7 +20,7 @@
 #include <stdint.h>
 
 #include "common/timer.h"
-#include "common/trickle_legacy.h"
+#include "common/trickle.h"
 
 /*
  * Implementation of a RPL non-storing root for a Linux host.
@@ -36,8 +36,7 @@
  *
  * Once started, the caller has to poll (with poll() or equivalent)
  * rpl_root->sockfd for any incoming packets, and call rpl_recv() when ready.
- * Additionally rpl_timer() must be setup as a timer callback with the timer ID
- * WS_TIMER_RPL in order to run the trickle algorithm for DIO packets.
+ * DIO packets are sent by a trickle timer running on the default timer group.
  *
  * Some information are stored to disk using rpl_storage.h. They can be restored on
  * reboot by calling rpl_storage_load() before rpl_start().
@@ -96,7 +95,8 @@ SLIST_HEAD(rpl_target_list, rpl_target);
 struct rpl_root {
     int sockfd;
 
-    struct trickle_legacy dio_trickle;
+    struct trickle_cfg dio_trickle_cfg;
+    struct trickle dio_trickle;
     uint8_t dio_i_doublings;
     uint8_t dio_i_min;
     uint8_t dio_redundancy;
@@ -131,7 +131,6 @@ struct rpl_root {
 void rpl_start(struct rpl_root *root,
                const char ifname[IF_NAMESIZE]);
 void rpl_recv(struct rpl_root *root);
-void rpl_timer(int ticks);
 
 void rpl_dodag_version_inc(struct rpl_root *root);
 void rpl_dtsn_inc(struct rpl_root *root);
@@ -141,6 +140,9 @@ struct rpl_target *rpl_target_new(struct rpl_root *root, const uint8_t prefix[16
 void rpl_target_del(struct rpl_root *root, struct rpl_target *target);
 uint16_t rpl_target_count(struct rpl_root *root);
 struct rpl_transit *rpl_transit_preferred(struct rpl_root *root, struct rpl_target *target);
+// Number of intermediate nodes between the root and a target, or -1 if there
+// is no route.
+int rpl_target_depth(struct rpl_root *root, const uint8_t prefix[16]);
 
 static inline uint16_t rpl_dag_rank(const struct rpl_root *root, uint16_t rank)
 {
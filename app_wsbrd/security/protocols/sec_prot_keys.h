@@ -117,6 +117,7 @@ typedef struct sec_prot_keys {
 typedef struct frame_counter {
     uint8_t gtk[GTK_LEN];                             /**< GTK of the frame counter */
     uint32_t frame_counter;                           /**< Current frame counter */
+    uint32_t stored_frame_counter;                    /**< Frame counter value in storage */
     bool set : 1;                                     /**< Value has been set */
 } frame_counter_t;
 
@@ -26,7 +26,6 @@
 #include "common/dbus.h"
 #include "common/log.h"
 #include "common/rand.h"
-#include "common/trickle_legacy.h"
 #include "common/log_legacy.h"
 #include "common/endian.h"
 #include "common/mathutils.h"
@@ -132,7 +131,7 @@ void ws_bootstrap_neighbor_add_cb(struct ws_neigh_table *table, struct ws_neigh
     struct net_if *net_if = container_of(table, struct net_if, ws_info.neighbor_storage);
     struct ipv6_neighbour *ipv6_neighbor;
 
-    if (ws_neigh->node_role == WS_NR_ROLE_LFN && timer_stopped(&net_if->ws_info.mngt.lts_timer))
+    if (ws_neigh_hot(table, ws_neigh)->node_role == WS_NR_ROLE_LFN && timer_stopped(&net_if->ws_info.mngt.lts_timer))
         timer_start_rel(NULL, &net_if->ws_info.mngt.lts_timer,
                         net_if->ws_info.mngt.lts_timer.period_ms);
 
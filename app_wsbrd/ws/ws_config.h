@@ -36,6 +36,8 @@
  * MAC frame counter NVM storing configuration
  */
 #define FRAME_COUNTER_INCREMENT             1000000     // How much frame counter is incremented on start up
+#define FRAME_COUNTER_STORE_THRESHOLD       100000      // Frame counter progress which triggers a new store
+#define NW_INFO_STORE_DELAY                 5           // Seconds to coalesce network info updates before storing
 
 /*
  * Candidate parent list parameters
@@ -157,7 +157,7 @@ static uint8_t ws_llc_get_node_role(struct net_if *interface, const uint8_t eui6
 
     neigh = ws_neigh_get(&interface->ws_info.neighbor_storage,
                          &EUI64_FROM_BUF(eui64));
-    return neigh ? neigh->node_role : WS_NR_ROLE_UNKNOWN;
+    return neigh ? ws_neigh_hot(&interface->ws_info.neighbor_storage, neigh)->node_role : WS_NR_ROLE_UNKNOWN;
 }
 
 /** Discover Message by message handle id */
@@ -279,7 +279,8 @@ static void ws_llc_eapol_confirm(struct llc_data_base *base, struct llc_message
     base->temp_entries.active_eapol_session = false;
     if (ws_neigh) {
         if (confirm->hif.status == HIF_STATUS_SUCCESS)
-            ws_neigh_refresh(&base->interface_ptr->ws_info.neighbor_storage, ws_neigh, ws_neigh->lifetime_s);
+            ws_neigh_refresh(&base->interface_ptr->ws_info.neighbor_storage, ws_neigh,
+                             ws_neigh_hot(&base->interface_ptr->ws_info.neighbor_storage, ws_neigh)->lifetime_s);
         if (ws_wh_utt_read(confirm_data->headerIeList, confirm_data->headerIeListLength, &ie_utt))
             ws_neigh_ut_update(&ws_neigh->fhss_data_unsecured, ie_utt.ufsi, confirm->hif.timestamp_us, &ws_neigh->eui64);
     }
@@ -390,13 +391,15 @@ static void ws_llc_data_confirm(struct llc_data_base *base, struct llc_message *
                 break;
             if (ws_wh_utt_read(confirm_data->headerIeList, confirm_data->headerIeListLength, &ie_utt)) {
                 if (confirm->hif.status == HIF_STATUS_SUCCESS)
-                    ws_neigh_refresh(&ws_info->neighbor_storage, ws_neigh, ws_neigh->lifetime_s);
+                    ws_neigh_refresh(&ws_info->neighbor_storage, ws_neigh,
+                                     ws_neigh_hot(&ws_info->neighbor_storage, ws_neigh)->lifetime_s);
                 ws_neigh_ut_update(&ws_neigh->fhss_data, ie_utt.ufsi, confirm->hif.timestamp_us, &ws_neigh->eui64);
                 ws_neigh_ut_update(&ws_neigh->fhss_data_unsecured, ie_utt.ufsi, confirm->hif.timestamp_us, &ws_neigh->eui64);
             }
             if (ws_wh_lutt_read(confirm_data->headerIeList, confirm_data->headerIeListLength, &ie_lutt))
                 if (confirm->hif.status == HIF_STATUS_SUCCESS)
-                    ws_neigh_refresh(&ws_info->neighbor_storage, ws_neigh, ws_neigh->lifetime_s);
+                    ws_neigh_refresh(&ws_info->neighbor_storage, ws_neigh,
+                                     ws_neigh_hot(&ws_info->neighbor_storage, ws_neigh)->lifetime_s);
             if (ws_wh_rsl_read(confirm_data->headerIeList, confirm_data->headerIeListLength, &ie_rsl)) {
                 ws_neigh->rsl_out_dbm = ws_neigh_ewma_next(ws_neigh->rsl_out_dbm, ie_rsl, WS_EWMA_SF);
                 rate = ws_llc_success_rate(msg->rate_list, confirm->hif.tx_retries + 1);
@@ -416,12 +419,12 @@ static void ws_llc_data_confirm(struct llc_data_base *base, struct llc_message *
     }
 }
 
-static bool tx_confirm_extensive(struct ws_neigh *ws_neigh, time_t tx_confirm_duration)
+static bool tx_confirm_extensive(struct ws_neigh_table *table, struct ws_neigh *ws_neigh, time_t tx_confirm_duration)
 {
     if (!ws_neigh)
         return false;
 
-    if (ws_neigh->node_role == WS_NR_ROLE_LFN) {
+    if (ws_neigh_hot(table, ws_neigh)->node_role == WS_NR_ROLE_LFN) {
         if (ws_neigh->fhss_data.lfn.uc_listen_interval_ms)
             return tx_confirm_duration * 1000 >= ws_neigh->fhss_data.lfn.uc_listen_interval_ms * TX_CONFIRM_EXTENSIVE_LFN_MULTIPLIER;
         else
@@ -477,12 +480,12 @@ void ws_llc_mac_confirm_cb(struct net_if *net_if, const mcps_data_cnf_t *data,
 
     switch (msg->message_type) {
     case WS_FT_DATA:
-        if (tx_confirm_extensive(ws_neigh, tx_confirm_duration))
+        if (tx_confirm_extensive(&base->interface_ptr->ws_info.neighbor_storage, ws_neigh, tx_confirm_duration))
             WARN("frame spent %"PRIu64" sec in MAC", (uint64_t)tx_confirm_duration);
         ws_llc_data_confirm(base, msg, &data_cpy, conf_data, ws_neigh);
         break;
     case WS_FT_EAPOL:
-        if (tx_confirm_extensive(ws_neigh, tx_confirm_duration))
+        if (tx_confirm_extensive(&base->interface_ptr->ws_info.neighbor_storage, ws_neigh, tx_confirm_duration))
             WARN("frame spent %"PRIu64" sec in MAC", (uint64_t)tx_confirm_duration);
         ws_llc_eapol_confirm(base, msg, &data_cpy, conf_data, ws_neigh);
         break;
@@ -582,7 +585,7 @@ static void ws_llc_data_ffn_ind(struct net_if *net_if, const mcps_data_ind_t *da
 
     if (!ws_neigh) {
         add_neighbor = (data->DstAddrMode == ADDR_802_15_4_LONG && has_us);
-    } else if (ws_neigh->node_role != WS_NR_ROLE_ROUTER) {
+    } else if (ws_neigh_hot(&net_if->ws_info.neighbor_storage, ws_neigh)->node_role != WS_NR_ROLE_ROUTER) {
         WARN("node changed role");
         ws_neigh_del(&net_if->ws_info.neighbor_storage, &ws_neigh->eui64);
         add_neighbor = true;
@@ -710,7 +713,8 @@ static void ws_llc_data_lfn_ind(struct net_if *net_if, const mcps_data_ind_t *da
 
     if (data->Key.SecurityLevel)
         ws_neigh_trust(&net_if->ws_info.neighbor_storage, ws_neigh);
-    ws_neigh_refresh(&net_if->ws_info.neighbor_storage, ws_neigh, ws_neigh->lifetime_s);
+    ws_neigh_refresh(&net_if->ws_info.neighbor_storage, ws_neigh,
+                     ws_neigh_hot(&net_if->ws_info.neighbor_storage, ws_neigh)->lifetime_s);
     if (has_pom && !duplicated)
         ws_neigh->pom_ie = ie_pom;
     if (duplicated) {
@@ -771,7 +775,8 @@ static void ws_llc_eapol_ffn_ind(struct net_if *net_if, const mcps_data_ind_t *d
     if (!ws_neigh)
         return;
 
-    ws_neigh_refresh(&net_if->ws_info.neighbor_storage, ws_neigh, ws_neigh->lifetime_s);
+    ws_neigh_refresh(&net_if->ws_info.neighbor_storage, ws_neigh,
+                     ws_neigh_hot(&net_if->ws_info.neighbor_storage, ws_neigh)->lifetime_s);
     ws_neigh->rsl_in_dbm_unsecured = ws_neigh_ewma_next(ws_neigh->rsl_in_dbm_unsecured, data->hif.rx_power_dbm, WS_EWMA_SF);
     ws_neigh->rx_power_dbm_unsecured = data->hif.rx_power_dbm;
     ws_neigh->lqi_unsecured = data->hif.lqi;
@@ -858,7 +863,8 @@ static void ws_llc_eapol_lfn_ind(struct net_if *net_if, const mcps_data_ind_t *d
     if (!ws_neigh)
         return;
 
-    ws_neigh_refresh(&net_if->ws_info.neighbor_storage, ws_neigh, ws_neigh->lifetime_s);
+    ws_neigh_refresh(&net_if->ws_info.neighbor_storage, ws_neigh,
+                     ws_neigh_hot(&net_if->ws_info.neighbor_storage, ws_neigh)->lifetime_s);
     ws_neigh->rsl_in_dbm_unsecured = ws_neigh_ewma_next(ws_neigh->rsl_in_dbm_unsecured, data->hif.rx_power_dbm, WS_EWMA_SF);
     ws_neigh->rx_power_dbm_unsecured = data->hif.rx_power_dbm;
     ws_neigh->lqi_unsecured = data->hif.lqi;
@@ -1295,7 +1301,7 @@ static void ws_llc_lowpan_mpx_data_request(llc_data_base_t *base, mpx_user_t *us
     struct ws_neigh *ws_neigh = data->DstAddrMode == IEEE802154_ADDR_MODE_64_BIT ?
                                 ws_neigh_get(&ws_info->neighbor_storage, &EUI64_FROM_BUF(data->DstAddr)) :
                                 NULL;
-    uint8_t node_role = ws_neigh ? ws_neigh->node_role : WS_NR_ROLE_UNKNOWN;
+    uint8_t node_role = ws_neigh ? ws_neigh_hot(&ws_info->neighbor_storage, ws_neigh)->node_role : WS_NR_ROLE_UNKNOWN;
     struct wh_ie_list wh_ies = {
         .utt = true,
         .bt  = true,
@@ -1308,7 +1314,7 @@ static void ws_llc_lowpan_mpx_data_request(llc_data_base_t *base, mpx_user_t *us
         // Include JM-IE in broadcast ULAD frames if PA transmissions are suppressed.
         .jm  = memzcmp(ws_info->pan_information.jm.metrics, sizeof(ws_info->pan_information.jm.metrics)) &&
                data->DstAddrMode == IEEE802154_ADDR_MODE_NONE &&
-               ws_info->mngt.trickle_pa.c >= ws_info->mngt.trickle_params.k,
+               ws_info->mngt.trickle_pa.c >= ws_info->mngt.trickle_pa.cfg->k,
     };
     uint24_t adjusted_offset_ms = 0;
     uint24_t adjusted_listening_interval = 0;
@@ -1679,6 +1685,13 @@ void ws_llc_reset(struct net_if *interface)
     ws_llc_clean(base);
 }
 
+int ws_llc_queue_size(struct net_if *interface)
+{
+    struct llc_data_base *base = &g_llc_base;
+
+    return base->llc_message_list_size;
+}
+
 mpx_api_t *ws_llc_mpx_api_get(struct net_if *interface)
 {
     struct llc_data_base *base = &g_llc_base;
@@ -67,6 +67,9 @@ void ws_llc_reset(struct net_if *interface);
  */
 struct mpx_api *ws_llc_mpx_api_get(struct net_if *interface);
 
+// Number of frames waiting for a confirmation from the RCP
+int ws_llc_queue_size(struct net_if *interface);
+
 /**
  * @brief ws_llc_asynch_request ws asynch message request to all giving channels
  * @param request Asynch message parameters: type, IE and channel list
@@ -16,7 +16,7 @@
 #include "common/log.h"
 #include "common/rand.h"
 #include "common/memutils.h"
-#include "common/trickle_legacy.h"
+#include "common/trickle.h"
 #include "common/specs/ieee802154.h"
 #include "common/specs/ws.h"
 #include "common/string_extra.h"
@@ -106,6 +106,16 @@ static struct ws_neigh *ws_mngt_neigh_fetch(struct ws_info *ws_info, const uint8
                         role, ws_info->tx_power_dbm, ws_info->key_index_mask);
 }
 
+// RFC 6206 only resets the timer when I > Imin, but a stopped timer is
+// restarted as well so that solicits can bring advertisements back.
+static void ws_mngt_trickle_inconsistent(struct trickle *tkl)
+{
+    if (timer_stopped(&tkl->timer_interval))
+        trickle_reset(tkl);
+    else
+        trickle_inconsistent(tkl);
+}
+
 void ws_mngt_pa_analyze(struct ws_info *ws_info,
                         const struct mcps_data_ind *data,
                         const struct mcps_data_rx_ie_list *ie_ext)
@@ -142,7 +152,7 @@ void ws_mngt_pa_analyze(struct ws_info *ws_info,
     // Border router routing cost is 0, so "Routing Cost the same or worse" is
     // always true
     if (ie_pan.routing_cost != 0xFFFF)
-        trickle_legacy_consistent(&ws_info->mngt.trickle_pa);
+        trickle_consistent(&ws_info->mngt.trickle_pa);
     ws_neigh = ws_mngt_neigh_fetch(ws_info, data->SrcAddr, WS_NR_ROLE_ROUTER);
     if (!ws_neigh)
         return;
@@ -168,8 +178,7 @@ void ws_mngt_pas_analyze(struct ws_info *ws_info,
         return;
 
     ws_mngt_ie_pom_handle(ws_info, data, ie_ext);
-    trickle_legacy_inconsistent(&ws_info->mngt.trickle_pa,
-                               &ws_info->mngt.trickle_params);
+    ws_mngt_trickle_inconsistent(&ws_info->mngt.trickle_pa);
     ws_neigh = ws_mngt_neigh_fetch(ws_info, data->SrcAddr, WS_NR_ROLE_ROUTER);
     if (!ws_neigh)
         return;
@@ -217,10 +226,9 @@ void ws_mngt_pc_analyze(struct ws_info *ws_info,
     }
 
     if (ws_info->pan_information.pan_version == ws_pan_version)
-        trickle_legacy_consistent(&ws_info->mngt.trickle_pc);
+        trickle_consistent(&ws_info->mngt.trickle_pc);
     else
-        trickle_legacy_inconsistent(&ws_info->mngt.trickle_pc,
-                                   &ws_info->mngt.trickle_params);
+        ws_mngt_trickle_inconsistent(&ws_info->mngt.trickle_pc);
 
     ws_neigh = ws_mngt_neigh_fetch(ws_info, data->SrcAddr, WS_NR_ROLE_ROUTER);
     if (!ws_neigh)
@@ -251,8 +259,7 @@ void ws_mngt_pcs_analyze(struct ws_info *ws_info,
         return;
     }
 
-    trickle_legacy_inconsistent(&ws_info->mngt.trickle_pc,
-                               &ws_info->mngt.trickle_params);
+    ws_mngt_trickle_inconsistent(&ws_info->mngt.trickle_pc);
 
     ws_neigh = ws_mngt_neigh_fetch(ws_info, data->SrcAddr, WS_NR_ROLE_ROUTER);
     if (!ws_neigh)
@@ -369,7 +376,7 @@ void ws_mngt_lpas_analyze(struct ws_info *ws_info,
 
     if (!ws_neigh) {
         add_neighbor = true;
-    } else if (ws_neigh->node_role != WS_NR_ROLE_LFN) {
+    } else if (ws_neigh_hot(&ws_info->neighbor_storage, ws_neigh)->node_role != WS_NR_ROLE_LFN) {
         WARN("node changed role");
         ws_neigh_del(&ws_info->neighbor_storage, &ws_neigh->eui64);
         add_neighbor = true;
@@ -558,29 +565,31 @@ void ws_mngt_pc_send(struct ws_info *ws_info)
     ws_llc_asynch_request(ws_info, &req);
 }
 
-void ws_mngt_async_trickle_start(struct ws_info *ws_info)
+void ws_mngt_pa_trickle_transmit(struct trickle *tkl)
 {
-    trickle_legacy_start(&ws_info->mngt.trickle_pa, "ADV", &ws_info->mngt.trickle_params);
-    trickle_legacy_start(&ws_info->mngt.trickle_pc, "CFG", &ws_info->mngt.trickle_params);
+    ws_mngt_pa_send(container_of(tkl, struct ws_info, mngt.trickle_pa));
 }
 
-void ws_mngt_async_trickle_stop(struct ws_info *ws_info)
+void ws_mngt_pc_trickle_transmit(struct trickle *tkl)
 {
-    trickle_legacy_stop(&ws_info->mngt.trickle_pa);
-    trickle_legacy_stop(&ws_info->mngt.trickle_pc);
+    ws_mngt_pc_send(container_of(tkl, struct ws_info, mngt.trickle_pc));
 }
 
-void ws_mngt_async_trickle_reset_pc(struct ws_info *ws_info)
+void ws_mngt_async_trickle_start(struct ws_info *ws_info)
+{
+    trickle_start(&ws_info->mngt.trickle_pa);
+    trickle_start(&ws_info->mngt.trickle_pc);
+}
+
+void ws_mngt_async_trickle_stop(struct ws_info *ws_info)
 {
-    trickle_legacy_inconsistent(&ws_info->mngt.trickle_pc, &ws_info->mngt.trickle_params);
+    trickle_stop(&ws_info->mngt.trickle_pa);
+    trickle_stop(&ws_info->mngt.trickle_pc);
 }
 
-void ws_mngt_async_trickle_timer_cb(struct ws_info *ws_info, uint16_t ticks)
+void ws_mngt_async_trickle_reset_pc(struct ws_info *ws_info)
 {
-    if (trickle_legacy_tick(&ws_info->mngt.trickle_pa, &ws_info->mngt.trickle_params, ticks))
-        ws_mngt_pa_send(ws_info);
-    if (trickle_legacy_tick(&ws_info->mngt.trickle_pc, &ws_info->mngt.trickle_params, ticks))
-        ws_mngt_pc_send(ws_info);
+    ws_mngt_trickle_inconsistent(&ws_info->mngt.trickle_pc);
 }
 
 static void ws_mngt_lts_send(struct ws_info *ws_info)
@@ -84,7 +84,7 @@ typedef struct pae_controller {
     pae_controller_gtk_t lgtks;                                       /**< Material for GTKs */
     sec_prot_keys_nw_info_t sec_keys_nw_info;                        /**< Security keys network information */
     sec_prot_certs_t certs;                                          /**< Certificates */
-    uint16_t frame_cnt_store_timer;                                  /**< Timer to check if storing of frame counter value is needed */
+    uint16_t nw_info_store_timer;                                    /**< Seconds before the pending network info store */
     sec_cfg_t sec_cfg;                                               /**< Security configuration (configuration set values) */
     struct net_if *interface_ptr;                  /**< List link entry */
     ws_pae_controller_nw_key_set *nw_key_set;                        /**< Key set callback */
@@ -98,6 +98,7 @@ typedef struct pae_controller {
     ws_pae_gtks_updated *pae_gtks_updated;                           /**< PAE GTKs updated */
     ws_pae_gtk_hash_update *pae_gtk_hash_update;                     /**< PAE GTK HASH update */
     bool auth_started : 1;                                           /**< Authenticator has been started */
+    bool nw_info_store_pending : 1;                                  /**< Network info must be stored */
 } pae_controller_t;
 
 typedef struct pae_controller_config {
@@ -118,6 +119,8 @@ static void ws_pae_controller_nw_key_index_check_and_set(struct net_if *interfac
 static void ws_pae_controller_data_init(pae_controller_t *controller);
 static void ws_pae_controller_frame_counter_reset(frame_counters_t *frame_counters);
 static int8_t ws_pae_controller_nw_info_read(pae_controller_t *controller);
+static void ws_pae_controller_nw_info_store_schedule(pae_controller_t *controller);
+static void ws_pae_controller_nw_info_store(pae_controller_t *controller);
 static int8_t ws_pae_controller_nvm_nw_info_write(const struct net_if *interface_ptr, const sec_prot_keys_nw_info_t *sec_keys_nw_info,
                                                   const frame_counters_t *gtk_frame_counters, const frame_counters_t *lgtk_frame_counters,
                                                   const uint8_t *gtk_eui64);
@@ -260,9 +263,7 @@ static void ws_pae_controller_nw_info_updated_check(struct net_if *interface_ptr
 
     if (controller->sec_keys_nw_info.updated ||
         sec_prot_keys_gtks_are_updated(controller->sec_keys_nw_info.gtks)) {
-        ws_pae_controller_nvm_nw_info_write(controller->interface_ptr, &controller->sec_keys_nw_info,
-                                            &controller->gtks.frame_counters, &controller->lgtks.frame_counters,
-                                            controller->interface_ptr->mac);
+        ws_pae_controller_nw_info_store_schedule(controller);
         controller->sec_keys_nw_info.updated = false;
         sec_prot_keys_gtks_updated_reset(controller->sec_keys_nw_info.gtks);
         sec_prot_keys_gtks_updated_reset(controller->sec_keys_nw_info.lgtks);
@@ -301,15 +302,50 @@ void ws_pae_controller_nw_frame_counter_indication_cb(int8_t net_if_id, unsigned
 {
     struct net_if *interface_ptr = protocol_stack_interface_info_get_by_id(net_if_id);
     pae_controller_t *controller = ws_pae_controller_get(interface_ptr);
+    frame_counter_t *counter;
 
     if (gtk_index >= GTK_NUM)
-        controller->lgtks.frame_counters.counter[gtk_index - GTK_NUM].frame_counter = frame_counter;
+        counter = &controller->lgtks.frame_counters.counter[gtk_index - GTK_NUM];
     else
-        controller->gtks.frame_counters.counter[gtk_index].frame_counter = frame_counter;
+        counter = &controller->gtks.frame_counters.counter[gtk_index];
+    counter->frame_counter = frame_counter;
+
+    // On start up, the stored frame counter is incremented by
+    // FRAME_COUNTER_INCREMENT. Each store thus reserves a block of frame
+    // counters, it is only needed once a significant part of this block has
+    // been consumed.
+    if (frame_counter - counter->stored_frame_counter >= FRAME_COUNTER_STORE_THRESHOLD)
+        ws_pae_controller_nw_info_store_schedule(controller);
+}
+
+static void ws_pae_controller_nw_info_store_schedule(pae_controller_t *controller)
+{
+    if (controller->nw_info_store_pending)
+        return;
+    controller->nw_info_store_pending = true;
+    controller->nw_info_store_timer = NW_INFO_STORE_DELAY;
+}
+
+static void ws_pae_controller_nw_info_store(pae_controller_t *controller)
+{
+    controller->nw_info_store_pending = false;
+    if (ws_pae_controller_nvm_nw_info_write(controller->interface_ptr, &controller->sec_keys_nw_info,
+                                            &controller->gtks.frame_counters, &controller->lgtks.frame_counters,
+                                            controller->interface_ptr->mac) < 0)
+        return;
+    for (int i = 0; i < GTK_NUM; i++)
+        controller->gtks.frame_counters.counter[i].stored_frame_counter =
+            controller->gtks.frame_counters.counter[i].frame_counter;
+    for (int i = 0; i < LGTK_NUM; i++)
+        controller->lgtks.frame_counters.counter[i].stored_frame_counter =
+            controller->lgtks.frame_counters.counter[i].frame_counter;
+}
 
-    ws_pae_controller_nvm_nw_info_write(controller->interface_ptr, &controller->sec_keys_nw_info,
-                                        &controller->gtks.frame_counters, &controller->lgtks.frame_counters,
-                                        controller->interface_ptr->mac);
+void ws_pae_controller_nw_info_flush(void)
+{
+    ns_list_foreach(pae_controller_t, entry, &pae_controller_list)
+        if (entry->nw_info_store_pending)
+            ws_pae_controller_nw_info_store(entry);
 }
 
 static int8_t ws_pae_controller_nw_key_check_and_insert(struct net_if *interface_ptr, sec_prot_gtk_keys_t *gtks, bool is_lgtk)
@@ -564,6 +600,9 @@ static int8_t ws_pae_controller_nw_info_read(pae_controller_t *controller)
                 tr_info("Read LGTK frame counter: index %i value %"PRIu32"", index, controller->lgtks.frame_counters.counter[index].frame_counter);
             }
         }
+        // Reserve the next block of frame counters before any frame is sent
+        // with the incremented values.
+        ws_pae_controller_nw_info_store(controller);
     }
 
     return 0;
@@ -638,7 +677,9 @@ static int8_t ws_pae_controller_nvm_nw_info_write(const struct net_if *interface
             fprintf(info->file, "#lgtk[%d].installed_hash = %s\n", i, str_buf);
         }
     }
-    storage_close(info);
+    storage_sync(info);
+    if (storage_close(info))
+        return -1;
     return 0;
 }
 
@@ -1061,6 +1102,12 @@ void ws_pae_controller_slow_timer(int seconds)
         if (entry->pae_slow_timer) {
             entry->pae_slow_timer(seconds);
         }
+        if (entry->nw_info_store_pending) {
+            if (entry->nw_info_store_timer > seconds)
+                entry->nw_info_store_timer -= seconds;
+            else
+                ws_pae_controller_nw_info_store(entry);
+        }
     }
 }
 
@@ -300,6 +300,15 @@ const sec_prot_gtk_keys_t *ws_pae_controller_get_transient_keys(int8_t interface
 
 void ws_pae_controller_nw_frame_counter_indication_cb(int8_t net_if_id, unsigned int gtk_index, uint32_t frame_counter);
 
+/**
+ * ws_pae_controller_nw_info_flush stores pending network info updates
+ *
+ * Network info updates are coalesced and stored after NW_INFO_STORE_DELAY.
+ * This function must be called before exiting.
+ *
+ */
+void ws_pae_controller_nw_info_flush(void);
+
 int8_t ws_pae_controller_network_name_set(struct net_if *interface_ptr, char *network_name);
 
 #else
@@ -317,6 +326,11 @@ static inline void ws_pae_controller_nw_frame_counter_indication_cb(int8_t net_i
 {
     // empty
 }
+
+static inline void ws_pae_controller_nw_info_flush(void)
+{
+    // empty
+}
 #endif
 
 #endif
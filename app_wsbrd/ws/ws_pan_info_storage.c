@@ -22,11 +22,30 @@
 #include "common/key_value_storage.h"
 #include "common/memutils.h"
 #include "common/parsers.h"
+#include "common/string_extra.h"
 #include "common/log.h"
 #include "common/version.h"
+#include "common/timer.h"
 
 #include "ws_pan_info_storage.h"
 
+// Several PAN version increases tend to follow each other (ex: installation
+// then activation of a GTK), so the file is rewritten at most once per delay.
+#define WS_PAN_INFO_STORAGE_DELAY_MS 1000
+
+static void ws_pan_info_storage_timer_expired(struct timer_group *group, struct timer_entry *timer);
+
+static struct {
+    uint16_t bsi;
+    uint16_t pan_id;
+    uint16_t pan_version;
+    uint16_t lfn_version;
+    char network_name[33];
+} ws_pan_info_storage_pending;
+static struct timer_entry ws_pan_info_storage_timer = {
+    .callback = ws_pan_info_storage_timer_expired,
+};
+
 void ws_pan_info_storage_read(int *bsi, int *pan_id, uint16_t *pan_version, uint16_t *lfn_version,
                               char network_name[33])
 {
@@ -61,8 +80,7 @@ void ws_pan_info_storage_read(int *bsi, int *pan_id, uint16_t *pan_version, uint
     storage_close(info);
 }
 
-void ws_pan_info_storage_write(uint16_t bsi, uint16_t pan_id, uint16_t pan_version, uint16_t lfn_version,
-                               const char network_name[33])
+static void ws_pan_info_storage_store(void)
 {
     struct storage_parse_info *info = storage_open_prefix("br-info", "w");
     char str_buf[256];
@@ -70,13 +88,39 @@ void ws_pan_info_storage_write(uint16_t bsi, uint16_t pan_id, uint16_t pan_versi
     if (!info)
         return;
     fprintf(info->file, "api_version = %#08x\n", version_daemon_api);
-    fprintf(info->file, "bsi = %d\n", bsi);
-    fprintf(info->file, "pan_id = %#04x\n", pan_id);
-    fprintf(info->file, "pan_version = %d\n", pan_version);
-    fprintf(info->file, "lfn_version = %d\n", lfn_version);
-    str_bytes(network_name, strlen(network_name), NULL, str_buf, sizeof(str_buf), FMT_ASCII_ALNUM);
+    fprintf(info->file, "bsi = %d\n", ws_pan_info_storage_pending.bsi);
+    fprintf(info->file, "pan_id = %#04x\n", ws_pan_info_storage_pending.pan_id);
+    fprintf(info->file, "pan_version = %d\n", ws_pan_info_storage_pending.pan_version);
+    fprintf(info->file, "lfn_version = %d\n", ws_pan_info_storage_pending.lfn_version);
+    str_bytes(ws_pan_info_storage_pending.network_name, strlen(ws_pan_info_storage_pending.network_name),
+              NULL, str_buf, sizeof(str_buf), FMT_ASCII_ALNUM);
     fprintf(info->file, "network_name = %s\n", str_buf);
-    fflush(info->file);
-    fsync(fileno(info->file));
+    storage_sync(info);
     storage_close(info);
 }
+
+void ws_pan_info_storage_flush(void)
+{
+    if (timer_stopped(&ws_pan_info_storage_timer))
+        return;
+    timer_stop(NULL, &ws_pan_info_storage_timer);
+    ws_pan_info_storage_store();
+}
+
+static void ws_pan_info_storage_timer_expired(struct timer_group *group, struct timer_entry *timer)
+{
+    ws_pan_info_storage_store();
+}
+
+void ws_pan_info_storage_write(uint16_t bsi, uint16_t pan_id, uint16_t pan_version, uint16_t lfn_version,
+                               const char network_name[33])
+{
+    ws_pan_info_storage_pending.bsi         = bsi;
+    ws_pan_info_storage_pending.pan_id      = pan_id;
+    ws_pan_info_storage_pending.pan_version = pan_version;
+    ws_pan_info_storage_pending.lfn_version = lfn_version;
+    strlcpy(ws_pan_info_storage_pending.network_name, network_name,
+            sizeof(ws_pan_info_storage_pending.network_name));
+    if (timer_stopped(&ws_pan_info_storage_timer))
+        timer_start_rel(NULL, &ws_pan_info_storage_timer, WS_PAN_INFO_STORAGE_DELAY_MS);
+}
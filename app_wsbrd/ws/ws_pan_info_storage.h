@@ -22,6 +22,9 @@
 #include <stdint.h>
 
 void ws_pan_info_storage_read(int *bsi, int *pan_id, uint16_t *pan_version, uint16_t *lfn_version, char network_name[33]);
+// The file is written after a short delay, in order to merge close updates
 void ws_pan_info_storage_write(uint16_t bsi, uint16_t pan_id, uint16_t pan_version, uint16_t lfn_version, const char network_name[33]);
+// Write the pending update now, if any
+void ws_pan_info_storage_flush(void);
 
 #endif
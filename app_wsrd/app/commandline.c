@@ -97,6 +97,8 @@ void parse_commandline(struct wsrd_conf *config, int argc, char *argv[])
         { "unicast_dwell_interval",        &config->ws_uc_dwell_interval_ms,          conf_set_number,      &valid_uc_dwell_interval },
         { "tx_power",                      &config->tx_power,                         conf_set_number,      &valid_int8 },
         { "trace",                         &g_enabled_traces,                         conf_add_flags,       &valid_traces },
+        { "trace_ring",                    config->trace_ring,                        conf_set_string,      (void *)sizeof(config->trace_ring) },
+        { "trace_ring_size",               &config->trace_ring_size,                  conf_set_number,      &valid_positive },
         { "color_output",                  &config->color_output,                     conf_set_enum,        &valid_tristate },
         { "authority",                     &config->ca_cert,                          conf_set_pem,         NULL },
         { "certificate",                   &config->cert,                             conf_set_pem,         NULL },
@@ -59,6 +59,8 @@ struct wsrd_conf {
 
     bool list_rf_configs;
     int  color_output;
+    char trace_ring[PATH_MAX];
+    int  trace_ring_size;
 };
 
 void parse_commandline(struct wsrd_conf *config, int argc, char *argv[]);
@@ -139,6 +139,16 @@ static int dbus_get_hw_address(sd_bus *bus, const char *path, const char *interf
     return 0;
 }
 
+static int dbus_get_header_compression(sd_bus *bus, const char *path, const char *interface,
+                                       const char *property, sd_bus_message *reply,
+                                       void *userdata, sd_bus_error *ret_error)
+{
+    struct lowpan_ctx *lowpan = userdata;
+
+    sd_bus_message_append(reply, "(tt)", lowpan->iphc_tx_count, lowpan->iphc_tx_saved);
+    return 0;
+}
+
 const struct sd_bus_vtable wsrd_dbus_vtable[] = {
     SD_BUS_VTABLE_START(0),
     SD_BUS_METHOD_WITH_OFFSET("JoinMulticastGroup",  "ay", NULL, dbus_join_multicast_group,  offsetof(struct wsrd, ipv6), 0),
@@ -149,5 +159,6 @@ const struct sd_bus_vtable wsrd_dbus_vtable[] = {
     SD_BUS_PROPERTY("PanVersion",    "q",   dbus_get_pan_version,    offsetof(struct wsrd, ws.pan_version), SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
     SD_BUS_PROPERTY("PrimaryParent", "ay",  dbus_get_primary_parent, offsetof(struct wsrd, ipv6),           SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
     SD_BUS_PROPERTY("DodagId",       "ay",  dbus_get_dodag_id,       offsetof(struct wsrd, ipv6),           0),
+    SD_BUS_PROPERTY("HeaderCompression", "(tt)", dbus_get_header_compression, offsetof(struct wsrd, ipv6.lowpan), 0),
     SD_BUS_VTABLE_END,
 };
@@ -52,16 +52,18 @@ static uint16_t ws_get_own_routing_cost(struct wsrd *wsrd)
 {
     const struct ipv6_neigh *ipv6_parent = rpl_neigh_pref_parent(&wsrd->ipv6);
     const struct ws_neigh *ws_parent;
+    float etx;
 
     if (!ipv6_parent)
         return 0xffff;
     ws_parent = ws_neigh_get(&wsrd->ws.neigh_table, &ipv6_parent->eui64);
     BUG_ON(!ws_parent);
+    etx = ws_neigh_hot(&wsrd->ws.neigh_table, ws_parent)->etx;
 
     // Note: overflow during float to int conversion is undefined behavior
-    if (ws_parent->ie_pan.routing_cost + (uint16_t)ws_parent->etx > 0xffff)
+    if (ws_parent->ie_pan.routing_cost + (uint16_t)etx > 0xffff)
         return 0xffff;
-    return ws_parent->ie_pan.routing_cost + (uint16_t)ws_parent->etx;
+    return ws_parent->ie_pan.routing_cost + (uint16_t)etx;
 }
 
 void ws_sync_fhss_bc(struct wsrd *wsrd, const struct ws_neigh *ws_neigh)
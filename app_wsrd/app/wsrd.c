@@ -24,6 +24,7 @@
 #include "app_wsrd/app/dbus.h"
 #include "app_wsrd/app/ws.h"
 #include "app_wsrd/ipv6/rpl.h"
+#include "common/specs/ws.h"
 #include "common/ws/eapol_relay.h"
 #include "common/ws/ws_regdb.h"
 #include "common/ipv6/ipv6_addr.h"
@@ -32,6 +33,7 @@
 #include "common/drop_privileges.h"
 #include "common/bits.h"
 #include "common/log.h"
+#include "common/log_bin.h"
 #include "common/memutils.h"
 #include "common/pktbuf.h"
 #include "common/string_extra.h"
@@ -55,7 +57,7 @@ enum {
 static void wsrd_on_rcp_reset(struct rcp *rcp);
 static void wsrd_on_etx_outdated(struct ws_neigh_table *table, struct ws_neigh *neigh);
 static void wsrd_on_etx_update(struct ws_neigh_table *table, struct ws_neigh *neigh);
-static int wsrd_ipv6_sendto_mac(struct ipv6_ctx *ipv6, struct pktbuf *pktbuf, const struct eui64 *dst);
+static int wsrd_ipv6_sendto_mac(struct ipv6_ctx *ipv6, struct pktbuf *pktbuf, const struct eui64 *dst, int prio);
 static void wsrd_eapol_sendto_mac(struct supp_ctx *supp, uint8_t kmp_id, const void *pkt,
                                   size_t pkt_len, const struct eui64 *dst);
 static struct eui64 wsrd_eapol_get_target(struct supp_ctx *supp);
@@ -87,6 +89,10 @@ struct wsrd g_wsrd = {
     .ws.on_recv_cnf                 = ws_on_recv_cnf,
     .ws.eapol_relay_fd = -1,
     .ipv6.sendto_mac = wsrd_ipv6_sendto_mac,
+    // Conservative estimate of the 802.15.4 header, IEs, and MIC
+    .ipv6.lowpan.frag_mtu = WS_MTU_BYTES - 200,
+    .ipv6.lowpan.reasm_max = 16,
+    .ipv6.lowpan.reasm_timeout_ms = 60 * 1000,
     .eapol_target_eui64 = EUI64_BC,
 
     // Wi-SUN FAN 1.1v08 - 6.5.2.1.1 SUP Operation
@@ -112,6 +118,7 @@ struct wsrd g_wsrd = {
     .config.ws_allowed_channels = { [0 ... sizeof(g_wsrd.config.ws_allowed_channels) - 1] = 0xff },
     .config.tx_power = 14,
     .config.color_output = -1,
+    .config.trace_ring_size = 4 * 1024 * 1024,
     .config.ws_mac_address = EUI64_BC,
 
     // Wi-SUN FAN 1.1v09 6.3.1.1 Configuration Parameters
@@ -229,11 +236,11 @@ static void wsrd_on_etx_update(struct ws_neigh_table *table, struct ws_neigh *ne
     rpl_mrhof_select_parent(&wsrd->ipv6);
 }
 
-static int wsrd_ipv6_sendto_mac(struct ipv6_ctx *ipv6, struct pktbuf *pktbuf, const struct eui64 *dst)
+static int wsrd_ipv6_sendto_mac(struct ipv6_ctx *ipv6, struct pktbuf *pktbuf, const struct eui64 *dst, int prio)
 {
     struct wsrd *wsrd = container_of(ipv6, struct wsrd, ipv6);
 
-    return ws_if_send_data(&wsrd->ws, pktbuf_head(pktbuf), pktbuf_len(pktbuf), dst);
+    return ws_if_send_data(&wsrd->ws, pktbuf_head(pktbuf), pktbuf_len(pktbuf), dst, prio);
 }
 
 static void wsrd_eapol_on_gtk_change(struct supp_ctx *supp, const uint8_t gtk[16], uint8_t index)
@@ -390,8 +397,8 @@ static void wsrd_init_radio(struct wsrd *wsrd)
     wsrd->ws.phy.rcp_rail_config_index = rail_config->index;
 
     ws_chan_mask_calc_reg(chan_mask, wsrd->ws.fhss.chan_params, HIF_REG_NONE);
-    bitand(chan_mask, wsrd->config.ws_allowed_channels, 256);
-    if (!memzcmp(chan_mask, sizeof(chan_mask)))
+    ws_chan_mask_and(chan_mask, wsrd->config.ws_allowed_channels);
+    if (!ws_chan_mask_count(chan_mask))
         FATAL(1, "combination of allowed_channels and regulatory constraints results in no valid channel (see --list-rf-configs)");
     rcp_set_fhss_uc(&wsrd->ws.rcp, wsrd->config.ws_uc_dwell_interval_ms, chan_mask, NULL);
     rcp_set_fhss_async(&wsrd->ws.rcp, 500, chan_mask);
@@ -413,6 +420,7 @@ static void wsrd_init_ipv6(struct wsrd *wsrd)
     tun_addr_add(&wsrd->ipv6.tun, &addr_linklocal, 64);
 
     timer_group_init(&wsrd->ipv6.timer_group);
+    timer_group_init(&wsrd->ipv6.lowpan.timer_group);
 
     wsrd->ipv6.rpl.compat = wsrd->config.rpl_compat;
     dhcp_client_init(&wsrd->ipv6.dhcp, &wsrd->ipv6.tun, wsrd->ws.rcp.eui64.u8);
@@ -475,6 +483,8 @@ int wsrd_main(int argc, char *argv[])
     parse_commandline(&wsrd->config, argc, argv);
     if (wsrd->config.color_output != -1)
         g_enable_color_traces = wsrd->config.color_output;
+    if (wsrd->config.trace_ring[0])
+        tr_bin_open(wsrd->config.trace_ring, wsrd->config.trace_ring_size);
 
     check_mbedtls_features();
 
@@ -11,18 +11,261 @@
  *
  * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
  */
+#include <netinet/ip6.h>
+#include <string.h>
 #include <errno.h>
 
 #include "common/specs/6lowpan.h"
 #include "common/ipv6/6lowpan_iphc.h"
 #include "common/ipv6/ipv6_addr.h"
+#include "common/bits.h"
+#include "common/fnv_hash.h"
 #include "common/iobuf.h"
 #include "common/log.h"
+#include "common/mathutils.h"
+#include "common/memutils.h"
 #include "common/pktbuf.h"
 #include "app_wsrd/ipv6/ipv6.h"
 #include "app_wsrd/app/ws.h"
 #include "6lowpan.h"
 
+// RFC 4944 - Figure 4: First Fragment
+#define LOWPAN_FRAG1_HDR_LEN 4
+// RFC 4944 - Figure 5: Subsequent Fragments
+#define LOWPAN_FRAGN_HDR_LEN 5
+
+static void lowpan_reasm_timeout(struct timer_group *group, struct timer_entry *timer);
+
+static void lowpan_iphc_ctx_timeout(struct timer_group *group, struct timer_entry *timer)
+{
+    struct lowpan_ctx *lowpan = container_of(group, struct lowpan_ctx, timer_group);
+    int cid = timer - lowpan->iphc_ctx_timer;
+
+    TRACE(TR_IPV6, "6lowpan context %d expired", cid);
+    memset(&lowpan->iphc_ctx[cid], 0, sizeof(lowpan->iphc_ctx[cid]));
+}
+
+void lowpan_iphc_ctx_set(struct lowpan_ctx *lowpan, uint8_t cid, bool compress,
+                         const struct in6_addr *prefix, uint8_t prefix_len,
+                         uint64_t lifetime_ms)
+{
+    struct lowpan_iphc_ctx *ctx = &lowpan->iphc_ctx[cid];
+    struct timer_entry *timer = &lowpan->iphc_ctx_timer[cid];
+
+    BUG_ON(cid >= LOWPAN_IPHC_CTX_COUNT);
+    timer_stop(&lowpan->timer_group, timer);
+    if (!lifetime_ms) {
+        memset(ctx, 0, sizeof(*ctx));
+        return;
+    }
+    ctx->valid      = true;
+    ctx->compress   = compress;
+    ctx->prefix_len = prefix_len;
+    memset(&ctx->prefix, 0, sizeof(ctx->prefix));
+    memcpy(&ctx->prefix, prefix, roundup(prefix_len, 8) / 8);
+    timer->callback = lowpan_iphc_ctx_timeout;
+    timer_start_rel(&lowpan->timer_group, timer, lifetime_ms);
+}
+
+static unsigned int lowpan_reasm_hash(const struct eui64 *src, uint16_t tag)
+{
+    uint8_t key[10];
+
+    memcpy(key, src->u8, 8);
+    memcpy(key + 8, &tag, 2);
+    return fnv_hash_reverse_32_init(key, sizeof(key)) % LOWPAN_REASM_HASH_SIZE;
+}
+
+static struct lowpan_reasm *lowpan_reasm_get(struct lowpan_ctx *lowpan,
+                                             const struct eui64 *src, const struct eui64 *dst,
+                                             uint16_t tag, uint16_t size)
+{
+    struct lowpan_reasm *reasm;
+
+    //   RFC 4944 - 5.3. Fragmentation Type and Header
+    // The recipient of link fragments SHALL use (1) the sender's 802.15.4
+    // source address (which may be short or long), (2) the destination's
+    // 802.15.4 address, (3) datagram_size, and (4) datagram_tag to identify
+    // all the link fragments that belong to a given datagram.
+    SLIST_FOREACH(reasm, &lowpan->reasm[lowpan_reasm_hash(src, tag)], link)
+        if (reasm->tag == tag && reasm->size == size &&
+            eui64_eq(&reasm->src, src) && eui64_eq(&reasm->dst, dst))
+            return reasm;
+    return NULL;
+}
+
+static struct lowpan_reasm *lowpan_reasm_new(struct lowpan_ctx *lowpan,
+                                             const struct eui64 *src, const struct eui64 *dst,
+                                             uint16_t tag, uint16_t size)
+{
+    struct lowpan_reasm *reasm;
+
+    if (lowpan->reasm_count >= lowpan->reasm_max) {
+        TRACE(TR_DROP, "drop %-9s: reassembly table full", "6lowpan");
+        return NULL;
+    }
+    reasm = zalloc(sizeof(*reasm));
+    reasm->src  = *src;
+    reasm->dst  = *dst;
+    reasm->tag  = tag;
+    reasm->size = size;
+    reasm->buf  = xalloc(size);
+    reasm->timer.callback = lowpan_reasm_timeout;
+    SLIST_INSERT_HEAD(&lowpan->reasm[lowpan_reasm_hash(src, tag)], reasm, link);
+    lowpan->reasm_count++;
+    //   RFC 4944 - 5.3. Fragmentation Type and Header
+    // If a fragment recipient disassociates from its peer or the reassembly
+    // timeout (60 seconds) expires, the entire packet SHALL be discarded.
+    timer_start_rel(&lowpan->timer_group, &reasm->timer, lowpan->reasm_timeout_ms);
+    return reasm;
+}
+
+static void lowpan_reasm_del(struct lowpan_ctx *lowpan, struct lowpan_reasm *reasm)
+{
+    SLIST_REMOVE(&lowpan->reasm[lowpan_reasm_hash(&reasm->src, reasm->tag)],
+                 reasm, lowpan_reasm, link);
+    lowpan->reasm_count--;
+    timer_stop(&lowpan->timer_group, &reasm->timer);
+    free(reasm->frag1);
+    free(reasm->buf);
+    free(reasm);
+}
+
+static void lowpan_reasm_timeout(struct timer_group *group, struct timer_entry *timer)
+{
+    struct lowpan_ctx *lowpan = container_of(group, struct lowpan_ctx, timer_group);
+    struct lowpan_reasm *reasm = container_of(timer, struct lowpan_reasm, timer);
+
+    TRACE(TR_DROP, "drop %-9s: reassembly timeout src=%s tag=%u",
+          "6lowpan", tr_eui64(reasm->src.u8), reasm->tag);
+    lowpan_reasm_del(lowpan, reasm);
+}
+
+/*
+ * Mark the 8-octet units covered by [offset, offset + len) as received.
+ * Returns 0 on success, -EALREADY for an exact duplicate (ie. retransmission
+ * after a lost ACK), and -EINVAL on partial overlap.
+ */
+static int lowpan_reasm_mark(struct lowpan_reasm *reasm, uint16_t offset, uint16_t len)
+{
+    int first = offset / 8;
+    int last = (offset + len - 1) / 8;
+    int cnt = 0;
+
+    for (int i = first; i <= last; i++)
+        cnt += bittest(reasm->rcvd, i);
+    if (cnt == last - first + 1)
+        return -EALREADY;
+    if (cnt)
+        return -EINVAL;
+    bitfill(reasm->rcvd, true, first, last);
+    reasm->rcvd_size += len;
+    return 0;
+}
+
+static void lowpan_reasm_complete(struct ipv6_ctx *ipv6, struct lowpan_reasm *reasm,
+                                  const uint8_t src_iid[8], const uint8_t dst_iid[8])
+{
+    struct pktbuf pktbuf = { };
+    struct eui64 src = reasm->src;
+    uint16_t size = reasm->size;
+
+    pktbuf_init(&pktbuf, reasm->frag1, reasm->frag1_len);
+    pktbuf_push_tail(&pktbuf, reasm->buf + reasm->frag1_size, reasm->size - reasm->frag1_size);
+    lowpan_reasm_del(&ipv6->lowpan, reasm);
+
+    lowpan_iphc_decmpr(&pktbuf, src_iid, dst_iid, ipv6->lowpan.iphc_ctx);
+    if (pktbuf.err)
+        goto err;
+    if (pktbuf_len(&pktbuf) != size) {
+        TRACE(TR_DROP, "drop %-9s: datagram_size mismatch", "6lowpan");
+        goto err;
+    }
+    ipv6_recvfrom_mac(ipv6, &pktbuf, &src);
+err:
+    pktbuf_free(&pktbuf);
+}
+
+static void lowpan_recv_frag(struct ipv6_ctx *ipv6, struct pktbuf *pktbuf,
+                             const struct eui64 *src, const struct eui64 *dst,
+                             const uint8_t src_iid[8], const uint8_t dst_iid[8])
+{
+    struct pktbuf frag1 = { };
+    struct lowpan_reasm *reasm;
+    uint16_t size, tag, offset;
+    uint16_t len;
+    bool is_frag1;
+    int ret;
+
+    is_frag1 = LOWPAN_DISPATCH_IS_FRAG1(pktbuf_head(pktbuf)[0]);
+    size = FIELD_GET(LOWPAN_MASK_FRAG_DGRAM_SIZE, pktbuf_pop_head_be16(pktbuf));
+    tag  = pktbuf_pop_head_be16(pktbuf);
+    offset = is_frag1 ? 0 : pktbuf_pop_head_u8(pktbuf) * 8;
+    if (pktbuf->err || !pktbuf_len(pktbuf)) {
+        TRACE(TR_DROP, "drop %-9s: malformed fragment", "6lowpan");
+        return;
+    }
+
+    if (is_frag1) {
+        // The uncompressed size of FRAG1 is needed to place subsequent
+        // fragments, decompress a throwaway copy to find it.
+        pktbuf_init(&frag1, pktbuf_head(pktbuf), pktbuf_len(pktbuf));
+        if (!LOWPAN_DISPATCH_IS_IPHC(frag1.buf[0])) {
+            TRACE(TR_DROP, "drop %-9s: unsupported dispatch type 0x%02x", "6lowpan", frag1.buf[0]);
+            goto err;
+        }
+        lowpan_iphc_decmpr(&frag1, src_iid, dst_iid, ipv6->lowpan.iphc_ctx);
+        if (frag1.err)
+            goto err;
+        len = pktbuf_len(&frag1);
+    } else {
+        len = pktbuf_len(pktbuf);
+    }
+    //   RFC 4944 - 5.3. Fragmentation Type and Header
+    // All link fragments for a datagram except the last one MUST be multiples
+    // of eight bytes in length.
+    if (offset + len > size || (offset + len < size && len % 8)) {
+        TRACE(TR_DROP, "drop %-9s: invalid fragment offset=%u len=%u size=%u",
+              "6lowpan", offset, len, size);
+        goto err;
+    }
+
+    reasm = lowpan_reasm_get(&ipv6->lowpan, src, dst, tag, size);
+    if (!reasm)
+        reasm = lowpan_reasm_new(&ipv6->lowpan, src, dst, tag, size);
+    if (!reasm)
+        goto err;
+
+    ret = lowpan_reasm_mark(reasm, offset, len);
+    if (ret == -EALREADY) {
+        TRACE(TR_IGNORE, "ignore %-9s: duplicate fragment tag=%u offset=%u", "6lowpan", tag, offset);
+        goto err;
+    }
+    if (ret < 0) {
+        //   RFC 4944 - 5.3. Fragmentation Type and Header
+        // If a link fragment that overlaps another fragment is received, as
+        // identified by the datagram_offset field in the fragment header and
+        // the fragment length, the fragment(s) already accumulated in the
+        // reassembly buffer SHALL be discarded.
+        TRACE(TR_DROP, "drop %-9s: overlapping fragment tag=%u", "6lowpan", tag);
+        lowpan_reasm_del(&ipv6->lowpan, reasm);
+        goto err;
+    }
+    if (is_frag1) {
+        reasm->frag1 = xalloc(pktbuf_len(pktbuf));
+        reasm->frag1_len = pktbuf_len(pktbuf);
+        reasm->frag1_size = len;
+        memcpy(reasm->frag1, pktbuf_head(pktbuf), pktbuf_len(pktbuf));
+    } else {
+        memcpy(reasm->buf + offset, pktbuf_head(pktbuf), len);
+    }
+
+    if (reasm->frag1_size && reasm->rcvd_size == reasm->size)
+        lowpan_reasm_complete(ipv6, reasm, src_iid, dst_iid);
+err:
+    pktbuf_free(&frag1);
+}
+
 void lowpan_recv(struct ipv6_ctx *ipv6,
                  const uint8_t *buf, size_t buf_len,
                  const struct eui64 *src, const struct eui64 *dst)
@@ -40,9 +283,11 @@ void lowpan_recv(struct ipv6_ctx *ipv6,
         return;
     dispatch = pktbuf.buf[pktbuf.offset_head];
 
-    // TODO: support FRAG1 and FRAGN
-    if (LOWPAN_DISPATCH_IS_IPHC(dispatch)) {
-        lowpan_iphc_decmpr(&pktbuf, src_iid, dst_iid);
+    if (LOWPAN_DISPATCH_IS_FRAG1(dispatch) || LOWPAN_DISPATCH_IS_FRAGN(dispatch)) {
+        lowpan_recv_frag(ipv6, &pktbuf, src, dst, src_iid, dst_iid);
+        goto err;
+    } else if (LOWPAN_DISPATCH_IS_IPHC(dispatch)) {
+        lowpan_iphc_decmpr(&pktbuf, src_iid, dst_iid, ipv6->lowpan.iphc_ctx);
     } else {
         TRACE(TR_DROP, "drop %-9s: unsupported dispatch type 0x%02x", "6lowpan", dispatch);
         goto err;
@@ -53,19 +298,100 @@ err:
     pktbuf_free(&pktbuf);
 }
 
+/*
+ * Fragments are sent directly from the compressed datagram buffer: the
+ * fragment header is written over the bytes preceding each fragment payload,
+ * which are restored once the frame has been handed to the MAC.
+ * WARN: sendto_mac() must not retain the pktbuf.
+ */
+static int lowpan_send_frag(struct ipv6_ctx *ipv6,
+                            struct pktbuf *pktbuf,
+                            uint16_t size, size_t hdr_len,
+                            const struct eui64 *dst, int prio)
+{
+    // Bytes removed by IPHC, only the IPv6 header is compressed
+    const size_t elided = size - pktbuf_len(pktbuf);
+    const uint16_t tag = ipv6->lowpan.tag++;
+    uint8_t saved[LOWPAN_FRAGN_HDR_LEN];
+    struct pktbuf frag;
+    size_t start, end;
+    size_t frag_hdr_len;
+    uint16_t offset;
+    int ret = 0;
+
+    // Reserve headroom for the FRAG1 header
+    pktbuf_push_head(pktbuf, NULL, LOWPAN_FRAG1_HDR_LEN);
+    pktbuf->offset_head += LOWPAN_FRAG1_HDR_LEN;
+
+    start = pktbuf->offset_head;
+    while (start < pktbuf->offset_tail) {
+        if (start == pktbuf->offset_head)
+            offset = 0;
+        else
+            offset = start - pktbuf->offset_head + elided;
+        frag_hdr_len = offset ? LOWPAN_FRAGN_HDR_LEN : LOWPAN_FRAG1_HDR_LEN;
+        end = MIN(pktbuf->offset_tail, start + ipv6->lowpan.frag_mtu - frag_hdr_len);
+        // Uncompressed offset of the next fragment must be a multiple of 8
+        if (end < pktbuf->offset_tail)
+            end -= (end - pktbuf->offset_head + elided) % 8;
+        if (end <= start || (!offset && end - pktbuf->offset_head < hdr_len)) {
+            TRACE(TR_TX_ABORT, "tx-abort %-9s: fragment MTU too small", "6lowpan");
+            return -EMSGSIZE;
+        }
+
+        memcpy(saved, pktbuf->buf + start - frag_hdr_len, frag_hdr_len);
+        frag = (struct pktbuf){
+            .buf         = pktbuf->buf,
+            .buf_len     = pktbuf->buf_len,
+            .offset_head = start,
+            .offset_tail = end,
+        };
+        if (offset) {
+            pktbuf_push_head_u8(&frag, offset / 8);
+            pktbuf_push_head_be16(&frag, tag);
+            pktbuf_push_head_be16(&frag, LOWPAN_DISPATCH_FRAGN << 8 | size);
+        } else {
+            pktbuf_push_head_be16(&frag, tag);
+            pktbuf_push_head_be16(&frag, LOWPAN_DISPATCH_FRAG1 << 8 | size);
+        }
+        BUG_ON(frag.buf != pktbuf->buf);
+        ret = ipv6->sendto_mac(ipv6, &frag, dst, prio);
+        memcpy(pktbuf->buf + start - frag_hdr_len, saved, frag_hdr_len);
+        if (ret < 0)
+            return ret;
+        start = end;
+    }
+    // Handle of the last fragment
+    return ret;
+}
+
 int lowpan_send(struct ipv6_ctx *ipv6,
                 struct pktbuf *pktbuf,
                 const struct eui64 *src,
-                const struct eui64 *dst)
+                const struct eui64 *dst,
+                int prio)
 {
+    const size_t size = pktbuf_len(pktbuf);
     uint8_t src_iid[8], dst_iid[8];
+    size_t hdr_len;
 
     ipv6_addr_conv_iid_eui64(src_iid, src->u8);
     ipv6_addr_conv_iid_eui64(dst_iid, dst->u8);
 
-    lowpan_iphc_cmpr(pktbuf, src_iid, dst_iid);
+    lowpan_iphc_cmpr(pktbuf, src_iid, dst_iid, ipv6->lowpan.iphc_ctx);
     if (pktbuf->err)
         return -EINVAL;
+    ipv6->lowpan.iphc_tx_count++;
+    ipv6->lowpan.iphc_tx_saved += size - pktbuf_len(pktbuf);
 
-    return ipv6->sendto_mac(ipv6, pktbuf, dst);
+    if (pktbuf_len(pktbuf) <= ipv6->lowpan.frag_mtu)
+        return ipv6->sendto_mac(ipv6, pktbuf, dst, prio);
+
+    if (size > FIELD_MAX(LOWPAN_MASK_FRAG_DGRAM_SIZE)) {
+        TRACE(TR_TX_ABORT, "tx-abort %-9s: packet too big", "6lowpan");
+        return -EMSGSIZE;
+    }
+    // Only the IPv6 header is compressed, the remaining bytes are unchanged
+    hdr_len = pktbuf_len(pktbuf) - (size - sizeof(struct ip6_hdr));
+    return lowpan_send_frag(ipv6, pktbuf, size, hdr_len, dst, prio);
 }
@@ -14,21 +14,67 @@
 #ifndef LOWPAN_H
 #define LOWPAN_H
 
+#include <sys/queue.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
-struct eui64;
+#include "common/ipv6/6lowpan_iphc.h"
+#include "common/eui64.h"
+#include "common/timer.h"
+
 struct ipv6_ctx;
 struct pktbuf;
 
+// RFC 4944 5.3. Fragmentation Type and Header
+#define LOWPAN_REASM_HASH_SIZE 64
+
+struct lowpan_reasm {
+    struct eui64 src;
+    struct eui64 dst;
+    uint16_t tag;
+    uint16_t size;         // datagram_size, uncompressed
+    uint8_t *frag1;        // FRAG1 payload, compressed
+    size_t   frag1_len;
+    uint16_t frag1_size;   // FRAG1 payload, uncompressed, 0 if not received
+    uint8_t *buf;          // Uncompressed datagram, indexed by datagram_offset
+    uint16_t rcvd_size;    // Uncompressed bytes received
+    uint8_t  rcvd[256 / 8]; // Bitmap of received 8-octet units
+    struct timer_entry timer;
+    SLIST_ENTRY(lowpan_reasm) link;
+};
+
+struct lowpan_ctx {
+    // Maximum 6LoWPAN payload in a single 802.15.4 frame
+    int frag_mtu;
+    int reasm_max;
+    int reasm_timeout_ms;
+
+    uint16_t tag;
+    int reasm_count;
+    SLIST_HEAD(, lowpan_reasm) reasm[LOWPAN_REASM_HASH_SIZE];
+    struct timer_group timer_group;
+
+    // RFC 6775 4.2. 6LoWPAN Context Option
+    struct lowpan_iphc_ctx iphc_ctx[LOWPAN_IPHC_CTX_COUNT];
+    struct timer_entry iphc_ctx_timer[LOWPAN_IPHC_CTX_COUNT];
+
+    uint64_t iphc_tx_count;
+    uint64_t iphc_tx_saved; // Header bytes saved by IPHC
+};
+
 void lowpan_recv(struct ipv6_ctx *ipv6,
                  const uint8_t *buf, size_t buf_len,
                  const struct eui64 *src, const struct eui64 *dst);
 
+void lowpan_iphc_ctx_set(struct lowpan_ctx *lowpan, uint8_t cid, bool compress,
+                         const struct in6_addr *prefix, uint8_t prefix_len,
+                         uint64_t lifetime_ms);
+
 int lowpan_send(struct ipv6_ctx *ipv6,
                 struct pktbuf *pktbuf,
                 const struct eui64 *src,
-                const struct eui64 *dst);
+                const struct eui64 *dst,
+                int prio);
 
 #endif
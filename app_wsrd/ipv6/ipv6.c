@@ -30,6 +30,7 @@
 #include "common/sys_queue_extra.h"
 #include "common/specs/icmpv6.h"
 #include "common/specs/ipv6.h"
+#include "common/ws/ws_interface.h"
 #include "app_wsrd/ipv6/6lowpan.h"
 #include "app_wsrd/ipv6/ipv6_addr_mc.h"
 #include "app_wsrd/ipv6/rpl_rpi.h"
@@ -209,6 +210,9 @@ void ipv6_recvfrom_mac(struct ipv6_ctx *ipv6, struct pktbuf *pktbuf, const struc
         case ND_NEIGHBOR_SOLICIT:
             ipv6_recv_ns(ipv6, pktbuf_head(pktbuf), pktbuf_len(pktbuf), &hdr.ip6_src);
             return;
+        case ND_ROUTER_ADVERT:
+            ipv6_recv_ra(ipv6, pktbuf_head(pktbuf), pktbuf_len(pktbuf), &hdr.ip6_src, hdr.ip6_hlim);
+            return;
         // TODO: NA
         default:
             TRACE(TR_DROP, "drop %-9s: unsupported ICMPv6 type %u", "ipv6", icmp->type);
@@ -398,6 +402,25 @@ static bool ipv6_is_pkt_allowed(struct pktbuf *pktbuf)
     return true;
 }
 
+// RPL and ND messages are sent ahead of data traffic.
+static int ipv6_tx_prio(uint8_t ipproto, const void *buf, size_t buf_len)
+{
+    const struct icmpv6_hdr *icmp = buf;
+
+    if (ipproto != IPPROTO_ICMPV6 || buf_len < sizeof(*icmp))
+        return WS_PRIO_DATA;
+    switch (icmp->type) {
+    case ND_ROUTER_SOLICIT:
+    case ND_ROUTER_ADVERT:
+    case ND_NEIGHBOR_SOLICIT:
+    case ND_NEIGHBOR_ADVERT:
+    case ICMPV6_TYPE_RPL:
+        return WS_PRIO_CTRL;
+    default:
+        return WS_PRIO_DATA;
+    }
+}
+
 void ipv6_recvfrom_tun(struct ipv6_ctx *ipv6)
 {
     const struct in6_addr *nxthop;
@@ -427,7 +450,8 @@ void ipv6_recvfrom_tun(struct ipv6_ctx *ipv6)
     TRACE(TR_IPV6, "tx-ipv6 src=%s dst=%s",
           tr_ipv6(hdr->ip6_src.s6_addr), tr_ipv6(hdr->ip6_dst.s6_addr));
 
-    lowpan_send(ipv6, &pktbuf, &ipv6->eui64, &dst_eui64);
+    lowpan_send(ipv6, &pktbuf, &ipv6->eui64, &dst_eui64,
+                ipv6_tx_prio(hdr->ip6_nxt, hdr + 1, pktbuf_len(&pktbuf) - sizeof(*hdr)));
 err:
     pktbuf_free(&pktbuf);
 }
@@ -446,8 +470,9 @@ int ipv6_sendto_mac(struct ipv6_ctx *ipv6, struct pktbuf *pktbuf,
         .ip6_src  = *src,
         .ip6_dst  = *dst,
     };
-    int ret;
+    int prio, ret;
 
+    prio = ipv6_tx_prio(ipproto, pktbuf_head(pktbuf), pktbuf_len(pktbuf));
     pktbuf_push_head(pktbuf, &hdr, sizeof(hdr));
 
     TRACE(TR_IPV6, "tx-ipv6 src=%s dst=%s",
@@ -462,5 +487,5 @@ int ipv6_sendto_mac(struct ipv6_ctx *ipv6, struct pktbuf *pktbuf,
     // TODO: RPL Option
     // TODO: IPv6 Tunnel
 
-    return lowpan_send(ipv6, pktbuf, &ipv6->eui64, &dst_eui64);
+    return lowpan_send(ipv6, pktbuf, &ipv6->eui64, &dst_eui64, prio);
 }
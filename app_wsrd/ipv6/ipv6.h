@@ -14,6 +14,7 @@
 #ifndef WSRD_IPV6_H
 #define WSRD_IPV6_H
 
+#include "app_wsrd/ipv6/6lowpan.h"
 #include "app_wsrd/ipv6/ndp.h"
 #include "app_wsrd/ipv6/rpl.h"
 #include "common/dhcp_client.h"
@@ -37,9 +38,11 @@ struct ipv6_ctx {
     struct eui64 eui64;
 
     struct timer_group timer_group;
+    struct lowpan_ctx lowpan;
     struct rpl_ctx rpl;
 
-    int (*sendto_mac)(struct ipv6_ctx *ipv6, struct pktbuf *pktbuf, const struct eui64 *dst);
+    // prio is a value from enum ws_prio
+    int (*sendto_mac)(struct ipv6_ctx *ipv6, struct pktbuf *pktbuf, const struct eui64 *dst, int prio);
 };
 
 void ipv6_recvfrom_mac(struct ipv6_ctx *ipv6, struct pktbuf *pktbuf, const struct eui64 *src_eui64);
@@ -388,6 +388,81 @@ void ipv6_recv_ns(struct ipv6_ctx *ipv6,
     }
 }
 
+static void ipv6_recv_ra_6co(struct ipv6_ctx *ipv6, const uint8_t *buf, size_t buf_len)
+{
+    const struct ndp_opt_6co *opt = (const struct ndp_opt_6co *)buf;
+
+    //   RFC 6775 4.2. 6LoWPAN Context Option
+    // The Context Length field can have a value from 0 to 128. If it is more
+    // than 64, then the Length field MUST be 3.
+    if (buf_len < sizeof(*opt) + 8 || opt->ctx_len > 128 ||
+        (opt->ctx_len > 64 && buf_len < sizeof(*opt) + 16)) {
+        TRACE(TR_DROP, "drop %-9s: malformed 6co", "ra");
+        return;
+    }
+    TRACE(TR_ICMP, "rx-icmp %-9s cid=%u prefix=%s lifetime=%umin%s", "ra-6co",
+          FIELD_GET(NDP_MASK_6CO_CID, opt->flags),
+          tr_ipv6_prefix(opt->prefix, opt->ctx_len),
+          be16toh(opt->lifetime_minutes),
+          FIELD_GET(NDP_MASK_6CO_C, opt->flags) ? "" : " (decompression only)");
+    lowpan_iphc_ctx_set(&ipv6->lowpan,
+                        FIELD_GET(NDP_MASK_6CO_CID, opt->flags),
+                        FIELD_GET(NDP_MASK_6CO_C, opt->flags),
+                        (const struct in6_addr *)opt->prefix, opt->ctx_len,
+                        (uint64_t)be16toh(opt->lifetime_minutes) * 60 * 1000);
+}
+
+/*
+ *   Wi-SUN FAN 1.1v08 6.2.3.1.4.1 FFN Neighbor Discovery
+ * The Router Solicitation/Router Advertisement exchange described in [RFC6775]
+ * is not used.
+ *
+ * NOTE: Router Advertisements are only processed to learn 6LoWPAN compression
+ * contexts, other options are ignored.
+ */
+void ipv6_recv_ra(struct ipv6_ctx *ipv6,
+                  const uint8_t *buf, size_t buf_len,
+                  const struct in6_addr *src, uint8_t hlim)
+{
+    const struct nd_router_advert *ra;
+    const struct nd_opt_hdr *opt;
+    struct iobuf_read iobuf = {
+        .data      = buf,
+        .data_size = buf_len,
+    };
+
+    TRACE(TR_ICMP, "rx-icmp %-9s src=%s", "ra", tr_ipv6(src->s6_addr));
+
+    // RFC 4861 6.1.2. Validation of Router Advertisement Messages
+    if (hlim != 255) {
+        TRACE(TR_DROP, "drop %-9s: invalid hop limit %u", "ra", hlim);
+        return;
+    }
+    ra = iobuf_pop_data_ptr(&iobuf, sizeof(struct nd_router_advert));
+    if (!ra || ra->nd_ra_code != 0 || !IN6_IS_ADDR_LINKLOCAL(src)) {
+        TRACE(TR_DROP, "drop %-9s: malformed packet", "ra");
+        return;
+    }
+
+    while (iobuf_remaining_size(&iobuf)) {
+        opt = iobuf_pop_data_ptr(&iobuf, sizeof(struct nd_opt_hdr));
+        if (!opt || !opt->nd_opt_len ||
+            !iobuf_pop_data_ptr(&iobuf, opt->nd_opt_len * 8 - sizeof(struct nd_opt_hdr))) {
+            TRACE(TR_DROP, "drop %-9s: malformed packet", "ra");
+            return;
+        }
+        switch (opt->nd_opt_type) {
+        case NDP_OPT_6CO:
+            ipv6_recv_ra_6co(ipv6, (const uint8_t *)(opt + 1),
+                             opt->nd_opt_len * 8 - sizeof(struct nd_opt_hdr));
+            break;
+        default:
+            TRACE(TR_IGNORE, "ignore %-9s: unsupported opt=%u", "ra", opt->nd_opt_type);
+            continue;
+        }
+    }
+}
+
 struct ipv6_neigh *ipv6_neigh_get_from_gua(const struct ipv6_ctx *ipv6,
                                            const struct in6_addr *gua)
 {
@@ -82,6 +82,10 @@ SLIST_HEAD(ipv6_neigh_cache, ipv6_neigh);
 
 struct ipv6_neigh *ipv6_neigh_get_from_eui64(const struct ipv6_ctx *ipv6,
                                              const struct eui64 *eui64);
+void ipv6_recv_ra(struct ipv6_ctx *ipv6,
+                  const uint8_t *buf, size_t buf_len,
+                  const struct in6_addr *src, uint8_t hlim);
+
 struct ipv6_neigh *ipv6_neigh_get_from_gua(const struct ipv6_ctx *ipv6,
                                            const struct in6_addr *gua);
 struct ipv6_neigh *ipv6_neigh_fetch(struct ipv6_ctx *ipv6,
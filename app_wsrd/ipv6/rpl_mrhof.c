@@ -25,7 +25,7 @@ static float rpl_mrhof_etx(const struct rpl_mrhof *mrhof, const struct ipv6_neig
 {
     struct ws_neigh *neigh = ws_neigh_get(mrhof->ws_neigh_table, &nce->eui64);
 
-    return neigh ? neigh->etx : NAN;
+    return neigh ? ws_neigh_hot(mrhof->ws_neigh_table, neigh)->etx : NAN;
 }
 
 // RFC 6719 3.1. Computing the Path Cost
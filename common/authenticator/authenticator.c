@@ -39,6 +39,7 @@
 #include "authenticator_eap.h"
 #include "authenticator_key.h"
 #include "authenticator_radius.h"
+#include "authenticator_rekey.h"
 
 #include "authenticator.h"
 
@@ -153,6 +154,10 @@ static void auth_gtk_install_timer_timeout(struct timer_group *group, struct tim
         auth->on_gtk_change(auth, new->key, slot_install + 1, init);
     TRACE(TR_SECURITY, "sec: installed %s=%s",
           tr_gtkname(slot_install), tr_key(new->key, sizeof(new->key)));
+
+    // Distribute the new key before its activation
+    if (!init && !timer_stopped(&gtk_group->activation_timer))
+        auth_rekey_start(auth, &gtk_group->rekey, slot_install, gtk_group->activation_timer.expire_ms);
 }
 
 void auth_rt_timer_start(struct auth_ctx *auth, struct auth_supp_ctx *supp,
@@ -235,6 +240,7 @@ struct auth_supp_ctx *auth_fetch_supp(struct auth_ctx *auth, const struct eui64
 
     supp = zalloc(sizeof(struct auth_supp_ctx));
     supp->eui64 = *eui64;
+    supp->id = auth->supp_count++;
     supp->radius.id = -1;
     supp->last_installed_key_slot = -1;
     supp->rt_timer.period_ms = auth->timeout_ms,
@@ -357,6 +363,8 @@ void auth_start(struct auth_ctx *auth, const struct eui64 *eui64, bool enable_lf
     auth->lgtk_group.activation_timer.callback = auth_gtk_activation_timer_timeout;
     auth->lgtk_group.install_timer.callback    = auth_gtk_install_timer_timeout;
     auth->lgtk_group.slot_active = 4;
+    auth_rekey_init(&auth->gtk_group.rekey);
+    auth_rekey_init(&auth->lgtk_group.rekey);
     for (int i = 0; i < ARRAY_SIZE(auth->gtks); i++)
         auth->gtks[i].expiration_timer.callback = auth_gtk_expiration_timer_timeout;
 
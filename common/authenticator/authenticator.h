@@ -28,6 +28,7 @@
 
 struct auth_supp_ctx {
     struct eui64 eui64;
+    int id; // Index in struct auth_rekey bitmaps
     uint8_t node_role;
 
     // Retransmissions
@@ -75,9 +76,30 @@ struct auth_node_cfg {
     int ptk_lifetime_s; // 0 for infinite
 };
 
+/*
+ * Group key handshakes initiated by the authenticator when a new GTK is
+ * installed. Progress is tracked with bitmaps indexed by supplicant ID, only
+ * the scheduler owns a timer.
+ */
+struct auth_rekey {
+    struct timer_entry timer;
+    int key_slot; // -1 if no rekey was ever started
+    struct auth_supp_ctx **supps; // Sorted by depth
+    int supps_len;
+    uint8_t *started; // Bitmaps of bitmap_len bits
+    uint8_t *done;
+    int bitmap_len;
+    int started_count;
+    int done_count;
+    uint64_t start_ms;
+    uint64_t end_ms;  // Activation of the key
+    uint64_t done_ms; // 0 while in progress
+};
+
 struct auth_gtk_group {
     struct timer_entry activation_timer;
     struct timer_entry install_timer;
+    struct auth_rekey rekey;
     int slot_active;
 };
 
@@ -108,6 +130,7 @@ struct auth_ctx {
     int eapol_relay_fd;
 
     struct auth_supp_ctx_list supplicants;
+    int supp_count;
     struct timer_group timer_group;
     uint64_t timeout_ms;
 
@@ -125,6 +148,9 @@ struct auth_ctx {
 
     // Called on rx of 4wh msg 4 and gkh msg 2
     void (*on_supp_gtk_installed)(struct auth_ctx *auth, const struct eui64 *eui64, uint8_t index);
+
+    // Optional, used to order group key handshakes, a lower depth goes first
+    int (*get_supp_depth)(struct auth_ctx *auth, const struct auth_supp_ctx *supp);
 };
 
 #ifndef HAVE_AUTH_LEGACY
@@ -37,6 +37,7 @@
 
 #include "authenticator.h"
 #include "authenticator_eap.h"
+#include "authenticator_rekey.h"
 
 #include "authenticator_key.h"
 
@@ -246,8 +247,8 @@ static void auth_key_write_key_data(struct auth_ctx *auth, const struct auth_sup
     pktbuf_free(&key_data);
 }
 
-static void auth_key_group_message_1_send(struct auth_ctx *auth, struct auth_supp_ctx *supp,
-                                          int key_slot)
+void auth_key_group_message_1_send(struct auth_ctx *auth, struct auth_supp_ctx *supp,
+                                   int key_slot)
 {
     struct eapol_key_frame message = {
         .descriptor_type = EAPOL_IEEE80211_KEY_DESCRIPTOR_TYPE,
@@ -310,6 +311,7 @@ static int auth_key_handshake_done(struct auth_ctx *auth, struct auth_supp_ctx *
         }
     }
     supp->last_installed_key_slot = -1;
+    auth_rekey_update(auth, supp);
 
     next_key_slot = auth_key_get_key_slot_missmatch(auth, supp);
     if (next_key_slot != -1)
@@ -531,6 +533,10 @@ static void auth_key_request_recv(struct auth_ctx *auth, struct auth_supp_ctx *s
     }
 
     if (supp_gtkl != auth_key_get_gtkl(auth->gtks, ARRAY_SIZE(auth->gtks))) {
+        if (!auth_rekey_admit(auth, supp)) {
+            TRACE(TR_DROP, "drop %-9s: group key distribution congested", "key-req");
+            return;
+        }
         TRACE(TR_SECURITY, "sec: gtkl out-of-date starting 2wh");
         next_key_slot = auth_key_get_key_slot_missmatch(auth, supp);
         auth_key_group_message_1_send(auth, supp, next_key_slot);
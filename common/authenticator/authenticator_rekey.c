@@ -0,0 +1,253 @@
+/*
+ * SPDX-License-Identifier: LicenseRef-MSLA
+ * Copyright (c) 2025 Silicon Laboratories Inc. (www.silabs.com)
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of the Silicon Labs Master Software License
+ * Agreement (MSLA) available at [1].  This software is distributed to you in
+ * Object Code format and/or Source Code format and is governed by the sections
+ * of the MSLA applicable to Object Code, Source Code and Modified Open Source
+ * Code. By using this software, you agree to the terms of the MSLA.
+ *
+ * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
+ */
+#define _DEFAULT_SOURCE
+#include <netinet/in.h>
+#include <inttypes.h>
+#include <stdlib.h>
+
+#include "common/specs/ws.h"
+#include "common/time_extra.h"
+#include "common/string_extra.h"
+#include "common/mathutils.h"
+#include "common/memutils.h"
+#include "common/bits.h"
+#include "common/log.h"
+
+#include "authenticator.h"
+#include "authenticator_key.h"
+
+#include "authenticator_rekey.h"
+
+struct auth_rekey_entry {
+    int depth;
+    struct auth_supp_ctx *supp;
+};
+
+static bool auth_rekey_in_progress(const struct auth_rekey *rekey)
+{
+    return !timer_stopped(&rekey->timer);
+}
+
+static bool auth_rekey_supp_has_key(const struct auth_supp_ctx *supp, int key_slot)
+{
+    if (key_slot < WS_GTK_COUNT)
+        return supp->gtkl & BIT(key_slot);
+    else
+        return supp->lgtkl & BIT(key_slot - WS_GTK_COUNT);
+}
+
+static bool auth_rekey_supp_needs_key(const struct auth_supp_ctx *supp, int key_slot)
+{
+    // Same rules as auth_key_get_key_slot_missmatch()
+    if (key_slot < WS_GTK_COUNT && supp->node_role == WS_NR_ROLE_LFN)
+        return false;
+    if (key_slot >= WS_GTK_COUNT && supp->node_role == WS_NR_ROLE_UNKNOWN)
+        return false;
+    // The group key handshake is protected by the PTK
+    if (!memzcmp(supp->eap_tls.tls.ptk.key, sizeof(supp->eap_tls.tls.ptk.key)))
+        return false;
+    return !auth_rekey_supp_has_key(supp, key_slot);
+}
+
+static int auth_rekey_entry_cmp(const void *a, const void *b)
+{
+    const struct auth_rekey_entry *e1 = a;
+    const struct auth_rekey_entry *e2 = b;
+
+    return (e1->depth > e2->depth) - (e1->depth < e2->depth);
+}
+
+static int auth_rekey_get_inflight(const struct auth_rekey *rekey,
+                                   const struct auth_supp_ctx *inflight[AUTH_REKEY_INFLIGHT_MAX])
+{
+    const struct auth_supp_ctx *supp;
+    int inflight_len = 0;
+
+    for (int i = 0; i < rekey->supps_len && inflight_len < AUTH_REKEY_INFLIGHT_MAX; i++) {
+        supp = rekey->supps[i];
+        if (bittest(rekey->started, supp->id) && !bittest(rekey->done, supp->id) &&
+            !timer_stopped(&supp->rt_timer))
+            inflight[inflight_len++] = supp;
+    }
+    return inflight_len;
+}
+
+static bool auth_rekey_can_start(const struct auth_supp_ctx *inflight[AUTH_REKEY_INFLIGHT_MAX],
+                                 int inflight_len, const struct auth_supp_ctx *supp)
+{
+    int parent_count = 0;
+
+    if (inflight_len >= AUTH_REKEY_INFLIGHT_MAX)
+        return false;
+    // Supplicants directly connected share the unspecified address
+    for (int i = 0; i < inflight_len; i++)
+        if (IN6_ARE_ADDR_EQUAL(&inflight[i]->eapol_target, &supp->eapol_target))
+            parent_count++;
+    return parent_count < AUTH_REKEY_PARENT_INFLIGHT_MAX;
+}
+
+static void auth_rekey_finish(struct auth_ctx *auth, struct auth_rekey *rekey)
+{
+    rekey->done_ms = time_now_ms(CLOCK_MONOTONIC);
+    timer_stop(&auth->timer_group, &rekey->timer);
+    TRACE(TR_SECURITY, "sec: rekey %s done=%d/%d started=%d duration=%"PRIu64"s",
+          tr_gtkname(rekey->key_slot), rekey->done_count, rekey->supps_len,
+          rekey->started_count, (rekey->done_ms - rekey->start_ms) / 1000);
+}
+
+static void auth_rekey_timer_timeout(struct timer_group *group, struct timer_entry *timer)
+{
+    struct auth_rekey *rekey = container_of(timer, struct auth_rekey, timer);
+    struct auth_ctx *auth = container_of(group, struct auth_ctx, timer_group);
+    const struct auth_supp_ctx *inflight[AUTH_REKEY_INFLIGHT_MAX];
+    const uint64_t now_ms = time_now_ms(CLOCK_MONOTONIC);
+    struct auth_supp_ctx *supp;
+    int inflight_len;
+    int target;
+
+    if (now_ms >= rekey->end_ms) {
+        auth_rekey_finish(auth, rekey);
+        return;
+    }
+
+    // Number of handshakes expected to be started at this point
+    if (now_ms - rekey->start_ms >= (rekey->end_ms - rekey->start_ms) / 2)
+        target = rekey->supps_len;
+    else
+        target = (uint64_t)rekey->supps_len * (now_ms - rekey->start_ms) * 2 /
+                 (rekey->end_ms - rekey->start_ms) + 1;
+
+    inflight_len = auth_rekey_get_inflight(rekey, inflight);
+    for (int i = 0; i < rekey->supps_len && rekey->started_count < target; i++) {
+        supp = rekey->supps[i];
+        if (bittest(rekey->started, supp->id))
+            continue;
+        // Another exchange is in progress with this supplicant
+        if (!timer_stopped(&supp->rt_timer))
+            continue;
+        if (!auth_rekey_can_start(inflight, inflight_len, supp)) {
+            if (inflight_len >= AUTH_REKEY_INFLIGHT_MAX)
+                break;
+            continue;
+        }
+        bitset(rekey->started, supp->id);
+        rekey->started_count++;
+        auth_key_group_message_1_send(auth, supp, rekey->key_slot);
+        inflight[inflight_len++] = supp;
+    }
+    timer_start_rel(group, timer, AUTH_REKEY_TICK_MS);
+}
+
+void auth_rekey_init(struct auth_rekey *rekey)
+{
+    rekey->timer.callback = auth_rekey_timer_timeout;
+    rekey->key_slot = -1;
+}
+
+void auth_rekey_start(struct auth_ctx *auth, struct auth_rekey *rekey, int key_slot, uint64_t end_ms)
+{
+    struct auth_rekey_entry *entries;
+    struct auth_supp_ctx *supp;
+    int n = 0;
+
+    // A new key supersedes the one being distributed
+    if (auth_rekey_in_progress(rekey))
+        auth_rekey_finish(auth, rekey);
+    free(rekey->supps);
+    free(rekey->started);
+    free(rekey->done);
+
+    rekey->key_slot   = key_slot;
+    rekey->bitmap_len = auth->supp_count;
+    rekey->started    = zalloc(roundup(rekey->bitmap_len, 8) / 8 + 1);
+    rekey->done       = zalloc(roundup(rekey->bitmap_len, 8) / 8 + 1);
+    entries = zalloc(sizeof(*entries) * (auth->supp_count + 1));
+    SLIST_FOREACH(supp, &auth->supplicants, link) {
+        if (!auth_rekey_supp_needs_key(supp, key_slot)) {
+            bitset(rekey->started, supp->id);
+            bitset(rekey->done, supp->id);
+            continue;
+        }
+        entries[n].depth = auth->get_supp_depth ? auth->get_supp_depth(auth, supp) : 0;
+        entries[n].supp  = supp;
+        n++;
+    }
+    qsort(entries, n, sizeof(*entries), auth_rekey_entry_cmp);
+    rekey->supps = zalloc(sizeof(*rekey->supps) * (n + 1));
+    for (int i = 0; i < n; i++)
+        rekey->supps[i] = entries[i].supp;
+    free(entries);
+
+    rekey->supps_len     = n;
+    rekey->started_count = 0;
+    rekey->done_count    = 0;
+    rekey->start_ms      = time_now_ms(CLOCK_MONOTONIC);
+    rekey->end_ms        = end_ms;
+    rekey->done_ms       = 0;
+    TRACE(TR_SECURITY, "sec: rekey %s supplicants=%d window=%"PRIu64"s", tr_gtkname(key_slot), n,
+          end_ms > rekey->start_ms ? (end_ms - rekey->start_ms) / 1000 : 0);
+    if (!n || end_ms <= rekey->start_ms)
+        rekey->done_ms = rekey->start_ms;
+    else
+        timer_start_rel(&auth->timer_group, &rekey->timer, AUTH_REKEY_TICK_MS);
+}
+
+bool auth_rekey_admit(struct auth_ctx *auth, struct auth_supp_ctx *supp)
+{
+    struct auth_rekey *rekeys[] = { &auth->gtk_group.rekey, &auth->lgtk_group.rekey };
+    const struct auth_supp_ctx *inflight[AUTH_REKEY_INFLIGHT_MAX];
+    bool admit[ARRAY_SIZE(rekeys)] = { };
+    struct auth_rekey *rekey;
+    int inflight_len;
+
+    // Nothing is marked unless every rekey in progress accepts the handshake
+    for (int i = 0; i < ARRAY_SIZE(rekeys); i++) {
+        rekey = rekeys[i];
+        if (!auth_rekey_in_progress(rekey) || supp->id >= rekey->bitmap_len ||
+            bittest(rekey->started, supp->id))
+            continue;
+        inflight_len = auth_rekey_get_inflight(rekey, inflight);
+        if (!auth_rekey_can_start(inflight, inflight_len, supp))
+            return false;
+        admit[i] = true;
+    }
+    for (int i = 0; i < ARRAY_SIZE(rekeys); i++) {
+        if (!admit[i])
+            continue;
+        bitset(rekeys[i]->started, supp->id);
+        rekeys[i]->started_count++;
+    }
+    return true;
+}
+
+void auth_rekey_update(struct auth_ctx *auth, struct auth_supp_ctx *supp)
+{
+    struct auth_rekey *rekeys[] = { &auth->gtk_group.rekey, &auth->lgtk_group.rekey };
+    struct auth_rekey *rekey;
+
+    for (int i = 0; i < ARRAY_SIZE(rekeys); i++) {
+        rekey = rekeys[i];
+        if (!auth_rekey_in_progress(rekey) || supp->id >= rekey->bitmap_len ||
+            bittest(rekey->done, supp->id) || !auth_rekey_supp_has_key(supp, rekey->key_slot))
+            continue;
+        if (!bittest(rekey->started, supp->id)) {
+            bitset(rekey->started, supp->id);
+            rekey->started_count++;
+        }
+        bitset(rekey->done, supp->id);
+        rekey->done_count++;
+        if (rekey->done_count == rekey->supps_len)
+            auth_rekey_finish(auth, rekey);
+    }
+}
@@ -0,0 +1,48 @@
+/*
+ * SPDX-License-Identifier: LicenseRef-MSLA
+ * Copyright (c) 2025 Silicon Laboratories Inc. (www.silabs.com)
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of the Silicon Labs Master Software License
+ * Agreement (MSLA) available at [1].  This software is distributed to you in
+ * Object Code format and/or Source Code format and is governed by the sections
+ * of the MSLA applicable to Object Code, Source Code and Modified Open Source
+ * Code. By using this software, you agree to the terms of the MSLA.
+ *
+ * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
+ */
+#ifndef AUTHENTICATOR_REKEY_H
+#define AUTHENTICATOR_REKEY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * When a new GTK is installed, every supplicant notices the new GTK hash at
+ * about the same time and requests a group key handshake. On large networks,
+ * this causes a burst of EAPOL frames. Instead, the authenticator distributes
+ * the new key by itself:
+ * - supplicants are sorted by depth so EAPOL relays get the key before their
+ *   children,
+ * - handshakes are paced over the first half of the time left before the key
+ *   activation, the second half is left for retransmissions,
+ * - the number of concurrent handshakes is limited, globally and per EAPOL
+ *   relay. Handshakes requested by supplicants are subject to the same limits.
+ */
+
+#define AUTH_REKEY_TICK_MS             1000
+#define AUTH_REKEY_INFLIGHT_MAX          32
+#define AUTH_REKEY_PARENT_INFLIGHT_MAX    4
+
+struct auth_ctx;
+struct auth_rekey;
+struct auth_supp_ctx;
+
+void auth_rekey_init(struct auth_rekey *rekey);
+void auth_rekey_start(struct auth_ctx *auth, struct auth_rekey *rekey, int key_slot, uint64_t end_ms);
+// Return false if a group key handshake requested by supp must be delayed
+bool auth_rekey_admit(struct auth_ctx *auth, struct auth_supp_ctx *supp);
+// Called when the GTKL of supp is updated
+void auth_rekey_update(struct auth_ctx *auth, struct auth_supp_ctx *supp);
+
+#endif
@@ -15,10 +15,16 @@
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <sys/random.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <dirent.h>
+#include <errno.h>
 #include <fcntl.h>
+#include <glob.h>
+#include <inttypes.h>
+#include <limits.h>
 #include <stdint.h>
 #include <stdlib.h>
-#include <sys/uio.h>
 #include <unistd.h>
 
 #include "common/bits.h"
@@ -27,6 +33,7 @@
 #include "common/endian.h"
 #include "common/hif.h"
 #include "common/iobuf.h"
+#include "common/key_value_storage.h"
 #include "common/log.h"
 #include "common/memutils.h"
 #include "common/time_extra.h"
@@ -37,6 +44,17 @@ struct capture_ctxt {
     int recfd;
     int *netfd_list;
     int netfd_cnt;
+
+    char filename[PATH_MAX];
+    uint64_t offset;
+    uint64_t start_ms;
+
+    // Checkpoints
+    FILE *index;
+    const char *const *storage_files;
+    uint64_t checkpoint_interval_ms;
+    uint64_t checkpoint_last_ms;
+    int checkpoint_count;
 };
 
 // The functions that this module wraps provide no way to retrieve this context
@@ -64,19 +82,88 @@ static void capture_record(struct capture_ctxt *ctxt, const void *buf, size_t bu
     FATAL_ON(ret < 0, 2, "%s: write: %m", __func__);
     if (ret != sizeof(hdr) + buf_len + sizeof(fcs))
         FATAL(2 ,"%s: write: Short write", __func__);
+    ctxt->offset += ret;
+}
+
+static void capture_copy_file(const char *src, const char *dst)
+{
+    uint8_t buf[4096];
+    int fd_src, fd_dst;
+    ssize_t ret;
+
+    fd_src = open(src, O_RDONLY);
+    if (fd_src < 0) {
+        WARN("open %s: %m", src);
+        return;
+    }
+    fd_dst = open(dst, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd_dst < 0) {
+        WARN("open %s: %m", dst);
+        close(fd_src);
+        return;
+    }
+    while ((ret = read(fd_src, buf, sizeof(buf))) > 0)
+        FATAL_ON(write(fd_dst, buf, ret) != ret, 2, "write %s: %m", dst);
+    WARN_ON(ret < 0, "read %s: %m", src);
+    close(fd_src);
+    close(fd_dst);
+}
+
+static void capture_checkpoint(struct capture_ctxt *ctxt, uint64_t now_ms)
+{
+    char path[PATH_MAX + 64];
+    char dir[PATH_MAX + 32];
+    size_t prefix_len;
+    glob_t globbuf;
+    int ret;
+
+    ctxt->checkpoint_last_ms = now_ms;
+    ctxt->checkpoint_count++;
+    snprintf(dir, sizeof(dir), "%s.ckpt/%d", ctxt->filename, ctxt->checkpoint_count);
+    if (mkdir(dir, 0777) < 0 && errno != EEXIST) {
+        WARN("mkdir %s: %m", dir);
+        return;
+    }
+    prefix_len = strlen(g_storage_prefix);
+    for (const char *const *files = ctxt->storage_files; *files; files++) {
+        snprintf(path, sizeof(path), "%s%s", g_storage_prefix, *files);
+        ret = glob(path, 0, NULL, &globbuf);
+        if (ret == GLOB_NOMATCH)
+            continue;
+        if (ret) {
+            WARN("glob %s returned an error", path);
+            continue;
+        }
+        for (int i = 0; globbuf.gl_pathv[i]; i++) {
+            snprintf(path, sizeof(path), "%s/%s", dir, globbuf.gl_pathv[i] + prefix_len);
+            capture_copy_file(globbuf.gl_pathv[i], path);
+        }
+        globfree(&globbuf);
+    }
+    // The checkpoint is committed only once the storage has been copied
+    fprintf(ctxt->index, "checkpoint %d %"PRIu64" %"PRIu64"\n",
+            ctxt->checkpoint_count, now_ms, ctxt->offset);
+    fflush(ctxt->index);
 }
 
 static void capture_record_timers(struct capture_ctxt *ctxt)
 {
     struct iobuf_write iobuf = { };
     struct timespec ts;
+    uint64_t now_ms;
     int ret;
 
     ret = clock_gettime(CLOCK_MONOTONIC, &ts);
     FATAL_ON(ret < 0, 2, "clock_gettime: %m");
 
+    // Checkpoints are placed before a timer record so replay restarts with a
+    // consistent time.
+    now_ms = time_now_ms(CLOCK_MONOTONIC);
+    if (ctxt->index && now_ms - ctxt->checkpoint_last_ms >= ctxt->checkpoint_interval_ms)
+        capture_checkpoint(ctxt, now_ms);
+
     hif_push_u8(&iobuf, HIF_CMD_IND_REPLAY_TIMER);
-    hif_push_u64(&iobuf, time_now_ms(CLOCK_MONOTONIC));
+    hif_push_u64(&iobuf, now_ms);
     capture_record(ctxt, iobuf.data, iobuf.len);
     iobuf_free(&iobuf);
 }
@@ -288,4 +375,82 @@ void capture_start(const char *filename)
                        S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
     if (ctxt->recfd < 0)
         FATAL(2, "open %s: %m", filename);
+    snprintf(ctxt->filename, sizeof(ctxt->filename), "%s", filename);
+    ctxt->start_ms = time_now_ms(CLOCK_MONOTONIC);
+}
+
+void capture_start_checkpoints(const char *const storage_files[], int interval_s)
+{
+    struct capture_ctxt *ctxt = &g_capture_ctxt;
+    char path[PATH_MAX + 16];
+
+    BUG_ON(ctxt->recfd < 0);
+    if (!g_storage_prefix)
+        return;
+    snprintf(path, sizeof(path), "%s.ckpt", ctxt->filename);
+    FATAL_ON(mkdir(path, 0777) < 0 && errno != EEXIST, 2, "mkdir %s: %m", path);
+    snprintf(path, sizeof(path), "%s.idx", ctxt->filename);
+    ctxt->index = fopen(path, "w");
+    FATAL_ON(!ctxt->index, 2, "open %s: %m", path);
+    ctxt->storage_files = storage_files;
+    ctxt->checkpoint_interval_ms = interval_s * 1000ull;
+    ctxt->checkpoint_last_ms = time_now_ms(CLOCK_MONOTONIC);
+    fprintf(ctxt->index, "start %"PRIu64"\n", ctxt->start_ms);
+    fprintf(ctxt->index, "init %"PRIu64"\n", ctxt->offset);
+    fflush(ctxt->index);
+}
+
+bool capture_seek(const char *filename, uint64_t time_s, struct capture_seek *seek)
+{
+    char path[PATH_MAX + 16];
+    uint64_t start_ms = 0;
+    uint64_t time_ms, offset;
+    char line[256];
+    bool found = false;
+    FILE *index;
+    int id;
+
+    snprintf(path, sizeof(path), "%s.idx", filename);
+    index = fopen(path, "r");
+    FATAL_ON(!index, 2, "open %s: %m", path);
+    while (fgets(line, sizeof(line), index)) {
+        if (sscanf(line, "start %"SCNu64, &start_ms) == 1)
+            continue;
+        if (sscanf(line, "init %"SCNu64, &seek->init_end) == 1)
+            continue;
+        if (sscanf(line, "checkpoint %d %"SCNu64" %"SCNu64, &id, &time_ms, &offset) != 3)
+            FATAL(1, "%s: invalid line: %s", path, line);
+        if (time_ms > start_ms + time_s * 1000)
+            break;
+        seek->index   = id;
+        seek->time_ms = time_ms;
+        seek->offset  = offset;
+        found = true;
+    }
+    fclose(index);
+    if (found)
+        seek->time_ms -= start_ms;
+    return found;
+}
+
+void capture_restore_checkpoint(const char *filename, int index)
+{
+    char src[PATH_MAX + 300];
+    char dst[PATH_MAX + 300];
+    char dir[PATH_MAX + 32];
+    struct dirent *entry;
+    DIR *dirp;
+
+    BUG_ON(!g_storage_prefix);
+    snprintf(dir, sizeof(dir), "%s.ckpt/%d", filename, index);
+    dirp = opendir(dir);
+    FATAL_ON(!dirp, 2, "opendir %s: %m", dir);
+    while ((entry = readdir(dirp))) {
+        if (entry->d_name[0] == '.')
+            continue;
+        snprintf(src, sizeof(src), "%s/%s", dir, entry->d_name);
+        snprintf(dst, sizeof(dst), "%s%s", g_storage_prefix, entry->d_name);
+        capture_copy_file(src, dst);
+    }
+    closedir(dirp);
 }
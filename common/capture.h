@@ -15,8 +15,16 @@
 #define CAPTURE_H
 
 #include <sys/socket.h>
+#include <stdbool.h>
 #include <stdint.h>
 
+struct capture_seek {
+    uint64_t init_end; // Offset of the end of the RCP initialization sequence
+    uint64_t offset;   // Offset of the checkpoint
+    uint64_t time_ms;  // Time of the checkpoint relative to the capture start
+    int index;
+};
+
 /*
  * Event capture module. Stores HIF packets to a raw binary file, and inserts
  * special commands to record timer ticks and external network events such as
@@ -29,6 +37,15 @@
  * read()/write() and write data to the capture file only after capture_start()
  * is called to set the output file. Finally, all random number generation must
  * use xgetrandom() to ensure reproducibility.
+ *
+ * Checkpoints allow to replay a capture from the middle. Once the RCP
+ * initialization sequence is complete, capture_start_checkpoints() regularly
+ * copies the storage files (the only serialized form of the daemon state) to
+ * FILE.ckpt/<n>/, and appends their location in the capture to FILE.idx. To
+ * seek, the replay feeds the initialization sequence, restores the storage of
+ * the selected checkpoint, and continues from the checkpoint offset. The state
+ * reached is the one the daemon would have after a restart at that time: not
+ * identical to the original run, but reproducible.
  */
 
 ssize_t xread(int fd, void *buf, size_t buf_len);
@@ -48,5 +65,11 @@ ssize_t xgetrandom(void *buf, size_t buf_len, unsigned int flags);
 void capture_register_netfd(int fd);
 void capture_record_hif(const void *buf, size_t buf_len);
 void capture_start(const char *filename);
+void capture_start_checkpoints(const char *const storage_files[], int interval_s);
+
+// Find the last checkpoint before time_s (relative to the capture start).
+// Returns false if there is none.
+bool capture_seek(const char *filename, uint64_t time_s, struct capture_seek *seek);
+void capture_restore_checkpoint(const char *filename, int index);
 
 #endif
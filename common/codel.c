@@ -0,0 +1,92 @@
+/*
+ * SPDX-License-Identifier: LicenseRef-MSLA
+ * Copyright (c) 2025 Silicon Laboratories Inc. (www.silabs.com)
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of the Silicon Labs Master Software License
+ * Agreement (MSLA) available at [1].  This software is distributed to you in
+ * Object Code format and/or Source Code format and is governed by the sections
+ * of the MSLA applicable to Object Code, Source Code and Modified Open Source
+ * Code. By using this software, you agree to the terms of the MSLA.
+ *
+ * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
+ */
+#include "codel.h"
+
+static uint32_t codel_isqrt(uint32_t val)
+{
+    uint32_t res = 0;
+    uint32_t bit = 1u << 30;
+
+    while (bit > val)
+        bit >>= 2;
+    while (bit) {
+        if (val >= res + bit) {
+            val -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return res;
+}
+
+static uint64_t codel_control_law(const struct codel_cfg *cfg, uint64_t t_us, uint32_t count)
+{
+    return t_us + (uint64_t)cfg->interval_ms * 1000 / codel_isqrt(count);
+}
+
+static bool codel_ok_to_drop(struct codel *codel, const struct codel_cfg *cfg,
+                             uint64_t sojourn_us, uint64_t now_us, bool backlog)
+{
+    if (sojourn_us < (uint64_t)cfg->target_ms * 1000 || !backlog) {
+        codel->first_above_us = 0;
+        return false;
+    }
+    if (!codel->first_above_us) {
+        codel->first_above_us = now_us + (uint64_t)cfg->interval_ms * 1000;
+        return false;
+    }
+    return now_us >= codel->first_above_us;
+}
+
+bool codel_dequeue(struct codel *codel, const struct codel_cfg *cfg,
+                   uint64_t sojourn_us, uint64_t now_us, bool backlog)
+{
+    bool ok_to_drop;
+    uint32_t delta;
+
+    if (!cfg->target_ms)
+        return false;
+    ok_to_drop = codel_ok_to_drop(codel, cfg, sojourn_us, now_us, backlog);
+    if (codel->dropping) {
+        if (!ok_to_drop) {
+            codel->dropping = false;
+            return false;
+        }
+        if (now_us < codel->drop_next_us)
+            return false;
+        codel->count++;
+        codel->drop_next_us = codel_control_law(cfg, codel->drop_next_us, codel->count);
+        codel->drops++;
+        return true;
+    }
+    if (!ok_to_drop)
+        return false;
+    /*
+     * If we recently left the dropping state, resume with a drop rate close
+     * to the previous one rather than starting over.
+     */
+    codel->dropping = true;
+    delta = codel->count - codel->lastcount;
+    if (delta > 1 && (now_us < codel->drop_next_us ||
+                      now_us - codel->drop_next_us < 16ull * cfg->interval_ms * 1000))
+        codel->count = delta;
+    else
+        codel->count = 1;
+    codel->lastcount = codel->count;
+    codel->drop_next_us = codel_control_law(cfg, now_us, codel->count);
+    codel->drops++;
+    return true;
+}
@@ -0,0 +1,53 @@
+/*
+ * SPDX-License-Identifier: LicenseRef-MSLA
+ * Copyright (c) 2025 Silicon Laboratories Inc. (www.silabs.com)
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of the Silicon Labs Master Software License
+ * Agreement (MSLA) available at [1].  This software is distributed to you in
+ * Object Code format and/or Source Code format and is governed by the sections
+ * of the MSLA applicable to Object Code, Source Code and Modified Open Source
+ * Code. By using this software, you agree to the terms of the MSLA.
+ *
+ * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
+ */
+#ifndef COMMON_CODEL_H
+#define COMMON_CODEL_H
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Controlled Delay (CoDel) active queue management, as specified by RFC 8289.
+ * Instead of the queue length, CoDel looks at the time spent by packets in the
+ * queue (sojourn time). When the sojourn time stays above the target for more
+ * than an interval, packets are dropped at dequeue with an increasing rate
+ * (interval / sqrt(count)) until the sojourn time goes back below the target.
+ *
+ * The state does not reference the queue, so one struct codel can be attached
+ * to each flow (ie. each next hop) of a shared queue.
+ */
+
+struct codel_cfg {
+    uint32_t target_ms;   // 0 disables CoDel
+    uint32_t interval_ms;
+};
+
+struct codel {
+    uint64_t first_above_us;
+    uint64_t drop_next_us;
+    uint32_t count;
+    uint32_t lastcount;
+    bool dropping;
+    uint64_t drops;       // Statistics only
+};
+
+/*
+ * To be called for each packet leaving the queue. backlog must be set when
+ * other packets of the same flow are still waiting (RFC 8289 checks that the
+ * queue holds more than one MTU). Returns true if the packet must be dropped,
+ * in which case the caller is expected to call again for the next packet.
+ */
+bool codel_dequeue(struct codel *codel, const struct codel_cfg *cfg,
+                   uint64_t sojourn_us, uint64_t now_us, bool backlog);
+
+#endif
@@ -38,6 +38,34 @@ void dbus_emit_change(const char *property_name)
         WARN("sd_bus_emit_properties_changed \"%s\": %s", property_name, strerror(-ret));
 }
 
+sd_bus_message *dbus_signal_new(const char *member)
+{
+    struct dbus_ctx *dbus_ctx = &g_dbus;
+    sd_bus_message *m;
+    int ret;
+
+    if (!dbus_ctx->dbus || !dbus_ctx->path)
+        return NULL;
+    ret = sd_bus_message_new_signal(dbus_ctx->dbus, &m, dbus_ctx->path,
+                                    dbus_ctx->interface, member);
+    if (ret < 0) {
+        WARN("sd_bus_message_new_signal \"%s\": %s", member, strerror(-ret));
+        return NULL;
+    }
+    return m;
+}
+
+void dbus_signal_send(sd_bus_message *m)
+{
+    struct dbus_ctx *dbus_ctx = &g_dbus;
+    int ret;
+
+    ret = sd_bus_send(dbus_ctx->dbus, m, NULL);
+    if (ret < 0)
+        WARN("sd_bus_send: %s", strerror(-ret));
+    sd_bus_message_unref(m);
+}
+
 void dbus_register(const char *name, const char *path, const char *interface,
                    const struct sd_bus_vtable *vtable, void *app_ctxt)
 {
@@ -15,6 +15,7 @@
 #define COMMON_DBUS_H
 
 struct sd_bus_vtable;
+struct sd_bus_message;
 
 #ifdef HAVE_LIBSYSTEMD
 
@@ -25,6 +26,11 @@ int dbus_process(void);
 
 void dbus_emit_change(const char *property_name);
 
+// Return a signal message on the registered object, or NULL if D-Bus is not
+// available. dbus_signal_send() releases the message.
+struct sd_bus_message *dbus_signal_new(const char *member);
+void dbus_signal_send(struct sd_bus_message *m);
+
 #else
 
 #include "common/log.h"
@@ -49,6 +55,15 @@ static inline void dbus_emit_change(const char *property_name)
 {
 }
 
+static inline struct sd_bus_message *dbus_signal_new(const char *member)
+{
+    return NULL;
+}
+
+static inline void dbus_signal_send(struct sd_bus_message *m)
+{
+}
+
 #endif
 
 #endif
@@ -20,6 +20,7 @@
 #include <fcntl.h>
 
 #include "common/ns_list.h"
+#include "common/histogram.h"
 #include "common/log.h"
 #include "common/memutils.h"
 
@@ -64,6 +65,11 @@ int8_t event_handler_create(void (*handler_func_ptr)(struct event_payload *))
     return new->id;
 }
 
+static unsigned int event_ring_len(const struct events_scheduler *ctxt)
+{
+    return ctxt->event_ring_head - ctxt->event_ring_tail;
+}
+
 int8_t event_send(const struct event_payload *event)
 {
     struct events_scheduler *ctxt = g_event_scheduler;
@@ -73,9 +79,17 @@ int8_t event_send(const struct event_payload *event)
     if (!event_tasklet_handler_get(event->receiver))
         return -1;
 
-    event_dup = xalloc(sizeof(struct event_payload));
-    memcpy(event_dup, event, sizeof(struct event_payload));
-    ns_list_add_to_end(&ctxt->event_queue, event_dup);
+    if (ns_list_is_empty(&ctxt->event_queue) && event_ring_len(ctxt) < EVENT_QUEUE_SIZE) {
+        ctxt->event_ring[ctxt->event_ring_head % EVENT_QUEUE_SIZE] = *event;
+        ctxt->event_ring_head++;
+    } else {
+        event_dup = xalloc(sizeof(struct event_payload));
+        memcpy(event_dup, event, sizeof(struct event_payload));
+        ns_list_add_to_end(&ctxt->event_queue, event_dup);
+        ctxt->event_queue_len++;
+    }
+    if (ctxt->depth_hist)
+        histogram_add(ctxt->depth_hist, event_ring_len(ctxt) + ctxt->event_queue_len);
     event_scheduler_signal();
     return 0;
 }
@@ -83,27 +97,42 @@ int8_t event_send(const struct event_payload *event)
 bool event_scheduler_dispatch_event(void)
 {
     struct events_scheduler *ctxt = g_event_scheduler;
-    struct event_payload *event = ns_list_get_first(&ctxt->event_queue);
+    struct event_payload *event_dup;
     struct event_tasklet *tasklet;
+    struct event_payload event;
 
     BUG_ON(!ctxt);
-    if (!event)
-        return false;
-    ns_list_remove(&ctxt->event_queue, event);
-    tasklet = event_tasklet_handler_get(event->receiver);
-    if (tasklet) {
-        tasklet->func_ptr(event);
+    if (event_ring_len(ctxt)) {
+        // Copy the event out of the ring so the handler can post new events
+        event = ctxt->event_ring[ctxt->event_ring_tail % EVENT_QUEUE_SIZE];
+        ctxt->event_ring_tail++;
+    } else if (!ns_list_is_empty(&ctxt->event_queue)) {
+        event_dup = ns_list_get_first(&ctxt->event_queue);
+        ns_list_remove(&ctxt->event_queue, event_dup);
+        ctxt->event_queue_len--;
+        event = *event_dup;
+        free(event_dup);
     } else {
-        WARN();
+        return false;
     }
-    free(event);
+    tasklet = event_tasklet_handler_get(event.receiver);
+    if (tasklet)
+        tasklet->func_ptr(&event);
+    else
+        WARN();
 
     return true;
 }
 
 void event_scheduler_run_until_idle(void)
 {
+    struct events_scheduler *ctxt = g_event_scheduler;
+
+    // The loop is awake: events posted by the handlers are processed below
+    // without going through the pipe.
+    ctxt->signaled = true;
     while (event_scheduler_dispatch_event());
+    ctxt->signaled = false;
 }
 
 void event_scheduler_signal()
@@ -111,6 +140,9 @@ void event_scheduler_signal()
     struct events_scheduler *ctxt = g_event_scheduler;
     uint64_t val = 'W';
 
+    if (ctxt->signaled)
+        return;
+    ctxt->signaled = true;
     write(ctxt->event_fd[1], &val, sizeof(val));
 }
 
@@ -127,4 +159,8 @@ void event_scheduler_init(struct events_scheduler *ctxt)
 
     ns_list_init(&ctxt->event_queue);
     ns_list_init(&ctxt->event_tasklet_list);
+    ctxt->event_ring_head = 0;
+    ctxt->event_ring_tail = 0;
+    ctxt->event_queue_len = 0;
+    ctxt->signaled = false;
 }
@@ -18,6 +18,19 @@
 
 #include "common/ns_list.h"
 
+struct histogram;
+
+/*
+ * Events are stored by value in a fixed size ring embedded in the scheduler,
+ * so posting an event does not allocate. If the ring is full, events are
+ * allocated and appended to an overflow list, which is drained before the
+ * ring accepts new events again in order to preserve the FIFO order.
+ *
+ * The pipe is only written when the main loop is not already going to process
+ * the queue (ie. no signal is pending and no dispatch is in progress).
+ */
+#define EVENT_QUEUE_SIZE 64 // Power of 2
+
 struct event_payload {
     int8_t receiver;    /* Tasklet ID */
     uint8_t event_id;
@@ -33,8 +46,15 @@ struct event_tasklet {
 
 struct events_scheduler {
     int event_fd[2];
+    bool signaled;
     NS_LIST_HEAD(struct event_tasklet, link) event_tasklet_list;
-    NS_LIST_HEAD(struct event_payload, link) event_queue;
+    struct event_payload event_ring[EVENT_QUEUE_SIZE];
+    unsigned int event_ring_head; // Free running indexes
+    unsigned int event_ring_tail;
+    NS_LIST_HEAD(struct event_payload, link) event_queue; // Overflow
+    int event_queue_len;
+    // Optional, records the queue depth on each event_send()
+    struct histogram *depth_hist;
 };
 
 /**
@@ -71,7 +91,7 @@ void event_scheduler_signal(void);
  * a pointer to a copy of the data, not the original pointer.
  *
  * \return 0 Event push OK
- * \return -1 Memory allocation Fail
+ * \return -1 Unknown receiver
  */
 int8_t event_send(const struct event_payload *event);
 
@@ -33,6 +33,7 @@ enum {
     HIF_CMD_REQ_DATA_TX_ABORT        = 0x11,
     HIF_CMD_CNF_DATA_TX              = 0x12,
     HIF_CMD_IND_DATA_RX              = 0x13,
+    HIF_CMD_SET_NEIGH_SLOT           = 0x14,
     HIF_CMD_REQ_RADIO_ENABLE         = 0x20,
     HIF_CMD_REQ_RADIO_LIST           = 0x21,
     HIF_CMD_CNF_RADIO_LIST           = 0x22,
@@ -81,6 +82,7 @@ enum hif_fatal_code {
     HIF_EINVAL_SCF           = 0x100f,
     HIF_EINVAL_FRAME         = 0x1010,
     HIF_EINVAL_CHAN_FIXED    = 0x1011,
+    HIF_EINVAL_NEIGH_SLOT    = 0x1012,
     HIF_ENOTSUP              = 0x2000,
     HIF_ENOTSUP_FHSS_DEFAULT = 0x2001,
 };
@@ -118,6 +120,7 @@ enum hif_mode_switch_type {
 };
 
 #define HIF_KEY_COUNT 8
+#define HIF_NEIGH_SLOT_COUNT 8
 
 const char *hif_cmd_str(uint8_t cmd);
 const char *hif_fatal_str(uint16_t code);
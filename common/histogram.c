@@ -0,0 +1,78 @@
+/*
+ * SPDX-License-Identifier: LicenseRef-MSLA
+ * Copyright (c) 2025 Silicon Laboratories Inc. (www.silabs.com)
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of the Silicon Labs Master Software License
+ * Agreement (MSLA) available at [1].  This software is distributed to you in
+ * Object Code format and/or Source Code format and is governed by the sections
+ * of the MSLA applicable to Object Code, Source Code and Modified Open Source
+ * Code. By using this software, you agree to the terms of the MSLA.
+ *
+ * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
+ */
+#include <inttypes.h>
+
+#include "common/mathutils.h"
+
+#include "histogram.h"
+
+static int histogram_index(uint64_t val)
+{
+    int exp;
+
+    if (val < (1u << HISTOGRAM_SUB_BITS))
+        return val;
+    exp = 63 - __builtin_clzll(val);
+    return ((exp - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS) +
+           ((val >> (exp - HISTOGRAM_SUB_BITS)) & ((1u << HISTOGRAM_SUB_BITS) - 1));
+}
+
+static uint64_t histogram_low(int index)
+{
+    int exp = (index >> HISTOGRAM_SUB_BITS) + HISTOGRAM_SUB_BITS - 1;
+    uint64_t mant = index & ((1u << HISTOGRAM_SUB_BITS) - 1);
+
+    if (index < (1 << HISTOGRAM_SUB_BITS))
+        return index;
+    return ((1ull << HISTOGRAM_SUB_BITS) | mant) << (exp - HISTOGRAM_SUB_BITS);
+}
+
+static uint64_t histogram_high(int index)
+{
+    if (index + 1 == HISTOGRAM_BUCKET_COUNT)
+        return UINT64_MAX;
+    return histogram_low(index + 1) - 1;
+}
+
+void histogram_add(struct histogram *hist, uint64_t val)
+{
+    hist->buckets[histogram_index(val)]++;
+    hist->count++;
+    hist->max = MAX(hist->max, val);
+}
+
+uint64_t histogram_quantile(const struct histogram *hist, double quantile)
+{
+    uint64_t target, sum = 0;
+
+    if (!hist->count)
+        return 0;
+    target = quantile * hist->count;
+    if (target < 1)
+        target = 1;
+    for (int i = 0; i < HISTOGRAM_BUCKET_COUNT; i++) {
+        sum += hist->buckets[i];
+        if (sum >= target)
+            return MIN(histogram_high(i), hist->max);
+    }
+    return hist->max;
+}
+
+void histogram_dump(const struct histogram *hist, FILE *stream)
+{
+    for (int i = 0; i < HISTOGRAM_BUCKET_COUNT; i++)
+        if (hist->buckets[i])
+            fprintf(stream, "%"PRIu64" %"PRIu64" %"PRIu32"\n",
+                    histogram_low(i), MIN(histogram_high(i), hist->max), hist->buckets[i]);
+}
@@ -0,0 +1,44 @@
+/*
+ * SPDX-License-Identifier: LicenseRef-MSLA
+ * Copyright (c) 2025 Silicon Laboratories Inc. (www.silabs.com)
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of the Silicon Labs Master Software License
+ * Agreement (MSLA) available at [1].  This software is distributed to you in
+ * Object Code format and/or Source Code format and is governed by the sections
+ * of the MSLA applicable to Object Code, Source Code and Modified Open Source
+ * Code. By using this software, you agree to the terms of the MSLA.
+ *
+ * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
+ */
+#ifndef COMMON_HISTOGRAM_H
+#define COMMON_HISTOGRAM_H
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Log-linear histogram in the spirit of HDR Histogram[1]. Values below
+ * 2^HISTOGRAM_SUB_BITS are counted exactly. Above, each power of 2 is split in
+ * 2^HISTOGRAM_SUB_BITS linear buckets, so the relative error on percentiles
+ * is bounded to 1/2^HISTOGRAM_SUB_BITS (6.25%) over the full 64-bit range.
+ * Recording a value is O(1) and does not allocate.
+ *
+ * [1]: https://hdrhistogram.github.io/HdrHistogram/
+ */
+
+#define HISTOGRAM_SUB_BITS     4
+#define HISTOGRAM_BUCKET_COUNT ((64 - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS)
+
+struct histogram {
+    uint64_t count;
+    uint64_t max;
+    uint32_t buckets[HISTOGRAM_BUCKET_COUNT];
+};
+
+void histogram_add(struct histogram *hist, uint64_t val);
+// quantile is in [0, 1]. Returns the upper bound of the matching bucket.
+uint64_t histogram_quantile(const struct histogram *hist, double quantile);
+// Print non-empty buckets as "<low> <high> <count>" lines
+void histogram_dump(const struct histogram *hist, FILE *stream);
+
+#endif
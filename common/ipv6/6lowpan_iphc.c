@@ -29,6 +29,35 @@
 
 #include "6lowpan_iphc.h"
 
+static void lowpan_iphc_prefix_cpy(struct in6_addr *addr, const struct in6_addr *prefix, uint8_t len)
+{
+    memcpy(addr->s6_addr, prefix->s6_addr, len / 8);
+    if (len % 8)
+        addr->s6_addr[len / 8] = (addr->s6_addr[len / 8] & ~(0xff00 >> (len % 8))) |
+                                 (prefix->s6_addr[len / 8] & (0xff00 >> (len % 8)));
+}
+
+static bool lowpan_iphc_prefix_match(const struct in6_addr *addr, const struct in6_addr *prefix, uint8_t len)
+{
+    if (memcmp(addr->s6_addr, prefix->s6_addr, len / 8))
+        return false;
+    if (len % 8 && (addr->s6_addr[len / 8] ^ prefix->s6_addr[len / 8]) & (0xff00 >> (len % 8)))
+        return false;
+    return true;
+}
+
+static const struct lowpan_iphc_ctx *lowpan_iphc_ctx_get(struct pktbuf *pktbuf,
+                                                         const struct lowpan_iphc_ctx *ctx_table,
+                                                         uint8_t cid)
+{
+    if (!ctx_table || !ctx_table[cid].valid) {
+        TRACE(TR_DROP, "drop %-9s: unknown context %u", "6lowpan", cid);
+        pktbuf->err = true;
+        return NULL;
+    }
+    return &ctx_table[cid];
+}
+
 // RFC 6282 - 3.2.1. Traffic Class and Flow Label Compression
 static uint32_t lowpan_iphc_decmpr_vtcflow(struct pktbuf *pktbuf, uint16_t base)
 {
@@ -156,33 +185,103 @@ static void lowpan_iphc_decmpr_maddr_stless(struct pktbuf *pktbuf, struct in6_ad
     }
 }
 
+// RFC 6282 - 3.2.2. Context-Based Address Compression (SAC=1, DAC=1)
+static void lowpan_iphc_decmpr_addr_stful(struct pktbuf *pktbuf, struct in6_addr *addr,
+                                          uint8_t mode, const uint8_t iid[8],
+                                          const struct lowpan_iphc_ctx *ctx)
+{
+    memset(addr, 0, sizeof(*addr));
+    switch (mode) {
+    case 0b01:
+        // 01: 64 bits. The address is derived using context information and
+        // the 64 bits carried in-line.
+        pktbuf_pop_head(pktbuf, addr->s6_addr + 8, 8);
+        break;
+    case 0b10:
+        // 10: 16 bits. The address is derived using context information and
+        // the 16 bits carried in-line. Any IID bits not covered by context
+        // information are taken directly from their corresponding bits in
+        // the 16-bit to IID mapping given by 0000:00ff:fe00:XXXX.
+        memcpy(addr->s6_addr + 8, (uint8_t[6]){ 0x00, 0x00, 0x00, 0xff, 0xfe, 0x00 }, 6);
+        pktbuf_pop_head(pktbuf, addr->s6_addr + 14, 2);
+        break;
+    case 0b11:
+        // 11: 0 bits. The address is fully elided and is derived using context
+        // information and the encapsulating header.
+        memcpy(addr->s6_addr + 8, iid, 8);
+        break;
+    default:
+        BUG();
+    }
+    // Bits covered by context information are always used.
+    lowpan_iphc_prefix_cpy(addr, &ctx->prefix, ctx->prefix_len);
+}
+
+// RFC 6282 - 3.2.4. Context-Based Multicast Address Compression (M=1, DAC=1)
+static void lowpan_iphc_decmpr_maddr_stful(struct pktbuf *pktbuf, struct in6_addr *addr,
+                                           uint8_t mode, const struct lowpan_iphc_ctx *ctx)
+{
+    if (mode != 0b00) {
+        TRACE(TR_DROP, "drop %-9s: reserved DAM=%u", "6lowpan", mode);
+        pktbuf->err = true;
+        return;
+    }
+    // 00: 48 bits. The multicast address takes the form
+    // ffXX:XXLL:PPPP:PPPP:PPPP:PPPP:XXXX:XXXX.
+    addr->s6_addr[0] = 0xff;
+    pktbuf_pop_head(pktbuf, addr->s6_addr + 1, 2);
+    addr->s6_addr[3] = ctx->prefix_len;
+    memcpy(addr->s6_addr + 4, ctx->prefix.s6_addr, 8);
+    pktbuf_pop_head(pktbuf, addr->s6_addr + 12, 4);
+}
+
 static void lowpan_iphc_decmpr_src(struct pktbuf *pktbuf, struct in6_addr *addr,
-                                   uint16_t base, const uint8_t iid[8])
+                                   uint16_t base, uint8_t cid, const uint8_t iid[8],
+                                   const struct lowpan_iphc_ctx *ctx_table)
 {
     const uint8_t mode = FIELD_GET(LOWPAN_MASK_IPHC_SAM, base);
+    const struct lowpan_iphc_ctx *ctx;
 
-    if (FIELD_GET(LOWPAN_MASK_IPHC_SAC, base)) {
-        TRACE(TR_DROP, "drop %-9s: unsupported stateful compression", "6lowpan");
-        pktbuf->err = true;
+    if (!FIELD_GET(LOWPAN_MASK_IPHC_SAC, base)) {
+        lowpan_iphc_decmpr_addr_stless(pktbuf, addr, mode, iid);
+        return;
+    }
+    if (mode == 0b00) {
+        // 00: The UNSPECIFIED address, ::
+        memset(addr, 0, sizeof(*addr));
         return;
     }
-    lowpan_iphc_decmpr_addr_stless(pktbuf, addr, mode, iid);
+    ctx = lowpan_iphc_ctx_get(pktbuf, ctx_table, FIELD_GET(LOWPAN_MASK_IPHC_SCI, cid));
+    if (ctx)
+        lowpan_iphc_decmpr_addr_stful(pktbuf, addr, mode, iid, ctx);
 }
 
 static void lowpan_iphc_decmpr_dst(struct pktbuf *pktbuf, struct in6_addr *addr,
-                                   uint16_t base, const uint8_t iid[8])
+                                   uint16_t base, uint8_t cid, const uint8_t iid[8],
+                                   const struct lowpan_iphc_ctx *ctx_table)
 {
     const uint8_t mode = FIELD_GET(LOWPAN_MASK_IPHC_DAM, base);
+    const struct lowpan_iphc_ctx *ctx;
 
-    if (FIELD_GET(LOWPAN_MASK_IPHC_DAC, base)) {
-        TRACE(TR_DROP, "drop %-9s: unsupported stateful compression", "6lowpan");
+    if (!FIELD_GET(LOWPAN_MASK_IPHC_DAC, base)) {
+        if (FIELD_GET(LOWPAN_MASK_IPHC_M, base))
+            lowpan_iphc_decmpr_maddr_stless(pktbuf, addr, mode);
+        else
+            lowpan_iphc_decmpr_addr_stless(pktbuf, addr, mode, iid);
+        return;
+    }
+    if (!FIELD_GET(LOWPAN_MASK_IPHC_M, base) && mode == 0b00) {
+        TRACE(TR_DROP, "drop %-9s: reserved DAC=1 DAM=00", "6lowpan");
         pktbuf->err = true;
         return;
     }
+    ctx = lowpan_iphc_ctx_get(pktbuf, ctx_table, FIELD_GET(LOWPAN_MASK_IPHC_DCI, cid));
+    if (!ctx)
+        return;
     if (FIELD_GET(LOWPAN_MASK_IPHC_M, base))
-        lowpan_iphc_decmpr_maddr_stless(pktbuf, addr, mode);
+        lowpan_iphc_decmpr_maddr_stful(pktbuf, addr, mode, ctx);
     else
-        lowpan_iphc_decmpr_addr_stless(pktbuf, addr, mode, iid);
+        lowpan_iphc_decmpr_addr_stful(pktbuf, addr, mode, iid, ctx);
 }
 
 static uint8_t lowpan_nhc_nxthdr(struct pktbuf *pktbuf)
@@ -211,11 +310,13 @@ static uint8_t lowpan_nhc_nxthdr(struct pktbuf *pktbuf)
     return 0;
 }
 
-static void lowpan_nhc_decmpr(struct pktbuf *pktbuf, const struct in6_addr *src, const struct in6_addr *dst);
+static void lowpan_nhc_decmpr(struct pktbuf *pktbuf, const struct in6_addr *src, const struct in6_addr *dst,
+                              const struct lowpan_iphc_ctx *ctx_table);
 
 // RFC 6282 - 4.2. IPv6 Extension Header Compression
 static void lowpan_nhc_decmpr_exthdr(struct pktbuf *pktbuf, uint8_t nhc,
-                                     const struct in6_addr *src, const struct in6_addr *dst)
+                                     const struct in6_addr *src, const struct in6_addr *dst,
+                                     const struct lowpan_iphc_ctx *ctx_table)
 {
     struct ip6_ext hdr;
     uint8_t pad;
@@ -226,7 +327,7 @@ static void lowpan_nhc_decmpr_exthdr(struct pktbuf *pktbuf, uint8_t nhc,
     // the LOWPAN_NHC encoding is unused and MUST be set to zero. The following
     // bytes MUST be encoded using LOWPAN_IPHC.
     if (FIELD_GET(LOWPAN_MASK_NHC_EXTHDR_EID, nhc) == LOWPAN_NHC_EID_IPV6) {
-        lowpan_iphc_decmpr(pktbuf, src->s6_addr + 8, dst->s6_addr + 8); // WARN: recursivity
+        lowpan_iphc_decmpr(pktbuf, src->s6_addr + 8, dst->s6_addr + 8, ctx_table); // WARN: recursivity
         return;
     }
 
@@ -238,7 +339,7 @@ static void lowpan_nhc_decmpr_exthdr(struct pktbuf *pktbuf, uint8_t nhc,
 
     if (FIELD_GET(LOWPAN_MASK_NHC_EXTHDR_NH, nhc)) {
         hdr.ip6e_nxt = lowpan_nhc_nxthdr(pktbuf);
-        lowpan_nhc_decmpr(pktbuf, src, dst); // WARN: recursivity
+        lowpan_nhc_decmpr(pktbuf, src, dst, ctx_table); // WARN: recursivity
     }
 
     //   RFC 6282 - 4.2. IPv6 Extension Header Compression
@@ -320,13 +421,14 @@ static void lowpan_nhc_decmpr_udp(struct pktbuf *pktbuf, uint8_t nhc,
     }
 }
 
-static void lowpan_nhc_decmpr(struct pktbuf *pktbuf, const struct in6_addr *src, const struct in6_addr *dst)
+static void lowpan_nhc_decmpr(struct pktbuf *pktbuf, const struct in6_addr *src, const struct in6_addr *dst,
+                              const struct lowpan_iphc_ctx *ctx_table)
 {
     uint8_t nhc;
 
     nhc = pktbuf_pop_head_u8(pktbuf);
     if (LOWPAN_NHC_IS_EXTHDR(nhc)) {
-        lowpan_nhc_decmpr_exthdr(pktbuf, nhc, src, dst);
+        lowpan_nhc_decmpr_exthdr(pktbuf, nhc, src, dst, ctx_table);
     } else if (LOWPAN_NHC_IS_UDP(nhc)) {
         lowpan_nhc_decmpr_udp(pktbuf, nhc, src, dst);
     } else {
@@ -337,26 +439,28 @@ static void lowpan_nhc_decmpr(struct pktbuf *pktbuf, const struct in6_addr *src,
 
 void lowpan_iphc_decmpr(struct pktbuf *pktbuf,
                         const uint8_t src_iid[8],
-                        const uint8_t dst_iid[8])
+                        const uint8_t dst_iid[8],
+                        const struct lowpan_iphc_ctx *ctx_table)
 {
     struct ip6_hdr hdr;
     uint16_t base;
+    uint8_t cid;
 
     base = pktbuf_pop_head_be16(pktbuf);
-    if (FIELD_GET(LOWPAN_MASK_IPHC_CID, base)) {
-        TRACE(TR_DROP, "drop %-9s: unsupported stateful compression", "6lowpan");
-        pktbuf->err = true;
-        return;
-    }
+    // RFC 6282 - 3.1.2. Context Identifier Extension
+    if (FIELD_GET(LOWPAN_MASK_IPHC_CID, base))
+        cid = pktbuf_pop_head_u8(pktbuf);
+    else
+        cid = 0;
     hdr.ip6_flow = htonl(lowpan_iphc_decmpr_vtcflow(pktbuf, base));
     if (!FIELD_GET(LOWPAN_MASK_IPHC_NH, base))
         hdr.ip6_nxt = pktbuf_pop_head_u8(pktbuf);
     hdr.ip6_hlim = lowpan_iphc_decmpr_hlim(pktbuf, base);
-    lowpan_iphc_decmpr_src(pktbuf, &hdr.ip6_src, base, src_iid);
-    lowpan_iphc_decmpr_dst(pktbuf, &hdr.ip6_dst, base, dst_iid);
+    lowpan_iphc_decmpr_src(pktbuf, &hdr.ip6_src, base, cid, src_iid, ctx_table);
+    lowpan_iphc_decmpr_dst(pktbuf, &hdr.ip6_dst, base, cid, dst_iid, ctx_table);
     if (FIELD_GET(LOWPAN_MASK_IPHC_NH, base)) {
         hdr.ip6_nxt = lowpan_nhc_nxthdr(pktbuf);
-        lowpan_nhc_decmpr(pktbuf, &hdr.ip6_src, &hdr.ip6_dst);
+        lowpan_nhc_decmpr(pktbuf, &hdr.ip6_src, &hdr.ip6_dst, ctx_table);
     }
     hdr.ip6_plen = htons(pktbuf_len(pktbuf));
 
@@ -453,6 +557,79 @@ static uint8_t lowpan_iphc_cmpr_addr_stless(struct pktbuf *pktbuf,
     }
 }
 
+/*
+ * Return the context with the longest prefix matching addr, among the ones
+ * allowed for compression.
+ */
+static int lowpan_iphc_ctx_lookup(const struct lowpan_iphc_ctx *ctx_table,
+                                  const struct in6_addr *addr)
+{
+    int cid = -1;
+
+    if (!ctx_table)
+        return -1;
+    for (int i = 0; i < LOWPAN_IPHC_CTX_COUNT; i++) {
+        if (!ctx_table[i].valid || !ctx_table[i].compress)
+            continue;
+        if (cid >= 0 && ctx_table[i].prefix_len <= ctx_table[cid].prefix_len)
+            continue;
+        if (lowpan_iphc_prefix_match(addr, &ctx_table[i].prefix, ctx_table[i].prefix_len))
+            cid = i;
+    }
+    return cid;
+}
+
+// RFC 6282 - 3.2.2. Context-Based Address Compression (SAC=1, DAC=1)
+static int lowpan_iphc_cmpr_addr_stful(struct pktbuf *pktbuf,
+                                       const struct in6_addr *addr,
+                                       const uint8_t iid[8],
+                                       const struct lowpan_iphc_ctx *ctx)
+{
+    struct in6_addr tmp = { };
+
+    // 11: 0 bits.
+    memcpy(tmp.s6_addr + 8, iid, 8);
+    lowpan_iphc_prefix_cpy(&tmp, &ctx->prefix, ctx->prefix_len);
+    if (IN6_ARE_ADDR_EQUAL(&tmp, addr))
+        return 0b11;
+
+    // 10: 16 bits.
+    memcpy(tmp.s6_addr + 8, (uint8_t[6]){ 0x00, 0x00, 0x00, 0xff, 0xfe, 0x00 }, 6);
+    memcpy(tmp.s6_addr + 14, addr->s6_addr + 14, 2);
+    lowpan_iphc_prefix_cpy(&tmp, &ctx->prefix, ctx->prefix_len);
+    if (IN6_ARE_ADDR_EQUAL(&tmp, addr)) {
+        pktbuf_push_head(pktbuf, addr->s6_addr + 14, 2);
+        return 0b10;
+    }
+
+    // 01: 64 bits. Bits not covered by the context in the first 64 bits are
+    // assumed to be zero.
+    memset(tmp.s6_addr, 0, 8);
+    memcpy(tmp.s6_addr + 8, addr->s6_addr + 8, 8);
+    lowpan_iphc_prefix_cpy(&tmp, &ctx->prefix, ctx->prefix_len);
+    if (IN6_ARE_ADDR_EQUAL(&tmp, addr)) {
+        pktbuf_push_head(pktbuf, addr->s6_addr + 8, 8);
+        return 0b01;
+    }
+    return -1;
+}
+
+// RFC 6282 - 3.2.4. Context-Based Multicast Address Compression (M=1, DAC=1)
+static int lowpan_iphc_ctx_lookup_mcast(const struct lowpan_iphc_ctx *ctx_table,
+                                        const struct in6_addr *addr)
+{
+    if (!ctx_table)
+        return -1;
+    // RFC 3306: ffXX:XXLL:PPPP:PPPP:PPPP:PPPP:XXXX:XXXX
+    for (int i = 0; i < LOWPAN_IPHC_CTX_COUNT; i++)
+        if (ctx_table[i].valid && ctx_table[i].compress &&
+            ctx_table[i].prefix_len <= 64 &&
+            addr->s6_addr[3] == ctx_table[i].prefix_len &&
+            !memcmp(addr->s6_addr + 4, ctx_table[i].prefix.s6_addr, 8))
+            return i;
+    return -1;
+}
+
 // RFC 6282 - 3.2.3. Stateless Multicast Address Compression
 static uint8_t lowpan_iphc_cmpr_maddr_stless(struct pktbuf *pktbuf,
                                              const struct in6_addr *addr)
@@ -481,24 +658,60 @@ static uint8_t lowpan_iphc_cmpr_maddr_stless(struct pktbuf *pktbuf,
 
 void lowpan_iphc_cmpr(struct pktbuf *pktbuf,
                       const uint8_t src_iid[8],
-                      const uint8_t dst_iid[8])
+                      const uint8_t dst_iid[8],
+                      const struct lowpan_iphc_ctx *ctx_table)
 {
     uint16_t base = htons(LOWPAN_DISPATCH_IPHC);
+    uint8_t sci = 0, dci = 0;
     struct ip6_hdr hdr;
-    uint8_t field;
+    int field, cid;
 
     pktbuf_pop_head(pktbuf, &hdr, sizeof(hdr));
     BUG_ON(pktbuf->err);
 
+    field = -1;
     if (IN6_IS_ADDR_MULTICAST(&hdr.ip6_dst)) {
-        field = lowpan_iphc_cmpr_maddr_stless(pktbuf, &hdr.ip6_dst);
+        cid = lowpan_iphc_ctx_lookup_mcast(ctx_table, &hdr.ip6_dst);
+        if (cid >= 0) {
+            // 00: 48 bits. ffXX:XXLL:PPPP:PPPP:PPPP:PPPP:XXXX:XXXX
+            pktbuf_push_head(pktbuf, hdr.ip6_dst.s6_addr + 12, 4);
+            pktbuf_push_head(pktbuf, hdr.ip6_dst.s6_addr + 1, 2);
+            field = 0b00;
+            base |= LOWPAN_MASK_IPHC_DAC;
+            dci = cid;
+        } else {
+            field = lowpan_iphc_cmpr_maddr_stless(pktbuf, &hdr.ip6_dst);
+        }
         base |= LOWPAN_MASK_IPHC_M;
-    } else {
-        field = lowpan_iphc_cmpr_addr_stless(pktbuf, &hdr.ip6_dst, dst_iid);
+    } else if (memcmp(&hdr.ip6_dst, ipv6_prefix_linklocal.s6_addr, 8)) {
+        cid = lowpan_iphc_ctx_lookup(ctx_table, &hdr.ip6_dst);
+        if (cid >= 0)
+            field = lowpan_iphc_cmpr_addr_stful(pktbuf, &hdr.ip6_dst, dst_iid, &ctx_table[cid]);
+        if (field >= 0) {
+            base |= LOWPAN_MASK_IPHC_DAC;
+            dci = cid;
+        }
     }
+    if (field < 0)
+        field = lowpan_iphc_cmpr_addr_stless(pktbuf, &hdr.ip6_dst, dst_iid);
     base |= FIELD_PREP(LOWPAN_MASK_IPHC_DAM, field);
 
-    field = lowpan_iphc_cmpr_addr_stless(pktbuf, &hdr.ip6_src, src_iid);
+    field = -1;
+    if (IN6_IS_ADDR_UNSPECIFIED(&hdr.ip6_src)) {
+        // 00: The UNSPECIFIED address, ::
+        field = 0b00;
+        base |= LOWPAN_MASK_IPHC_SAC;
+    } else if (memcmp(&hdr.ip6_src, ipv6_prefix_linklocal.s6_addr, 8)) {
+        cid = lowpan_iphc_ctx_lookup(ctx_table, &hdr.ip6_src);
+        if (cid >= 0)
+            field = lowpan_iphc_cmpr_addr_stful(pktbuf, &hdr.ip6_src, src_iid, &ctx_table[cid]);
+        if (field >= 0) {
+            base |= LOWPAN_MASK_IPHC_SAC;
+            sci = cid;
+        }
+    }
+    if (field < 0)
+        field = lowpan_iphc_cmpr_addr_stless(pktbuf, &hdr.ip6_src, src_iid);
     base |= FIELD_PREP(LOWPAN_MASK_IPHC_SAM, field);
 
     field = lowpan_iphc_cmpr_hlim(pktbuf, hdr.ip6_hlim);
@@ -510,5 +723,11 @@ void lowpan_iphc_cmpr(struct pktbuf *pktbuf,
     field = lowpan_iphc_cmpr_vtcflow(pktbuf, ntohl(hdr.ip6_flow));
     base |= FIELD_PREP(LOWPAN_MASK_IPHC_TF, field);
 
+    // RFC 6282 - 3.1.2. Context Identifier Extension
+    if (sci || dci) {
+        pktbuf_push_head_u8(pktbuf, FIELD_PREP(LOWPAN_MASK_IPHC_SCI, sci) |
+                                    FIELD_PREP(LOWPAN_MASK_IPHC_DCI, dci));
+        base |= LOWPAN_MASK_IPHC_CID;
+    }
     pktbuf_push_head_be16(pktbuf, base);
 }
@@ -20,12 +20,31 @@
 
 struct pktbuf;
 
+// RFC 6282 3.1.1. Base Format: 4-bit context identifiers
+#define LOWPAN_IPHC_CTX_COUNT 16
+
+/*
+ * Context table for stateful address compression, typically learned from the
+ * 6LoWPAN Context Option (RFC 6775 4.2). Contexts with compress = false are
+ * only used for decompression. Functions accept ctx_table = NULL to restrict
+ * to stateless compression, otherwise an array of LOWPAN_IPHC_CTX_COUNT
+ * entries indexed by CID is expected.
+ */
+struct lowpan_iphc_ctx {
+    bool valid;
+    bool compress;
+    uint8_t prefix_len;
+    struct in6_addr prefix;
+};
+
 void lowpan_iphc_decmpr(struct pktbuf *pktbuf,
                         const uint8_t src_iid[8],
-                        const uint8_t dst_iid[8]);
+                        const uint8_t dst_iid[8],
+                        const struct lowpan_iphc_ctx *ctx_table);
 
 void lowpan_iphc_cmpr(struct pktbuf *pktbuf,
                       const uint8_t src_iid[8],
-                      const uint8_t dst_iid[8]);
+                      const uint8_t dst_iid[8],
+                      const struct lowpan_iphc_ctx *ctx_table);
 
 #endif
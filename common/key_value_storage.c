@@ -15,6 +15,7 @@
 #include <string.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <libgen.h>
 #include <errno.h>
 #include <glob.h>
@@ -47,7 +48,16 @@ struct storage_parse_info *storage_open(const char *filename, const char *mode)
 
     info = zalloc(sizeof(struct storage_parse_info));
     strlcpy(info->filename, filename, sizeof(info->filename));
-    info->file = fopen(info->filename, mode);
+    // Files are never updated in place: the new content is written to a
+    // temporary file which replaces the previous one on storage_close(). Thus,
+    // a crash in the middle of a write leaves the previous version intact.
+    if (mode[0] == 'w') {
+        info->replace = true;
+        snprintf(info->tmpname, sizeof(info->tmpname), "%s.tmp", filename);
+        info->file = fopen(info->tmpname, mode);
+    } else {
+        info->file = fopen(info->filename, mode);
+    }
     if (!info->file) {
         free(info);
         return NULL;
@@ -70,15 +80,50 @@ struct storage_parse_info *storage_open_prefix(const char *filename, const char
     return info;
 }
 
+int storage_sync(struct storage_parse_info *info)
+{
+    BUG_ON(!info);
+    BUG_ON(!info->file);
+    // The rename done by storage_close() must also reach the disk
+    info->sync = true;
+    if (fflush(info->file))
+        return -1;
+    return fsync(fileno(info->file));
+}
+
+static int storage_sync_dir(const char *filename)
+{
+    char *tmp = strdupa(filename);
+    int fd, ret;
+
+    fd = open(dirname(tmp), O_RDONLY | O_DIRECTORY);
+    if (fd < 0)
+        return -1;
+    ret = fsync(fd);
+    close(fd);
+    return ret;
+}
+
 int storage_close(struct storage_parse_info *info)
 {
-    FILE *file;
+    int ret;
 
     BUG_ON(!info);
     BUG_ON(!info->file);
-    file = info->file;
+    ret = fclose(info->file);
+    if (info->replace) {
+        if (!ret)
+            ret = rename(info->tmpname, info->filename);
+        if (ret) {
+            WARN("%s: %m", info->filename);
+            unlink(info->tmpname);
+        } else if (info->sync) {
+            ret = storage_sync_dir(info->filename);
+            WARN_ON(ret, "%s: fsync: %m", info->filename);
+        }
+    }
     free(info);
-    return fclose(file);
+    return ret;
 }
 
 static char *storage_get_line(struct storage_parse_info *info)
@@ -123,28 +168,46 @@ int storage_parse_line(struct storage_parse_info *info)
     return 0;
 }
 
-void storage_delete(const char *files[])
+static void storage_unlink(const char *pattern)
 {
-    char filename[PATH_MAX];
     glob_t globbuf;
     int ret;
 
+    ret = glob(pattern, 0, NULL, &globbuf);
+    if (ret == GLOB_NOMATCH)
+        return;
+    if (ret) {
+        WARN("glob %s returned an error", pattern);
+        return;
+    }
+    for (int i = 0; globbuf.gl_pathv[i]; i++) {
+        ret = unlink(globbuf.gl_pathv[i]);
+        WARN_ON(ret < 0, "unlink %s: %m", globbuf.gl_pathv[i]);
+    }
+    globfree(&globbuf);
+}
+
+void storage_delete(const char *files[])
+{
+    char filename[PATH_MAX];
+
     if (!g_storage_prefix)
         return;
 
     for (; *files; files++) {
         snprintf(filename, sizeof(filename), "%s%s", g_storage_prefix, *files);
-        ret = glob(filename, 0, NULL, &globbuf);
-        if (ret == GLOB_NOMATCH) {
-            continue;
-        } else if (ret) {
-            WARN("glob %s returned an error", filename);
-            return;
-        }
-        for (int i = 0; globbuf.gl_pathv[i]; i++) {
-            ret = unlink(globbuf.gl_pathv[i]);
-            WARN_ON(ret < 0, "unlink %s: %m", globbuf.gl_pathv[i]);
-        }
-        globfree(&globbuf);
+        storage_unlink(filename);
     }
 }
+
+void storage_delete_tmp(void)
+{
+    char filename[PATH_MAX];
+
+    if (!g_storage_prefix)
+        return;
+
+    // Left by a crash between storage_open() and storage_close()
+    snprintf(filename, sizeof(filename), "%s*.tmp", g_storage_prefix);
+    storage_unlink(filename);
+}
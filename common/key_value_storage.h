@@ -24,6 +24,11 @@
  *
  * If storage_open() fail, error can be read from errno.
  *
+ * Files opened for writing are replaced atomically by storage_close(). Call
+ * storage_sync() before storage_close() if the new content must also survive a
+ * power loss, storage_close() then also syncs the directory after the rename.
+ * Temporary files left by a crash are removed with storage_delete_tmp().
+ *
  * To parse an existing file, parse_line() can be called until it returns EOF
  * (= -1). Function storage_parse_line() fills storage_parse_info with the
  * key/value couple it find. If a parse error happens, it returns < -1.
@@ -33,12 +38,16 @@
  * key_array_index value is UINT_MAX)
  */
 
+#include <stdbool.h>
 #include <stdio.h>
 #include <limits.h>
 
 struct storage_parse_info {
     FILE *file;
     char filename[PATH_MAX];
+    char tmpname[PATH_MAX + 4];
+    bool replace;
+    bool sync;
     int linenr;
     char line[256];
     char key[256], value[256];
@@ -50,8 +59,10 @@ extern const char *g_storage_prefix;
 int storage_check_access(const char *storage_prefix);
 struct storage_parse_info *storage_open(const char *filename, const char *mode);
 struct storage_parse_info *storage_open_prefix(const char *filename, const char *mode);
+int storage_sync(struct storage_parse_info *file);
 int storage_close(struct storage_parse_info *file);
 int storage_parse_line(struct storage_parse_info *file);
 void storage_delete(const char *files[]);
+void storage_delete_tmp(void);
 
 #endif
@@ -70,6 +70,8 @@
 extern FILE *g_trace_stream;
 extern unsigned int g_enabled_traces;
 extern bool g_enable_color_traces;
+// When set, TRACE() records raw arguments in a binary ring (see log_bin.h)
+extern struct tr_bin_hdr *g_trace_ring;
 
 enum {
     TR_BUS        = 0x00000001,
@@ -147,17 +149,51 @@ const char *tr_bytes(const void *in, int len, const void **in_done, int max_out,
 const char *tr_mbedtls_err(int err);
 const char *tr_gtkname(uint8_t slot);
 
+/*
+ * Every TRACE(TR_DROP, ...) call site registers a counter in the
+ * "tr_drop_sites" ELF section, incremented even if the trace is disabled. The
+ * linker provides __start_tr_drop_sites and __stop_tr_drop_sites to iterate
+ * over them (see tr_drop_site_first() and tr_drop_site_last()).
+ */
+struct tr_drop_site {
+    const char *file;
+    const char *fmt;
+    int line;
+    uint64_t count; // Atomic
+};
+
+extern struct tr_drop_site __start_tr_drop_sites[] __attribute__((weak));
+extern struct tr_drop_site __stop_tr_drop_sites[] __attribute__((weak));
+
+static inline struct tr_drop_site *tr_drop_site_first(void)
+{
+    return __start_tr_drop_sites;
+}
+
+static inline struct tr_drop_site *tr_drop_site_last(void)
+{
+    return __stop_tr_drop_sites;
+}
+
 void __tr_enter();
 void __tr_exit();
 __attribute__ ((format(printf, 2, 3)))
 void __tr_printf(const char *color, const char *fmt, ...);
 __attribute__ ((format(printf, 2, 0)))
 void __tr_vprintf(const char *color, const char *fmt, va_list ap);
+__attribute__ ((format(printf, 2, 3)))
+void __tr_bin_printf(uint16_t *site_id, const char *fmt, ...);
+__attribute__ ((format(printf, 2, 0)))
+void __tr_bin_vprintf(uint16_t *site_id, const char *fmt, va_list ap);
 
 #define __TRACE(COND, MSG, ...) \
     do {                                                             \
+        if ((COND) & TR_DROP)                                        \
+            __COUNT_DROP(MSG);                                       \
         if (g_enabled_traces & (COND)) {                             \
-            if (MSG[0] != '\0')                                      \
+            if (MSG[0] != '\0' && g_trace_ring)                      \
+                __PRINT_BIN(MSG, ##__VA_ARGS__);                     \
+            else if (MSG[0] != '\0')                                 \
                 __PRINT_WITH_TIME(90, MSG, ##__VA_ARGS__);           \
             else                                                     \
                 __PRINT_WITH_TIME(90, "%s:%d", __FILE__, __LINE__);  \
@@ -268,6 +304,23 @@ void __tr_vprintf(const char *color, const char *fmt, va_list ap);
         __tr_exit();                                                 \
     } while(0)
 
+#define __COUNT_DROP(MSG) \
+    do {                                                             \
+        static struct tr_drop_site __drop_site                       \
+            __attribute__((section("tr_drop_sites"), used)) = {      \
+            __FILE__, MSG, __LINE__                                  \
+        };                                                           \
+        __atomic_fetch_add(&__drop_site.count, 1, __ATOMIC_RELAXED); \
+    } while(0)
+
+#define __PRINT_BIN(MSG, ...) \
+    do {                                                             \
+        static uint16_t __site_id;                                   \
+        __tr_enter();                                                \
+        __tr_bin_printf(&__site_id, MSG, ##__VA_ARGS__);             \
+        __tr_exit();                                                 \
+    } while(0)
+
 #define __PRINT_WITH_TIME(COLOR, MSG, ...) \
     do {                                                             \
         struct timespec tp;                                          \
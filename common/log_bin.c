@@ -0,0 +1,332 @@
+/*
+ * SPDX-License-Identifier: LicenseRef-MSLA
+ * Copyright (c) 2025 Silicon Laboratories Inc. (www.silabs.com)
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of the Silicon Labs Master Software License
+ * Agreement (MSLA) available at [1].  This software is distributed to you in
+ * Object Code format and/or Source Code format and is governed by the sections
+ * of the MSLA applicable to Object Code, Source Code and Modified Open Source
+ * Code. By using this software, you agree to the terms of the MSLA.
+ *
+ * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
+ */
+#include <sys/mman.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#include "common/mathutils.h"
+#include "common/log.h"
+
+#include "log_bin.h"
+
+#define TR_BIN_ID_INVALID UINT16_MAX
+
+struct tr_bin_hdr *g_trace_ring = NULL;
+
+const char *tr_bin_parse_spec(const char *fmt, struct tr_bin_spec *spec)
+{
+    const char *p;
+
+    for (p = strchr(fmt, '%'); p; p = strchr(p + 2, '%'))
+        if (p[1] != '%')
+            break;
+    if (!p)
+        return NULL;
+
+    memset(spec, 0, sizeof(*spec));
+    spec->precision = -1;
+    spec->start = p++;
+    while (*p && strchr("-+ #0'", *p))
+        p++;
+    if (*p == '*') {
+        spec->star_count++;
+        p++;
+    }
+    while (*p >= '0' && *p <= '9')
+        p++;
+    if (*p == '.') {
+        p++;
+        spec->precision = 0;
+        if (*p == '*') {
+            spec->star_count++;
+            spec->prec_star = true;
+            p++;
+        }
+        while (*p >= '0' && *p <= '9')
+            spec->precision = spec->precision * 10 + *p++ - '0';
+    }
+    if (p[0] == 'h' && p[1] == 'h') {
+        spec->len_mod = TR_BIN_LEN_HH;
+        p += 2;
+    } else if (p[0] == 'l' && p[1] == 'l') {
+        spec->len_mod = TR_BIN_LEN_LL;
+        p += 2;
+    } else if (*p == 'h') {
+        spec->len_mod = TR_BIN_LEN_H;
+        p++;
+    } else if (*p == 'l') {
+        spec->len_mod = TR_BIN_LEN_L;
+        p++;
+    } else if (*p == 'q') {
+        spec->len_mod = TR_BIN_LEN_LL;
+        p++;
+    } else if (*p == 'j') {
+        spec->len_mod = TR_BIN_LEN_J;
+        p++;
+    } else if (*p == 'z') {
+        spec->len_mod = TR_BIN_LEN_Z;
+        p++;
+    } else if (*p == 't') {
+        spec->len_mod = TR_BIN_LEN_T;
+        p++;
+    } else if (*p == 'L') {
+        spec->len_mod = TR_BIN_LEN_LD;
+        p++;
+    }
+    spec->conv = *p;
+    spec->end = *p ? p + 1 : p;
+    return spec->end;
+}
+
+void tr_bin_open(const char *path, size_t ring_size)
+{
+    struct tr_bin_hdr *hdr;
+    size_t fmt_offset, str_offset, ring_offset;
+    int fd, ret;
+
+    BUG_ON(g_trace_ring);
+    ring_size = 1ul << (sizeof(unsigned long) * 8 - __builtin_clzl(MAX(ring_size, TR_BIN_REC_MAX) - 1));
+    fmt_offset  = roundup(sizeof(struct tr_bin_hdr), 8);
+    str_offset  = roundup(fmt_offset + TR_BIN_FMT_MAX * sizeof(uint32_t), 8);
+    ring_offset = roundup(str_offset + TR_BIN_STR_SIZE, 4096);
+
+    fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    FATAL_ON(fd < 0, 2, "open %s: %m", path);
+    ret = ftruncate(fd, ring_offset + ring_size);
+    FATAL_ON(ret < 0, 2, "ftruncate %s: %m", path);
+    hdr = mmap(NULL, ring_offset + ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    FATAL_ON(hdr == MAP_FAILED, 2, "mmap %s: %m", path);
+    close(fd);
+
+    hdr->fmt_max     = TR_BIN_FMT_MAX;
+    hdr->fmt_count   = 1; // ID 0 means "not registered yet"
+    hdr->str_size    = TR_BIN_STR_SIZE;
+    hdr->str_used    = 0;
+    hdr->fmt_offset  = fmt_offset;
+    hdr->str_offset  = str_offset;
+    hdr->ring_offset = ring_offset;
+    hdr->ring_size   = ring_size;
+    hdr->head        = 0;
+    // The magic is written last so a partially initialized file is ignored
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(hdr->magic, TR_BIN_MAGIC, sizeof(hdr->magic));
+    g_trace_ring = hdr;
+}
+
+static uint16_t tr_bin_register(uint16_t *site_id, const char *fmt)
+{
+    struct tr_bin_hdr *hdr = g_trace_ring;
+    uint32_t *fmt_tbl = (uint32_t *)((uint8_t *)hdr + hdr->fmt_offset);
+    char *str = (char *)hdr + hdr->str_offset;
+    uint32_t len = strlen(fmt) + 1;
+    uint16_t expected = 0;
+    uint32_t id, off;
+
+    off = __atomic_fetch_add(&hdr->str_used, len, __ATOMIC_RELAXED);
+    if (off + len > hdr->str_size)
+        id = TR_BIN_ID_INVALID;
+    else
+        id = __atomic_fetch_add(&hdr->fmt_count, 1, __ATOMIC_RELAXED);
+    if (id >= hdr->fmt_max) {
+        id = TR_BIN_ID_INVALID;
+    } else {
+        memcpy(str + off, fmt, len);
+        __atomic_store_n(&fmt_tbl[id], off, __ATOMIC_RELEASE);
+    }
+    // If another thread registered the same site concurrently, its ID wins
+    // and the entry allocated here is simply never referenced.
+    if (!__atomic_compare_exchange_n(site_id, &expected, id, false,
+                                     __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        return expected;
+    return id;
+}
+
+static bool tr_bin_put(struct tr_bin_rec *rec, const void *val, size_t len)
+{
+    if (rec->len + len > TR_BIN_REC_MAX)
+        return false;
+    memcpy((uint8_t *)rec + rec->len, val, len);
+    rec->len += len;
+    return true;
+}
+
+static bool tr_bin_put_int(struct tr_bin_rec *rec, const struct tr_bin_spec *spec, va_list *ap)
+{
+    bool is_signed = spec->conv == 'd' || spec->conv == 'i';
+    uint64_t val;
+
+    switch (spec->len_mod) {
+    case TR_BIN_LEN_L:
+        val = is_signed ? (uint64_t)va_arg(*ap, long) : va_arg(*ap, unsigned long);
+        break;
+    case TR_BIN_LEN_LL:
+        val = is_signed ? (uint64_t)va_arg(*ap, long long) : va_arg(*ap, unsigned long long);
+        break;
+    case TR_BIN_LEN_J:
+        val = is_signed ? (uint64_t)va_arg(*ap, intmax_t) : va_arg(*ap, uintmax_t);
+        break;
+    case TR_BIN_LEN_Z:
+        val = is_signed ? (uint64_t)va_arg(*ap, ssize_t) : va_arg(*ap, size_t);
+        break;
+    case TR_BIN_LEN_T:
+        val = (uint64_t)va_arg(*ap, ptrdiff_t);
+        break;
+    case TR_BIN_LEN_HH:
+        val = is_signed ? (uint64_t)(signed char)va_arg(*ap, int) : (unsigned char)va_arg(*ap, int);
+        break;
+    case TR_BIN_LEN_H:
+        val = is_signed ? (uint64_t)(short)va_arg(*ap, int) : (unsigned short)va_arg(*ap, int);
+        break;
+    default:
+        val = is_signed ? (uint64_t)va_arg(*ap, int) : va_arg(*ap, unsigned int);
+        break;
+    }
+    return tr_bin_put(rec, &val, sizeof(val));
+}
+
+// Like printf(), str does not need to be NUL terminated when precision >= 0
+static bool tr_bin_put_str(struct tr_bin_rec *rec, const char *str, int precision)
+{
+    uint16_t len;
+
+    if (!str)
+        str = "(null)";
+    if (rec->len + sizeof(len) > TR_BIN_REC_MAX)
+        return false;
+    len = MIN(strnlen(str, precision < 0 ? SIZE_MAX : precision),
+              TR_BIN_REC_MAX - rec->len - sizeof(len));
+    tr_bin_put(rec, &len, sizeof(len));
+    return tr_bin_put(rec, str, len);
+}
+
+static void tr_bin_serialize(struct tr_bin_rec *rec, const char *fmt, va_list ap, int err)
+{
+    struct tr_bin_spec spec;
+    va_list ap2;
+    uint64_t val;
+    double dbl;
+    bool ok = true;
+
+    va_copy(ap2, ap);
+    while (ok && (fmt = tr_bin_parse_spec(fmt, &spec))) {
+        for (int i = 0; ok && i < spec.star_count; i++) {
+            val = (uint64_t)va_arg(ap2, int);
+            // A negative precision is taken as if it were omitted
+            if (spec.prec_star && i == spec.star_count - 1)
+                spec.precision = (int)val;
+            ok = tr_bin_put(rec, &val, sizeof(val));
+        }
+        if (!ok)
+            break;
+        switch (spec.conv) {
+        case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+            ok = tr_bin_put_int(rec, &spec, &ap2);
+            break;
+        case 'c':
+            val = (uint64_t)va_arg(ap2, int);
+            ok = tr_bin_put(rec, &val, sizeof(val));
+            break;
+        case 'p':
+            val = (uintptr_t)va_arg(ap2, void *);
+            ok = tr_bin_put(rec, &val, sizeof(val));
+            break;
+        case 'e': case 'E': case 'f': case 'F':
+        case 'g': case 'G': case 'a': case 'A':
+            if (spec.len_mod == TR_BIN_LEN_LD)
+                dbl = va_arg(ap2, long double);
+            else
+                dbl = va_arg(ap2, double);
+            ok = tr_bin_put(rec, &dbl, sizeof(dbl));
+            break;
+        case 's':
+            ok = tr_bin_put_str(rec, va_arg(ap2, const char *), spec.precision);
+            break;
+        case 'm':
+            val = err;
+            ok = tr_bin_put(rec, &val, sizeof(val));
+            break;
+        case 'n':
+            va_arg(ap2, void *);
+            break;
+        default:
+            // Unsupported conversion, the remaining arguments cannot be found
+            ok = false;
+            break;
+        }
+    }
+    va_end(ap2);
+}
+
+static void tr_bin_ring_write(struct tr_bin_hdr *hdr, uint64_t pos, const void *buf, size_t len)
+{
+    uint8_t *ring = (uint8_t *)hdr + hdr->ring_offset;
+    size_t off = pos & (hdr->ring_size - 1);
+    size_t n = MIN(len, hdr->ring_size - off);
+
+    memcpy(ring + off, buf, n);
+    memcpy(ring, (const uint8_t *)buf + n, len - n);
+}
+
+void __tr_bin_vprintf(uint16_t *site_id, const char *fmt, va_list ap)
+{
+    uint64_t buf[TR_BIN_REC_MAX / sizeof(uint64_t)];
+    struct tr_bin_rec *rec = (struct tr_bin_rec *)buf;
+    struct tr_bin_hdr *hdr = g_trace_ring;
+    int err = errno;
+    struct timespec tp;
+    char msg[256];
+    uint64_t *commit;
+    uint64_t pos;
+    uint16_t id;
+
+    clock_gettime(CLOCK_REALTIME, &tp);
+    id = __atomic_load_n(site_id, __ATOMIC_RELAXED);
+    if (!id)
+        id = tr_bin_register(site_id, fmt);
+    if (id == TR_BIN_ID_INVALID) {
+        // Format table is full: fallback to synchronous formatting
+        errno = err;
+        vsnprintf(msg, sizeof(msg), fmt, ap);
+        __tr_printf("90", "%ju.%06ju: %s", (uintmax_t)tp.tv_sec, (uintmax_t)tp.tv_nsec / 1000, msg);
+        return;
+    }
+
+    rec->tstamp_us = (uint64_t)tp.tv_sec * 1000000 + tp.tv_nsec / 1000;
+    rec->id = id;
+    rec->len = sizeof(struct tr_bin_rec);
+    rec->reserved = 0;
+    tr_bin_serialize(rec, fmt, ap, err);
+    memset((uint8_t *)rec + rec->len, 0, roundup(rec->len, 8) - rec->len);
+    rec->len = roundup(rec->len, 8);
+
+    pos = __atomic_fetch_add(&hdr->head, rec->len, __ATOMIC_RELAXED);
+    tr_bin_ring_write(hdr, pos + sizeof(rec->pos), (uint8_t *)rec + sizeof(rec->pos),
+                      rec->len - sizeof(rec->pos));
+    // Records are 8-byte aligned, so the position never wraps around the ring
+    commit = (uint64_t *)((uint8_t *)hdr + hdr->ring_offset + (pos & (hdr->ring_size - 1)));
+    __atomic_store_n(commit, pos, __ATOMIC_RELEASE);
+    errno = err;
+}
+
+void __tr_bin_printf(uint16_t *site_id, const char *fmt, ...)
+{
+    va_list ap;
+
+    va_start(ap, fmt);
+    __tr_bin_vprintf(site_id, fmt, ap);
+    va_end(ap);
+}
@@ -0,0 +1,92 @@
+/*
+ * SPDX-License-Identifier: LicenseRef-MSLA
+ * Copyright (c) 2025 Silicon Laboratories Inc. (www.silabs.com)
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of the Silicon Labs Master Software License
+ * Agreement (MSLA) available at [1].  This software is distributed to you in
+ * Object Code format and/or Source Code format and is governed by the sections
+ * of the MSLA applicable to Object Code, Source Code and Modified Open Source
+ * Code. By using this software, you agree to the terms of the MSLA.
+ *
+ * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
+ */
+#ifndef COMMON_LOG_BIN_H
+#define COMMON_LOG_BIN_H
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Binary trace mode. Instead of formatting TRACE() messages with vfprintf(),
+ * the raw arguments are copied into a ring buffer backed by a memory mapped
+ * file. The format strings are stored once per call site in a separate table
+ * of the same file. The file can be decoded offline (even after a crash) with
+ * silabs-tracedump.
+ *
+ * Writers reserve space in the ring with an atomic increment of the head, so
+ * several threads can trace concurrently without lock. A record is committed
+ * by writing its absolute position last. The decoder uses this field to find
+ * the first complete record after the ring wrapped and to detect records
+ * partially overwritten.
+ *
+ * Integers and pointers are stored on 64 bits, floating points as double,
+ * strings as a 16-bit length followed by the characters (limited by the
+ * precision, and truncated to fit in TR_BIN_REC_MAX). %m stores errno. Values use the host endianness.
+ */
+
+#define TR_BIN_MAGIC      "WSTRACE1"
+#define TR_BIN_REC_MAX    512
+#define TR_BIN_FMT_MAX    4096
+#define TR_BIN_STR_SIZE   (256 * 1024)
+
+struct tr_bin_hdr {
+    char     magic[8];
+    uint32_t fmt_max;
+    uint32_t fmt_count;    // Atomic
+    uint32_t str_size;
+    uint32_t str_used;     // Atomic
+    uint64_t fmt_offset;   // Offset of the uint32_t[fmt_max] table from the file start
+    uint64_t str_offset;   // Offset of the string area from the file start
+    uint64_t ring_offset;  // Offset of the ring from the file start
+    uint64_t ring_size;    // Power of 2
+    uint64_t head;         // Atomic, number of bytes ever written in the ring
+};
+
+struct tr_bin_rec {
+    uint64_t pos;          // Absolute position, written last
+    uint64_t tstamp_us;    // CLOCK_REALTIME
+    uint16_t id;           // Index in the format table
+    uint16_t len;          // Including this header, multiple of 8
+    uint32_t reserved;
+    uint8_t  data[];
+};
+
+enum {
+    TR_BIN_LEN_NONE,
+    TR_BIN_LEN_HH,
+    TR_BIN_LEN_H,
+    TR_BIN_LEN_L,
+    TR_BIN_LEN_LL,
+    TR_BIN_LEN_J,
+    TR_BIN_LEN_Z,
+    TR_BIN_LEN_T,
+    TR_BIN_LEN_LD,
+};
+
+struct tr_bin_spec {
+    const char *start;     // Points to '%'
+    const char *end;       // Points after the conversion character
+    int star_count;        // Number of '*' in width and precision
+    bool prec_star;        // Precision is given by the last '*' argument
+    int precision;         // Literal precision, -1 if not specified
+    int len_mod;
+    char conv;
+};
+
+// Returns NULL if there is no more conversion in fmt
+const char *tr_bin_parse_spec(const char *fmt, struct tr_bin_spec *spec);
+
+void tr_bin_open(const char *path, size_t ring_size);
+
+#endif
@@ -81,11 +81,11 @@ void pcapng_write_shb(struct iobuf_write *buf)
     pcapng_block_end(buf, offset);
 }
 
-void pcapng_write_idb(struct iobuf_write *buf, uint16_t link_type)
+void pcapng_write_idb(struct iobuf_write *buf, uint16_t link_type, uint32_t snaplen)
 {
     struct pcapng_idb idb = {
         .link_type = link_type,
-        .snap_len  = 0, // No packet size restriction
+        .snap_len  = snaplen, // 0 for no packet size restriction
     };
     int offset;
 
@@ -96,7 +96,8 @@ void pcapng_write_idb(struct iobuf_write *buf, uint16_t link_type)
 
 void pcapng_write_epb(struct iobuf_write *buf,
                       uint64_t timestamp_us,
-                      const void *pkt, size_t pkt_len)
+                      const void *pkt, size_t pkt_len,
+                      uint32_t snaplen)
 {
     struct pcapng_epb epb = {
         .ifindex = 0,
@@ -107,6 +108,10 @@ void pcapng_write_epb(struct iobuf_write *buf,
     };
     int offset;
 
+    if (snaplen && pkt_len > snaplen) {
+        pkt_len = snaplen;
+        epb.pkt_len = snaplen;
+    }
     offset = pcapng_block_start(buf, PCAPNG_BLOCK_TYPE_EPB);
     iobuf_push_data(buf, &epb, sizeof(epb));
     iobuf_push_data(buf, pkt, pkt_len);
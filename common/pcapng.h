@@ -13,6 +13,7 @@
  */
 #ifndef PCAPNG_H
 #define PCAPNG_H
+#include <stddef.h>
 #include <stdint.h>
 
 /*
@@ -28,9 +29,11 @@
 struct iobuf_write;
 
 void pcapng_write_shb(struct iobuf_write *buf);
-void pcapng_write_idb(struct iobuf_write *buf, uint16_t link_type);
+// snaplen is the maximum number of bytes captured per packet, 0 for no limit
+void pcapng_write_idb(struct iobuf_write *buf, uint16_t link_type, uint32_t snaplen);
 void pcapng_write_epb(struct iobuf_write *buf,
                       uint64_t timestamp_us,
-                      const void *pkt, size_t pkt_len);
+                      const void *pkt, size_t pkt_len,
+                      uint32_t snaplen);
 
 #endif
@@ -44,6 +44,8 @@ static void rcp_tx(struct rcp *rcp, struct iobuf_write *buf)
           tr_bytes(buf->data + 1, buf->len - 1,
                    NULL, 128, DELIM_SPACE | ELLIPSIS_STAR));
     rcp->bus.tx(&rcp->bus, buf->data, buf->len);
+    __atomic_fetch_add(&rcp->tx_frames, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&rcp->tx_bytes, buf->len, __ATOMIC_RELAXED);
 }
 
 static void rcp_ind_nop(struct rcp *rcp, struct iobuf_read *buf)
@@ -118,6 +120,87 @@ void rcp_set_host_api(struct rcp *rcp, uint32_t host_api_version)
 #define HIF_MASK_FRAME_COUNTERS 0x1fc0
 #define HIF_MASK_MODE_SWITCH_TYPE 0x2000
 #define HIF_MASK_FRAME_COUNTER_8 0x4000
+#define HIF_MASK_NEIGH_SLOT     0x8000
+
+#define HIF_NEIGH_SLOT_MODE_SWITCH 0x01
+
+static void rcp_push_uc_chan_seq(struct iobuf_write *buf, const struct ws_neigh_fhss *fhss_data)
+{
+    hif_push_u8(buf, fhss_data->uc_chan_func);
+    switch (fhss_data->uc_chan_func) {
+    case WS_CHAN_FUNC_FIXED: {
+        int chan_fixed = ws_chan_mask_get_fixed(fhss_data->uc_channel_list);
+
+        BUG_ON(chan_fixed < 0);
+        hif_push_u16(buf, chan_fixed);
+        break;
+    }
+    case WS_CHAN_FUNC_DH1CF: {
+        uint8_t chan_mask_len = ws_chan_mask_width(fhss_data->uc_channel_list);
+
+        hif_push_u8(buf, chan_mask_len);
+        hif_push_fixed_u8_array(buf, fhss_data->uc_channel_list, chan_mask_len);
+        break;
+    }
+    default:
+        BUG();
+    }
+}
+
+static void rcp_push_rate_list(struct iobuf_write *buf, const struct rcp_rate_info rate_list[4])
+{
+    for (int i = 0; i < 4; i++) {
+        hif_push_u8(buf, rate_list[i].phy_mode_id);
+        hif_push_u8(buf, rate_list[i].tx_attempts);
+        hif_push_i8(buf, rate_list[i].tx_power_dbm);
+    }
+}
+
+/*
+ * The channel sequence and the mode switch rates rarely change, and most
+ * neighbors share the same ones. They are pushed once in a RCP slot, and data
+ * requests only reference the slot. Slots are looked up by content, so
+ * neighbors with identical schedules use the same slot. When no slot matches,
+ * the least recently used one is overwritten with a new generation.
+ */
+static int rcp_neigh_slot_get(struct rcp *rcp, const struct ws_neigh_fhss *fhss_data,
+                              const struct rcp_rate_info rate_list[4])
+{
+    struct rcp_neigh_slot *slot = NULL;
+    struct iobuf_write data = { };
+    struct iobuf_write buf = { };
+
+    BUG_ON(!fhss_data);
+    rcp_push_uc_chan_seq(&data, fhss_data);
+    if (rate_list)
+        rcp_push_rate_list(&data, rate_list);
+    BUG_ON(data.len > sizeof(slot->data));
+
+    for (int i = 0; i < ARRAY_SIZE(rcp->neigh_slots); i++) {
+        if (rcp->neigh_slots[i].data_len == data.len &&
+            !memcmp(rcp->neigh_slots[i].data, data.data, data.len)) {
+            slot = &rcp->neigh_slots[i];
+            break;
+        }
+        if (!slot || rcp->neigh_slots[i].last_use < slot->last_use)
+            slot = &rcp->neigh_slots[i];
+    }
+    if (slot->data_len != data.len || memcmp(slot->data, data.data, data.len)) {
+        slot->gen++;
+        slot->data_len = data.len;
+        memcpy(slot->data, data.data, data.len);
+        hif_push_u8(&buf, HIF_CMD_SET_NEIGH_SLOT);
+        hif_push_u8(&buf, slot - rcp->neigh_slots);
+        hif_push_u8(&buf, slot->gen);
+        hif_push_u8(&buf, rate_list ? HIF_NEIGH_SLOT_MODE_SWITCH : 0);
+        hif_push_fixed_u8_array(&buf, slot->data, slot->data_len);
+        rcp_tx(rcp, &buf);
+        iobuf_free(&buf);
+    }
+    slot->last_use = ++rcp->neigh_slot_clock;
+    iobuf_free(&data);
+    return slot - rcp->neigh_slots;
+}
 
 void rcp_req_data_tx(struct rcp *rcp,
                      const uint8_t *frame, int frame_len,
@@ -129,6 +212,11 @@ void rcp_req_data_tx(struct rcp *rcp,
     struct iobuf_write buf = { };
     int bitfield_offset;
     uint16_t bitfield;
+    int slot = -1;
+
+    if ((fhss_type == HIF_FHSS_TYPE_FFN_UC || fhss_type == HIF_FHSS_TYPE_LFN_UC || fhss_type == HIF_FHSS_TYPE_LFN_PA) &&
+        !version_older_than(rcp->version_api, 2, 7, 0))
+        slot = rcp_neigh_slot_get(rcp, fhss_data, rate_list);
 
     hif_push_u8(&buf, HIF_CMD_REQ_DATA_TX);
     hif_push_u8(&buf, handle);
@@ -176,26 +264,12 @@ void rcp_req_data_tx(struct rcp *rcp,
     default:
         BUG();
     }
-    if (fhss_type == HIF_FHSS_TYPE_FFN_UC || fhss_type == HIF_FHSS_TYPE_LFN_UC || fhss_type == HIF_FHSS_TYPE_LFN_PA) {
-        hif_push_u8(&buf, fhss_data->uc_chan_func);
-        switch (fhss_data->uc_chan_func) {
-        case WS_CHAN_FUNC_FIXED: {
-            int chan_fixed = ws_chan_mask_get_fixed(fhss_data->uc_channel_list);
-
-            BUG_ON(chan_fixed < 0);
-            hif_push_u16(&buf, chan_fixed);
-            break;
-        }
-        case WS_CHAN_FUNC_DH1CF: {
-            uint8_t chan_mask_len = ws_chan_mask_width(fhss_data->uc_channel_list);
-
-            hif_push_u8(&buf, chan_mask_len);
-            hif_push_fixed_u8_array(&buf, fhss_data->uc_channel_list, chan_mask_len);
-            break;
-        }
-        default:
-            BUG();
-        }
+    if (slot >= 0) {
+        bitfield |= HIF_MASK_NEIGH_SLOT;
+        hif_push_u8(&buf, slot);
+        hif_push_u8(&buf, rcp->neigh_slots[slot].gen);
+    } else if (fhss_type == HIF_FHSS_TYPE_FFN_UC || fhss_type == HIF_FHSS_TYPE_LFN_UC || fhss_type == HIF_FHSS_TYPE_LFN_PA) {
+        rcp_push_uc_chan_seq(&buf, fhss_data);
     }
     if (frame_counters_min) {
         for (uint8_t i = 0; i < 7; i++) {
@@ -207,11 +281,8 @@ void rcp_req_data_tx(struct rcp *rcp,
     }
     if (rate_list) {
         bitfield |= HIF_MASK_MODE_SWITCH;
-        for (int i = 0; i < 4; i++) {
-            hif_push_u8(&buf, rate_list[i].phy_mode_id);
-            hif_push_u8(&buf, rate_list[i].tx_attempts);
-            hif_push_i8(&buf, rate_list[i].tx_power_dbm);
-        }
+        if (slot < 0)
+            rcp_push_rate_list(&buf, rate_list);
     }
     if (frame_counters_min && frame_counters_min[7] != UINT32_MAX) {
         bitfield |= HIF_MASK_FRAME_COUNTER_8;
@@ -605,6 +676,8 @@ void rcp_rx(struct rcp *rcp)
     buf.data_size = rcp->bus.rx(&rcp->bus, rcp_rx_buf, sizeof(rcp_rx_buf));
     if (!buf.data_size)
         return;
+    __atomic_fetch_add(&rcp->rx_frames, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&rcp->rx_bytes, buf.data_size, __ATOMIC_RELAXED);
     capture_record_hif(buf.data, buf.data_size);
     cmd = hif_pop_u8(&buf);
     TRACE(TR_HIF, "hif rx: %s %s", hif_cmd_str(cmd),
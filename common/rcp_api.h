@@ -24,6 +24,7 @@
 #include "common/ieee802154_frame.h"
 
 struct bus;
+struct rcp_io;
 struct ws_neigh_fhss;
 
 struct rcp_rail_config {
@@ -36,6 +37,15 @@ struct rcp_rail_config {
     int16_t  sensitivity_dbm;
 };
 
+// Host copy of the schedules pushed with HIF_CMD_SET_NEIGH_SLOT
+struct rcp_neigh_slot {
+    uint8_t  gen;
+    uint64_t last_use;
+    // Serialized chan_seq and rate_config[], empty if the slot is unused
+    uint8_t  data[2 + WS_CHAN_MASK_LEN + 4 * 3];
+    uint8_t  data_len;
+};
+
 struct rcp_rate_info {
     uint8_t phy_mode_id;
     uint8_t tx_attempts;
@@ -87,6 +97,18 @@ struct rcp {
     const char *version_label;
     struct eui64 eui64;
     struct rcp_rail_config *rail_config_list;
+
+    // NULL unless rcp_io_start() was called
+    struct rcp_io *io;
+
+    struct rcp_neigh_slot neigh_slots[HIF_NEIGH_SLOT_COUNT];
+    uint64_t neigh_slot_clock;
+
+    // Atomic, HIF traffic including the command byte
+    uint64_t tx_frames;
+    uint64_t tx_bytes;
+    uint64_t rx_frames;
+    uint64_t rx_bytes;
 };
 
 // Share rx buffer with legacy implementation to not allocate twice
@@ -0,0 +1,227 @@
+/*
+ * SPDX-License-Identifier: LicenseRef-MSLA
+ * Copyright (c) 2025 Silicon Laboratories Inc. (www.silabs.com)
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of the Silicon Labs Master Software License
+ * Agreement (MSLA) available at [1].  This software is distributed to you in
+ * Object Code format and/or Source Code format and is governed by the sections
+ * of the MSLA applicable to Object Code, Source Code and Modified Open Source
+ * Code. By using this software, you agree to the terms of the MSLA.
+ *
+ * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
+ */
+#define _GNU_SOURCE
+#include <sys/eventfd.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+
+#include "common/bus_uart.h"
+#include "common/log.h"
+#include "common/mathutils.h"
+#include "common/memutils.h"
+#include "common/rcp_api.h"
+
+#include "rcp_io.h"
+
+#define RCP_IO_RING_SIZE        (256 * 1024)
+#define RCP_IO_RX_FULL_RETRY_MS 1
+
+static void rcp_io_ring_copy_in(struct rcp_io_ring *ring, uint64_t pos, const void *buf, size_t len)
+{
+    size_t off = pos % ring->size;
+    size_t n = MIN(len, ring->size - off);
+
+    memcpy(ring->buf + off, buf, n);
+    memcpy(ring->buf, (const uint8_t *)buf + n, len - n);
+}
+
+static void rcp_io_ring_copy_out(const struct rcp_io_ring *ring, uint64_t pos, void *buf, size_t len)
+{
+    size_t off = pos % ring->size;
+    size_t n = MIN(len, ring->size - off);
+
+    memcpy(buf, ring->buf + off, n);
+    memcpy((uint8_t *)buf + n, ring->buf, len - n);
+}
+
+// Producer side
+static bool rcp_io_ring_push(struct rcp_io_ring *ring, const void *buf, uint16_t len)
+{
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    if (head + sizeof(len) + len - tail > ring->size)
+        return false;
+    rcp_io_ring_copy_in(ring, head, &len, sizeof(len));
+    rcp_io_ring_copy_in(ring, head + sizeof(len), buf, len);
+    __atomic_store_n(&ring->head, head + sizeof(len) + len, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Consumer side, returns 0 if the ring is empty
+static uint16_t rcp_io_ring_pop(struct rcp_io_ring *ring, void *buf, size_t buf_len)
+{
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    uint16_t len;
+
+    if (head == tail)
+        return 0;
+    rcp_io_ring_copy_out(ring, tail, &len, sizeof(len));
+    BUG_ON(len > buf_len);
+    rcp_io_ring_copy_out(ring, tail + sizeof(len), buf, len);
+    __atomic_store_n(&ring->tail, tail + sizeof(len) + len, __ATOMIC_RELEASE);
+    return len;
+}
+
+static bool rcp_io_ring_is_empty(struct rcp_io_ring *ring)
+{
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) ==
+           __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
+
+// Protocol thread, replaces rcp.bus.tx
+static int rcp_io_tx(struct bus *bus, const void *buf, unsigned int len)
+{
+    struct rcp_io *io = container_of(bus, struct rcp, bus)->io;
+    bool warned = false;
+
+    BUG_ON(sizeof(uint16_t) + len > io->tx.size);
+    // Same back-pressure as a blocking write() on the device
+    while (!rcp_io_ring_push(&io->tx, buf, len)) {
+        if (!warned)
+            WARN("%s: ring full", __func__);
+        warned = true;
+        usleep(1000);
+    }
+    eventfd_write(io->tx_evfd, 1);
+    return len;
+}
+
+// Protocol thread, replaces rcp.bus.rx
+static int rcp_io_rx(struct bus *bus, void *buf, unsigned int buf_len)
+{
+    struct rcp_io *io = container_of(bus, struct rcp, bus)->io;
+    eventfd_t val;
+    int len;
+
+    // Acknowledge the event before looking at the ring, so a message queued
+    // in between always triggers a new event.
+    eventfd_read(bus->fd, &val);
+    len = rcp_io_ring_pop(&io->rx, buf, buf_len);
+    bus->uart.data_ready = !rcp_io_ring_is_empty(&io->rx);
+    return len;
+}
+
+static void rcp_io_process_tx(struct rcp_io *io, uint8_t *buf, size_t buf_size)
+{
+    eventfd_t val;
+    int len;
+
+    eventfd_read(io->tx_evfd, &val);
+    while ((len = rcp_io_ring_pop(&io->tx, buf, buf_size)))
+        io->bus.tx(&io->bus, buf, len);
+    // Requested by rcp_io_tx_flush(), the ring is empty at this point
+    if (__atomic_load_n(&io->flush_req, __ATOMIC_ACQUIRE)) {
+        if (io->bus.tx == uart_tx)
+            uart_tx_flush(&io->bus);
+        __atomic_store_n(&io->flush_req, false, __ATOMIC_RELEASE);
+    }
+}
+
+static void *rcp_io_thread(void *arg)
+{
+    struct rcp *rcp = arg;
+    struct rcp_io *io = rcp->io;
+    struct pollfd pfd[2] = {
+        { .fd = io->bus.fd,  .events = POLLIN },
+        { .fd = io->tx_evfd, .events = POLLIN },
+    };
+    uint8_t tx_buf[sizeof(rcp_rx_buf)];
+    uint8_t rx_buf[sizeof(rcp_rx_buf)];
+    int rx_len = 0;
+    bool queued;
+    int timeout;
+    int ret;
+
+    while (true) {
+        // A decoded message is pending because the RX ring is full: stop
+        // reading the device until the protocol thread catches up.
+        pfd[0].events = rx_len ? 0 : POLLIN;
+        if (rx_len)
+            timeout = RCP_IO_RX_FULL_RETRY_MS;
+        else if (io->bus.uart.data_ready)
+            timeout = 0;
+        else
+            timeout = -1;
+        ret = poll(pfd, ARRAY_SIZE(pfd), timeout);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        FATAL_ON(ret < 0, 2, "%s poll: %m", __func__);
+
+        if (pfd[1].revents & POLLIN)
+            rcp_io_process_tx(io, tx_buf, sizeof(tx_buf));
+
+        queued = false;
+        do {
+            if (!rx_len && (pfd[0].revents & (POLLIN | POLLERR) || io->bus.uart.data_ready)) {
+                rx_len = io->bus.rx(&io->bus, rx_buf, sizeof(rx_buf));
+                pfd[0].revents = 0;
+            }
+            if (!rx_len || !rcp_io_ring_push(&io->rx, rx_buf, rx_len))
+                break;
+            rx_len = 0;
+            queued = true;
+        } while (io->bus.uart.data_ready);
+        if (queued)
+            eventfd_write(rcp->bus.fd, 1);
+    }
+    return NULL;
+}
+
+void rcp_io_start(struct rcp *rcp)
+{
+    struct rcp_io *io = zalloc(sizeof(*io));
+    sigset_t sigmask, sigmask_prev;
+    int ret;
+
+    BUG_ON(rcp->io);
+    io->bus = rcp->bus;
+    io->rx.size = RCP_IO_RING_SIZE;
+    io->rx.buf = xalloc(RCP_IO_RING_SIZE);
+    io->tx.size = RCP_IO_RING_SIZE;
+    io->tx.buf = xalloc(RCP_IO_RING_SIZE);
+    io->tx_evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    FATAL_ON(io->tx_evfd < 0, 2, "eventfd: %m");
+
+    memset(&rcp->bus, 0, sizeof(rcp->bus));
+    rcp->bus.tx = rcp_io_tx;
+    rcp->bus.rx = rcp_io_rx;
+    rcp->bus.fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    FATAL_ON(rcp->bus.fd < 0, 2, "eventfd: %m");
+    rcp->io = io;
+
+    // Signals are handled by the protocol thread
+    sigfillset(&sigmask);
+    pthread_sigmask(SIG_SETMASK, &sigmask, &sigmask_prev);
+    ret = pthread_create(&io->thread, NULL, rcp_io_thread, rcp);
+    FATAL_ON(ret, 2, "pthread_create: %s", strerror(ret));
+    pthread_sigmask(SIG_SETMASK, &sigmask_prev, NULL);
+    pthread_setname_np(io->thread, "rcp-io");
+}
+
+void rcp_io_tx_flush(struct rcp *rcp)
+{
+    struct rcp_io *io = rcp->io;
+
+    // The device belongs to the I/O thread, let it drain the UART itself
+    __atomic_store_n(&io->flush_req, true, __ATOMIC_RELEASE);
+    eventfd_write(io->tx_evfd, 1);
+    for (int i = 0; i < 1000 && __atomic_load_n(&io->flush_req, __ATOMIC_ACQUIRE); i++)
+        usleep(1000);
+    WARN_ON(__atomic_load_n(&io->flush_req, __ATOMIC_ACQUIRE), "RCP messages not sent");
+}
@@ -0,0 +1,70 @@
+/*
+ * SPDX-License-Identifier: LicenseRef-MSLA
+ * Copyright (c) 2025 Silicon Laboratories Inc. (www.silabs.com)
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of the Silicon Labs Master Software License
+ * Agreement (MSLA) available at [1].  This software is distributed to you in
+ * Object Code format and/or Source Code format and is governed by the sections
+ * of the MSLA applicable to Object Code, Source Code and Modified Open Source
+ * Code. By using this software, you agree to the terms of the MSLA.
+ *
+ * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
+ */
+#ifndef RCP_IO_H
+#define RCP_IO_H
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "common/bus.h"
+
+struct rcp;
+
+/*
+ * Optional thread dedicated to the RCP bus. It performs the blocking reads
+ * and writes, the UART framing and the CRC checks, so that a slow stage of
+ * the protocol processing (D-Bus request, TLS handshake, storage write...)
+ * does not delay the RCP indications and confirmations.
+ *
+ * The I/O thread and the protocol thread exchange complete HIF messages
+ * (command byte included) through two lock-free single-producer
+ * single-consumer rings. Each message is stored as a 16-bit length followed by
+ * the data.
+ *
+ * Ownership:
+ *   - rcp_io.bus (the real device, UART state, CPC endpoint) belongs to the
+ *     I/O thread once started.
+ *   - Everything else in struct rcp, including rcp.bus which is turned into a
+ *     shim backed by the rings, belongs to the protocol thread.
+ *   - Ring buffers are shared: the head is only written by the producer, the
+ *     tail only by the consumer.
+ *
+ * rcp.bus.fd becomes an eventfd signaled when the RX ring is not empty, and
+ * rcp.bus.uart.data_ready reports remaining messages, so the main loop polls
+ * it exactly like a real bus.
+ */
+struct rcp_io_ring {
+    uint8_t *buf;
+    size_t size;
+    uint64_t head;              // Atomic, only written by the producer
+    uint64_t tail;              // Atomic, only written by the consumer
+};
+
+struct rcp_io {
+    pthread_t thread;
+    struct bus bus;             // I/O thread only
+    int tx_evfd;
+    bool flush_req;             // Atomic, cleared by the I/O thread once done
+    struct rcp_io_ring rx;      // I/O thread -> protocol thread
+    struct rcp_io_ring tx;      // Protocol thread -> I/O thread
+};
+
+// Must be called once the synchronous RCP initialization is done.
+void rcp_io_start(struct rcp *rcp);
+
+// Wait for the messages queued for transmission to be sent by the device.
+void rcp_io_tx_flush(struct rcp *rcp);
+
+#endif
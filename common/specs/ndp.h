@@ -24,6 +24,7 @@ enum {
     NDP_OPT_TLLAO =  2, // Target Link-Layer Address Option
     // ...
     NDP_OPT_ARO   = 33, // Address Registration Option
+    NDP_OPT_6CO   = 34, // 6LoWPAN Context Option
 };
 
 // Address Registration Option Status Values
@@ -60,6 +61,17 @@ struct ndp_opt_earo {
     be64_t  eui64; // ROVR (only EUI-64 supported)
 } __attribute__((packed));
 
+// RFC 6775 4.2. 6LoWPAN Context Option (6CO)
+struct ndp_opt_6co {
+    uint8_t ctx_len;
+    uint8_t flags;
+#define NDP_MASK_6CO_C   0x10
+#define NDP_MASK_6CO_CID 0x0f
+    be16_t  reserved;
+    be16_t  lifetime_minutes;
+    uint8_t prefix[]; // 8 or 16 bytes
+} __attribute__((packed));
+
 // P-Field Values
 // https://www.iana.org/assignments/icmpv6-parameters/icmpv6-parameters.xhtml#p-field-values
 enum {
@@ -30,6 +30,14 @@ uint64_t time_now_ms(clockid_t clockid)
     return (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
 }
 
+uint64_t time_now_us(clockid_t clockid)
+{
+    struct timespec now;
+
+    clock_gettime(clockid, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
 time_t time_get_elapsed(clockid_t clockid, time_t start)
 {
     struct timespec tp;
@@ -20,6 +20,8 @@ time_t time_now_s(clockid_t clockid);
 
 uint64_t time_now_ms(clockid_t clockid);
 
+uint64_t time_now_us(clockid_t clockid);
+
 time_t time_get_elapsed(clockid_t clockid, time_t start);
 
 /*
@@ -31,6 +31,7 @@ struct timer_ctxt {
     int fd;
     struct timer_group_list groups;
     struct timer_group group_default;
+    struct timer_stats stats;
 } g_timer_ctxt = {
     .fd = -1,
 };
@@ -125,6 +126,7 @@ void timer_process(void)
     struct timer_entry *timer, *tmp;
     struct timer_list trig_list;
     struct timer_group *group;
+    uint64_t lag_ms = 0;
     uint64_t val;
     ssize_t ret;
 
@@ -132,6 +134,14 @@ void timer_process(void)
     FATAL_ON(ret != 8, 2, "read timer: %m");
     WARN_ON(val != 1);
 
+    timer = timer_next();
+    if (timer && timer->expire_ms < now_ms)
+        lag_ms = now_ms - timer->expire_ms;
+    __atomic_fetch_add(&ctxt->stats.lag_count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&ctxt->stats.lag_sum_ms, lag_ms, __ATOMIC_RELAXED);
+    if (lag_ms > ctxt->stats.lag_max_ms)
+        __atomic_store_n(&ctxt->stats.lag_max_ms, lag_ms, __ATOMIC_RELAXED);
+
     SLIST_INIT(&trig_list);
     SLIST_FOREACH(group, &ctxt->groups, link) {
         SLIST_FOREACH_SAFE(timer, &group->timers, link, tmp) {
@@ -156,6 +166,11 @@ void timer_process(void)
     timer_schedule();
 }
 
+const struct timer_stats *timer_get_stats(void)
+{
+    return &timer_ctxt()->stats;
+}
+
 void timer_group_init(struct timer_group *group)
 {
     struct timer_ctxt *ctxt = timer_ctxt();
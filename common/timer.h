@@ -68,6 +68,14 @@ struct timer_entry {
     SLIST_ENTRY(timer_entry) link;
 };
 
+// Delay between the expiration of the earliest timer and the wake up of
+// timer_process(). Fields are updated atomically.
+struct timer_stats {
+    uint64_t lag_count;
+    uint64_t lag_sum_ms;
+    uint64_t lag_max_ms;
+};
+
 // File descriptor indicating when a timer event is ready to be processed.
 int timer_fd(void);
 
@@ -77,6 +85,8 @@ struct timer_entry *timer_next(void);
 // Should be called when timer_fd() is ready.
 void timer_process(void);
 
+const struct timer_stats *timer_get_stats(void);
+
 // Should be called once per project submodule to register a new timer group.
 void timer_group_init(struct timer_group *group);
 
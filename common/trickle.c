@@ -121,6 +121,11 @@ void trickle_inconsistent(struct trickle *tkl)
     if (tkl->I_ms <= tkl->cfg->Imin_ms)
         return;
     TRACE(TR_TRICKLE, "tkl %-4s inconsistent", tkl->debug_name);
+    trickle_reset(tkl);
+}
+
+void trickle_reset(struct trickle *tkl)
+{
     tkl->I_ms = tkl->cfg->Imin_ms;
     trickle_interval_begin(tkl);
 }
@@ -54,5 +54,7 @@ void trickle_stop(struct trickle *tkl);
 
 void trickle_consistent(struct trickle *tkl);
 void trickle_inconsistent(struct trickle *tkl);
+// Unconditionally restart with I = Imin, even if the timer was stopped.
+void trickle_reset(struct trickle *tkl);
 
 #endif
@@ -15,32 +15,99 @@
 
 #include "common/ws/ws_regdb.h"
 #include "common/bits.h"
+#include "common/endian.h"
 #include "common/log.h"
 #include "common/hif.h"
 #include "common/parsers.h"
 
 #include "ws_chan_mask.h"
 
+/*
+ * Channel masks are stored as bytes (channel n is bit n % 8 of byte n / 8),
+ * which is the layout of the HIF and of the Wi-SUN IEs. This is also the
+ * layout of little-endian 64-bit words, so the helpers below process 64
+ * channels at once.
+ */
+#define WS_CHAN_MASK_WORDS (WS_CHAN_MASK_LEN / 8)
+
+static uint64_t ws_chan_mask_word(const uint8_t chan_mask[WS_CHAN_MASK_LEN], int i)
+{
+    return read_le64(chan_mask + 8 * i);
+}
+
 int ws_chan_mask_get_fixed(const uint8_t chan_mask[WS_CHAN_MASK_LEN])
 {
-    int val = -EINVAL;
+    if (ws_chan_mask_count(chan_mask) != 1)
+        return -EINVAL;
+    return ws_chan_mask_nth(chan_mask, 0);
+}
+
+int ws_chan_mask_width(const uint8_t chan_mask[WS_CHAN_MASK_LEN])
+{
+    uint64_t word;
+
+    for (int i = WS_CHAN_MASK_WORDS - 1; i >= 0; i--) {
+        word = ws_chan_mask_word(chan_mask, i);
+        if (word)
+            return 8 * i + (63 - __builtin_clzll(word)) / 8 + 1;
+    }
+    return 0;
+}
+
+int ws_chan_mask_count(const uint8_t chan_mask[WS_CHAN_MASK_LEN])
+{
+    int cnt = 0;
 
-    for (int i = 0; i < 8 * WS_CHAN_MASK_LEN; i++) {
-        if (bittest(chan_mask, i)) {
-            if (val >= 0)
-                return -EINVAL;
-            val = i;
+    for (int i = 0; i < WS_CHAN_MASK_WORDS; i++)
+        cnt += __builtin_popcountll(ws_chan_mask_word(chan_mask, i));
+    return cnt;
+}
+
+int ws_chan_mask_nth(const uint8_t chan_mask[WS_CHAN_MASK_LEN], int n)
+{
+    uint64_t word;
+    int cnt;
+
+    for (int i = 0; i < WS_CHAN_MASK_WORDS; i++) {
+        word = ws_chan_mask_word(chan_mask, i);
+        cnt = __builtin_popcountll(word);
+        if (n >= cnt) {
+            n -= cnt;
+            continue;
         }
+        while (n--)
+            word &= word - 1; // Clear the lowest bit set
+        return 64 * i + __builtin_ctzll(word);
     }
-    return val;
+    return -EINVAL;
 }
 
-int ws_chan_mask_width(const uint8_t chan_mask[WS_CHAN_MASK_LEN])
+int ws_chan_mask_find_next(const uint8_t chan_mask[WS_CHAN_MASK_LEN], int start, bool val)
 {
-    for (int i = WS_CHAN_MASK_LEN - 1; i >= 0; i--)
-        if (chan_mask[i])
-            return i + 1;
-    return 0;
+    uint64_t word;
+
+    for (int i = start / 64; i < WS_CHAN_MASK_WORDS; i++) {
+        word = ws_chan_mask_word(chan_mask, i);
+        if (!val)
+            word = ~word;
+        if (i == start / 64)
+            word &= UINT64_MAX << (start % 64);
+        if (word)
+            return 64 * i + __builtin_ctzll(word);
+    }
+    return 8 * WS_CHAN_MASK_LEN;
+}
+
+void ws_chan_mask_and(uint8_t dst[WS_CHAN_MASK_LEN], const uint8_t src[WS_CHAN_MASK_LEN])
+{
+    for (int i = 0; i < WS_CHAN_MASK_WORDS; i++)
+        write_le64(dst + 8 * i, ws_chan_mask_word(dst, i) & ws_chan_mask_word(src, i));
+}
+
+void ws_chan_mask_andn(uint8_t dst[WS_CHAN_MASK_LEN], const uint8_t src[WS_CHAN_MASK_LEN])
+{
+    for (int i = 0; i < WS_CHAN_MASK_WORDS; i++)
+        write_le64(dst + 8 * i, ws_chan_mask_word(dst, i) & ~ws_chan_mask_word(src, i));
 }
 
 void ws_chan_mask_calc_reg(uint8_t  chan_mask[WS_CHAN_MASK_LEN],
@@ -78,21 +145,21 @@ void ws_chan_mask_calc_excl(uint8_t chan_mask_excl[WS_CHAN_MASK_LEN],
     if (ws_chan_mask_get_fixed(chan_mask_custom) >= 0) {
         memset(chan_mask_excl, 0, WS_CHAN_MASK_LEN);
     } else {
-        for (int i = 0; i < WS_CHAN_MASK_LEN; i++)
-            chan_mask_excl[i] = chan_mask_reg[i] & ~chan_mask_custom[i];
+        memcpy(chan_mask_excl, chan_mask_reg, WS_CHAN_MASK_LEN);
+        ws_chan_mask_andn(chan_mask_excl, chan_mask_custom);
     }
 }
 
 int ws_chan_mask_ranges(const uint8_t chan_mask[WS_CHAN_MASK_LEN])
 {
-    bool in_range = false;
+    uint64_t word, prev = 0;
     int cnt = 0;
 
-    for (int i = 0; i < 8 * WS_CHAN_MASK_LEN; i++) {
-        if (in_range != bittest(chan_mask, i)) {
-            in_range = !in_range;
-            cnt += in_range;
-        }
+    // Count the bits set whose predecessor is not set
+    for (int i = 0; i < WS_CHAN_MASK_WORDS; i++) {
+        word = ws_chan_mask_word(chan_mask, i);
+        cnt += __builtin_popcountll(word & ~(word << 1 | prev >> 63));
+        prev = word;
     }
     return cnt;
 }
@@ -14,6 +14,7 @@
 #ifndef WS_CHAN_MASK_H
 #define WS_CHAN_MASK_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 struct chan_params;
@@ -28,6 +29,21 @@ int ws_chan_mask_get_fixed(const uint8_t chan_mask[WS_CHAN_MASK_LEN]);
 // Get the minimum number of bytes needed to represent the mask.
 int ws_chan_mask_width(const uint8_t chan_mask[WS_CHAN_MASK_LEN]);
 
+// Count the number of channels in the mask.
+int ws_chan_mask_count(const uint8_t chan_mask[WS_CHAN_MASK_LEN]);
+
+// Get the channel number of the nth (starting from 0) channel in the mask, or
+// -EINVAL if the mask contains n channels or less.
+int ws_chan_mask_nth(const uint8_t chan_mask[WS_CHAN_MASK_LEN], int n);
+
+// Get the first channel number >= start whose bit is equal to val, or
+// 8 * WS_CHAN_MASK_LEN if there is none.
+int ws_chan_mask_find_next(const uint8_t chan_mask[WS_CHAN_MASK_LEN], int start, bool val);
+
+// dst &= src, and dst &= ~src.
+void ws_chan_mask_and(uint8_t dst[WS_CHAN_MASK_LEN], const uint8_t src[WS_CHAN_MASK_LEN]);
+void ws_chan_mask_andn(uint8_t dst[WS_CHAN_MASK_LEN], const uint8_t src[WS_CHAN_MASK_LEN]);
+
 // Compute the channel mask based on regulation parameters.
 void ws_chan_mask_calc_reg(uint8_t  chan_mask[WS_CHAN_MASK_LEN],
                            const struct chan_params *chan_params,
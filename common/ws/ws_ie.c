@@ -360,7 +360,7 @@ static void ws_wp_chan_excl_write(struct iobuf_write *buf, const struct ws_fhss_
     uint8_t chan_mask_excl[WS_CHAN_MASK_LEN];
     uint8_t chan_mask_reg[WS_CHAN_MASK_LEN];
     int mask_len, range_cnt;
-    int range_start;
+    int range_start, range_end;
 
     BUG_ON(!fhss_config->chan_params);
     ws_chan_mask_calc_reg(chan_mask_reg, fhss_config->chan_params, fhss_config->regional_regulation);
@@ -376,22 +376,12 @@ static void ws_wp_chan_excl_write(struct iobuf_write *buf, const struct ws_fhss_
         iobuf_push_data(buf, chan_mask_excl, mask_len);
     } else {
         iobuf_push_u8(buf, range_cnt);
-        range_start = -1;
-        for (int i = 0; i < 8 * WS_CHAN_MASK_LEN; i++) {
-            if (range_start < 0) {
-                if (bittest(chan_mask_excl, i))
-                    range_start = i;
-            } else {
-                if (!bittest(chan_mask_excl, i)) {
-                    iobuf_push_le16(buf, range_start);
-                    iobuf_push_le16(buf, i - 1);
-                    range_start = -1;
-                }
-            }
-        }
-        if (range_start >= 0) {
+        range_start = ws_chan_mask_find_next(chan_mask_excl, 0, true);
+        while (range_start < 8 * WS_CHAN_MASK_LEN) {
+            range_end = ws_chan_mask_find_next(chan_mask_excl, range_start, false);
             iobuf_push_le16(buf, range_start);
-            iobuf_push_le16(buf, WS_CHAN_MASK_LEN - 1);
+            iobuf_push_le16(buf, range_end - 1);
+            range_start = ws_chan_mask_find_next(chan_mask_excl, range_end, true);
         }
     }
 }
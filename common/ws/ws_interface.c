@@ -163,7 +163,7 @@ void ws_if_recv_ind(struct rcp *rcp, const struct rcp_rx_ind *hif_ind)
         // TODO: TX power (APC), active key indices
         ind.neigh = ws_neigh_add(&ws->neigh_table, &ind.hdr.src, WS_NR_ROLE_ROUTER, 16, 0x02);
     else
-        ws_neigh_refresh(&ws->neigh_table, ind.neigh, ind.neigh->lifetime_s);
+        ws_neigh_refresh(&ws->neigh_table, ind.neigh, ws_neigh_hot(&ws->neigh_table, ind.neigh)->lifetime_s);
     ws_neigh_ut_update(&ind.neigh->fhss_data_unsecured, ie_utt.ufsi,
                        ind.hif->timestamp_us, &ind.hdr.src);
     ind.neigh->rsl_in_dbm_unsecured = ws_neigh_ewma_next(ind.neigh->rsl_in_dbm_unsecured,
@@ -180,52 +180,228 @@ void ws_if_recv_ind(struct rcp *rcp, const struct rcp_rx_ind *hif_ind)
         ws->on_recv_ind(ws, &ind);
 }
 
+// Maximum number of frames handed to the RCP at once
+#define WS_TX_INFLIGHT_MAX 8
+// Maximum number of unicast data frames handed to the RCP per destination
+#define WS_TX_INFLIGHT_MAX_PER_DST 2
+// Maximum number of frames queued per destination
+#define WS_TX_QUEUE_MAX 16
+
+static bool ws_if_frame_ctx_has_type(struct ws_ctx *ws, uint8_t type)
+{
+    for (int i = 0; i < ARRAY_SIZE(ws->frame_ctx_table); i++)
+        if (ws->frame_ctx_table[i] && ws->frame_ctx_table[i]->type == type)
+            return true;
+    return false;
+}
+
 static struct ws_frame_ctx *ws_if_frame_ctx_new(struct ws_ctx *ws, uint8_t type)
 {
-    struct ws_frame_ctx *cur, *new;
+    struct ws_frame_ctx *new;
 
-    if (type == SL_FT_DCS &&
-        SLIST_FIND(cur, &ws->frame_ctx_list, link, cur->type == type)) {
+    if (type == SL_FT_DCS && ws_if_frame_ctx_has_type(ws, type)) {
         WARN("%s tx overlap, consider increasing disc_period_s", tr_ws_frame(type));
         TRACE(TR_TX_ABORT, "tx-abort %-9s: tx already in progress", tr_ws_frame(type));
         return NULL;
     }
     if ((type == WS_FT_PAS || type == WS_FT_PA || type == WS_FT_PCS || type == WS_FT_PC) &&
-        SLIST_FIND(cur, &ws->frame_ctx_list, link, cur->type == type)) {
+        ws_if_frame_ctx_has_type(ws, type)) {
         WARN("%s tx overlap, consider increasing trickle Imin", tr_ws_frame(type));
         TRACE(TR_TX_ABORT, "tx-abort %-9s: tx already in progress", tr_ws_frame(type));
         return NULL;
     }
-    if (SLIST_SIZE(&ws->frame_ctx_list, link) > UINT8_MAX) {
+    if (ws->frame_ctx_count >= ARRAY_SIZE(ws->frame_ctx_table)) {
         TRACE(TR_TX_ABORT, "tx-abort %-9s: no handle available", tr_ws_frame(type));
         return NULL;
     }
 
+    // If next handle is already in use (unlikely), use the next available one.
+    while (ws->frame_ctx_table[ws->handle_next])
+        ws->handle_next++;
     new = zalloc(sizeof(*new));
     new->handle = ws->handle_next++;
     new->type = type;
-    // If next handle is already in use (unlikely), use the next available one.
-    while (SLIST_FIND(cur, &ws->frame_ctx_list, link,
-                      cur->handle == new->handle))
-        new->handle = ws->handle_next++;
-    SLIST_INSERT_HEAD(&ws->frame_ctx_list, new, link);
+    ws->frame_ctx_table[new->handle] = new;
+    ws->frame_ctx_count++;
     return new;
 }
 
 static struct ws_frame_ctx *ws_if_frame_ctx_pop(struct ws_ctx *ws, uint8_t handle)
 {
-    struct ws_frame_ctx *cur;
+    struct ws_frame_ctx *cur = ws->frame_ctx_table[handle];
 
-    cur = SLIST_FIND(cur, &ws->frame_ctx_list, link, cur->handle == handle);
-    if (cur)
-        SLIST_REMOVE(&ws->frame_ctx_list, cur, ws_frame_ctx, link);
+    if (cur) {
+        ws->frame_ctx_table[handle] = NULL;
+        ws->frame_ctx_count--;
+    }
     return cur;
 }
 
+static struct ws_tx_queue *ws_if_tx_queue_get(struct ws_ctx *ws, const struct eui64 *dst)
+{
+    struct ws_tx_queue *queue;
+
+    return SLIST_FIND(queue, &ws->tx_queues, link, eui64_eq(&queue->dst, dst));
+}
+
+static struct ws_tx_queue *ws_if_tx_queue_fetch(struct ws_ctx *ws, const struct eui64 *dst)
+{
+    struct ws_tx_queue *queue = ws_if_tx_queue_get(ws, dst);
+
+    if (queue)
+        return queue;
+    queue = zalloc(sizeof(*queue));
+    queue->dst = *dst;
+    for (int i = 0; i < WS_PRIO_COUNT; i++)
+        STAILQ_INIT(&queue->frames[i]);
+    SLIST_INSERT_HEAD(&ws->tx_queues, queue, link);
+    return queue;
+}
+
+static void ws_if_tx_queue_gc(struct ws_ctx *ws, struct ws_tx_queue *queue)
+{
+    if (queue->len || queue->inflight)
+        return;
+    SLIST_REMOVE(&ws->tx_queues, queue, ws_tx_queue, link);
+    free(queue);
+}
+
+static struct ws_frame_ctx *ws_if_tx_queue_pop(struct ws_ctx *ws, struct ws_tx_queue *queue, int prio)
+{
+    struct ws_frame_ctx *frame_ctx = STAILQ_FIRST(&queue->frames[prio]);
+
+    STAILQ_REMOVE_HEAD(&queue->frames[prio], link);
+    queue->len--;
+    ws->tx_queued--;
+    return frame_ctx;
+}
+
+/*
+ * Report a frame which never reached the RCP to the upper layer, as if the
+ * RCP had failed to send it. Link metrics are left untouched.
+ */
+static void ws_if_tx_abort(struct ws_ctx *ws, struct ws_frame_ctx *frame_ctx)
+{
+    struct rcp_tx_cnf cnf = {
+        .handle = frame_ctx->handle,
+        .status = HIF_STATUS_NOMEM,
+    };
+
+    ws_if_frame_ctx_pop(ws, frame_ctx->handle);
+    free(frame_ctx->frame);
+    if (ws->on_recv_cnf)
+        ws->on_recv_cnf(ws, frame_ctx, &cnf);
+    free(frame_ctx);
+}
+
+static bool ws_if_tx_queue_send(struct ws_ctx *ws, struct ws_tx_queue *queue,
+                                struct ws_frame_ctx *frame_ctx)
+{
+    struct ws_neigh *neigh = ws_neigh_get(&ws->neigh_table, &queue->dst);
+
+    if (!neigh || !ws_neigh_has_us(&neigh->fhss_data_unsecured)) {
+        TRACE(TR_TX_ABORT, "tx-abort %-9s: unknown neighbor %s", "15.4", tr_eui64(queue->dst.u8));
+        return false;
+    }
+    TRACE(TR_15_4_DATA, "tx-15.4 %-9s dst:%s", tr_ws_frame(WS_FT_DATA), tr_eui64(queue->dst.u8));
+    rcp_req_data_tx(&ws->rcp,
+                    frame_ctx->frame, frame_ctx->frame_len,
+                    frame_ctx->handle,
+                    HIF_FHSS_TYPE_FFN_UC,
+                    &neigh->fhss_data_unsecured,
+                    neigh->frame_counter_min,
+                    NULL, 0);  // TODO: mode switch
+    free(frame_ctx->frame);
+    frame_ctx->frame = NULL;
+    frame_ctx->frame_len = 0;
+    queue->inflight++;
+    return true;
+}
+
+/*
+ * Hand queued frames to the RCP while credits are available. The highest
+ * priority class is served first, then the oldest frame across destinations.
+ */
+static void ws_if_tx_queue_kick(struct ws_ctx *ws)
+{
+    STAILQ_HEAD(, ws_frame_ctx) aborted = STAILQ_HEAD_INITIALIZER(aborted);
+    struct ws_tx_queue *queue, *best;
+    struct ws_frame_ctx *frame_ctx;
+    int prio;
+
+    while (ws->tx_queued && ws->frame_ctx_count - ws->tx_queued < WS_TX_INFLIGHT_MAX) {
+        best = NULL;
+        for (prio = WS_PRIO_COUNT - 1; prio >= 0; prio--) {
+            SLIST_FOREACH(queue, &ws->tx_queues, link) {
+                if (queue->inflight >= WS_TX_INFLIGHT_MAX_PER_DST)
+                    continue;
+                frame_ctx = STAILQ_FIRST(&queue->frames[prio]);
+                if (!frame_ctx)
+                    continue;
+                if (!best || (int32_t)(frame_ctx->order - STAILQ_FIRST(&best->frames[prio])->order) < 0)
+                    best = queue;
+            }
+            if (best)
+                break;
+        }
+        if (!best)
+            break;
+        frame_ctx = ws_if_tx_queue_pop(ws, best, prio);
+        if (!ws_if_tx_queue_send(ws, best, frame_ctx))
+            STAILQ_INSERT_TAIL(&aborted, frame_ctx, link);
+        ws_if_tx_queue_gc(ws, best);
+    }
+
+    // Upper layers may send new frames from the confirmation callback
+    while ((frame_ctx = STAILQ_FIRST(&aborted))) {
+        STAILQ_REMOVE_HEAD(&aborted, link);
+        ws_if_tx_abort(ws, frame_ctx);
+    }
+}
+
+static int ws_if_tx_queue_push(struct ws_ctx *ws, struct ws_frame_ctx *frame_ctx,
+                               struct iobuf_write *iobuf, int prio)
+{
+    struct ws_tx_queue *queue = ws_if_tx_queue_fetch(ws, &frame_ctx->dst);
+    struct ws_frame_ctx *victim = NULL;
+
+    BUG_ON(prio < 0 || prio >= WS_PRIO_COUNT);
+    if (queue->len >= WS_TX_QUEUE_MAX) {
+        // Control traffic evicts the oldest lower priority frame
+        for (int i = 0; i < prio && !victim; i++)
+            if (!STAILQ_EMPTY(&queue->frames[i]))
+                victim = ws_if_tx_queue_pop(ws, queue, i);
+    }
+    if (queue->len >= WS_TX_QUEUE_MAX) {
+        TRACE(TR_TX_ABORT, "tx-abort %-9s: queue full for %s", "15.4", tr_eui64(queue->dst.u8));
+        ws_if_frame_ctx_pop(ws, frame_ctx->handle);
+        free(frame_ctx);
+        ws_if_tx_queue_gc(ws, queue);
+        return -ENOBUFS;
+    }
+
+    // Take ownership of the frame buffer
+    frame_ctx->frame     = iobuf->data;
+    frame_ctx->frame_len = iobuf->len;
+    frame_ctx->order     = ws->tx_order++;
+    iobuf->data = NULL;
+    STAILQ_INSERT_TAIL(&queue->frames[prio], frame_ctx, link);
+    queue->len++;
+    ws->tx_queued++;
+    TRACE(TR_QUEUE, "queue %-9s: dst=%s len=%d", "15.4", tr_eui64(queue->dst.u8), queue->len);
+
+    if (victim) {
+        TRACE(TR_TX_ABORT, "tx-abort %-9s: queue full for %s", "15.4", tr_eui64(victim->dst.u8));
+        ws_if_tx_abort(ws, victim);
+    }
+    return 0;
+}
+
 void ws_if_recv_cnf(struct rcp *rcp, const struct rcp_tx_cnf *cnf)
 {
     struct ws_ctx *ws = container_of(rcp, struct ws_ctx, rcp);
     struct ws_frame_ctx frame_ctx, *frame_ctx_ptr;
+    struct ws_tx_queue *queue;
     struct iobuf_read ie_header, ie_payload;
     struct ws_neigh *neigh = NULL;
     struct ieee802154_hdr hdr;
@@ -243,6 +419,13 @@ void ws_if_recv_cnf(struct rcp *rcp, const struct rcp_tx_cnf *cnf)
     }
     frame_ctx = *frame_ctx_ptr;
     free(frame_ctx_ptr);
+    if (frame_ctx.type == WS_FT_DATA && !eui64_is_bc(&frame_ctx.dst)) {
+        queue = ws_if_tx_queue_get(ws, &frame_ctx.dst);
+        if (queue) {
+            queue->inflight--;
+            ws_if_tx_queue_gc(ws, queue);
+        }
+    }
 
     // DCS are async unicast packets to the chosen target
     if (frame_ctx.type != SL_FT_DCS && !eui64_is_bc(&frame_ctx.dst)) {
@@ -265,7 +448,7 @@ void ws_if_recv_cnf(struct rcp *rcp, const struct rcp_tx_cnf *cnf)
             return;
         }
         // TODO: check frame counter
-        ws_neigh_refresh(&ws->neigh_table, neigh, neigh->lifetime_s);
+        ws_neigh_refresh(&ws->neigh_table, neigh, ws_neigh_hot(&ws->neigh_table, neigh)->lifetime_s);
         neigh->rsl_in_dbm_unsecured = ws_neigh_ewma_next(neigh->rsl_in_dbm_unsecured,
                                                          cnf->rx_power_dbm, WS_EWMA_SF);
         if (hdr.key_index)
@@ -291,9 +474,10 @@ void ws_if_recv_cnf(struct rcp *rcp, const struct rcp_tx_cnf *cnf)
                             cnf->status == HIF_STATUS_SUCCESS);
     if (ws->on_recv_cnf)
         ws->on_recv_cnf(ws, &frame_ctx, cnf);
+    ws_if_tx_queue_kick(ws);
 }
 
-int ws_if_send_data(struct ws_ctx *ws, const void *pkt, size_t pkt_len, const struct eui64 *dst)
+int ws_if_send_data(struct ws_ctx *ws, const void *pkt, size_t pkt_len, const struct eui64 *dst, int prio)
 {
     struct ws_neigh *neigh = ws_neigh_get(&ws->neigh_table, dst);
     struct ieee802154_hdr hdr = {
@@ -317,7 +501,7 @@ int ws_if_send_data(struct ws_ctx *ws, const void *pkt, size_t pkt_len, const st
     struct wp_ie_list wp_ies = { }; // TODO: JM-IE
     struct ws_frame_ctx *frame_ctx;
     struct iobuf_write iobuf = { };
-    int offset;
+    int offset, handle, ret;
 
     if (!ws->gak_index) {
         TRACE(TR_TX_ABORT, "tx-abort %-9s: security not ready", "15.4");
@@ -350,13 +534,22 @@ int ws_if_send_data(struct ws_ctx *ws, const void *pkt, size_t pkt_len, const st
 
     ieee802154_reserve_mic(&iobuf, &hdr);
 
+    if (neigh) {
+        handle = frame_ctx->handle;
+        ret = ws_if_tx_queue_push(ws, frame_ctx, &iobuf, prio);
+        iobuf_free(&iobuf);
+        if (ret < 0)
+            return ret;
+        ws_if_tx_queue_kick(ws);
+        return handle;
+    }
+
     TRACE(TR_15_4_DATA, "tx-15.4 %-9s dst:%s", tr_ws_frame(WS_FT_DATA), tr_eui64(hdr.dst.u8));
     rcp_req_data_tx(&ws->rcp,
                     iobuf.data, iobuf.len,
                     frame_ctx->handle,
-                    neigh ? HIF_FHSS_TYPE_FFN_UC : HIF_FHSS_TYPE_FFN_BC,
-                    neigh ? &neigh->fhss_data_unsecured : NULL,
-                    neigh ? neigh->frame_counter_min : NULL,
+                    HIF_FHSS_TYPE_FFN_BC,
+                    NULL, NULL,
                     NULL, 0);  // TODO: mode switch
     iobuf_free(&iobuf);
     return frame_ctx->handle;
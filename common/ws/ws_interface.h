@@ -13,6 +13,7 @@
  */
 #ifndef WS_INTERFACE_H
 #define WS_INTERFACE_H
+#include <sys/queue.h>
 #include <inttypes.h>
 
 #include "common/ieee802154_frame.h"
@@ -71,16 +72,40 @@ struct ws_send_req {
     size_t pkt_len;
 };
 
-// Frame sent to the RCP and waiting for a confirmation.
+// TX priority classes, higher values are sent first.
+enum ws_prio {
+    WS_PRIO_DATA,
+    WS_PRIO_CTRL, // RPL and ND
+    WS_PRIO_COUNT,
+};
+
+// Frame queued for transmission, or sent to the RCP and waiting for a
+// confirmation.
 struct ws_frame_ctx {
     uint8_t handle;
     uint8_t type;
     struct eui64 dst;
-    SLIST_ENTRY(ws_frame_ctx) link;
+
+    // Only set while queued
+    uint8_t *frame;
+    size_t   frame_len;
+    uint32_t order;
+    STAILQ_ENTRY(ws_frame_ctx) link;
 };
 
-// Define struct ws_frame_list
-SLIST_HEAD(ws_frame_ctx_list, ws_frame_ctx);
+/*
+ * Unicast data frames are queued per destination, and only a few of them are
+ * handed to the RCP at once. This keeps the RCP buffers available for other
+ * neighbors when a destination is slow, and allows control traffic to
+ * overtake data.
+ */
+struct ws_tx_queue {
+    struct eui64 dst;
+    int inflight;
+    int len;
+    STAILQ_HEAD(, ws_frame_ctx) frames[WS_PRIO_COUNT];
+    SLIST_ENTRY(ws_tx_queue) link;
+};
 
 struct ws_ind {
     const struct rcp_rx_ind *hif;
@@ -112,7 +137,12 @@ struct ws_ctx {
 
     uint8_t seqno;
     uint8_t  handle_next;
-    struct ws_frame_ctx_list frame_ctx_list;
+    // Frames queued or sent to the RCP, indexed by handle
+    struct ws_frame_ctx *frame_ctx_table[UINT8_MAX + 1];
+    int frame_ctx_count;
+    SLIST_HEAD(, ws_tx_queue) tx_queues;
+    int tx_queued;
+    uint32_t tx_order;
     struct eui64 edfe_src;
     int     eapol_relay_fd;
     uint8_t gak_index;
@@ -126,7 +156,7 @@ void ws_if_recv_cnf(struct rcp *rcp, const struct rcp_tx_cnf *cnf);
 
 int ws_if_send_data(struct ws_ctx *ws,
                     const void *pkt, size_t pkt_len,
-                    const struct eui64 *dst);
+                    const struct eui64 *dst, int prio);
 void ws_if_send_eapol(struct ws_ctx *ws, uint8_t kmp_id,
                       const void *pkt, size_t pkt_len,
                       const struct eui64 *dst,
@@ -27,6 +27,7 @@
 #include "common/time_extra.h"
 #include "common/version.h"
 #include "common/endian.h"
+#include "common/fnv_hash.h"
 #include "common/mathutils.h"
 #include "common/memutils.h"
 #include "common/rand.h"
@@ -49,6 +50,7 @@ static void ws_neigh_timer_cb(struct timer_group *group, struct timer_entry *tim
 // Wi-SUN FAN 1v33 6.2.3.1.6.1 Link Metrics
 static void ws_neigh_etx_compute(struct ws_neigh_table *table, struct ws_neigh *neigh)
 {
+    struct ws_neigh_hot *hot = ws_neigh_hot(table, neigh);
     float etx;
 
     /*
@@ -64,7 +66,7 @@ static void ws_neigh_etx_compute(struct ws_neigh_table *table, struct ws_neigh *
      * calculation epoch (to speed boot time).
      */
     if (!((neigh->etx_tx_cnt >= 4 && timer_stopped(&neigh->etx_timer_compute)) ||
-          isnan(neigh->etx))) {
+          isnan(hot->etx))) {
         // Probe right now until we reach the 4 necessary measurements
         if (timer_stopped(&neigh->etx_timer_outdated) && table->on_etx_outdated)
             table->on_etx_outdated(table, neigh);
@@ -93,12 +95,12 @@ static void ws_neigh_etx_compute(struct ws_neigh_table *table, struct ws_neigh *
      * The ETX calculation is performed at a defined epoch, with the ETX result
      * fed into an EWMA using smoothing factor of 1/8.
      */
-    etx = ws_neigh_ewma_next(neigh->etx, etx, 1.f / (float)neigh->etx_compute_cnt);
+    etx = ws_neigh_ewma_next(hot->etx, etx, 1.f / (float)neigh->etx_compute_cnt);
 
     TRACE(TR_NEIGH_15_4, "neigh-15.4 set %s etx tx=%u / ack=%u => old=%.2f new=%.2f",
-          tr_eui64(neigh->eui64.u8), neigh->etx_tx_cnt, neigh->etx_ack_cnt, neigh->etx, etx);
+          tr_eui64(neigh->eui64.u8), neigh->etx_tx_cnt, neigh->etx_ack_cnt, hot->etx, etx);
 
-    neigh->etx = etx;
+    hot->etx = etx;
     neigh->etx_tx_cnt  = 0;
     neigh->etx_ack_cnt = 0;
     timer_start_rel(&table->timer_group, &neigh->etx_timer_compute, 60 * 1000);
@@ -143,14 +145,29 @@ void ws_neigh_etx_update(struct ws_neigh_table *table,
     timer_start_rel(&table->timer_group, &neigh->etx_timer_compute, 0);
 }
 
+static unsigned int ws_neigh_hash(const struct eui64 *eui64)
+{
+    return fnv_hash_reverse_32_init(eui64->u8, sizeof(eui64->u8)) % WS_NEIGH_HASH_SIZE;
+}
+
 struct ws_neigh *ws_neigh_add(struct ws_neigh_table *table,
                               const struct eui64 *eui64,
                               uint8_t role, int8_t tx_power_dbm,
                               unsigned int key_index_mask)
 {
     struct ws_neigh *neigh = zalloc(sizeof(struct ws_neigh));
+    struct ws_neigh_hot *hot;
 
-    neigh->node_role = role;
+    if (table->hot_len == table->hot_size) {
+        table->hot_size = MAX(64, 2 * table->hot_size);
+        table->hot = realloc(table->hot, table->hot_size * sizeof(*table->hot));
+        FATAL_ON(!table->hot, 2, "%s: realloc(): %m", __func__);
+    }
+    neigh->id = table->hot_len++;
+    hot = ws_neigh_hot(table, neigh);
+    memset(hot, 0, sizeof(*hot));
+    hot->neigh = neigh;
+    hot->node_role = role;
     for (uint8_t key_index = 1; key_index <= HIF_KEY_COUNT; key_index++)
         if (!(key_index_mask & BIT(key_index)))
             neigh->frame_counter_min[key_index - 1] = UINT32_MAX;
@@ -164,10 +181,10 @@ struct ws_neigh *ws_neigh_add(struct ws_neigh_table *table,
      * - this neighbor link metrics refresh only applies to wsrd
      * - 2200s gives a 7min margin for probe retries.
      */
-    neigh->lifetime_s = WS_NEIGHBOR_LINK_TIMEOUT;
+    hot->lifetime_s = WS_NEIGHBOR_LINK_TIMEOUT;
     neigh->eui64 = *eui64;
     neigh->timer.callback = ws_neigh_timer_cb;
-    timer_start_rel(&table->timer_group, &neigh->timer, neigh->lifetime_s * 1000);
+    timer_start_rel(&table->timer_group, &neigh->timer, hot->lifetime_s * 1000);
     neigh->rsl_in_dbm = NAN;
     neigh->rsl_in_dbm_unsecured = NAN;
     neigh->rsl_out_dbm = NAN;
@@ -177,14 +194,15 @@ struct ws_neigh *ws_neigh_add(struct ws_neigh_table *table,
     neigh->lqi_unsecured = INT_MAX;
     neigh->apc_txpow_dbm = tx_power_dbm;
     neigh->apc_txpow_dbm_ofdm = tx_power_dbm;
-    neigh->etx = NAN;
+    hot->etx = NAN;
     neigh->etx_timer_compute.callback  = ws_neigh_etx_timeout_compute;
     neigh->etx_timer_outdated.callback = ws_neigh_etx_timeout_outdated;
     SLIST_INSERT_HEAD(&table->neigh_list, neigh, link);
+    SLIST_INSERT_HEAD(&table->neigh_hash[ws_neigh_hash(eui64)], neigh, hash_link);
     if (table->on_add)
         table->on_add(table, neigh);
     TRACE(TR_NEIGH_15_4, "neigh-15.4 add %s lifetime=%us",
-          tr_eui64(neigh->eui64.u8), neigh->lifetime_s);
+          tr_eui64(neigh->eui64.u8), hot->lifetime_s);
     return neigh;
 }
 
@@ -192,7 +210,7 @@ struct ws_neigh *ws_neigh_get(const struct ws_neigh_table *table, const struct e
 {
     struct ws_neigh *neigh;
 
-    return SLIST_FIND(neigh, &table->neigh_list, link,
+    return SLIST_FIND(neigh, &table->neigh_hash[ws_neigh_hash(eui64)], hash_link,
                       eui64_eq(&neigh->eui64, eui64));
 }
 
@@ -205,25 +223,30 @@ void ws_neigh_del(struct ws_neigh_table *table, const struct eui64 *eui64)
         timer_stop(&table->timer_group, &neigh->etx_timer_compute);
         timer_stop(&table->timer_group, &neigh->etx_timer_outdated);
         SLIST_REMOVE(&table->neigh_list, neigh, ws_neigh, link);
+        SLIST_REMOVE(&table->neigh_hash[ws_neigh_hash(eui64)], neigh, ws_neigh, hash_link);
         TRACE(TR_NEIGH_15_4, "neigh-15.4 del %s", tr_eui64(neigh->eui64.u8));
         if (table->on_del)
             table->on_del(table, neigh);
+        table->hot[neigh->id] = table->hot[--table->hot_len];
+        table->hot[neigh->id].neigh->id = neigh->id;
+        if (!table->hot_len) {
+            free(table->hot);
+            table->hot = NULL;
+            table->hot_size = 0;
+        }
         free(neigh);
     }
 }
 
 void ws_neigh_clean(struct ws_neigh_table *table)
 {
-    struct ws_neigh *neigh;
-    struct ws_neigh *tmp;
-
-    SLIST_FOREACH_SAFE(neigh, &table->neigh_list, link, tmp)
-        ws_neigh_del(table, &neigh->eui64);
+    while (table->hot_len)
+        ws_neigh_del(table, &table->hot[table->hot_len - 1].neigh->eui64);
 }
 
 void ws_neigh_etx_reset(struct ws_neigh_table *table, struct ws_neigh *neigh)
 {
-    neigh->etx = NAN;
+    ws_neigh_hot(table, neigh)->etx = NAN;
     neigh->etx_tx_cnt = 0;
     neigh->etx_ack_cnt = 0;
     neigh->etx_compute_cnt = 0;
@@ -233,7 +256,7 @@ void ws_neigh_etx_reset(struct ws_neigh_table *table, struct ws_neigh *neigh)
 
 size_t ws_neigh_get_neigh_count(struct ws_neigh_table *table)
 {
-    return SLIST_SIZE(&table->neigh_list, link);
+    return table->hot_len;
 }
 
 void ws_neigh_ut_update(struct ws_neigh_fhss *fhss_data, uint24_t ufsi,
@@ -297,10 +320,12 @@ static void ws_neigh_excluded_mask_by_mask(uint8_t channel_mask[WS_CHAN_MASK_LEN
                                            uint16_t number_of_channels)
 {
     int nchan = MIN(number_of_channels, mask_info->mask_len_inline * 8);
+    uint8_t mask_excl[WS_CHAN_MASK_LEN] = { };
 
-    for (int i = 0; i < nchan; i++)
-        if (bittest(mask_info->channel_mask, i))
-            bitclr(channel_mask, i);
+    memcpy(mask_excl, mask_info->channel_mask, MIN(mask_info->mask_len_inline, WS_CHAN_MASK_LEN));
+    if (nchan < 8 * WS_CHAN_MASK_LEN)
+        bitfill(mask_excl, false, nchan, 8 * WS_CHAN_MASK_LEN - 1);
+    ws_chan_mask_andn(channel_mask, mask_excl);
 }
 
 static void ws_neigh_set_chan_list(const struct ws_fhss_config *fhss_config,
@@ -555,32 +580,33 @@ bool ws_neigh_duplicate_packet_check(struct ws_neigh *neigh, uint8_t mac_dsn, ui
 
 int ws_neigh_lfn_count(struct ws_neigh_table *table)
 {
-    struct ws_neigh *neigh;
     int cnt = 0;
 
-    SLIST_FOREACH(neigh, &table->neigh_list, link)
-        if (neigh->node_role == WS_NR_ROLE_LFN)
+    for (int i = 0; i < table->hot_len; i++)
+        if (table->hot[i].node_role == WS_NR_ROLE_LFN)
             cnt++;
     return cnt;
 }
 
 void ws_neigh_trust(struct ws_neigh_table *table, struct ws_neigh *neigh)
 {
-    if (neigh->trusted_device)
+    struct ws_neigh_hot *hot = ws_neigh_hot(table, neigh);
+
+    if (hot->trusted)
         return;
 
-    timer_start_rel(&table->timer_group, &neigh->timer, neigh->lifetime_s * 1000);
-    neigh->trusted_device = true;
+    timer_start_rel(&table->timer_group, &neigh->timer, hot->lifetime_s * 1000);
+    hot->trusted = true;
     TRACE(TR_NEIGH_15_4, "neigh-15.4 set %s lifetime=%us (trusted)",
-          tr_eui64(neigh->eui64.u8), neigh->lifetime_s);
+          tr_eui64(neigh->eui64.u8), hot->lifetime_s);
 }
 
 void ws_neigh_refresh(struct ws_neigh_table *table, struct ws_neigh *neigh, uint32_t lifetime_s)
 {
-    neigh->lifetime_s = lifetime_s;
-    timer_start_rel(&table->timer_group, &neigh->timer, neigh->lifetime_s * 1000);
+    ws_neigh_hot(table, neigh)->lifetime_s = lifetime_s;
+    timer_start_rel(&table->timer_group, &neigh->timer, lifetime_s * 1000);
     TRACE(TR_NEIGH_15_4, "neigh-15.4 set %s lifetime=%us (refresh)",
-          tr_eui64(neigh->eui64.u8), neigh->lifetime_s);
+          tr_eui64(neigh->eui64.u8), lifetime_s);
 }
 
 /*
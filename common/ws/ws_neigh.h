@@ -25,6 +25,7 @@
 
 #include "common/ws/ws_chan_mask.h"
 #include "common/ws/ws_ie.h"
+#include "common/codel.h"
 #include "common/eui64.h"
 #include "common/int24.h"
 #include "common/timer.h"
@@ -73,8 +74,26 @@ struct lto_info {
     bool offset_adjusted;
 };
 
+/*
+ * Fields read when walking the whole table. They are kept out of struct
+ * ws_neigh, in a dense array of struct ws_neigh_table indexed by ws_neigh.id,
+ * so a walk reads contiguous memory instead of one large struct per neighbor.
+ * struct ws_neigh keeps the rarely read data (schedules, RSL, timers...).
+ */
+struct ws_neigh_hot {
+    struct ws_neigh *neigh;
+    uint32_t lifetime_s;
+    float etx;          // TODO: Support ETX computation with mode switch as per FAN 1.1
+    uint8_t node_role;
+    bool trusted;       // True mean use normal group key, false for enable pairwise key
+};
+
 struct ws_neigh {
+    // Only fields read by ws_neigh_get() are placed here, so a lookup touches
+    // a single cache line per entry in the bucket.
     struct eui64 eui64;
+    SLIST_ENTRY(ws_neigh) hash_link;
+    int id; // Index in ws_neigh_table.hot
 
     /**
      * Theses fields were introduced to differentiate FHSS data read in secured
@@ -117,10 +136,8 @@ struct ws_neigh {
     int lqi_unsecured;
     struct ws_pom_ie pom_ie;
     struct lto_info lto_info;
-    uint8_t node_role;
     uint32_t frame_counter_min[HIF_KEY_COUNT];
     uint32_t expiration_s;
-    uint32_t lifetime_s;                                   /*!< Life time in seconds */
     uint8_t ms_phy_mode_id;                                /*!< PhyModeId selected for Mode Switch with this neighbor */
     uint8_t ms_mode;                                       /*!< Mode switch mode */
     uint32_t ms_tx_count;                                  /*!< Mode switch Tx success count */ // TODO: implement fallback mechanism in wbsrd
@@ -135,27 +152,37 @@ struct ws_neigh {
     int8_t apc_txpow_dbm;
     int8_t apc_txpow_dbm_ofdm;
 
-    // TODO: Support ETX computation with mode switch as per FAN 1.1
-    float etx;
     int etx_tx_cnt;
     int etx_ack_cnt;
     int etx_compute_cnt;
     struct timer_entry etx_timer_compute;
     struct timer_entry etx_timer_outdated;
 
+    // Active queue management of the frames waiting for this neighbor
+    struct codel aqm;
+
     uint8_t edfe_mode;
-    bool trusted_device: 1;                                /*!< True mean use normal group key, false for enable pairwise key */
     struct timer_entry timer;
     SLIST_ENTRY(ws_neigh) link;
 };
 SLIST_HEAD(ws_neigh_list, ws_neigh);
 
+
+#define WS_NEIGH_HASH_SIZE 256 /* buckets of the EUI-64 index */
 /**
  * Neighbor hopping info data base
  */
 struct ws_neigh_table {
     struct timer_group timer_group;
     struct ws_neigh_list neigh_list;
+    // ws_neigh_get() runs for every frame sent or received, it uses this
+    // index instead of the list.
+    struct ws_neigh_list neigh_hash[WS_NEIGH_HASH_SIZE];
+    // Neighbor IDs are kept contiguous: deleting a neighbor moves the last
+    // one into its slot.
+    struct ws_neigh_hot *hot;
+    int hot_len;
+    int hot_size;
     void (*on_add)(struct ws_neigh_table *table, struct ws_neigh *neigh);
     void (*on_del)(struct ws_neigh_table *table, struct ws_neigh *neigh);
 
@@ -169,6 +196,11 @@ struct ws_neigh_table {
 
 struct ws_neigh *ws_neigh_get(const struct ws_neigh_table *table, const struct eui64 *eui64);
 
+static inline struct ws_neigh_hot *ws_neigh_hot(const struct ws_neigh_table *table, const struct ws_neigh *neigh)
+{
+    return &table->hot[neigh->id];
+}
+
 void ws_neigh_del(struct ws_neigh_table *table, const struct eui64 *eui64);
 void ws_neigh_clean(struct ws_neigh_table *table);
 
@@ -12,6 +12,7 @@
  * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
  */
 #define _GNU_SOURCE
+#include <inttypes.h>
 #include <stdio.h>
 #include <errno.h>
 #include <fcntl.h>
@@ -22,6 +23,7 @@
 #include "common/log.h"
 #include "common/memutils.h"
 #include "wsbrd_fuzz.h"
+#include "vrcp.h"
 #include "commandline.h"
 
 enum {
@@ -43,7 +45,13 @@ void __wrap_print_help_br(FILE *stream)
     fprintf(stream, "Extra options:\n");
     fprintf(stream, "  --replay=FILE         Replay a sequence captured using --capture. When specified more than\n");
     fprintf(stream, "                          once, files are replayed back to back from left to right.\n");
+    fprintf(stream, "  --seek=SECONDS        Start the replay of the first file from the last checkpoint before\n");
+    fprintf(stream, "                          SECONDS after the start of the capture (see\n");
+    fprintf(stream, "                          capture_checkpoint_interval).\n");
     fprintf(stream, "  --fuzz                Disable CRC check, stub security RNG, relax SPINEL checks, disable NVM.\n");
+    fprintf(stream, "  --vrcp=FILE           Replace the RCP by a simulated network described in FILE (see\n");
+    fprintf(stream, "                          tools/fuzz/README.md). Runs on a virtual clock and exits with a\n");
+    fprintf(stream, "                          report at the end of the simulation.\n");
 }
 
 static void parse_opt_replay(struct fuzz_ctxt *ctxt, const char *arg)
@@ -54,10 +62,28 @@ static void parse_opt_replay(struct fuzz_ctxt *ctxt, const char *arg)
         "--replay used too many times (max %zu)", ARRAY_SIZE(ctxt->replay_fds));
     ret = open(arg, O_RDONLY);
     FATAL_ON(ret < 0, 2, "open '%s': %m", arg);
+    if (!ctxt->replay_count)
+        ctxt->replay_filename = arg;
     ctxt->replay_fds[ctxt->replay_count++] = ret;
     ctxt->wsbrd->config.rcp_cfg.uart_dev[0] = true; // UART device does not need to be specified
 }
 
+static void parse_opt_seek(struct fuzz_ctxt *ctxt, const char *arg)
+{
+    char *end;
+
+    ctxt->seek_time_s = strtoull(arg, &end, 0);
+    FATAL_ON(!*arg || *end, 1, "--seek: invalid number: %s", arg);
+    ctxt->seek_enabled = true;
+}
+
+static void parse_opt_vrcp(struct fuzz_ctxt *ctxt, const char *arg)
+{
+    FATAL_ON(ctxt->replay_count, 1, "--vrcp is incompatible with --replay");
+    ctxt->vrcp = vrcp_new(ctxt, arg);
+    ctxt->wsbrd->config.rcp_cfg.uart_dev[0] = true; // UART device does not need to be specified
+}
+
 static void parse_opt_fuzz(struct fuzz_ctxt *ctxt, const char *arg)
 {
     ctxt->fuzzing_enabled = true;
@@ -103,7 +129,9 @@ static int fuzz_parse_arg(struct fuzz_ctxt *ctxt, char **argv)
 {
     static const struct option opts[] = {
         { "--replay",       true,  parse_opt_replay },
+        { "--seek",         true,  parse_opt_seek },
         { "--fuzz",         false, parse_opt_fuzz },
+        { "--vrcp",         true,  parse_opt_vrcp },
         { 0,                0,     0 },
     };
     int ret;
@@ -137,6 +165,16 @@ int fuzz_parse_commandline(struct fuzz_ctxt *ctxt, char **argv)
 
     if (ctxt->replay_count)
         ctxt->rand_predictable = true;
+    FATAL_ON(ctxt->seek_enabled && !ctxt->replay_count, 1, "--seek requires --replay");
+    FATAL_ON(ctxt->vrcp && ctxt->replay_count > 1, 1, "--vrcp is incompatible with --replay");
+    FATAL_ON(ctxt->vrcp && ctxt->seek_enabled, 1, "--vrcp is incompatible with --seek");
+    if (ctxt->seek_enabled && !capture_seek(ctxt->replay_filename, ctxt->seek_time_s, &ctxt->seek)) {
+        WARN("no checkpoint before %"PRIu64"s, replaying from the start", ctxt->seek_time_s);
+        ctxt->seek_enabled = false;
+    }
+    if (ctxt->seek_enabled)
+        INFO("replay from checkpoint %d at %"PRIu64".%03"PRIu64"s", ctxt->seek.index,
+             ctxt->seek.time_ms / 1000, ctxt->seek.time_ms % 1000);
 
     return j;
 }
@@ -14,6 +14,7 @@
 #define _GNU_SOURCE
 #include <stdint.h>
 #include <assert.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <netinet/in.h>
 #include "app_wsbrd/net/netaddr_types.h"
@@ -28,6 +29,7 @@
 #include "common/hif.h"
 #include "interfaces.h"
 #include "wsbrd_fuzz.h"
+#include "vrcp.h"
 
 static struct fuzz_iface *fuzz_iface_new(struct fuzz_ctxt *ctxt)
 {
@@ -40,7 +42,8 @@ static struct fuzz_iface *fuzz_iface_new(struct fuzz_ctxt *ctxt)
     iface = &ctxt->iface_list[ctxt->iface_count - 1];
 
     memset(iface, 0, sizeof(*iface));
-    ret = pipe(iface->pipefd);
+    // The virtual RCP may queue several packets: keep their boundaries
+    ret = pipe2(iface->pipefd, ctxt->vrcp ? O_DIRECT : 0);
     FATAL_ON(ret < 0, 2, "pipe: %m");
     return iface;
 }
@@ -98,6 +101,8 @@ void __wrap_wsbr_tun_init(struct wsbr_ctxt *wsbrd)
 
     iface = fuzz_iface_new(ctxt);
     wsbrd->tun.fd = iface->pipefd[0];
+    // Like the real TUN, see wsbr_tun_read()
+    FATAL_ON(fcntl(wsbrd->tun.fd, F_SETFL, O_NONBLOCK) < 0, 2, "fcntl: %m");
 
     memcpy(ctxt->tun_gua, &wsbrd->config.ipv6_prefix, 8);
     memcpy(ctxt->tun_gua + 8, &wsbrd->rcp.eui64, 8);
@@ -244,6 +249,8 @@ ssize_t __wrap_sendmsg(int sockfd, const struct msghdr *msg, int flags)
 {
     ssize_t size = 0;
 
+    if (g_fuzz_ctxt.vrcp)
+        vrcp_recv_sendmsg(g_fuzz_ctxt.vrcp, sockfd, msg);
     if (g_fuzz_ctxt.replay_count) {
         for (int i = 0; i < msg->msg_iovlen; i++)
             size += msg->msg_iov[i].iov_len;
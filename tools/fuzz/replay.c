@@ -17,7 +17,9 @@
 #include "app_wsbrd/app/wsbrd.h"
 #include "app_wsbrd/net/timers.h"
 #include "tools/fuzz/wsbrd_fuzz.h"
+#include "tools/fuzz/vrcp.h"
 #include "common/log.h"
+#include "common/mathutils.h"
 #include "common/bus.h"
 #include "common/hif.h"
 
@@ -81,6 +83,8 @@ ssize_t __wrap_write(int fd, const void *buf, size_t count)
     if (fd == ctxt->wsbrd->rcp.bus.fd && ctxt->replay_count)
         return count;
 
+    if (fd == ctxt->wsbrd->tun.fd && ctxt->vrcp)
+        vrcp_recv_tun(ctxt->vrcp, buf, count);
     if (fd == ctxt->wsbrd->tun.fd && ctxt->replay_count)
         return count;
 
@@ -93,6 +97,8 @@ ssize_t __wrap_writev(int fd, const struct iovec *iov, int iovcnt)
     struct fuzz_ctxt *ctxt = &g_fuzz_ctxt;
 
     BUG_ON(iovcnt != 3); // hdr | cmd + body | fcs
+    if (fd == ctxt->wsbrd->rcp.bus.fd && ctxt->vrcp)
+        vrcp_recv_hif(ctxt->vrcp, iov[1].iov_base, iov[1].iov_len);
     if (fd == ctxt->wsbrd->rcp.bus.fd && ctxt->replay_count)
         return iov[0].iov_len + iov[1].iov_len + iov[2].iov_len;
     else
@@ -126,8 +132,22 @@ ssize_t __wrap_read(int fd, void *buf, size_t buf_len)
 {
     struct fuzz_ctxt *ctxt = &g_fuzz_ctxt;
     struct timer_entry *timer;
+    off_t pos;
     ssize_t ret;
 
+    // Feed the RCP initialization sequence, then jump to the checkpoint
+    if (ctxt->seek_enabled && ctxt->replay_count && fd == ctxt->replay_fds[0]) {
+        pos = lseek(fd, 0, SEEK_CUR);
+        FATAL_ON(pos < 0, 2, "%s: lseek: %m", __func__);
+        if (pos >= ctxt->seek.init_end) {
+            pos = lseek(fd, ctxt->seek.offset, SEEK_SET);
+            FATAL_ON(pos < 0, 2, "%s: lseek: %m", __func__);
+            ctxt->seek_enabled = false;
+        } else {
+            buf_len = MIN(buf_len, ctxt->seek.init_end - pos);
+        }
+    }
+
     ret = __real_read(fd, buf, buf_len);
     if (ret < 0 || !ctxt->replay_count)
         return ret;
@@ -0,0 +1,882 @@
+/*
+ * SPDX-License-Identifier: LicenseRef-MSLA
+ * Copyright (c) 2025 Silicon Laboratories Inc. (www.silabs.com)
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of the Silicon Labs Master Software License
+ * Agreement (MSLA) available at [1].  This software is distributed to you in
+ * Object Code format and/or Source Code format and is governed by the sections
+ * of the MSLA applicable to Object Code, Source Code and Modified Open Source
+ * Code. By using this software, you agree to the terms of the MSLA.
+ *
+ * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
+ */
+#define _GNU_SOURCE
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include "app_wsbrd/app/wsbrd.h"
+#include "app_wsbrd/net/netaddr_types.h"
+#include "app_wsbrd/rpl/rpl_lollipop.h"
+#include "common/ipv6/ipv6_cksum.h"
+#include "common/specs/6lowpan.h"
+#include "common/specs/icmpv6.h"
+#include "common/specs/ieee802154.h"
+#include "common/specs/ieee802159.h"
+#include "common/specs/ipv6.h"
+#include "common/specs/ndp.h"
+#include "common/specs/rpl.h"
+#include "common/specs/ws.h"
+#include "common/ws/ws_ie.h"
+#include "common/ws/ws_regdb.h"
+#include "common/commandline.h"
+#include "common/histogram.h"
+#include "common/ieee802154_frame.h"
+#include "common/ieee802154_ie.h"
+#include "common/string_extra.h"
+#include "common/mathutils.h"
+#include "common/memutils.h"
+#include "common/version.h"
+#include "common/endian.h"
+#include "common/timer.h"
+#include "common/bits.h"
+#include "common/crc.h"
+#include "common/hif.h"
+#include "common/iobuf.h"
+#include "common/log.h"
+#include "common/mpx.h"
+#include "wsbrd_fuzz.h"
+#include "vrcp.h"
+
+// Uplink UDP packets are sent to a documentation address (RFC 3849) which is
+// routed to the TUN interface.
+static const struct in6_addr vrcp_data_dst = {
+    .s6_addr = { 0x20, 0x01, 0x0d, 0xb8, 0xff, 0xff, 0xff, 0xff, [15] = 0x01 }
+};
+#define VRCP_DATA_PORT 1234
+
+#define VRCP_ARO_LIFETIME_MIN 120
+#define VRCP_JOIN_WAIT_MS     1000
+#define VRCP_NODE_MAX         0xfffffe
+#define VRCP_BR_INDEX         0xffffff
+
+enum {
+    VRCP_EV_JOIN,
+    VRCP_EV_DAO,
+    VRCP_EV_ARO,
+    VRCP_EV_DATA,
+    VRCP_EV_END,
+};
+
+struct vrcp_event {
+    uint64_t time_ms;
+    uint32_t seq;     // Keeps events scheduled at the same time in order
+    uint32_t node;
+    uint16_t gen;     // VRCP_EV_DAO is ignored if it does not match the node
+    uint8_t  type;
+};
+
+struct vrcp_node {
+    int      parent;  // -1 for children of the border router
+    int      relay;   // Child of the border router forwarding the frames
+    uint8_t  depth;
+    bool     joined;
+    uint8_t  seqno;
+    uint8_t  dao_seq;
+    uint8_t  path_seq;
+    uint8_t  aro_tid;
+    uint16_t dao_gen;
+    uint32_t frame_counter;
+    uint64_t join_ms; // First DAO transmission
+};
+
+struct vrcp_scenario {
+    int node_count;
+    int br_children;
+    int fanout;
+    int join_start_s;
+    int join_interval_ms;
+    int dao_retry_s;
+    int data_interval_s;
+    int data_size;
+    int duration_s;
+};
+
+struct vrcp {
+    struct fuzz_ctxt *ctxt;
+    struct vrcp_scenario cfg;
+    int fd;
+    struct iobuf_write out;  // HIF frames not yet accepted by the socket
+    int out_offset;
+    uint64_t out_count;
+    bool started;
+    unsigned int key_mask;
+    uint8_t key_index;
+
+    struct vrcp_node *nodes;
+    struct vrcp_event *events; // Binary min-heap
+    int event_count;
+    int event_size;
+    uint32_t event_seq;
+
+    uint64_t start_ms;
+    uint64_t last_join_ms;
+    int joined_count;
+    struct histogram join_hist;
+    uint64_t frame_rx;
+    uint64_t frame_tx;
+    uint64_t data_tx;
+    uint64_t data_rx;
+    uint64_t cpu_ns;
+    struct timespec wall_start;
+};
+
+int __real_clock_gettime(clockid_t clockid, struct timespec *tp);
+int __real_setsockopt(int sockfd, int level, int optname, const void *optval, socklen_t optlen);
+ssize_t __real_write(int fd, const void *buf, size_t count);
+
+static uint64_t vrcp_cpu_ns(void)
+{
+    struct timespec ts;
+
+    __real_clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static bool vrcp_event_before(const struct vrcp_event *a, const struct vrcp_event *b)
+{
+    if (a->time_ms != b->time_ms)
+        return a->time_ms < b->time_ms;
+    return a->seq < b->seq;
+}
+
+static void vrcp_event_push(struct vrcp *vrcp, uint64_t time_ms, int node, uint8_t type, uint16_t gen)
+{
+    struct vrcp_event ev = {
+        .time_ms = time_ms,
+        .seq     = vrcp->event_seq++,
+        .node    = node,
+        .gen     = gen,
+        .type    = type,
+    };
+    int i, parent;
+
+    if (vrcp->event_count == vrcp->event_size) {
+        vrcp->event_size = vrcp->event_size ? 2 * vrcp->event_size : 64;
+        vrcp->events = reallocarray(vrcp->events, vrcp->event_size, sizeof(struct vrcp_event));
+        FATAL_ON(!vrcp->events, 2, "%s: realloc: %m", __func__);
+    }
+    i = vrcp->event_count++;
+    while (i) {
+        parent = (i - 1) / 2;
+        if (vrcp_event_before(&vrcp->events[parent], &ev))
+            break;
+        vrcp->events[i] = vrcp->events[parent];
+        i = parent;
+    }
+    vrcp->events[i] = ev;
+}
+
+static struct vrcp_event vrcp_event_pop(struct vrcp *vrcp)
+{
+    struct vrcp_event ev = vrcp->events[0];
+    struct vrcp_event *last;
+    int i, child;
+
+    BUG_ON(!vrcp->event_count);
+    last = &vrcp->events[--vrcp->event_count];
+    i = 0;
+    while ((child = 2 * i + 1) < vrcp->event_count) {
+        if (child + 1 < vrcp->event_count &&
+            vrcp_event_before(&vrcp->events[child + 1], &vrcp->events[child]))
+            child++;
+        if (vrcp_event_before(last, &vrcp->events[child]))
+            break;
+        vrcp->events[i] = vrcp->events[child];
+        i = child;
+    }
+    vrcp->events[i] = *last;
+    return ev;
+}
+
+static void vrcp_node_eui64(int i, struct eui64 *eui64)
+{
+    // Locally administered, "vrcp" in ASCII, then the node index
+    const uint8_t buf[8] = { 0x02, 'v', 'r', 'c', 'p', i >> 16, i >> 8, i };
+
+    memcpy(eui64->u8, buf, 8);
+}
+
+static void vrcp_node_addr(int i, const uint8_t prefix[8], struct in6_addr *addr)
+{
+    struct eui64 eui64;
+
+    vrcp_node_eui64(i, &eui64);
+    memcpy(addr->s6_addr, prefix, 8);
+    memcpy(addr->s6_addr + 8, eui64.u8, 8);
+    addr->s6_addr[8] ^= 0x02;
+}
+
+static int vrcp_node_from_addr(struct vrcp *vrcp, const struct in6_addr *addr)
+{
+    struct in6_addr ref;
+    int i;
+
+    vrcp_node_addr(0, vrcp->ctxt->wsbrd->config.ipv6_prefix.s6_addr, &ref);
+    if (memcmp(addr->s6_addr, ref.s6_addr, 13))
+        return -1;
+    i = addr->s6_addr[13] << 16 | addr->s6_addr[14] << 8 | addr->s6_addr[15];
+    return i < vrcp->cfg.node_count ? i : -1;
+}
+
+static int vrcp_iface_index(struct fuzz_ctxt *ctxt, int fd)
+{
+    for (int i = 0; i < ctxt->iface_count; i++)
+        if (ctxt->iface_list[i].pipefd[0] == fd)
+            return i;
+    BUG("fd=%i not registered", fd);
+}
+
+static void vrcp_flush(struct vrcp *vrcp)
+{
+    ssize_t ret;
+
+    if (vrcp->out_offset == vrcp->out.len)
+        return;
+    ret = __real_write(vrcp->fd, vrcp->out.data + vrcp->out_offset, vrcp->out.len - vrcp->out_offset);
+    if (ret < 0 && errno == EAGAIN)
+        return;
+    FATAL_ON(ret < 0, 2, "%s: write: %m", __func__);
+    vrcp->out_offset += ret;
+    if (vrcp->out_offset == vrcp->out.len) {
+        vrcp->out.len = 0;
+        vrcp->out_offset = 0;
+    }
+}
+
+// Same framing as uart_tx()
+static void vrcp_tx(struct vrcp *vrcp, const struct iobuf_write *buf)
+{
+    uint8_t hdr[4];
+
+    write_le16(hdr,     buf->len);
+    write_le16(hdr + 2, crc16(CRC_INIT_HCS, hdr, 2));
+    iobuf_push_data(&vrcp->out, hdr, sizeof(hdr));
+    iobuf_push_data(&vrcp->out, buf->data, buf->len);
+    iobuf_push_le16(&vrcp->out, crc16(CRC_INIT_FCS, buf->data, buf->len));
+    vrcp->out_count++;
+    vrcp_flush(vrcp);
+}
+
+static void vrcp_send_ind_reset(struct vrcp *vrcp)
+{
+    struct iobuf_write buf = { };
+    struct eui64 eui64;
+
+    vrcp_node_eui64(VRCP_BR_INDEX, &eui64);
+    iobuf_push_u8(&buf, HIF_CMD_IND_RESET);
+    iobuf_push_le32(&buf, version_daemon_api);
+    iobuf_push_le32(&buf, version_daemon_api);
+    iobuf_push_data(&buf, "vrcp", sizeof("vrcp"));
+    iobuf_push_data(&buf, eui64.u8, 8);
+    vrcp_tx(vrcp, &buf);
+    iobuf_free(&buf);
+}
+
+// Advertise a single RAIL configuration matching the one requested by wsbrd
+static void vrcp_send_cnf_radio_list(struct vrcp *vrcp)
+{
+    const struct wsbrd_conf *config = &vrcp->ctxt->wsbrd->config;
+    const struct chan_params *chan_params;
+    const struct phy_params *phy_params;
+    struct iobuf_write buf = { };
+
+    phy_params  = ws_regdb_phy_params(config->ws_phy_mode_id, config->ws_mode);
+    chan_params = ws_regdb_chan_params(config->ws_domain, config->ws_chan_plan_id, config->ws_class);
+    FATAL_ON(!phy_params, 1, "vrcp: unsupported PHY configuration");
+    iobuf_push_u8(&buf, HIF_CMD_CNF_RADIO_LIST);
+    iobuf_push_u8(&buf, 2 + 1 + 4 + 4 + 2 + 2); // Entry size
+    iobuf_push_u8(&buf, true);                  // List end
+    iobuf_push_le16(&buf, 0x01fe);              // MCS 0 to 7, no PHY group
+    iobuf_push_u8(&buf, phy_params->rail_phy_mode_id);
+    iobuf_push_le32(&buf, chan_params ? chan_params->chan0_freq   : config->ws_chan0_freq);
+    iobuf_push_le32(&buf, chan_params ? chan_params->chan_spacing : config->ws_chan_spacing);
+    iobuf_push_le16(&buf, chan_params ? chan_params->chan_count   : config->ws_chan_count);
+    iobuf_push_le16(&buf, (uint16_t)-100);      // Sensitivity (dBm)
+    vrcp_tx(vrcp, &buf);
+    iobuf_free(&buf);
+}
+
+// Every transmission succeeds, without Enhanced Acknowledgment
+static void vrcp_send_cnf_data_tx(struct vrcp *vrcp, uint8_t handle)
+{
+    struct iobuf_write buf = { };
+
+    iobuf_push_u8(&buf, HIF_CMD_CNF_DATA_TX);
+    iobuf_push_u8(&buf, handle);
+    iobuf_push_u8(&buf, HIF_STATUS_SUCCESS);
+    iobuf_push_le16(&buf, 0); // Ack frame length
+    iobuf_push_le64(&buf, vrcp->ctxt->replay_time_ms * 1000);
+    iobuf_push_u8(&buf, 0);   // LQI
+    iobuf_push_u8(&buf, 0);   // RX power
+    iobuf_push_le32(&buf, 0); // Frame counter
+    iobuf_push_le16(&buf, 0); // Channel
+    iobuf_push_u8(&buf, 0);   // CCA retries
+    iobuf_push_u8(&buf, 0);   // TX retries
+    iobuf_push_u8(&buf, 0);   // Mode switch stats
+    vrcp_tx(vrcp, &buf);
+    iobuf_free(&buf);
+}
+
+static void vrcp_send_replay_timer(struct vrcp *vrcp, uint64_t time_ms)
+{
+    struct iobuf_write buf = { };
+
+    iobuf_push_u8(&buf, HIF_CMD_IND_REPLAY_TIMER);
+    iobuf_push_le64(&buf, time_ms);
+    vrcp_tx(vrcp, &buf);
+    iobuf_free(&buf);
+}
+
+// Emulate the kernel delivering a packet to a socket (or to the TUN)
+static void vrcp_send_replay_socket(struct vrcp *vrcp, int fd,
+                                    const void *src, const void *dst,
+                                    const uint8_t *pkt, size_t pkt_len)
+{
+    struct iobuf_write buf = { };
+
+    iobuf_push_u8(&buf, HIF_CMD_IND_REPLAY_SOCKET);
+    iobuf_push_u8(&buf, vrcp_iface_index(vrcp->ctxt, fd));
+    iobuf_push_data(&buf, src, 16);
+    iobuf_push_data(&buf, dst, 16);
+    iobuf_push_le16(&buf, 0); // Source port
+    iobuf_push_le16(&buf, pkt_len);
+    iobuf_push_data(&buf, pkt, pkt_len);
+    vrcp_tx(vrcp, &buf);
+    iobuf_free(&buf);
+}
+
+static void vrcp_send_ind_data_rx(struct vrcp *vrcp, int relay, const struct iobuf_write *pkt)
+{
+    struct wsbr_ctxt *wsbrd = vrcp->ctxt->wsbrd;
+    struct vrcp_node *node = &vrcp->nodes[relay];
+    struct ieee802154_hdr hdr = {
+        .frame_type    = IEEE802154_FRAME_TYPE_DATA,
+        .ack_req       = true,
+        .seqno         = node->seqno++,
+        .pan_id        = UINT16_MAX,
+        .dst           = wsbrd->rcp.eui64,
+        .sec_level     = IEEE802154_SEC_LEVEL_ENC_MIC64,
+        .key_index     = vrcp->key_index,
+        .frame_counter = node->frame_counter++,
+    };
+    struct iobuf_write frame = { };
+    struct iobuf_write buf = { };
+    int offset;
+
+    // The RCP decrypts the frames, the MIC is left in place
+    vrcp_node_eui64(relay, &hdr.src);
+    ieee802154_frame_write_hdr(&frame, &hdr);
+    ws_wh_utt_write(&frame, WS_FT_DATA);
+    ieee802154_ie_push_header(&frame, IEEE802154_IE_ID_HT1);
+    offset = ieee802154_ie_push_payload(&frame, IEEE802154_IE_ID_WP);
+    ws_wp_nested_us_write(&frame, &wsbrd->net_if.ws_info.fhss_config);
+    ieee802154_ie_fill_len_payload(&frame, offset);
+    offset = ieee802154_ie_push_payload(&frame, IEEE802154_IE_ID_MPX);
+    mpx_ie_write(&frame, &(struct mpx_ie){
+        .transfer_type = MPX_FT_FULL_FRAME,
+        .multiplex_id  = MPX_ID_6LOWPAN,
+    });
+    iobuf_push_u8(&frame, LOWPAN_DISPATCH_IPV6);
+    iobuf_push_data(&frame, pkt->data, pkt->len);
+    ieee802154_ie_fill_len_payload(&frame, offset);
+    ieee802154_reserve_mic(&frame, &hdr);
+
+    iobuf_push_u8(&buf, HIF_CMD_IND_DATA_RX);
+    iobuf_push_le16(&buf, frame.len);
+    iobuf_push_data(&buf, frame.data, frame.len);
+    iobuf_push_le64(&buf, vrcp->ctxt->replay_time_ms * 1000);
+    iobuf_push_u8(&buf, 255);                    // LQI
+    iobuf_push_u8(&buf, (uint8_t)-60);           // RX power (dBm)
+    iobuf_push_u8(&buf, wsbrd->config.ws_phy_mode_id);
+    iobuf_push_le16(&buf, 0);                    // Channel
+    vrcp_tx(vrcp, &buf);
+    vrcp->frame_rx++;
+    iobuf_free(&frame);
+    iobuf_free(&buf);
+}
+
+// Fill the upper layer checksum and prepend the IPv6 header
+static void vrcp_ipv6_write(struct iobuf_write *pkt,
+                            const struct in6_addr *src, const struct in6_addr *dst,
+                            uint8_t nxthdr, uint8_t hop_limit,
+                            struct iobuf_write *body, int cksum_offset)
+{
+    be16_t cksum;
+
+    cksum = ipv6_cksum(src, dst, nxthdr, body->data, body->len);
+    memcpy(body->data + cksum_offset, &cksum, sizeof(cksum));
+    iobuf_push_be32(pkt, FIELD_PREP(IPV6_MASK_VERSION, 6));
+    iobuf_push_be16(pkt, body->len);
+    iobuf_push_u8(pkt, nxthdr);
+    iobuf_push_u8(pkt, hop_limit);
+    iobuf_push_data(pkt, src, 16);
+    iobuf_push_data(pkt, dst, 16);
+    iobuf_push_data(pkt, body->data, body->len);
+}
+
+static void vrcp_node_send(struct vrcp *vrcp, int i,
+                           const struct in6_addr *src, const struct in6_addr *dst,
+                           uint8_t nxthdr, struct iobuf_write *body, int cksum_offset)
+{
+    struct vrcp_node *node = &vrcp->nodes[i];
+    struct iobuf_write pkt = { };
+
+    // Nodes cannot send anything secured without GTK
+    if (!vrcp->key_index)
+        return;
+    vrcp_ipv6_write(&pkt, src, dst, nxthdr,
+                    nxthdr == IPV6_NH_ICMPV6 && body->data[0] == ICMPV6_TYPE_NS ? 255 : 64 - node->depth,
+                    body, cksum_offset);
+    vrcp_send_ind_data_rx(vrcp, node->relay, &pkt);
+    iobuf_free(&pkt);
+}
+
+// RFC 8505 - 5.1. Extending the Address Registration Option
+static void vrcp_node_send_ns_earo(struct vrcp *vrcp, int i)
+{
+    struct fuzz_ctxt *ctxt = vrcp->ctxt;
+    struct iobuf_write buf = { };
+    struct in6_addr src, dst, gua;
+    struct eui64 eui64;
+
+    vrcp_node_eui64(i, &eui64);
+    vrcp_node_addr(i, ADDR_LINK_LOCAL_PREFIX, &src);
+    vrcp_node_addr(i, ctxt->wsbrd->config.ipv6_prefix.s6_addr, &gua);
+    memcpy(dst.s6_addr, ctxt->tun_lla, 16);
+
+    iobuf_push_u8(&buf, ICMPV6_TYPE_NS);
+    iobuf_push_u8(&buf, 0);     // Code
+    iobuf_push_be16(&buf, 0);   // Checksum
+    iobuf_push_be32(&buf, 0);   // Reserved
+    iobuf_push_data(&buf, &gua, 16);
+    iobuf_push_u8(&buf, NDP_OPT_ARO);
+    iobuf_push_u8(&buf, 2);     // Length
+    iobuf_push_u8(&buf, NDP_ARO_STATUS_SUCCESS);
+    iobuf_push_u8(&buf, 0);     // Opaque
+    iobuf_push_u8(&buf, NDP_MASK_ARO_R | NDP_MASK_ARO_T);
+    iobuf_push_u8(&buf, vrcp->nodes[i].aro_tid++);
+    iobuf_push_be16(&buf, VRCP_ARO_LIFETIME_MIN);
+    iobuf_push_data(&buf, eui64.u8, 8);
+    vrcp_node_send(vrcp, i, &src, &dst, IPV6_NH_ICMPV6, &buf, 2);
+    iobuf_free(&buf);
+}
+
+// RFC 6550 - 6.4. Destination Advertisement Object (DAO)
+static void vrcp_node_send_dao(struct vrcp *vrcp, int i)
+{
+    struct rpl_root *root = &vrcp->ctxt->wsbrd->net_if.rpl_root;
+    const uint8_t *prefix = vrcp->ctxt->wsbrd->config.ipv6_prefix.s6_addr;
+    struct vrcp_node *node = &vrcp->nodes[i];
+    struct iobuf_write buf = { };
+    struct in6_addr src, dst, parent;
+
+    vrcp_node_addr(i, prefix, &src);
+    memcpy(dst.s6_addr, root->dodag_id, 16);
+    if (node->parent < 0)
+        memcpy(parent.s6_addr, root->dodag_id, 16);
+    else
+        vrcp_node_addr(node->parent, prefix, &parent);
+    node->dao_seq  = rpl_lollipop_inc(node->dao_seq);
+    node->path_seq = rpl_lollipop_inc(node->path_seq);
+
+    iobuf_push_u8(&buf, ICMPV6_TYPE_RPL);
+    iobuf_push_u8(&buf, RPL_CODE_DAO);
+    iobuf_push_be16(&buf, 0);   // Checksum
+    iobuf_push_u8(&buf, root->instance_id);
+    iobuf_push_u8(&buf, RPL_MASK_DAO_K);
+    iobuf_push_u8(&buf, 0);     // Reserved
+    iobuf_push_u8(&buf, node->dao_seq);
+    iobuf_push_u8(&buf, RPL_OPT_TARGET);
+    iobuf_push_u8(&buf, sizeof(struct rpl_opt_target));
+    iobuf_push_u8(&buf, 0);     // Flags
+    iobuf_push_u8(&buf, 128);   // Prefix Length
+    iobuf_push_data(&buf, &src, 16);
+    iobuf_push_u8(&buf, RPL_OPT_TRANSIT);
+    iobuf_push_u8(&buf, sizeof(struct rpl_opt_transit));
+    iobuf_push_u8(&buf, 0);     // Flags
+    iobuf_push_u8(&buf, FIELD_PREP(RPL_MASK_PATH_CTL_PC1, 2)); // Preferred parent
+    iobuf_push_u8(&buf, node->path_seq);
+    iobuf_push_u8(&buf, MIN(root->lifetime_s / root->lifetime_unit_s, 0xfe));
+    iobuf_push_data(&buf, &parent, 16);
+    vrcp_node_send(vrcp, i, &src, &dst, IPV6_NH_ICMPV6, &buf, 2);
+    iobuf_free(&buf);
+}
+
+static void vrcp_node_send_data(struct vrcp *vrcp, int i)
+{
+    struct iobuf_write buf = { };
+    struct in6_addr src;
+
+    vrcp_node_addr(i, vrcp->ctxt->wsbrd->config.ipv6_prefix.s6_addr, &src);
+    iobuf_push_be16(&buf, VRCP_DATA_PORT);
+    iobuf_push_be16(&buf, VRCP_DATA_PORT);
+    iobuf_push_be16(&buf, 8 + vrcp->cfg.data_size);
+    iobuf_push_be16(&buf, 0);   // Checksum
+    for (int j = 0; j < vrcp->cfg.data_size; j++)
+        iobuf_push_u8(&buf, i + j);
+    vrcp_node_send(vrcp, i, &src, &vrcp_data_dst, IPV6_NH_UDP, &buf, 6);
+    vrcp->data_tx++;
+    iobuf_free(&buf);
+}
+
+static void vrcp_node_dao_ack(struct vrcp *vrcp, int i)
+{
+    struct rpl_root *root = &vrcp->ctxt->wsbrd->net_if.rpl_root;
+    uint64_t now = vrcp->ctxt->replay_time_ms;
+    struct vrcp_node *node = &vrcp->nodes[i];
+    uint64_t data_interval_ms = vrcp->cfg.data_interval_s * 1000ull;
+
+    if (!node->joined) {
+        node->joined = true;
+        vrcp->joined_count++;
+        vrcp->last_join_ms = now;
+        histogram_add(&vrcp->join_hist, now - node->join_ms);
+        // Spread the uplink traffic over the interval
+        if (data_interval_ms)
+            vrcp_event_push(vrcp, now + data_interval_ms * i / vrcp->cfg.node_count, i, VRCP_EV_DATA, 0);
+    }
+    // Cancel the retransmission, refresh at half the path lifetime
+    node->dao_gen++;
+    vrcp_event_push(vrcp, now + root->lifetime_s * 1000ull / 2, i, VRCP_EV_DAO, node->dao_gen);
+}
+
+static void vrcp_report(struct vrcp *vrcp)
+{
+    struct rpl_root *root = &vrcp->ctxt->wsbrd->net_if.rpl_root;
+    uint64_t now = vrcp->ctxt->replay_time_ms;
+    uint64_t cpu_ms, vrcp_ms, wall_ms;
+    struct timespec wall;
+    struct rusage ru;
+
+    getrusage(RUSAGE_SELF, &ru);
+    __real_clock_gettime(CLOCK_MONOTONIC, &wall);
+    cpu_ms  = (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000ull +
+              (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1000;
+    vrcp_ms = vrcp->cpu_ns / 1000000;
+    wall_ms = (wall.tv_sec - vrcp->wall_start.tv_sec) * 1000ll +
+              (wall.tv_nsec - vrcp->wall_start.tv_nsec) / 1000000;
+
+    INFO("vrcp: %d/%d nodes joined, last after %"PRIu64".%03"PRIu64"s, %d RPL targets",
+         vrcp->joined_count, vrcp->cfg.node_count,
+         (vrcp->last_join_ms - vrcp->start_ms) / 1000, (vrcp->last_join_ms - vrcp->start_ms) % 1000,
+         rpl_target_count(root));
+    INFO("vrcp: join latency p50=%"PRIu64"ms p99=%"PRIu64"ms max=%"PRIu64"ms",
+         histogram_quantile(&vrcp->join_hist, 0.5),
+         histogram_quantile(&vrcp->join_hist, 0.99),
+         vrcp->join_hist.max);
+    INFO("vrcp: frames rx=%"PRIu64" tx=%"PRIu64", uplink packets sent=%"PRIu64" received=%"PRIu64,
+         vrcp->frame_rx, vrcp->frame_tx, vrcp->data_tx, vrcp->data_rx);
+    INFO("vrcp: simulated %"PRIu64"s in %"PRIu64".%03"PRIu64"s, wsbrd cpu=%"PRIu64".%03"PRIu64"s, max rss=%ldKiB",
+         (now - vrcp->start_ms) / 1000, wall_ms / 1000, wall_ms % 1000,
+         (cpu_ms - MIN(cpu_ms, vrcp_ms)) / 1000, (cpu_ms - MIN(cpu_ms, vrcp_ms)) % 1000,
+         ru.ru_maxrss);
+}
+
+static void vrcp_event_process(struct vrcp *vrcp, const struct vrcp_event *ev)
+{
+    uint64_t now = vrcp->ctxt->replay_time_ms;
+    struct vrcp_node *node = &vrcp->nodes[ev->node];
+
+    switch (ev->type) {
+    case VRCP_EV_JOIN:
+        // A node can only join once its parent is part of the DODAG
+        if (node->parent >= 0 && !vrcp->nodes[node->parent].joined) {
+            vrcp_event_push(vrcp, now + VRCP_JOIN_WAIT_MS, ev->node, VRCP_EV_JOIN, 0);
+            break;
+        }
+        node->join_ms = now;
+        if (node->parent < 0) {
+            vrcp_node_send_ns_earo(vrcp, ev->node);
+            vrcp_event_push(vrcp, now + VRCP_ARO_LIFETIME_MIN * 60 * 1000ull / 2,
+                            ev->node, VRCP_EV_ARO, 0);
+        }
+        vrcp_event_push(vrcp, now, ev->node, VRCP_EV_DAO, node->dao_gen);
+        break;
+    case VRCP_EV_DAO:
+        if (ev->gen != node->dao_gen)
+            break;
+        vrcp_node_send_dao(vrcp, ev->node);
+        vrcp_event_push(vrcp, now + vrcp->cfg.dao_retry_s * 1000ull, ev->node, VRCP_EV_DAO, node->dao_gen);
+        break;
+    case VRCP_EV_ARO:
+        vrcp_node_send_ns_earo(vrcp, ev->node);
+        vrcp_event_push(vrcp, now + VRCP_ARO_LIFETIME_MIN * 60 * 1000ull / 2,
+                        ev->node, VRCP_EV_ARO, 0);
+        break;
+    case VRCP_EV_DATA:
+        vrcp_node_send_data(vrcp, ev->node);
+        vrcp_event_push(vrcp, now + vrcp->cfg.data_interval_s * 1000ull, ev->node, VRCP_EV_DATA, 0);
+        break;
+    case VRCP_EV_END:
+        vrcp_report(vrcp);
+        exit(0);
+    default:
+        BUG();
+    }
+}
+
+static void vrcp_start(struct vrcp *vrcp)
+{
+    uint64_t now = vrcp->ctxt->replay_time_ms;
+
+    INFO("vrcp: starting simulation of %d nodes", vrcp->cfg.node_count);
+    vrcp->started = true;
+    vrcp->start_ms = now;
+    vrcp->last_join_ms = now;
+    for (int i = 0; i < vrcp->cfg.node_count; i++)
+        vrcp_event_push(vrcp, now + vrcp->cfg.join_start_s * 1000ull +
+                        (uint64_t)vrcp->cfg.join_interval_ms * i, i, VRCP_EV_JOIN, 0);
+    vrcp_event_push(vrcp, now + vrcp->cfg.duration_s * 1000ull, 0, VRCP_EV_END, 0);
+}
+
+/*
+ * Called when wsbrd has nothing left to process. Either run the simulated
+ * nodes scheduled now, or advance the clock to the next event (simulated node
+ * or wsbrd timer).
+ */
+static void vrcp_idle(struct vrcp *vrcp)
+{
+    uint64_t now = vrcp->ctxt->replay_time_ms;
+    uint64_t out_count = vrcp->out_count;
+    struct timer_entry *timer;
+    struct vrcp_event ev;
+    uint64_t next;
+
+    if (!vrcp->started && vrcp->key_index)
+        vrcp_start(vrcp);
+    while (vrcp->event_count && vrcp->events[0].time_ms <= now) {
+        ev = vrcp_event_pop(vrcp);
+        vrcp_event_process(vrcp, &ev);
+    }
+    if (vrcp->out_count != out_count)
+        return;
+
+    next = vrcp->event_count ? vrcp->events[0].time_ms : UINT64_MAX;
+    timer = timer_next();
+    // Timers only fire if they expire strictly before the replay target
+    if (timer)
+        next = MIN(next, MAX(timer->expire_ms, now) + 1);
+    FATAL_ON(next == UINT64_MAX, 1, "vrcp: nothing left to simulate");
+    vrcp_send_replay_timer(vrcp, next);
+}
+
+void vrcp_recv_hif(struct vrcp *vrcp, const uint8_t *buf, size_t buf_len)
+{
+    struct iobuf_read iobuf = {
+        .data_size = buf_len,
+        .data = buf,
+    };
+    uint64_t start_ns = vrcp_cpu_ns();
+    uint8_t key_index;
+    const uint8_t *key;
+
+    switch (iobuf_pop_u8(&iobuf)) {
+    case HIF_CMD_REQ_RESET:
+        vrcp_send_ind_reset(vrcp);
+        break;
+    case HIF_CMD_REQ_RADIO_LIST:
+        vrcp_send_cnf_radio_list(vrcp);
+        break;
+    case HIF_CMD_REQ_DATA_TX:
+        vrcp->frame_tx++;
+        vrcp_send_cnf_data_tx(vrcp, iobuf_pop_u8(&iobuf));
+        break;
+    case HIF_CMD_SET_SEC_KEY:
+        key_index = iobuf_pop_u8(&iobuf);
+        key = iobuf_pop_data_ptr(&iobuf, 16);
+        // Only GTKs are used, LGTKs (5 to 7) are for LFNs
+        if (iobuf.err || key_index < 1 || key_index > 4)
+            break;
+        if (memzcmp(key, 16)) {
+            vrcp->key_mask |= BIT(key_index);
+            vrcp->key_index = key_index;
+        } else {
+            vrcp->key_mask &= ~BIT(key_index);
+            if (vrcp->key_index == key_index)
+                vrcp->key_index = vrcp->key_mask ? __builtin_ctz(vrcp->key_mask) : 0;
+        }
+        break;
+    default:
+        break;
+    }
+    vrcp->cpu_ns += vrcp_cpu_ns() - start_ns;
+}
+
+void vrcp_recv_tun(struct vrcp *vrcp, const uint8_t *buf, size_t buf_len)
+{
+    struct fuzz_ctxt *ctxt = vrcp->ctxt;
+    struct iobuf_read iobuf = {
+        .data_size = buf_len,
+        .data = buf,
+    };
+    uint64_t start_ns = vrcp_cpu_ns();
+    const uint8_t *src, *dst;
+    uint8_t nxthdr;
+    uint16_t len;
+
+    iobuf_pop_be32(&iobuf); // Version, Traffic Class, Flow Label
+    len    = iobuf_pop_be16(&iobuf);
+    nxthdr = iobuf_pop_u8(&iobuf);
+    iobuf_pop_u8(&iobuf);   // Hop Limit
+    src    = iobuf_pop_data_ptr(&iobuf, 16);
+    dst    = iobuf_pop_data_ptr(&iobuf, 16);
+    if (iobuf.err || len < 4 || len > iobuf_remaining_size(&iobuf))
+        goto out;
+    if (nxthdr == IPV6_NH_UDP && !memcmp(dst, vrcp_data_dst.s6_addr, 16)) {
+        vrcp->data_rx++;
+        goto out;
+    }
+    // Only deliver what the RPL socket would receive
+    if (nxthdr != IPV6_NH_ICMPV6 || iobuf_ptr(&iobuf)[0] != ICMPV6_TYPE_RPL)
+        goto out;
+    if (!IN6_IS_ADDR_MULTICAST(dst) && memcmp(dst, ctxt->tun_gua, 16) && memcmp(dst, ctxt->tun_lla, 16))
+        goto out;
+    vrcp_send_replay_socket(vrcp, ctxt->wsbrd->net_if.rpl_root.sockfd, src, dst, iobuf_ptr(&iobuf), len);
+out:
+    vrcp->cpu_ns += vrcp_cpu_ns() - start_ns;
+}
+
+void vrcp_recv_sendmsg(struct vrcp *vrcp, int fd, const struct msghdr *msg)
+{
+    const struct sockaddr_in6 *dst = msg->msg_name;
+    struct fuzz_ctxt *ctxt = vrcp->ctxt;
+    uint64_t start_ns = vrcp_cpu_ns();
+    struct iobuf_write icmp = { };
+    struct iobuf_write pkt = { };
+    struct in6_addr src;
+    int node;
+
+    if (fd != ctxt->wsbrd->net_if.rpl_root.sockfd)
+        return;
+    BUG_ON(!dst || dst->sin6_family != AF_INET6);
+    for (int i = 0; i < msg->msg_iovlen; i++)
+        iobuf_push_data(&icmp, msg->msg_iov[i].iov_base, msg->msg_iov[i].iov_len);
+    BUG_ON(icmp.len < 4);
+    if (icmp.data[0] == ICMPV6_TYPE_RPL && icmp.data[1] == RPL_CODE_DAO_ACK) {
+        node = vrcp_node_from_addr(vrcp, &dst->sin6_addr);
+        if (node >= 0)
+            vrcp_node_dao_ack(vrcp, node);
+    }
+
+    // Route the packet through the TUN like the kernel would
+    if (IN6_IS_ADDR_MULTICAST(&dst->sin6_addr) || IN6_IS_ADDR_LINKLOCAL(&dst->sin6_addr))
+        memcpy(src.s6_addr, ctxt->tun_lla, 16);
+    else
+        memcpy(src.s6_addr, ctxt->tun_gua, 16);
+    memset(icmp.data + 2, 0, 2); // Checksum
+    vrcp_ipv6_write(&pkt, &src, &dst->sin6_addr, IPV6_NH_ICMPV6,
+                    IN6_IS_ADDR_MULTICAST(&dst->sin6_addr) ? 255 : 64, &icmp, 2);
+    vrcp_send_replay_socket(vrcp, ctxt->wsbrd->tun.fd, &src, &dst->sin6_addr, pkt.data, pkt.len);
+    iobuf_free(&icmp);
+    iobuf_free(&pkt);
+    vrcp->cpu_ns += vrcp_cpu_ns() - start_ns;
+}
+
+/*
+ * Only the blocking poll() of the main loop is of interest: it means wsbrd is
+ * idle, so the simulation can move forward.
+ */
+int __real_poll(struct pollfd *fds, nfds_t nfds, int timeout);
+int __wrap_poll(struct pollfd *fds, nfds_t nfds, int timeout)
+{
+    struct vrcp *vrcp = g_fuzz_ctxt.vrcp;
+    uint64_t start_ns;
+    int ret;
+
+    if (!vrcp || !timeout)
+        return __real_poll(fds, nfds, timeout);
+
+    start_ns = vrcp_cpu_ns();
+    vrcp_flush(vrcp);
+    ret = __real_poll(fds, nfds, 0);
+    if (!ret)
+        vrcp_idle(vrcp);
+    vrcp->cpu_ns += vrcp_cpu_ns() - start_ns;
+    return ret ? ret : __real_poll(fds, nfds, timeout);
+}
+
+static void vrcp_scenario_parse(struct vrcp_scenario *cfg, const char *filename)
+{
+    static const struct number_limit valid_node_count = { 1, VRCP_NODE_MAX };
+    static const struct number_limit valid_data_size  = { 0, 1024 };
+    const struct option_struct opts[] = {
+        { "node_count",       &cfg->node_count,       conf_set_number, &valid_node_count },
+        { "br_children",      &cfg->br_children,      conf_set_number, &valid_positive },
+        { "fanout",           &cfg->fanout,           conf_set_number, &valid_positive },
+        { "join_start_s",     &cfg->join_start_s,     conf_set_number, &valid_unsigned },
+        { "join_interval_ms", &cfg->join_interval_ms, conf_set_number, &valid_unsigned },
+        { "dao_retry_s",      &cfg->dao_retry_s,      conf_set_number, &valid_positive },
+        { "data_interval_s",  &cfg->data_interval_s,  conf_set_number, &valid_unsigned },
+        { "data_size",        &cfg->data_size,        conf_set_number, &valid_data_size },
+        { "duration_s",       &cfg->duration_s,       conf_set_number, &valid_positive },
+        { }
+    };
+
+    parse_config_file(opts, filename);
+}
+
+struct vrcp *vrcp_new(struct fuzz_ctxt *ctxt, const char *scenario)
+{
+    struct vrcp *vrcp = zalloc(sizeof(struct vrcp));
+    int bufsize = 1024 * 1024;
+    struct vrcp_node *node;
+    int sv[2];
+
+    vrcp->ctxt = ctxt;
+    vrcp->cfg = (struct vrcp_scenario){
+        .node_count       = 1000,
+        .br_children      = 64,
+        .fanout           = 4,
+        .join_start_s     = 10,
+        .join_interval_ms = 100,
+        .dao_retry_s      = 30,
+        .data_interval_s  = 300,
+        .data_size        = 64,
+        .duration_s       = 3600,
+    };
+    vrcp_scenario_parse(&vrcp->cfg, scenario);
+
+    // Node i is a child of the border router if i < br_children, else of
+    // node (i - br_children) / fanout: parents always join first.
+    vrcp->nodes = zalloc(vrcp->cfg.node_count * sizeof(struct vrcp_node));
+    for (int i = 0; i < vrcp->cfg.node_count; i++) {
+        node = &vrcp->nodes[i];
+        node->dao_seq  = RPL_LOLLIPOP_INIT;
+        node->path_seq = RPL_LOLLIPOP_INIT;
+        if (i < vrcp->cfg.br_children) {
+            node->parent = -1;
+            node->relay  = i;
+            node->depth  = 0;
+        } else {
+            node->parent = (i - vrcp->cfg.br_children) / vrcp->cfg.fanout;
+            node->relay  = vrcp->nodes[node->parent].relay;
+            node->depth  = vrcp->nodes[node->parent].depth + 1;
+        }
+    }
+
+    // wsbrd reads the RCP from sv[0]. The other direction is intercepted in
+    // __wrap_writev() and never goes through the socket.
+    FATAL_ON(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0, 2, "socketpair: %m");
+    FATAL_ON(fcntl(sv[1], F_SETFL, O_NONBLOCK) < 0, 2, "fcntl: %m");
+    __real_setsockopt(sv[1], SOL_SOCKET, SO_SNDBUF, &bufsize, sizeof(bufsize));
+    vrcp->fd = sv[1];
+    ctxt->replay_fds[ctxt->replay_count++] = sv[0];
+    __real_clock_gettime(CLOCK_MONOTONIC, &vrcp->wall_start);
+    return vrcp;
+}
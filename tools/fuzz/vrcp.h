@@ -0,0 +1,48 @@
+/*
+ * SPDX-License-Identifier: LicenseRef-MSLA
+ * Copyright (c) 2025 Silicon Laboratories Inc. (www.silabs.com)
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of the Silicon Labs Master Software License
+ * Agreement (MSLA) available at [1].  This software is distributed to you in
+ * Object Code format and/or Source Code format and is governed by the sections
+ * of the MSLA applicable to Object Code, Source Code and Modified Open Source
+ * Code. By using this software, you agree to the terms of the MSLA.
+ *
+ * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
+ */
+#ifndef FUZZ_VRCP_H
+#define FUZZ_VRCP_H
+#include <sys/socket.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Virtual RCP used to load wsbrd with a large simulated network without any
+ * radio hardware. The RCP side of the HIF is implemented in wsbrd-fuzz, and
+ * is driven by the replay clock: time only advances when wsbrd is idle, so a
+ * simulation of several hours runs as fast as the host CPU allows and is
+ * fully deterministic.
+ *
+ * The simulated nodes skip the authentication (they are assumed to already
+ * know the GTK installed on the RCP) and the DHCP (their GUA is derived from
+ * their EUI-64). Each node sends NS(EARO) if it is a direct child of the
+ * border router, DAOs, and optionally periodic uplink UDP packets. Frames of
+ * nodes deeper in the tree are received from their first hop ancestor.
+ *
+ * The Linux kernel is emulated for the TUN interface and the RPL socket only.
+ */
+
+struct fuzz_ctxt;
+struct vrcp;
+
+struct vrcp *vrcp_new(struct fuzz_ctxt *ctxt, const char *scenario);
+
+// Host to RCP HIF command (without UART framing)
+void vrcp_recv_hif(struct vrcp *vrcp, const uint8_t *buf, size_t buf_len);
+// Packet written by wsbrd to the TUN interface
+void vrcp_recv_tun(struct vrcp *vrcp, const uint8_t *buf, size_t buf_len);
+// Packet sent by wsbrd to a socket
+void vrcp_recv_sendmsg(struct vrcp *vrcp, int fd, const struct msghdr *msg);
+
+#endif
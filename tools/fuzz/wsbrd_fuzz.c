@@ -47,12 +47,26 @@ void __wrap_parse_commandline(struct wsbrd_conf *config, int argc, char *argv[],
 
     __real_parse_commandline(config, argc, argv, print_help);
 
-    if (ctxt->fuzzing_enabled)
+    if (ctxt->fuzzing_enabled || ctxt->seek_enabled || ctxt->vrcp)
         ctxt->wsbrd->config.storage_delete = true;
     if (ctxt->replay_count) {
         WARN_ON(!ctxt->wsbrd->config.storage_delete, "storage_delete set to false while using replay");
         WARN_ON(!ctxt->wsbrd->config.tun_autoconf, "tun_autoconf set to false while using replay");
     }
+    // The replay relies on the RCP being read from the main loop
+    ctxt->wsbrd->config.rcp_io_thread = false;
+}
+
+// The storage is deleted at startup when replaying, restore the checkpoint
+// right after.
+void __real_storage_delete(const char *files[]);
+void __wrap_storage_delete(const char *files[])
+{
+    struct fuzz_ctxt *ctxt = &g_fuzz_ctxt;
+
+    __real_storage_delete(files);
+    if (ctxt->seek_enabled)
+        capture_restore_checkpoint(ctxt->replay_filename, ctxt->seek.index);
 }
 
 int __real_uart_rx(struct bus *bus, void *buf, unsigned int buf_len);
@@ -17,9 +17,12 @@
 #include <stdbool.h>
 #include <time.h>
 
+#include "common/capture.h"
+
 #include "interfaces.h"
 
 struct wsbr_ctxt;
+struct vrcp;
 
 struct fuzz_ctxt {
     struct wsbr_ctxt *wsbrd; // Avoids accessing g_ctxt directly
@@ -31,12 +34,17 @@ struct fuzz_ctxt {
     int replay_count;
     int replay_fds[10];
     int replay_i;
+    const char *replay_filename;
+    bool seek_enabled;
+    uint64_t seek_time_s;
+    struct capture_seek seek;
     uint8_t tun_gua[16];
     uint8_t tun_lla[16];
     int iface_count;
     struct fuzz_iface *iface_list;
     uint64_t replay_time_ms;
     uint64_t target_time_ms;
+    struct vrcp *vrcp;
 };
 
 extern struct fuzz_ctxt g_fuzz_ctxt;
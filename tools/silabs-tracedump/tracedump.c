@@ -0,0 +1,249 @@
+/*
+ * SPDX-License-Identifier: LicenseRef-MSLA
+ * Copyright (c) 2025 Silicon Laboratories Inc. (www.silabs.com)
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of the Silicon Labs Master Software License
+ * Agreement (MSLA) available at [1].  This software is distributed to you in
+ * Object Code format and/or Source Code format and is governed by the sections
+ * of the MSLA applicable to Object Code, Source Code and Modified Open Source
+ * Code. By using this software, you agree to the terms of the MSLA.
+ *
+ * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
+ */
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "common/log_bin.h"
+#include "common/log.h"
+#include "common/mathutils.h"
+
+struct tracedump {
+    const uint8_t *file;
+    size_t file_len;
+    const struct tr_bin_hdr *hdr;
+    const uint8_t *ring;
+    uint64_t head;
+};
+
+static void print_help(FILE *stream, int exit_code)
+{
+    fprintf(stream, "Usage:\n");
+    fprintf(stream, "  silabs-tracedump FILE\n");
+    fprintf(stream, "\n");
+    fprintf(stream, "Decode the binary traces recorded by wsbrd or wsrd when \"trace_ring\" is set.\n");
+    fprintf(stream, "Records are printed from the oldest to the most recent one. FILE may be read\n");
+    fprintf(stream, "while the daemon is running or after it exited (or crashed).\n");
+    exit(exit_code);
+}
+
+static void ring_read(const struct tracedump *ctx, uint64_t pos, void *buf, size_t len)
+{
+    size_t off = pos & (ctx->hdr->ring_size - 1);
+    size_t n = MIN(len, ctx->hdr->ring_size - off);
+
+    memcpy(buf, ctx->ring + off, n);
+    memcpy((uint8_t *)buf + n, ctx->ring, len - n);
+}
+
+static const char *fmt_get(const struct tracedump *ctx, uint16_t id)
+{
+    const uint32_t *fmt_tbl = (const uint32_t *)(ctx->file + ctx->hdr->fmt_offset);
+    const char *str = (const char *)(ctx->file + ctx->hdr->str_offset);
+    uint32_t off;
+
+    if (!id || id >= MIN(ctx->hdr->fmt_count, ctx->hdr->fmt_max))
+        return NULL;
+    off = fmt_tbl[id];
+    if (off >= ctx->hdr->str_size || !memchr(str + off, '\0', ctx->hdr->str_size - off))
+        return NULL;
+    return str + off;
+}
+
+static bool rec_get(const uint8_t **data, const uint8_t *end, void *val, size_t len)
+{
+    if (*data + len > end)
+        return false;
+    memcpy(val, *data, len);
+    *data += len;
+    return true;
+}
+
+static void print_literal(const char *start, const char *end)
+{
+    for (const char *p = start; p < end; p++) {
+        if (p[0] == '%' && p[1] == '%')
+            p++;
+        putchar(*p);
+    }
+}
+
+static void rec_print(const struct tr_bin_rec *rec, const char *fmt)
+{
+    const uint8_t *data = rec->data;
+    const uint8_t *end = (const uint8_t *)rec + rec->len;
+    struct tr_bin_spec spec;
+    char spec_fmt[64];
+    char str[TR_BIN_REC_MAX + 1];
+    const char *prev = fmt;
+    int stars[2];
+    int star;
+    uint64_t val;
+    uint16_t len;
+    double dbl;
+    char *out;
+
+    printf("%ju.%06ju: ", (uintmax_t)rec->tstamp_us / 1000000, (uintmax_t)rec->tstamp_us % 1000000);
+    while ((fmt = tr_bin_parse_spec(fmt, &spec))) {
+        print_literal(prev, spec.start);
+        prev = spec.end;
+
+        for (int i = 0; i < spec.star_count; i++) {
+            if (!rec_get(&data, end, &val, sizeof(val)))
+                goto truncated;
+            stars[i] = (int)val;
+        }
+        // Rebuild the conversion without length modifier, then add the one
+        // matching the stored type.
+        out = spec_fmt;
+        star = 0;
+        for (const char *p = spec.start; p < spec.end - 1 && out < spec_fmt + sizeof(spec_fmt) - 24; p++) {
+            if (strchr("hlqjztL", *p))
+                continue;
+            if (*p == '*')
+                out += sprintf(out, "%d", stars[star++]);
+            else
+                *out++ = *p;
+        }
+        switch (spec.conv) {
+        case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+            if (!rec_get(&data, end, &val, sizeof(val)))
+                goto truncated;
+            sprintf(out, "j%c", spec.conv);
+            if (spec.conv == 'd' || spec.conv == 'i')
+                printf(spec_fmt, (intmax_t)(int64_t)val);
+            else
+                printf(spec_fmt, (uintmax_t)val);
+            break;
+        case 'c':
+            if (!rec_get(&data, end, &val, sizeof(val)))
+                goto truncated;
+            sprintf(out, "c");
+            printf(spec_fmt, (int)val);
+            break;
+        case 'p':
+            if (!rec_get(&data, end, &val, sizeof(val)))
+                goto truncated;
+            sprintf(out, "p");
+            printf(spec_fmt, (void *)(uintptr_t)val);
+            break;
+        case 'e': case 'E': case 'f': case 'F':
+        case 'g': case 'G': case 'a': case 'A':
+            if (!rec_get(&data, end, &dbl, sizeof(dbl)))
+                goto truncated;
+            sprintf(out, "%c", spec.conv);
+            printf(spec_fmt, dbl);
+            break;
+        case 's':
+            if (!rec_get(&data, end, &len, sizeof(len)))
+                goto truncated;
+            if (!rec_get(&data, end, str, len))
+                goto truncated;
+            str[len] = '\0';
+            sprintf(out, "s");
+            printf(spec_fmt, str);
+            break;
+        case 'm':
+            if (!rec_get(&data, end, &val, sizeof(val)))
+                goto truncated;
+            printf("%s", strerror((int)val));
+            break;
+        case 'n':
+            break;
+        default:
+            goto truncated;
+        }
+    }
+    print_literal(prev, prev + strlen(prev));
+    putchar('\n');
+    return;
+
+truncated:
+    printf("[truncated]\n");
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option opts_long[] = {
+        { "help", no_argument, 0, 'h' },
+        { 0,      0,           0,  0  }
+    };
+    struct tracedump ctx = { };
+    uint64_t buf[TR_BIN_REC_MAX / sizeof(uint64_t)];
+    struct tr_bin_rec *rec = (struct tr_bin_rec *)buf;
+    const char *fmt;
+    struct stat st;
+    uint64_t pos;
+    int opt, fd;
+
+    while ((opt = getopt_long(argc, argv, "h", opts_long, NULL)) != -1) {
+        switch (opt) {
+        case 'h':
+            print_help(stdout, 0);
+            break;
+        default:
+            print_help(stderr, 1);
+            break;
+        }
+    }
+    if (argc != optind + 1)
+        print_help(stderr, 1);
+
+    fd = open(argv[optind], O_RDONLY);
+    FATAL_ON(fd < 0, 2, "open %s: %m", argv[optind]);
+    FATAL_ON(fstat(fd, &st) < 0, 2, "fstat %s: %m", argv[optind]);
+    FATAL_ON(st.st_size < sizeof(struct tr_bin_hdr), 1, "%s: file too small", argv[optind]);
+    ctx.file_len = st.st_size;
+    ctx.file = mmap(NULL, ctx.file_len, PROT_READ, MAP_SHARED, fd, 0);
+    FATAL_ON(ctx.file == MAP_FAILED, 2, "mmap %s: %m", argv[optind]);
+    close(fd);
+
+    ctx.hdr = (const struct tr_bin_hdr *)ctx.file;
+    FATAL_ON(memcmp(ctx.hdr->magic, TR_BIN_MAGIC, sizeof(ctx.hdr->magic)), 1,
+             "%s: invalid magic", argv[optind]);
+    FATAL_ON(ctx.hdr->ring_size & (ctx.hdr->ring_size - 1), 1, "%s: corrupted header", argv[optind]);
+    FATAL_ON(ctx.hdr->fmt_offset + ctx.hdr->fmt_max * sizeof(uint32_t) > ctx.file_len ||
+             ctx.hdr->str_offset + ctx.hdr->str_size > ctx.file_len ||
+             ctx.hdr->ring_offset + ctx.hdr->ring_size > ctx.file_len,
+             1, "%s: truncated file", argv[optind]);
+    ctx.ring = ctx.file + ctx.hdr->ring_offset;
+    ctx.head = __atomic_load_n(&ctx.hdr->head, __ATOMIC_ACQUIRE);
+
+    // Records overwritten by a newer lap of the ring (or still being written)
+    // do not carry the expected position: skip them by steps of 8 bytes until
+    // the next valid record.
+    pos = ctx.head > ctx.hdr->ring_size ? ctx.head - ctx.hdr->ring_size : 0;
+    while (pos + sizeof(struct tr_bin_rec) <= ctx.head) {
+        ring_read(&ctx, pos, rec, sizeof(struct tr_bin_rec));
+        if (rec->pos != pos || rec->len < sizeof(struct tr_bin_rec) ||
+            rec->len > TR_BIN_REC_MAX || rec->len % 8 || pos + rec->len > ctx.head) {
+            pos += 8;
+            continue;
+        }
+        ring_read(&ctx, pos, rec, rec->len);
+        fmt = fmt_get(&ctx, rec->id);
+        if (fmt)
+            rec_print(rec, fmt);
+        else
+            printf("%ju.%06ju: [unknown format %u]\n", (uintmax_t)rec->tstamp_us / 1000000,
+                   (uintmax_t)rec->tstamp_us % 1000000, rec->id);
+        pos += rec->len;
+    }
+    return 0;
+}
@@ -240,8 +240,8 @@ static void dc_init_radio(struct dc *dc)
     dc->ws.phy.rcp_rail_config_index = rail_config->index;
 
     ws_chan_mask_calc_reg(chan_mask, dc->ws.fhss.chan_params, HIF_REG_NONE);
-    bitand(chan_mask, dc->cfg.ws_allowed_channels, 256);
-    if (!memzcmp(chan_mask, sizeof(chan_mask)))
+    ws_chan_mask_and(chan_mask, dc->cfg.ws_allowed_channels);
+    if (!ws_chan_mask_count(chan_mask))
         FATAL(1, "combination of allowed_channels and regulatory constraints results in no valid channel (see --list-rf-configs)");
     rcp_set_fhss_uc(&dc->ws.rcp, dc->cfg.ws_uc_dwell_interval_ms, chan_mask, NULL);
     // Disable async fragmentation for faster advertisement
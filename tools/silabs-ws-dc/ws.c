@@ -43,13 +43,13 @@ static int ws_send_lowpan(struct dc *dc, struct pktbuf *pktbuf, const uint8_t sr
     ipv6_addr_conv_iid_eui64(src_iid, src);
     ipv6_addr_conv_iid_eui64(dst_iid, dst);
 
-    lowpan_iphc_cmpr(pktbuf, src_iid, dst_iid);
+    lowpan_iphc_cmpr(pktbuf, src_iid, dst_iid, NULL);
     if (pktbuf->err) {
         TRACE(TR_TX_ABORT, "tx-abort: 6lowpan compression error");
         return -EINVAL;
     }
 
-    return ws_if_send_data(&dc->ws, pktbuf_head(pktbuf), pktbuf_len(pktbuf), &EUI64_FROM_BUF(dst));
+    return ws_if_send_data(&dc->ws, pktbuf_head(pktbuf), pktbuf_len(pktbuf), &EUI64_FROM_BUF(dst), WS_PRIO_DATA);
 }
 
 static int ws_send_ipv6(struct dc *dc, struct pktbuf *pktbuf, uint8_t ipproto, uint8_t hlim,
@@ -245,7 +245,7 @@ static void ws_recv_6lowpan(struct dc *dc, const uint8_t *buf, size_t buf_len, c
 
     // TODO: support FRAG1 and FRAGN
     if (LOWPAN_DISPATCH_IS_IPHC(dispatch)) {
-        lowpan_iphc_decmpr(&pktbuf, src_iid, dst_iid);
+        lowpan_iphc_decmpr(&pktbuf, src_iid, dst_iid, NULL);
     } else {
         TRACE(TR_DROP, "drop %-9s: unsupported dispatch type 0x%02x", "6lowpan", dispatch);
         goto err;
@@ -0,0 +1,81 @@
+/*
+ * SPDX-License-Identifier: LicenseRef-MSLA
+ * Copyright (c) 2025 Silicon Laboratories Inc. (www.silabs.com)
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of the Silicon Labs Master Software License
+ * Agreement (MSLA) available at [1].  This software is distributed to you in
+ * Object Code format and/or Source Code format and is governed by the sections
+ * of the MSLA applicable to Object Code, Source Code and Modified Open Source
+ * Code. By using this software, you agree to the terms of the MSLA.
+ *
+ * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
+ */
+#include <sys/mman.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "common/log_bin.h"
+#include "common/log.h"
+
+/*
+ * Strings traced with a precision (for example packet data with "%.*s") are
+ * not necessarily NUL terminated. They are placed here right before an
+ * inaccessible page, so reading past the precision crashes the test.
+ */
+
+static const struct tr_bin_rec *test_rec(uint64_t pos)
+{
+    return (const struct tr_bin_rec *)((uint8_t *)g_trace_ring + g_trace_ring->ring_offset + pos);
+}
+
+// Returns the position of the next record
+static uint64_t test_check_str(uint64_t pos, int star_count, const char *expected)
+{
+    const struct tr_bin_rec *rec = test_rec(pos);
+    const uint8_t *data = rec->data + star_count * sizeof(uint64_t);
+    uint16_t len;
+
+    BUG_ON(rec->pos != pos);
+    memcpy(&len, data, sizeof(len));
+    BUG_ON(len != strlen(expected), "len=%u expected=\"%s\"", len, expected);
+    BUG_ON(memcmp(data + sizeof(len), expected, len));
+    return pos + rec->len;
+}
+
+int main(void)
+{
+    char path[] = "/tmp/test-log-bin-XXXXXX";
+    long page_size = sysconf(_SC_PAGESIZE);
+    uint16_t site_ids[4] = { };
+    uint64_t pos = 0;
+    uint8_t *pages;
+    char *str;
+    int fd;
+
+    fd = mkstemp(path);
+    FATAL_ON(fd < 0, 2, "mkstemp: %m");
+    close(fd);
+    tr_bin_open(path, 4096);
+    unlink(path);
+
+    pages = mmap(NULL, 2 * page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    FATAL_ON(pages == MAP_FAILED, 2, "mmap: %m");
+    FATAL_ON(mprotect(pages + page_size, page_size, PROT_NONE) < 0, 2, "mprotect: %m");
+    str = (char *)pages + page_size - 4;
+    memcpy(str, "abcd", 4);
+
+    __tr_bin_printf(&site_ids[0], "identity=\"%.*s\"", 4, str);
+    pos = test_check_str(pos, 1, "abcd");
+    __tr_bin_printf(&site_ids[1], "identity=\"%.4s\"", str);
+    pos = test_check_str(pos, 0, "abcd");
+    __tr_bin_printf(&site_ids[2], "identity=\"%*.*s\"", 8, 2, str);
+    pos = test_check_str(pos, 2, "ab");
+    // A negative precision is ignored, the string is NUL terminated here
+    __tr_bin_printf(&site_ids[3], "identity=\"%.*s\"", -1, "xyz");
+    pos = test_check_str(pos, 1, "xyz");
+
+    munmap(pages, 2 * page_size);
+    return 0;
+}
@@ -0,0 +1,178 @@
+/*
+ * SPDX-License-Identifier: LicenseRef-MSLA
+ * Copyright (c) 2025 Silicon Laboratories Inc. (www.silabs.com)
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of the Silicon Labs Master Software License
+ * Agreement (MSLA) available at [1].  This software is distributed to you in
+ * Object Code format and/or Source Code format and is governed by the sections
+ * of the MSLA applicable to Object Code, Source Code and Modified Open Source
+ * Code. By using this software, you agree to the terms of the MSLA.
+ *
+ * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
+ */
+#include <netinet/ip6.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "app_wsrd/ipv6/6lowpan.h"
+#include "app_wsrd/ipv6/ipv6.h"
+#include "common/ipv6/ipv6_addr.h"
+#include "common/log.h"
+#include "common/memutils.h"
+#include "common/pktbuf.h"
+
+/*
+ * Round-trip of fragmented datagrams through lowpan_send() and lowpan_recv(),
+ * with fragments delivered out of order, duplicated, or lost. The IPv6 layer
+ * is replaced by the stubs below.
+ */
+
+#define FRAG_MAX 64
+
+struct frag {
+    uint8_t buf[256];
+    size_t len;
+};
+
+static struct frag frags[FRAG_MAX];
+static int frag_count;
+
+static uint8_t rcvd[1280];
+static size_t rcvd_len;
+static int rcvd_count;
+
+void ipv6_recvfrom_mac(struct ipv6_ctx *ipv6, struct pktbuf *pktbuf, const struct eui64 *src_eui64)
+{
+    BUG_ON(pktbuf_len(pktbuf) > sizeof(rcvd));
+    memcpy(rcvd, pktbuf_head(pktbuf), pktbuf_len(pktbuf));
+    rcvd_len = pktbuf_len(pktbuf);
+    rcvd_count++;
+}
+
+static int test_sendto_mac(struct ipv6_ctx *ipv6, struct pktbuf *pktbuf, const struct eui64 *dst, int prio)
+{
+    BUG_ON(frag_count >= FRAG_MAX);
+    BUG_ON(pktbuf_len(pktbuf) > ipv6->lowpan.frag_mtu);
+    memcpy(frags[frag_count].buf, pktbuf_head(pktbuf), pktbuf_len(pktbuf));
+    frags[frag_count].len = pktbuf_len(pktbuf);
+    return frag_count++;
+}
+
+// Timer groups are registered globally: contexts are initialized only once
+static struct ipv6_ctx tx = {
+    .sendto_mac = test_sendto_mac,
+    .lowpan.reasm_max = 4,
+    .lowpan.reasm_timeout_ms = 60000,
+};
+static struct ipv6_ctx rx = {
+    .lowpan.reasm_max = 4,
+    .lowpan.reasm_timeout_ms = 60000,
+};
+
+static size_t test_pkt_build(uint8_t *pkt, size_t size, const struct eui64 *src, const struct eui64 *dst)
+{
+    struct ip6_hdr *hdr = (struct ip6_hdr *)pkt;
+
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->ip6_flow = htonl(6 << 28);
+    hdr->ip6_plen = htons(size - sizeof(*hdr));
+    hdr->ip6_nxt  = IPPROTO_UDP;
+    hdr->ip6_hlim = 64;
+    hdr->ip6_src.s6_addr[0] = 0xfe;
+    hdr->ip6_src.s6_addr[1] = 0x80;
+    ipv6_addr_conv_iid_eui64(hdr->ip6_src.s6_addr + 8, src->u8);
+    hdr->ip6_dst.s6_addr[0] = 0xfe;
+    hdr->ip6_dst.s6_addr[1] = 0x80;
+    ipv6_addr_conv_iid_eui64(hdr->ip6_dst.s6_addr + 8, dst->u8);
+    for (size_t i = sizeof(*hdr); i < size; i++)
+        pkt[i] = i * 7;
+    return size;
+}
+
+static void test_recv(struct ipv6_ctx *ipv6, const int *order, int count,
+                      const struct eui64 *src, const struct eui64 *dst)
+{
+    for (int i = 0; i < count; i++)
+        lowpan_recv(ipv6, frags[order[i]].buf, frags[order[i]].len, src, dst);
+}
+
+static void test_roundtrip(int frag_mtu, size_t size)
+{
+    const struct eui64 src = { .u8 = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01 } };
+    const struct eui64 dst = { .u8 = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02 } };
+    struct pktbuf pktbuf = { };
+    uint8_t pkt[1280];
+    int order[FRAG_MAX];
+    int ret;
+
+    tx.lowpan.frag_mtu = frag_mtu;
+    test_pkt_build(pkt, size, &src, &dst);
+    frag_count = 0;
+    pktbuf_init(&pktbuf, pkt, size);
+    ret = lowpan_send(&tx, &pktbuf, &src, &dst, 0);
+    pktbuf_free(&pktbuf);
+    BUG_ON(ret < 0, "mtu=%d size=%zu: lowpan_send() failed", frag_mtu, size);
+    BUG_ON(frag_count < 2, "mtu=%d size=%zu: datagram not fragmented", frag_mtu, size);
+
+    // In order
+    for (int i = 0; i < frag_count; i++)
+        order[i] = i;
+    rcvd_count = 0;
+    test_recv(&rx, order, frag_count, &src, &dst);
+    BUG_ON(rcvd_count != 1, "mtu=%d size=%zu: in order", frag_mtu, size);
+    BUG_ON(rcvd_len != size || memcmp(rcvd, pkt, size), "mtu=%d size=%zu: in order", frag_mtu, size);
+
+    // Reverse order, FRAG1 last
+    for (int i = 0; i < frag_count; i++)
+        order[i] = frag_count - 1 - i;
+    rcvd_count = 0;
+    test_recv(&rx, order, frag_count, &src, &dst);
+    BUG_ON(rcvd_count != 1, "mtu=%d size=%zu: reverse order", frag_mtu, size);
+    BUG_ON(rcvd_len != size || memcmp(rcvd, pkt, size), "mtu=%d size=%zu: reverse order", frag_mtu, size);
+
+    // Shuffled, with every fragment duplicated
+    for (int i = 0; i < frag_count; i++)
+        order[i] = i;
+    for (int i = frag_count - 1; i > 0; i--) {
+        int j = rand() % (i + 1);
+        int tmp = order[i];
+
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+    rcvd_count = 0;
+    for (int i = 0; i < frag_count; i++)
+        test_recv(&rx, order + i, 1, &src, &dst);
+    test_recv(&rx, order, frag_count, &src, &dst);
+    BUG_ON(rcvd_count != 2, "mtu=%d size=%zu: duplicates", frag_mtu, size);
+    BUG_ON(rcvd_len != size || memcmp(rcvd, pkt, size), "mtu=%d size=%zu: duplicates", frag_mtu, size);
+    BUG_ON(rx.lowpan.reasm_count, "mtu=%d size=%zu: duplicates", frag_mtu, size);
+
+    // Each fragment lost in turn, then retransmitted
+    for (int lost = 0; lost < frag_count; lost++) {
+        for (int i = 0; i < frag_count; i++)
+            order[i] = i;
+        order[lost] = order[frag_count - 1];
+        rcvd_count = 0;
+        test_recv(&rx, order, frag_count - 1, &src, &dst);
+        BUG_ON(rcvd_count, "mtu=%d size=%zu: fragment %d lost", frag_mtu, size, lost);
+        BUG_ON(rx.lowpan.reasm_count != 1, "mtu=%d size=%zu: fragment %d lost", frag_mtu, size, lost);
+        test_recv(&rx, &lost, 1, &src, &dst);
+        BUG_ON(rcvd_count != 1, "mtu=%d size=%zu: fragment %d retransmitted", frag_mtu, size, lost);
+        BUG_ON(rcvd_len != size || memcmp(rcvd, pkt, size),
+               "mtu=%d size=%zu: fragment %d retransmitted", frag_mtu, size, lost);
+        BUG_ON(rx.lowpan.reasm_count, "mtu=%d size=%zu: fragment %d retransmitted", frag_mtu, size, lost);
+    }
+}
+
+int main(void)
+{
+    srand(0);
+    timer_group_init(&tx.lowpan.timer_group);
+    timer_group_init(&rx.lowpan.timer_group);
+    for (int frag_mtu = 48; frag_mtu <= 200; frag_mtu += 13)
+        for (size_t size = 300; size <= 1280; size += 97)
+            test_roundtrip(frag_mtu, size);
+    return 0;
+}
@@ -0,0 +1,181 @@
+/*
+ * SPDX-License-Identifier: LicenseRef-MSLA
+ * Copyright (c) 2025 Silicon Laboratories Inc. (www.silabs.com)
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of the Silicon Labs Master Software License
+ * Agreement (MSLA) available at [1].  This software is distributed to you in
+ * Object Code format and/or Source Code format and is governed by the sections
+ * of the MSLA applicable to Object Code, Source Code and Modified Open Source
+ * Code. By using this software, you agree to the terms of the MSLA.
+ *
+ * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
+ */
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/ws/ws_chan_mask.h"
+#include "common/ws/ws_regdb.h"
+#include "common/bits.h"
+#include "common/hif.h"
+#include "common/log.h"
+#include "common/mathutils.h"
+#include "common/memutils.h"
+
+/*
+ * The ws_chan_mask helpers work on 64-bit words. They are compared here with
+ * straightforward bit by bit implementations, for the regulatory mask of every
+ * entry of chan_params_table combined with various custom masks.
+ */
+
+#define CUSTOM_MASK_COUNT 200
+
+static int ref_get_fixed(const uint8_t chan_mask[WS_CHAN_MASK_LEN])
+{
+    int val = -EINVAL;
+
+    for (int i = 0; i < 8 * WS_CHAN_MASK_LEN; i++) {
+        if (bittest(chan_mask, i)) {
+            if (val >= 0)
+                return -EINVAL;
+            val = i;
+        }
+    }
+    return val;
+}
+
+static int ref_width(const uint8_t chan_mask[WS_CHAN_MASK_LEN])
+{
+    for (int i = WS_CHAN_MASK_LEN - 1; i >= 0; i--)
+        if (chan_mask[i])
+            return i + 1;
+    return 0;
+}
+
+static void test_nth(const uint8_t chan_mask[WS_CHAN_MASK_LEN])
+{
+    int cnt = 0;
+
+    for (int i = 0; i < 8 * WS_CHAN_MASK_LEN; i++) {
+        if (!bittest(chan_mask, i))
+            continue;
+        BUG_ON(ws_chan_mask_nth(chan_mask, cnt) != i);
+        cnt++;
+    }
+    BUG_ON(ws_chan_mask_count(chan_mask) != cnt);
+    BUG_ON(ws_chan_mask_nth(chan_mask, cnt) >= 0);
+}
+
+static int ref_find_next(const uint8_t chan_mask[WS_CHAN_MASK_LEN], int start, bool val)
+{
+    for (int i = start; i < 8 * WS_CHAN_MASK_LEN; i++)
+        if (bittest(chan_mask, i) == val)
+            return i;
+    return 8 * WS_CHAN_MASK_LEN;
+}
+
+static void ref_calc_excl(uint8_t chan_mask_excl[WS_CHAN_MASK_LEN],
+                          const uint8_t chan_mask_reg[WS_CHAN_MASK_LEN],
+                          const uint8_t chan_mask_custom[WS_CHAN_MASK_LEN])
+{
+    if (ref_get_fixed(chan_mask_custom) >= 0) {
+        memset(chan_mask_excl, 0, WS_CHAN_MASK_LEN);
+    } else {
+        for (int i = 0; i < WS_CHAN_MASK_LEN; i++)
+            chan_mask_excl[i] = chan_mask_reg[i] & ~chan_mask_custom[i];
+    }
+}
+
+static int ref_ranges(const uint8_t chan_mask[WS_CHAN_MASK_LEN])
+{
+    bool in_range = false;
+    int cnt = 0;
+
+    for (int i = 0; i < 8 * WS_CHAN_MASK_LEN; i++) {
+        if (in_range != bittest(chan_mask, i)) {
+            in_range = !in_range;
+            cnt += in_range;
+        }
+    }
+    return cnt;
+}
+
+static void test_custom_mask(uint8_t chan_mask[WS_CHAN_MASK_LEN],
+                             const uint8_t chan_mask_reg[WS_CHAN_MASK_LEN], int k)
+{
+    int start, len;
+
+    switch (k % 4) {
+    case 0: // Random subset
+        memcpy(chan_mask, chan_mask_reg, WS_CHAN_MASK_LEN);
+        for (int i = 0; i < WS_CHAN_MASK_LEN; i++)
+            chan_mask[i] &= rand();
+        break;
+    case 1: // Single channel
+        memset(chan_mask, 0, WS_CHAN_MASK_LEN);
+        bitset(chan_mask, rand() % (8 * WS_CHAN_MASK_LEN));
+        break;
+    case 2: // Empty, or single channel
+        memset(chan_mask, 0, WS_CHAN_MASK_LEN);
+        if (k & 4)
+            bitset(chan_mask, rand() % (8 * WS_CHAN_MASK_LEN));
+        break;
+    case 3: // Excluded range, possibly reaching the last channel
+        memcpy(chan_mask, chan_mask_reg, WS_CHAN_MASK_LEN);
+        start = rand() % (8 * WS_CHAN_MASK_LEN);
+        len = rand() % 40;
+        bitfill(chan_mask, false, start, MIN(start + len, 8 * WS_CHAN_MASK_LEN - 1));
+        break;
+    }
+}
+
+static void test_chan_params(const struct chan_params *chan_params, uint8_t reg)
+{
+    uint8_t chan_mask_reg[WS_CHAN_MASK_LEN];
+    uint8_t chan_mask_custom[WS_CHAN_MASK_LEN];
+    uint8_t chan_mask_excl[WS_CHAN_MASK_LEN];
+    uint8_t chan_mask_ref[WS_CHAN_MASK_LEN];
+    uint8_t chan_mask[WS_CHAN_MASK_LEN];
+
+    ws_chan_mask_calc_reg(chan_mask_reg, chan_params, reg);
+    test_nth(chan_mask_reg);
+    for (int k = 0; k < CUSTOM_MASK_COUNT; k++) {
+        test_custom_mask(chan_mask_custom, chan_mask_reg, k);
+        BUG_ON(ws_chan_mask_get_fixed(chan_mask_custom) != ref_get_fixed(chan_mask_custom));
+        BUG_ON(ws_chan_mask_width(chan_mask_custom) != ref_width(chan_mask_custom));
+        BUG_ON(ws_chan_mask_ranges(chan_mask_custom) != ref_ranges(chan_mask_custom));
+        test_nth(chan_mask_custom);
+        for (int i = 0; i <= 8 * WS_CHAN_MASK_LEN; i++) {
+            BUG_ON(ws_chan_mask_find_next(chan_mask_custom, i, true) != ref_find_next(chan_mask_custom, i, true));
+            BUG_ON(ws_chan_mask_find_next(chan_mask_custom, i, false) != ref_find_next(chan_mask_custom, i, false));
+        }
+
+        ws_chan_mask_calc_excl(chan_mask_excl, chan_mask_reg, chan_mask_custom);
+        ref_calc_excl(chan_mask_ref, chan_mask_reg, chan_mask_custom);
+        BUG_ON(memcmp(chan_mask_excl, chan_mask_ref, WS_CHAN_MASK_LEN));
+        BUG_ON(ws_chan_mask_width(chan_mask_excl) != ref_width(chan_mask_excl));
+        BUG_ON(ws_chan_mask_ranges(chan_mask_excl) != ref_ranges(chan_mask_excl));
+
+        memcpy(chan_mask, chan_mask_reg, WS_CHAN_MASK_LEN);
+        ws_chan_mask_and(chan_mask, chan_mask_custom);
+        for (int i = 0; i < WS_CHAN_MASK_LEN; i++)
+            BUG_ON(chan_mask[i] != (chan_mask_reg[i] & chan_mask_custom[i]));
+        memcpy(chan_mask, chan_mask_reg, WS_CHAN_MASK_LEN);
+        ws_chan_mask_andn(chan_mask, chan_mask_custom);
+        for (int i = 0; i < WS_CHAN_MASK_LEN; i++)
+            BUG_ON(chan_mask[i] != (chan_mask_reg[i] & ~chan_mask_custom[i]));
+    }
+}
+
+int main(void)
+{
+    // ARIB is only supported for some Japanese channel plans
+    static const uint8_t regs[] = { HIF_REG_NONE, HIF_REG_FCC, HIF_REG_ETSI };
+
+    srand(0);
+    for (int i = 0; chan_params_table[i].chan0_freq; i++)
+        for (int j = 0; j < ARRAY_SIZE(regs); j++)
+            test_chan_params(&chan_params_table[i], regs[j]);
+    return 0;
+}
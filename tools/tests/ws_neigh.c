@@ -0,0 +1,172 @@
+/*
+ * SPDX-License-Identifier: LicenseRef-MSLA
+ * Copyright (c) 2025 Silicon Laboratories Inc. (www.silabs.com)
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of the Silicon Labs Master Software License
+ * Agreement (MSLA) available at [1].  This software is distributed to you in
+ * Object Code format and/or Source Code format and is governed by the sections
+ * of the MSLA applicable to Object Code, Source Code and Modified Open Source
+ * Code. By using this software, you agree to the terms of the MSLA.
+ *
+ * [1]: https://www.silabs.com/about-us/legal/master-software-license-agreement
+ */
+#include <inttypes.h>
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "common/ws/ws_neigh.h"
+#include "common/specs/ws.h"
+#include "common/sys_queue_extra.h"
+#include "common/time_extra.h"
+#include "common/log.h"
+
+/*
+ * Consistency of the EUI-64 index and of the hot field array of struct
+ * ws_neigh_table across additions and deletions, followed by a comparison of
+ * ws_neigh_get() with a walk of the neighbor list, and of a scan of the hot
+ * field array with a scan of the neighbor list. Neighbors are interleaved with
+ * unrelated heap allocations so that they do not end up contiguous in memory.
+ */
+
+#define NEIGH_COUNT  5000
+#define LOOKUP_COUNT 20000
+#define SCAN_COUNT   1000
+
+// Avoid pulling common/capture.c, which is only needed for replay
+ssize_t xgetrandom(void *buf, size_t buf_len, unsigned int flags)
+{
+    uint8_t *ptr = buf;
+
+    for (size_t i = 0; i < buf_len; i++)
+        ptr[i] = rand();
+    return buf_len;
+}
+
+static struct eui64 eui64s[NEIGH_COUNT];
+static void *filler[NEIGH_COUNT];
+
+// Timer groups are registered globally: the table is initialized only once
+static struct ws_neigh_table table;
+
+static struct ws_neigh *test_list_find(const struct eui64 *eui64)
+{
+    struct ws_neigh *neigh;
+
+    return SLIST_FIND(neigh, &table.neigh_list, link, eui64_eq(&neigh->eui64, eui64));
+}
+
+static struct ws_neigh *test_index_find(const struct eui64 *eui64)
+{
+    return ws_neigh_get(&table, eui64);
+}
+
+// Before the hot/cold split, lifetime_s, etx, node_role and trusted_device
+// were stored in struct ws_neigh, next to the fields read here.
+static int test_list_scan(void)
+{
+    struct ws_neigh *neigh;
+    int cnt = 0;
+
+    SLIST_FOREACH(neigh, &table.neigh_list, link)
+        if (neigh->expiration_s < WS_NEIGHBOR_LINK_TIMEOUT && !neigh->etx_tx_cnt && !neigh->edfe_mode)
+            cnt++;
+    return cnt;
+}
+
+static int test_hot_scan(void)
+{
+    int cnt = 0;
+
+    for (int i = 0; i < table.hot_len; i++)
+        if (table.hot[i].lifetime_s <= WS_NEIGHBOR_LINK_TIMEOUT && isnan(table.hot[i].etx) && !table.hot[i].trusted)
+            cnt++;
+    return cnt;
+}
+
+static uint64_t test_bench_scan(int (*scan)(void))
+{
+    uint64_t start_us;
+
+    start_us = time_now_us(CLOCK_MONOTONIC);
+    for (int i = 0; i < SCAN_COUNT; i++)
+        BUG_ON(scan() != NEIGH_COUNT);
+    return time_now_us(CLOCK_MONOTONIC) - start_us;
+}
+
+static void test_check(int count, bool deleted_odd)
+{
+    struct ws_neigh *neigh;
+
+    for (int i = 0; i < table.hot_len; i++)
+        BUG_ON(table.hot[i].neigh->id != i);
+    BUG_ON(ws_neigh_get_neigh_count(&table) != (deleted_odd ? count / 2 : count));
+    BUG_ON(ws_neigh_lfn_count(&table) != (deleted_odd ? 0 : count / 2));
+
+    for (int i = 0; i < count; i++) {
+        neigh = ws_neigh_get(&table, &eui64s[i]);
+        if (deleted_odd && i % 2) {
+            BUG_ON(neigh, "%s still indexed", tr_eui64(eui64s[i].u8));
+        } else {
+            BUG_ON(!neigh, "%s not indexed", tr_eui64(eui64s[i].u8));
+            BUG_ON(!eui64_eq(&neigh->eui64, &eui64s[i]));
+            BUG_ON(ws_neigh_hot(&table, neigh)->neigh != neigh);
+            BUG_ON(ws_neigh_hot(&table, neigh)->node_role != (i % 2 ? WS_NR_ROLE_LFN : WS_NR_ROLE_ROUTER));
+        }
+    }
+}
+
+static uint64_t test_bench(struct ws_neigh *(*find)(const struct eui64 *eui64))
+{
+    uint64_t start_us;
+
+    start_us = time_now_us(CLOCK_MONOTONIC);
+    for (int i = 0; i < LOOKUP_COUNT; i++)
+        BUG_ON(!find(&eui64s[rand() % NEIGH_COUNT]));
+    return time_now_us(CLOCK_MONOTONIC) - start_us;
+}
+
+int main(void)
+{
+    uint64_t list_us, index_us, hot_us;
+
+    srand(0);
+    timer_group_init(&table.timer_group);
+    for (int i = 0; i < NEIGH_COUNT; i++) {
+        for (int j = 0; j < sizeof(eui64s[i].u8); j++)
+            eui64s[i].u8[j] = rand();
+        // Neighbors often share an OUI
+        eui64s[i].u8[0] = 0x02;
+        eui64s[i].u8[1] = 0x00;
+        eui64s[i].u8[2] = 0x5e;
+        ws_neigh_add(&table, &eui64s[i], i % 2 ? WS_NR_ROLE_LFN : WS_NR_ROLE_ROUTER, 0, 0);
+        filler[i] = malloc(64 + rand() % 512);
+    }
+    test_check(NEIGH_COUNT, false);
+
+    list_us  = test_bench(test_list_find);
+    index_us = test_bench(test_index_find);
+    INFO("%d neighbors, %d lookups: list %"PRIu64"us, index %"PRIu64"us",
+         NEIGH_COUNT, LOOKUP_COUNT, list_us, index_us);
+    list_us = test_bench_scan(test_list_scan);
+    hot_us  = test_bench_scan(test_hot_scan);
+    INFO("%d neighbors, %d scans: list %"PRIu64"us, hot array %"PRIu64"us",
+         NEIGH_COUNT, SCAN_COUNT, list_us, hot_us);
+
+    for (int i = 1; i < NEIGH_COUNT; i += 2)
+        ws_neigh_del(&table, &eui64s[i]);
+    test_check(NEIGH_COUNT, true);
+    for (int i = 1; i < NEIGH_COUNT; i += 2)
+        ws_neigh_add(&table, &eui64s[i], WS_NR_ROLE_LFN, 0, 0);
+    test_check(NEIGH_COUNT, false);
+
+    ws_neigh_clean(&table);
+    BUG_ON(!SLIST_EMPTY(&table.neigh_list));
+    BUG_ON(table.hot_len || table.hot);
+    for (int i = 0; i < WS_NEIGH_HASH_SIZE; i++)
+        BUG_ON(!SLIST_EMPTY(&table.neigh_hash[i]));
+    for (int i = 0; i < NEIGH_COUNT; i++)
+        free(filler[i]);
+    return 0;
+}